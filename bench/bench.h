@@ -0,0 +1,271 @@
+/**
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/**
+ * A small benchmark harness.
+ *
+ * Each benchmark is a callable taking an iteration count. The
+ * runner calibrates the count so one repetition runs for at least
+ * the minimum time, warms up, then times several repetitions and
+ * reports the mean, standard deviation and minimum time per item.
+ */
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>                          // std::atof()
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>                      // __rdtsc()
+#endif
+
+namespace bench {
+
+/**
+ * Keep the compiler from discarding \c value, or from assuming
+ * it is unchanged between iterations.
+ */
+template <typename T>
+inline void doNotOptimize(T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : "+m"(value) : : "memory");
+#else
+    volatile char sink = *reinterpret_cast<volatile char*>(&value);
+    (void)sink;
+#endif
+}
+
+template <typename T>
+inline void doNotOptimize(T const& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "m"(value) : "memory");
+#else
+    volatile char sink = *reinterpret_cast<volatile char const*>(&value);
+    (void)sink;
+#endif
+}
+
+/**
+ * A timestamp counter for cycles/op. On x86 this is the TSC,
+ * which counts reference cycles; elsewhere it is unavailable
+ * and reads as zero.
+ */
+inline uint64_t cycles()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Statistics for one benchmark.
+ */
+struct Result
+{
+    std::string name;
+    std::size_t items;                      // items processed per iteration
+    uint64_t iterations;                    // iterations per repetition
+    int repetitions;
+
+    double nsMean;                          // ns per item
+    double nsStddev;
+    double nsMin;
+    double cyclesPerItem;
+    double itemsPerSec;
+};
+
+struct Options
+{
+    double minTime = 0.05;                  // seconds per repetition
+    double warmupTime = 0.02;               // seconds
+    int repetitions = 5;
+    std::string filter;                     // substring match on names
+    std::string jsonPath;
+    std::string comparePath;
+    double threshold = 0.10;                // regression limit for --compare
+};
+
+class Runner
+{
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    Options m_opts;
+    std::vector<Result> m_results;
+
+    template <typename Fn>
+    static double timeIt(Fn& fn, uint64_t iters, uint64_t& ticks)
+    {
+        uint64_t const c0 = cycles();
+        Clock::time_point const t0 = Clock::now();
+        fn(iters);
+        Clock::time_point const t1 = Clock::now();
+        ticks = cycles() - c0;
+        return std::chrono::duration<double>(t1 - t0).count();
+    }
+
+  public:
+    explicit Runner(Options const& opts)
+        : m_opts(opts)
+    { }
+
+    std::vector<Result> const& results() const { return m_results; }
+
+    /**
+     * Run benchmark \c name. \c fn(n) must perform \c n iterations,
+     * each processing \c items items.
+     */
+    template <typename Fn>
+    void run(std::string const& name, std::size_t items, Fn fn)
+    {
+        if (!m_opts.filter.empty() && name.find(m_opts.filter) == std::string::npos)
+            return;
+
+        // Calibrate and warm up: grow the count until a run takes
+        // a measurable share of the minimum time.
+        uint64_t iters = 1;
+        uint64_t ticks = 0;
+        double elapsed = 0;
+        Clock::time_point const warmupStart = Clock::now();
+        for (;;)
+        {
+            elapsed = timeIt(fn, iters, ticks);
+            double const warm = std::chrono::duration<double>(Clock::now() - warmupStart).count();
+            if (elapsed >= m_opts.minTime / 10 && warm >= m_opts.warmupTime)
+                break;
+            if (elapsed < m_opts.minTime / 10)
+                iters *= 2;
+        }
+        iters = std::max<uint64_t>(1, uint64_t(iters * (m_opts.minTime / elapsed)));
+
+        std::vector<double> ns;
+        double cyc = 0;
+        for (int r=0; r<m_opts.repetitions; ++r)
+        {
+            elapsed = timeIt(fn, iters, ticks);
+            ns.push_back(1.0e9 * elapsed / (double(iters) * items));
+            cyc += double(ticks) / (double(iters) * items);
+        }
+
+        Result res;
+        res.name = name;
+        res.items = items;
+        res.iterations = iters;
+        res.repetitions = m_opts.repetitions;
+
+        double sum = 0;
+        for (double v : ns)
+            sum += v;
+        res.nsMean = sum / ns.size();
+
+        double var = 0;
+        for (double v : ns)
+            var += (v - res.nsMean) * (v - res.nsMean);
+        res.nsStddev = (ns.size() > 1) ? std::sqrt(var / (ns.size() - 1)) : 0.0;
+        res.nsMin = *std::min_element(ns.begin(), ns.end());
+        res.cyclesPerItem = cyc / m_opts.repetitions;
+        res.itemsPerSec = 1.0e9 / res.nsMean;
+
+        std::printf("%-40s %10.3f ns/op  +-%6.2f%%  %8.2f cyc/op  %10.3f M/s\n",
+                    res.name.c_str(), res.nsMean,
+                    100.0 * res.nsStddev / res.nsMean,
+                    res.cyclesPerItem, res.itemsPerSec / 1.0e6);
+        std::fflush(stdout);
+
+        m_results.push_back(res);
+    }
+
+    /**
+     * Write results as JSON. Each benchmark is on its own line so
+     * two result files diff cleanly.
+     */
+    bool writeJson(std::string const& path, std::string const& context) const
+    {
+        std::ofstream os(path.c_str());
+        if (!os)
+            return false;
+
+        os << "{\n  \"context\": " << context << ",\n  \"benchmarks\": [\n";
+        for (std::size_t i=0; i<m_results.size(); ++i)
+        {
+            Result const& r = m_results[i];
+            char line[512];
+            std::snprintf(line, sizeof(line),
+                          "    {\"name\": \"%s\", \"items\": %zu, \"iterations\": %llu, "
+                          "\"repetitions\": %d, \"ns_per_op\": %.4f, \"ns_per_op_stddev\": %.4f, "
+                          "\"ns_per_op_min\": %.4f, \"cycles_per_op\": %.3f, \"items_per_second\": %.1f}%s\n",
+                          r.name.c_str(), r.items, (unsigned long long)r.iterations,
+                          r.repetitions, r.nsMean, r.nsStddev, r.nsMin,
+                          r.cyclesPerItem, r.itemsPerSec,
+                          (i+1 < m_results.size()) ? "," : "");
+            os << line;
+        }
+        os << "  ]\n}\n";
+        return bool(os);
+    }
+
+    /**
+     * Compare against a JSON file from writeJson(). Prints every
+     * benchmark present in both, and returns the number that are
+     * slower than the baseline by more than the threshold.
+     */
+    int compare(std::string const& path) const
+    {
+        std::ifstream is(path.c_str());
+        if (!is)
+        {
+            std::printf("cannot read baseline %s\n", path.c_str());
+            return -1;
+        }
+
+        std::map<std::string, double> base;
+        std::string line;
+        while (std::getline(is, line))
+        {
+            std::size_t const n = line.find("\"name\": \"");
+            std::size_t const t = line.find("\"ns_per_op\": ");
+            if (n == std::string::npos || t == std::string::npos)
+                continue;
+            std::size_t const start = n + 9;
+            std::string const name = line.substr(start, line.find('"', start) - start);
+            base[name] = std::atof(line.c_str() + t + 13);
+        }
+
+        int regressions = 0;
+        std::printf("\n%-40s %10s %10s %8s\n", "benchmark", "base", "now", "change");
+        for (Result const& r : m_results)
+        {
+            std::map<std::string, double>::const_iterator it = base.find(r.name);
+            if (it == base.end() || it->second <= 0)
+                continue;
+
+            double const change = r.nsMean / it->second - 1.0;
+            bool const slow = change > m_opts.threshold;
+            regressions += slow;
+            std::printf("%-40s %10.3f %10.3f %+7.1f%%%s\n", r.name.c_str(),
+                        it->second, r.nsMean, 100.0 * change, slow ? "  REGRESSION" : "");
+        }
+        return regressions;
+    }
+};
+
+} // ::bench
+
+#endif // BENCH_H
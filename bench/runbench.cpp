@@ -0,0 +1,1331 @@
+/**
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/**
+ * Benchmarks for the vecmath operators, factories and kernels.
+ *
+ * Usage: runbench [--filter=substr] [--min-time=sec] [--repetitions=n]
+ *                 [--json=out.json] [--compare=baseline.json] [--threshold=0.10]
+ *
+ * Every benchmark runs for float and double. The "single" variant
+ * times one operation on values the compiler cannot see through;
+ * the "batch" variant times a loop over arrays of kBatch elements.
+ */
+#include "vecmath.h"
+#include "vecarray.h"
+#include "vecalloc.h"
+#include "aabb.h"
+#include "bvh.h"
+#include "vecbatch.h"
+#include "affine.h"
+#include "quaternion.h"
+#include "vecexpr.h"
+#include "vecfile.h"
+#include "vechierarchy.h"
+#include "vecintersect.h"
+#include "vecn.h"
+#include "vecpack.h"
+#include "vecparallel.h"
+#include "vecpipeline.h"
+#include "vecproject.h"
+#include "vecsimd.h"
+#include "vectext.h"
+#include "vectrig.h"
+#include "circle3pts.h"
+
+#include "bench.h"
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+std::size_t const kBatch = 1024;
+
+/*
+ * Deterministic pseudo-random values in [-1, 1).
+ */
+class Lcg
+{
+  private:
+    uint32_t m_state;
+
+  public:
+    explicit Lcg(uint32_t seed = 12345) : m_state(seed) { }
+
+    double next()
+    {
+        m_state = m_state * 1664525u + 1013904223u;
+        return (m_state >> 8) * (2.0 / 16777216.0) - 1.0;
+    }
+};
+
+template <typename fptype>
+std::vector<vecmath::Vector3<fptype>> makeVectors(std::size_t n, uint32_t seed)
+{
+    Lcg rng(seed);
+    std::vector<vecmath::Vector3<fptype>> v;
+    for (std::size_t i=0; i<n; ++i)
+    {
+        v.push_back({fptype(rng.next()), fptype(rng.next()), fptype(rng.next())});
+    }
+    return v;
+}
+
+template <typename fptype>
+std::vector<vecmath::Matrix3<fptype>> makeMatrices(std::size_t n, uint32_t seed)
+{
+    using Mat3 = vecmath::Matrix3<fptype>;
+    Lcg rng(seed);
+    std::vector<Mat3> m;
+    for (std::size_t i=0; i<n; ++i)
+    {
+        m.push_back(Mat3::translation(fptype(rng.next()), fptype(rng.next()), fptype(rng.next())) *
+                    Mat3::rotateX(fptype(rng.next())) *
+                    Mat3::rotateY(fptype(rng.next())) *
+                    Mat3::scale(fptype(1.5), fptype(0.5), fptype(2.0)));
+    }
+    return m;
+}
+
+/*
+ * Register single and batch variants of a binary operation.
+ */
+template <typename A, typename B, typename Op>
+void binary(bench::Runner& r, std::string const& name,
+            std::vector<A> const& va, std::vector<B> const& vb, Op op)
+{
+    A a = va[0];
+    B b = vb[0];
+    r.run(name + "/single", 1, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            bench::doNotOptimize(a);
+            bench::doNotOptimize(b);
+            auto res = op(a, b);
+            bench::doNotOptimize(res);
+        }
+    });
+
+    typedef decltype(op(va[0], vb[0])) R;
+    std::vector<R> out(va.size());
+    r.run(name + "/batch", va.size(), [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            for (std::size_t k=0; k<va.size(); ++k)
+            {
+                out[k] = op(va[k], vb[k]);
+            }
+            bench::doNotOptimize(out[0]);
+        }
+    });
+}
+
+/*
+ * Register single and batch variants of a unary operation.
+ */
+template <typename A, typename Op>
+void unary(bench::Runner& r, std::string const& name, std::vector<A> const& va, Op op)
+{
+    A a = va[0];
+    r.run(name + "/single", 1, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            bench::doNotOptimize(a);
+            auto res = op(a);
+            bench::doNotOptimize(res);
+        }
+    });
+
+    typedef decltype(op(va[0])) R;
+    std::vector<R> out(va.size());
+    r.run(name + "/batch", va.size(), [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            for (std::size_t k=0; k<va.size(); ++k)
+            {
+                out[k] = op(va[k]);
+            }
+            bench::doNotOptimize(out[0]);
+        }
+    });
+}
+
+template <typename fptype>
+void benchType(bench::Runner& r, std::string const& tname)
+{
+    using Vec3 = vecmath::Vector3<fptype>;
+    using Mat3 = vecmath::Matrix3<fptype>;
+
+    std::vector<Vec3> const va = makeVectors<fptype>(kBatch, 1);
+    std::vector<Vec3> const vb = makeVectors<fptype>(kBatch, 2);
+    std::vector<Mat3> const ma = makeMatrices<fptype>(kBatch, 4);
+    std::vector<Mat3> const mb = makeMatrices<fptype>(kBatch, 5);
+
+    std::vector<fptype> angles;
+    for (Vec3 const& v : va)
+        angles.push_back(v.X());
+
+    // vecops.h / vecfuncs.h
+    binary(r, "dot/" + tname, va, vb,
+           [](Vec3 const& a, Vec3 const& b) { return vecmath::dot(a, b); });
+    binary(r, "cross/" + tname, va, vb,
+           [](Vec3 const& a, Vec3 const& b) { return vecmath::cross(a, b); });
+    binary(r, "add/" + tname, va, vb,
+           [](Vec3 const& a, Vec3 const& b) { return a + b; });
+    binary(r, "sub/" + tname, va, vb,
+           [](Vec3 const& a, Vec3 const& b) { return a - b; });
+    binary(r, "midpoint/" + tname, va, vb,
+           [](Vec3 const& a, Vec3 const& b) { return vecmath::midpoint(a, b); });
+
+    // vecexpr.h, against the eager operators
+    {
+        std::vector<Vec3> const vc = makeVectors<fptype>(kBatch, 3);
+        std::vector<Vec3> out(kBatch);
+        r.run("add_sub/eager/" + tname + "/batch", kBatch, [&](uint64_t n) {
+            for (uint64_t i=0; i<n; ++i)
+            {
+                for (std::size_t k=0; k<kBatch; ++k)
+                {
+                    out[k] = va[k] + vb[k] - vc[k];
+                }
+                bench::doNotOptimize(out[0]);
+            }
+        });
+        r.run("add_sub/lazy/" + tname + "/batch", kBatch, [&](uint64_t n) {
+            for (uint64_t i=0; i<n; ++i)
+            {
+                for (std::size_t k=0; k<kBatch; ++k)
+                {
+                    out[k] = vecmath::lazy(va[k]) + vecmath::lazy(vb[k]) - vecmath::lazy(vc[k]);
+                }
+                bench::doNotOptimize(out[0]);
+            }
+        });
+
+        vecmath::Vector3Array<fptype> sa, sb, sout;
+        for (std::size_t k=0; k<kBatch; ++k)
+        {
+            sa.push_back(va[k]);
+            sb.push_back(vb[k]);
+        }
+        fptype const s = fptype(1.5);
+        r.run("axpy_soa/lazy/" + tname + "/batch", kBatch, [&](uint64_t n) {
+            for (uint64_t i=0; i<n; ++i)
+            {
+                vecmath::evaluate(vecmath::lazy(sa) * s + vecmath::lazy(sb), sout);
+                bench::doNotOptimize(sout.X()[0]);
+            }
+        });
+    }
+
+    // Vector3 members
+    unary(r, "length/" + tname, va,
+          [](Vec3 const& a) { return a.length(); });
+    unary(r, "normalize/" + tname, va,
+          [](Vec3 const& a) { Vec3 t = a; return t.normalize(); });
+    unary(r, "length_squared/" + tname, va,
+          [](Vec3 const& a) { return a.length_squared(); });
+    unary(r, "fast_length/exact/" + tname, va,
+          [](Vec3 const& a) { return a.template fast_length<vecmath::precision::exact>(); });
+    unary(r, "fast_length/refined/" + tname, va,
+          [](Vec3 const& a) { return a.template fast_length<vecmath::precision::refined>(); });
+    unary(r, "fast_length/approx/" + tname, va,
+          [](Vec3 const& a) { return a.template fast_length<vecmath::precision::approx>(); });
+    unary(r, "fast_normalize/exact/" + tname, va,
+          [](Vec3 const& a) { Vec3 t = a; return t.template fast_normalize<vecmath::precision::exact>(); });
+    unary(r, "fast_normalize/refined/" + tname, va,
+          [](Vec3 const& a) { Vec3 t = a; return t.template fast_normalize<vecmath::precision::refined>(); });
+    unary(r, "fast_normalize/approx/" + tname, va,
+          [](Vec3 const& a) { Vec3 t = a; return t.template fast_normalize<vecmath::precision::approx>(); });
+
+    // matops.h
+    binary(r, "mm_mult/" + tname, ma, mb,
+           [](Mat3 const& a, Mat3 const& b) { return a * b; });
+    binary(r, "mv_mult/" + tname, ma, va,
+           [](Mat3 const& m, Vec3 const& v) { return m * v; });
+    binary(r, "vm_mult/" + tname, va, ma,
+           [](Vec3 const& v, Mat3 const& m) { return v * m; });
+    unary(r, "inverse/" + tname, ma,
+          [](Mat3 const& m) { Mat3 r; m.inverse(r); return r; });
+    unary(r, "inverseAffine/" + tname, ma,
+          [](Mat3 const& m) { Mat3 r; m.inverseAffine(r); return r; });
+    unary(r, "inverseRigid/" + tname, ma,
+          [](Mat3 const& m) { return m.inverseRigid(); });
+    unary(r, "normalMatrix/" + tname, ma,
+          [](Mat3 const& m) { Mat3 r; m.normalMatrix(r); return r; });
+
+    // affine.h
+    {
+        using Aff3 = vecmath::AffineMatrix3<fptype>;
+        std::vector<Aff3> aa, ab;
+        for (std::size_t k=0; k<kBatch; ++k)
+        {
+            aa.push_back(Aff3(ma[k]));
+            ab.push_back(Aff3(mb[k]));
+        }
+        binary(r, "affine_mm_mult/" + tname, aa, ab,
+               [](Aff3 const& a, Aff3 const& b) { return a * b; });
+        binary(r, "affine_mv_mult/" + tname, aa, va,
+               [](Aff3 const& m, Vec3 const& v) { return m * v; });
+    }
+
+    // quaternion.h, against the equivalent Matrix3 operations
+    {
+        using Quat = vecmath::Quaternion<fptype>;
+        std::vector<Quat> qa, qb;
+        for (std::size_t k=0; k<kBatch; ++k)
+        {
+            qa.push_back(Quat::rotateX(va[k].X()) * Quat::rotateY(va[k].Y()));
+            qb.push_back(Quat::rotateZ(vb[k].Z()) * Quat::rotateX(vb[k].X()));
+        }
+        binary(r, "quat_compose/" + tname, qa, qb,
+               [](Quat const& a, Quat const& b) { return a * b; });
+        binary(r, "quat_rotate/" + tname, qa, va,
+               [](Quat const& q, Vec3 const& v) { return q * v; });
+        binary(r, "quat_slerp/" + tname, qa, qb,
+               [](Quat const& a, Quat const& b) { return vecmath::slerp(a, b, fptype(0.3)); });
+        binary(r, "quat_nlerp/" + tname, qa, qb,
+               [](Quat const& a, Quat const& b) { return vecmath::nlerp(a, b, fptype(0.3)); });
+        unary(r, "quat_to_matrix/" + tname, qa,
+              [](Quat const& q) { return Mat3(q); });
+    }
+
+    // Matrix3 factories
+    unary(r, "translation/" + tname, va,
+          [](Vec3 const& v) { return Mat3::translation(v.X(), v.Y(), v.Z()); });
+    unary(r, "scale/" + tname, va,
+          [](Vec3 const& v) { return Mat3::scale(v.X(), v.Y(), v.Z()); });
+    unary(r, "rotateX/" + tname, angles,
+          [](fptype t) { return Mat3::rotateX(t); });
+    unary(r, "rotateY/" + tname, angles,
+          [](fptype t) { return Mat3::rotateY(t); });
+    unary(r, "rotateZ/" + tname, angles,
+          [](fptype t) { return Mat3::rotateZ(t); });
+    unary(r, "rotateXYZ_product/" + tname, va,
+          [](Vec3 const& v) { return Mat3::rotateX(v.X()) * Mat3::rotateY(v.Y()) * Mat3::rotateZ(v.Z()); });
+    unary(r, "rotateEuler/" + tname, va,
+          [](Vec3 const& v) { return Mat3::rotateEuler(v.X(), v.Y(), v.Z()); });
+    unary(r, "rotateAxis/" + tname, angles,
+          [](fptype t) { return Mat3::rotateAxis(Vec3(0, 0, 1), t); });
+
+    // vectrig.h
+    {
+        std::vector<fptype> ax(kBatch), ay(kBatch), az(kBatch), s(kBatch), c(kBatch);
+        for (std::size_t k=0; k<kBatch; ++k)
+        {
+            ax[k] = va[k].X();
+            ay[k] = va[k].Y();
+            az[k] = va[k].Z();
+        }
+        r.run("sincos_std/" + tname + "/batch", kBatch, [&](uint64_t n) {
+            for (uint64_t i=0; i<n; ++i)
+            {
+                for (std::size_t k=0; k<kBatch; ++k)
+                {
+                    s[k] = std::sin(ax[k]);
+                    c[k] = std::cos(ax[k]);
+                }
+                bench::doNotOptimize(s[0]);
+                bench::doNotOptimize(c[0]);
+            }
+        });
+        r.run("sincos_batch/" + tname + "/batch", kBatch, [&](uint64_t n) {
+            for (uint64_t i=0; i<n; ++i)
+            {
+                vecmath::sincos_batch(&ax[0], &s[0], &c[0], kBatch);
+                bench::doNotOptimize(s[0]);
+                bench::doNotOptimize(c[0]);
+            }
+        });
+
+        std::vector<Mat3> out(kBatch);
+        r.run("rotateEuler_batch/" + tname + "/batch", kBatch, [&](uint64_t n) {
+            for (uint64_t i=0; i<n; ++i)
+            {
+                vecmath::rotateEuler_batch(&ax[0], &ay[0], &az[0], &out[0], kBatch);
+                bench::doNotOptimize(out[0]);
+            }
+        });
+    }
+
+    // circle3pts.h, on triples taken from random circles in the X,Y plane
+    {
+        std::vector<Vec3> ta, tb, tc;
+        for (std::size_t k=0; k<kBatch; ++k)
+        {
+            Vec3 const& ctr = va[k];
+            fptype const rad = 1 + std::abs(vb[k].X());
+            fptype const t = 3 * vb[k].Y();
+            ta.push_back({ctr.X() + rad*std::cos(t),     ctr.Y() + rad*std::sin(t),     0});
+            tb.push_back({ctr.X() + rad*std::cos(t + 2), ctr.Y() + rad*std::sin(t + 2), 0});
+            tc.push_back({ctr.X() + rad*std::cos(t + 4), ctr.Y() + rad*std::sin(t + 4), 0});
+        }
+
+        Vec3 a = ta[0], b = tb[0], c = tc[0];
+        r.run("circle3pts/" + tname + "/single", 1, [&](uint64_t n) {
+            for (uint64_t i=0; i<n; ++i)
+            {
+                bench::doNotOptimize(a);
+                Vec3 res = vecmath::circle3pts(a, b, c);
+                bench::doNotOptimize(res);
+            }
+        });
+
+        std::vector<Vec3> out(kBatch);
+        r.run("circle3pts/" + tname + "/batch", kBatch, [&](uint64_t n) {
+            for (uint64_t i=0; i<n; ++i)
+            {
+                for (std::size_t k=0; k<kBatch; ++k)
+                {
+                    out[k] = vecmath::circle3pts(ta[k], tb[k], tc[k]);
+                }
+                bench::doNotOptimize(out[0]);
+            }
+        });
+
+        std::vector<uint8_t> status(kBatch);
+        r.run("circle3pts_batch/" + tname + "/batch", kBatch, [&](uint64_t n) {
+            for (uint64_t i=0; i<n; ++i)
+            {
+                vecmath::circle3pts_batch(&ta[0], &tb[0], &tc[0], &out[0], &status[0], kBatch);
+                bench::doNotOptimize(out[0]);
+            }
+        });
+
+        vecmath::Vector3Array<fptype> sa, sb, sc, sout;
+        for (std::size_t k=0; k<kBatch; ++k)
+        {
+            sa.push_back(ta[k]);
+            sb.push_back(tb[k]);
+            sc.push_back(tc[k]);
+        }
+        r.run("circle3pts_batch_soa/" + tname + "/batch", kBatch, [&](uint64_t n) {
+            for (uint64_t i=0; i<n; ++i)
+            {
+                vecmath::circle3pts_batch(sa, sb, sc, sout, &status[0]);
+                bench::doNotOptimize(sout.X()[0]);
+            }
+        });
+    }
+
+    // vecarray.h
+    {
+        vecmath::Vector3Array<fptype> in, out;
+        for (Vec3 const& v : va)
+            in.push_back(v);
+        Mat3 const m = ma[0];
+
+        r.run("transform_soa/" + tname + "/batch", kBatch, [&](uint64_t n) {
+            for (uint64_t i=0; i<n; ++i)
+            {
+                vecmath::transform(m, in, out);
+                bench::doNotOptimize(out.X()[0]);
+            }
+        });
+
+        // a scratch array per batch, from the heap and from an arena
+        r.run("scratch_heap/" + tname + "/batch", kBatch, [&](uint64_t n) {
+            for (uint64_t i=0; i<n; ++i)
+            {
+                std::vector<Vec3> tmp(kBatch);
+                for (std::size_t k=0; k<kBatch; ++k)
+                    tmp[k] = m * va[k];
+                bench::doNotOptimize(tmp[0]);
+            }
+        });
+
+        vecmath::arena scratch;
+        r.run("scratch_arena/" + tname + "/batch", kBatch, [&](uint64_t n) {
+            for (uint64_t i=0; i<n; ++i)
+            {
+                Vec3* tmp = scratch.allocate<Vec3>(kBatch);
+                for (std::size_t k=0; k<kBatch; ++k)
+                    tmp[k] = m * va[k];
+                bench::doNotOptimize(tmp[0]);
+                scratch.reset();
+            }
+        });
+    }
+}
+
+/*
+ * Float kernels of the SIMD backend, for each supported ISA.
+ */
+void benchSimd(bench::Runner& r)
+{
+    using vecmath::simd::isa;
+    isa const isas[] = {isa::scalar, isa::sse, isa::avx2, isa::avx512, isa::neon};
+
+    std::vector<vecmath::Vector3f> const va = makeVectors<float>(kBatch, 1);
+    std::vector<vecmath::Matrix3f> const ma = makeMatrices<float>(2, 4);
+    std::vector<vecmath::Vector3f> const vb = makeVectors<float>(kBatch, 5);
+    std::vector<vecmath::Vector3f> out(kBatch);
+    std::vector<float> dots(kBatch);
+
+    float const* a = reinterpret_cast<float const*>(&ma[0]);
+    float const* b = reinterpret_cast<float const*>(&ma[1]);
+    float const* v = reinterpret_cast<float const*>(&va[0]);
+    float const* w = reinterpret_cast<float const*>(&vb[0]);
+    float* o = reinterpret_cast<float*>(&out[0]);
+
+    for (isa id : isas)
+    {
+        vecmath::simd::kernels const* k = vecmath::simd::find(id);
+        if (!k)
+            continue;
+        std::string const prefix = std::string("simd_") + k->name;
+
+        r.run(prefix + "/mm_mult/float/single", 1, [&](uint64_t n) {
+            float res[16];
+            for (uint64_t i=0; i<n; ++i)
+            {
+                bench::doNotOptimize(ma);
+                k->mm_mult(res, a, b);
+                bench::doNotOptimize(res);
+            }
+        });
+
+        r.run(prefix + "/mv_mult/float/single", 1, [&](uint64_t n) {
+            float res[4];
+            for (uint64_t i=0; i<n; ++i)
+            {
+                bench::doNotOptimize(va);
+                k->mv_mult(res, a, v);
+                bench::doNotOptimize(res);
+            }
+        });
+
+        r.run(prefix + "/mv_mult/float/batch", kBatch, [&](uint64_t n) {
+            for (uint64_t i=0; i<n; ++i)
+            {
+                k->mv_mult_n(o, a, v, kBatch);
+                bench::doNotOptimize(out[0]);
+            }
+        });
+
+        r.run(prefix + "/dot_n/float/batch", kBatch, [&](uint64_t n) {
+            for (uint64_t i=0; i<n; ++i)
+            {
+                k->dot_n(dots.data(), v, w, kBatch);
+                bench::doNotOptimize(dots[0]);
+            }
+        });
+
+        r.run(prefix + "/cross_n/float/batch", kBatch, [&](uint64_t n) {
+            for (uint64_t i=0; i<n; ++i)
+            {
+                k->cross_n(o, v, w, kBatch);
+                bench::doNotOptimize(out[0]);
+            }
+        });
+
+        r.run(prefix + "/normalize_n/float/batch", kBatch, [&](uint64_t n) {
+            for (uint64_t i=0; i<n; ++i)
+            {
+                k->normalize_n(o, v, kBatch);
+                bench::doNotOptimize(out[0]);
+            }
+        });
+
+        r.run(prefix + "/add_n/float/batch", kBatch, [&](uint64_t n) {
+            for (uint64_t i=0; i<n; ++i)
+            {
+                k->add_n(o, v, w, kBatch);
+                bench::doNotOptimize(out[0]);
+            }
+        });
+    }
+
+    // The same operations one vector at a time, and on a Vector3Array
+    r.run("loop/dot/float/batch", kBatch, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            for (std::size_t j=0; j<kBatch; ++j)
+                dots[j] = vecmath::dot(va[j], vb[j]);
+            bench::doNotOptimize(dots[0]);
+        }
+    });
+    r.run("loop/normalize/float/batch", kBatch, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            for (std::size_t j=0; j<kBatch; ++j)
+            {
+                out[j] = va[j];
+                out[j].fast_normalize<vecmath::precision::exact>();
+            }
+            bench::doNotOptimize(out[0]);
+        }
+    });
+
+    vecmath::Vector3Arrayf sa, sb, so;
+    for (std::size_t j=0; j<kBatch; ++j)
+    {
+        sa.push_back(va[j]);
+        sb.push_back(vb[j]);
+    }
+    r.run("soa/dot_batch/float/batch", kBatch, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            vecmath::dot_batch(sa, sb, dots);
+            bench::doNotOptimize(dots[0]);
+        }
+    });
+    r.run("soa/cross_batch/float/batch", kBatch, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            vecmath::cross_batch(sa, sb, so);
+            bench::doNotOptimize(so.X()[0]);
+        }
+    });
+    r.run("soa/normalize_batch/float/batch", kBatch, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            vecmath::normalize_batch(sa, so);
+            bench::doNotOptimize(so.X()[0]);
+        }
+    });
+}
+
+/*
+ * The multithreaded kernels on large batches, with one thread and
+ * with the whole default pool.
+ */
+void benchParallel(bench::Runner& r)
+{
+    std::size_t const kLarge = 1 << 20;
+
+    vecmath::Vector3Arrayf in, out;
+    Lcg rng(7);
+    for (std::size_t k=0; k<kLarge; ++k)
+    {
+        in.push_back({float(rng.next()), float(rng.next()), float(rng.next())});
+    }
+    vecmath::Matrix3f const m = makeMatrices<float>(1, 4)[0];
+    std::vector<vecmath::Matrix3f> const chain = makeMatrices<float>(kLarge / 16, 6);
+    std::vector<vecmath::Matrix3f> composed(chain.size());
+
+    vecmath::parallel::thread_pool one(1);
+    vecmath::parallel::thread_pool& all = vecmath::parallel::default_pool();
+    std::string const threads = "t" + std::to_string(all.size());
+
+    struct { vecmath::parallel::thread_pool* pool; std::string name; } const pools[] = {
+        {&one, "t1"}, {&all, threads}};
+
+    for (auto const& p : pools)
+    {
+        if (p.pool != &one && p.pool->size() == 1)
+            continue;
+
+        r.run("parallel_transform_points/" + p.name + "/float/batch", kLarge, [&](uint64_t n) {
+            for (uint64_t i=0; i<n; ++i)
+            {
+                vecmath::parallel::transform_points(m, in, out, *p.pool);
+                bench::doNotOptimize(out.X()[0]);
+            }
+        });
+
+        r.run("parallel_transform_normals/" + p.name + "/float/batch", kLarge, [&](uint64_t n) {
+            for (uint64_t i=0; i<n; ++i)
+            {
+                vecmath::parallel::transform_normals(m, in, out, *p.pool);
+                bench::doNotOptimize(out.X()[0]);
+            }
+        });
+
+        r.run("parallel_compose_chain/" + p.name + "/float/batch", chain.size(), [&](uint64_t n) {
+            for (uint64_t i=0; i<n; ++i)
+            {
+                vecmath::parallel::compose_chain(chain.data(), composed.data(),
+                                                 chain.size(), *p.pool);
+                bench::doNotOptimize(composed[0]);
+            }
+        });
+    }
+}
+
+/*
+ * World transforms of a large hierarchy: a recursive walk over
+ * child lists with operator*, against the flat passes.
+ */
+void composeChildren(std::vector<std::vector<int32_t>> const& children,
+                     std::vector<vecmath::Matrix3f> const& locals,
+                     std::vector<vecmath::Matrix3f>& world, int32_t node)
+{
+    for (int32_t c : children[node])
+    {
+        world[c] = world[node] * locals[c];
+        composeChildren(children, locals, world, c);
+    }
+}
+
+void benchHierarchy(bench::Runner& r)
+{
+    std::size_t const kNodes = 1 << 16;
+
+    // Trees of 4096 nodes, three children per node, breadth first.
+    std::vector<int32_t> parents(kNodes);
+    std::vector<std::vector<int32_t>> children(kNodes);
+    std::vector<int32_t> roots;
+    for (std::size_t i=0; i<kNodes; ++i)
+    {
+        std::size_t const base = i - i % 4096;
+        parents[i] = (i == base) ? -1 : int32_t(base + (i - base - 1) / 3);
+        if (parents[i] < 0)
+            roots.push_back(int32_t(i));
+        else
+            children[parents[i]].push_back(int32_t(i));
+    }
+    std::vector<vecmath::Matrix3f> const locals = makeMatrices<float>(kNodes, 9);
+    std::vector<vecmath::Matrix3f> world(kNodes);
+
+    r.run("hierarchy/recursive/float/batch", kNodes, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            for (int32_t root : roots)
+            {
+                world[root] = locals[root];
+                composeChildren(children, locals, world, root);
+            }
+            bench::doNotOptimize(world[0]);
+        }
+    });
+
+    r.run("hierarchy/compose_hierarchy/float/batch", kNodes, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            vecmath::compose_hierarchy(parents, locals, world);
+            bench::doNotOptimize(world[0]);
+        }
+    });
+
+    // One node in 20 moving per frame, all leaves (the last 2730 of
+    // each tree), stepping through them from frame to frame.
+    vecmath::TransformCachef cache;
+    cache.reserve(kNodes);
+    for (std::size_t i=0; i<kNodes; ++i)
+    {
+        cache.add(parents[i], locals[i]);
+    }
+    cache.update();
+    r.run("hierarchy/cache_update_5pct/float/batch", kNodes, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            for (std::size_t k=1366+i%13; k<kNodes; k+=13)
+            {
+                if (k % 4096 >= 1366)
+                    cache.setLocal(k, locals[k]);
+            }
+            cache.update();
+            bench::doNotOptimize(cache.world(0));
+        }
+    });
+
+    vecmath::parallel::thread_pool& all = vecmath::parallel::default_pool();
+    r.run("hierarchy/parallel/t" + std::to_string(all.size()) + "/float/batch", kNodes, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            vecmath::parallel::compose_hierarchy(parents, locals, world, all);
+            bench::doNotOptimize(world[0]);
+        }
+    });
+}
+
+/*
+ * Decoding large point arrays from the packed storage types, against
+ * copying them at full precision. Points are in [-1, 1] so that
+ * they suit all three types.
+ */
+void benchPack(bench::Runner& r)
+{
+    std::size_t const kLarge = 1 << 20;
+
+    std::vector<vecmath::Vector3f> full(kLarge);
+    Lcg rng(9);
+    for (std::size_t k=0; k<kLarge; ++k)
+    {
+        vecmath::Vector3f v(float(rng.next()), float(rng.next()), float(rng.next()));
+        full[k] = v.fast_normalize();
+    }
+
+    std::vector<vecmath::PackedVector3f> packed(kLarge);
+    std::vector<vecmath::Vector3h> halves(kLarge);
+    std::vector<vecmath::PackedNormal3> normals(kLarge);
+    vecmath::pack(full.data(), packed.data(), kLarge);
+    vecmath::pack(full.data(), halves.data(), kLarge);
+    vecmath::pack(full.data(), normals.data(), kLarge);
+
+    std::vector<vecmath::Vector3f> out(kLarge);
+    vecmath::Vector3Arrayf soa;
+
+    r.run("unpack_copy/Vector3f/batch", kLarge, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            std::copy(full.begin(), full.end(), out.begin());
+            bench::doNotOptimize(out[0]);
+        }
+    });
+    r.run("unpack/PackedVector3f/batch", kLarge, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            vecmath::unpack(packed.data(), out.data(), kLarge);
+            bench::doNotOptimize(out[0]);
+        }
+    });
+    r.run("unpack/Vector3h/batch", kLarge, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            vecmath::unpack(halves.data(), out.data(), kLarge);
+            bench::doNotOptimize(out[0]);
+        }
+    });
+    r.run("unpack_soa/Vector3h/batch", kLarge, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            vecmath::unpack(halves.data(), kLarge, soa);
+            bench::doNotOptimize(soa.X()[0]);
+        }
+    });
+    r.run("unpack/PackedNormal3/batch", kLarge, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            vecmath::unpack(normals.data(), out.data(), kLarge);
+            bench::doNotOptimize(out[0]);
+        }
+    });
+    r.run("unpack_soa/PackedNormal3/batch", kLarge, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            vecmath::unpack(normals.data(), kLarge, soa);
+            bench::doNotOptimize(soa.X()[0]);
+        }
+    });
+    r.run("pack/Vector3h/batch", kLarge, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            vecmath::pack(full.data(), halves.data(), kLarge);
+            bench::doNotOptimize(halves[0]);
+        }
+    });
+}
+
+void benchFile(bench::Runner& r)
+{
+    std::size_t const kLarge = 1 << 20;
+    std::string const in = "runbench_in.vmf";
+    std::string const out = "runbench_out.vmf";
+
+    vecmath::Vector3Arrayf pts(kLarge);
+    Lcg rng(11);
+    for (std::size_t k=0; k<kLarge; ++k)
+        pts.set(k, vecmath::Vector3f(float(rng.next()), float(rng.next()), float(rng.next())));
+    vecmath::write_file(in, pts);
+    vecmath::Matrix3f const m = vecmath::Matrix3f::rotateZ(0.5f) *
+                                vecmath::Matrix3f::translation(1.0f, 2.0f, 3.0f);
+
+    // Reading the whole file, transforming and writing it back out
+    r.run("load_transform_store/Vector3f/file", kLarge, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            vecmath::mapped_file const f(in);
+            vecmath::Vector3Arrayf all(f.size());
+            std::copy(f.component<float>(0).begin(), f.component<float>(0).end(), all.X());
+            std::copy(f.component<float>(1).begin(), f.component<float>(1).end(), all.Y());
+            std::copy(f.component<float>(2).begin(), f.component<float>(2).end(), all.Z());
+            vecmath::transform(m, all, all);
+            vecmath::write_file(out, all);
+        }
+    });
+    r.run("transform_file/Vector3f/file", kLarge, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+            vecmath::transform_file(in, out, m);
+    });
+    r.run("transform_file/Vector3f/pipelined", kLarge, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+            vecmath::parallel::transform_file(in, out, m);
+    });
+
+    std::remove(in.c_str());
+    std::remove(out.c_str());
+}
+
+void benchText(bench::Runner& r)
+{
+    std::size_t const kMats = 4096;
+    std::vector<vecmath::Matrix3f> const mats = makeMatrices<float>(kMats, 12);
+    std::vector<vecmath::Matrix3f> back(kMats);
+    vecmath::text_options const fixed(vecmath::chars_format::fixed, 5);
+    std::vector<char> buf(vecmath::max_text_size<vecmath::Matrix3f>(kMats));
+
+    // operator<< formats through the stream itself when the stream
+    // has another locale, as it always did before to_chars()
+    r.run("text/operator<</iostream/Matrix3f/batch", kMats, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            std::ostringstream os;
+            os.imbue(std::locale(std::locale::classic(), new std::numpunct<char>()));
+            for (vecmath::Matrix3f const& m : mats)
+                os << m;
+            bench::doNotOptimize(os.tellp());
+        }
+    });
+    r.run("text/operator<</Matrix3f/batch", kMats, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            std::ostringstream os;
+            for (vecmath::Matrix3f const& m : mats)
+                os << m;
+            bench::doNotOptimize(os.tellp());
+        }
+    });
+    r.run("text/write_text/fixed/Matrix3f/batch", kMats, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+            bench::doNotOptimize(vecmath::write_text(mats, buf.data(), buf.size(), fixed).bytes);
+    });
+    r.run("text/write_text/exact/Matrix3f/batch", kMats, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+            bench::doNotOptimize(vecmath::write_text(mats, buf.data(), buf.size()).bytes);
+    });
+
+    std::size_t const bytes = vecmath::write_text(mats, buf.data(), buf.size()).bytes;
+    std::string const text(buf.data(), bytes);
+    r.run("text/istream/Matrix3f/batch", kMats, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            std::istringstream is(text);
+            for (vecmath::Matrix3f& m : back)
+                for (int k=0; k<16; ++k)
+                    is >> m.data()[k];
+            bench::doNotOptimize(back[0]);
+        }
+    });
+    r.run("text/read_text/Matrix3f/batch", kMats, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+            bench::doNotOptimize(vecmath::read_text(text.data(), text.size(), back).count);
+    });
+}
+
+/*
+ * One ray against a mesh and many rays against a plane: the one-ray
+ * intersect() per element, against the batch kernels.
+ */
+void benchIntersect(bench::Runner& r)
+{
+    std::size_t const kTris = 1 << 14;
+    std::vector<vecmath::Vector3f> const pts = makeVectors<float>(3 * kTris, 13);
+    vecmath::TriangleArrayf tris;
+    tris.reserve(kTris);
+    for (std::size_t i=0; i<kTris; ++i)
+    {
+        tris.push_back(pts[3*i], pts[3*i+1], pts[3*i+2]);
+    }
+    vecmath::Rayf const ray(vecmath::Vector3f(0.1f, 0.2f, -5), vecmath::Vector3f(0.01f, -0.02f, 1));
+    std::vector<float> t(kTris);
+    std::vector<uint8_t> hit(kTris);
+
+    r.run("intersect/ray_triangles/float/single", kTris, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            for (std::size_t k=0; k<kTris; ++k)
+            {
+                vecmath::Vector3f const a = tris.v0.get(k);
+                hit[k] = vecmath::intersect(ray, a, a + tris.e1.get(k), a + tris.e2.get(k), t[k]);
+            }
+            bench::doNotOptimize(t[0]);
+        }
+    });
+
+    r.run("intersect/ray_triangles/float/batch", kTris, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            bench::doNotOptimize(vecmath::intersect(ray, tris, t, hit));
+        }
+    });
+
+    vecmath::RayArrayf rays;
+    rays.reserve(kTris);
+    for (std::size_t i=0; i<kTris; ++i)
+    {
+        rays.push_back(vecmath::Rayf(pts[i], pts[kTris + i]));
+    }
+    vecmath::Planef const plane = vecmath::Planef::through(vecmath::Vector3f(0, 0, 0.5f),
+                                                           vecmath::Vector3f(0.6f, 0, 0.8f));
+
+    r.run("intersect/rays_plane/float/single", kTris, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            for (std::size_t k=0; k<kTris; ++k)
+            {
+                vecmath::Rayf const rk(rays.origins.get(k), rays.directions.get(k));
+                hit[k] = vecmath::intersect(rk, plane, t[k]);
+            }
+            bench::doNotOptimize(t[0]);
+        }
+    });
+
+    r.run("intersect/rays_plane/float/batch", kTris, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            bench::doNotOptimize(vecmath::intersect(rays, plane, t, hit));
+        }
+    });
+}
+
+/*
+ * Bounding a point array, and culling many boxes against a frustum:
+ * one element at a time, against the batch kernels.
+ */
+void benchBounds(bench::Runner& r)
+{
+    std::size_t const kPoints = 1 << 16;
+    std::vector<vecmath::Vector3f> const pts = makeVectors<float>(kPoints, 14);
+    vecmath::Vector3Arrayf soa;
+    soa.reserve(kPoints);
+    for (vecmath::Vector3f const& p : pts)
+    {
+        soa.push_back(p);
+    }
+
+    r.run("bounds/extend/float/single", kPoints, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            vecmath::AABBf b;
+            for (vecmath::Vector3f const& p : pts)
+                b.extend(p);
+            bench::doNotOptimize(b);
+        }
+    });
+    r.run("bounds/compute_bounds/float/batch", kPoints, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+            bench::doNotOptimize(vecmath::compute_bounds(pts));
+    });
+    r.run("bounds/compute_bounds/soa/float/batch", kPoints, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+            bench::doNotOptimize(vecmath::compute_bounds(soa));
+    });
+
+    vecmath::Matrix3f const m = vecmath::Matrix3f::translation(1, 2, 3) *
+                                vecmath::Matrix3f::rotateEuler(0.3f, -0.7f, 1.1f);
+    vecmath::AABBf const box = vecmath::compute_bounds(pts);
+    r.run("bounds/transform_corners/float/single", 1, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            vecmath::AABBf b;
+            for (int c=0; c<8; ++c)
+                b.extend(m * vecmath::Vector3f((c & 1) ? box.hi.X() : box.lo.X(),
+                                               (c & 2) ? box.hi.Y() : box.lo.Y(),
+                                               (c & 4) ? box.hi.Z() : box.lo.Z()));
+            bench::doNotOptimize(b);
+        }
+    });
+    r.run("bounds/transform/float/single", 1, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+            bench::doNotOptimize(vecmath::transform(box, m));
+    });
+
+    // Boxes of the point pairs, seen from inside the cloud.
+    std::size_t const kBoxes = kPoints / 2;
+    vecmath::AABBArrayf boxes;
+    boxes.reserve(kBoxes);
+    for (std::size_t i=0; i<kBoxes; ++i)
+    {
+        vecmath::AABBf b(pts[2*i], pts[2*i]);
+        b.extend(pts[2*i+1]);
+        boxes.push_back(b);
+    }
+    vecmath::Matrix3f proj = vecmath::Matrix3f::scale(1.5f, 1.5f, -1.1f);
+    proj(2,3) = -2.1f;
+    proj(3,2) = -1;
+    proj(3,3) = 0;
+    vecmath::Frustumf const f = vecmath::Frustumf::from_matrix(proj);
+    std::vector<uint8_t> vis(kBoxes);
+
+    r.run("bounds/cull/float/single", kBoxes, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            for (std::size_t k=0; k<kBoxes; ++k)
+                vis[k] = f.visible(boxes.get(k));
+            bench::doNotOptimize(vis[0]);
+        }
+    });
+    r.run("bounds/cull/float/batch", kBoxes, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+            bench::doNotOptimize(vecmath::cull(f, boxes, vis));
+    });
+}
+
+void benchBvh(bench::Runner& r)
+{
+    std::size_t const kPoints = 1 << 18;
+    std::size_t const kQueries = 64;
+    std::vector<vecmath::Vector3f> const pts = makeVectors<float>(kPoints, 15);
+    std::vector<vecmath::Vector3f> const queries = makeVectors<float>(kQueries, 16);
+
+    vecmath::PointBVHf bvh;
+    r.run("bvh/build/float/serial", kPoints, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            bvh.build(pts);
+            bench::doNotOptimize(bvh.nodes().size());
+        }
+    });
+    r.run("bvh/build/float/parallel", kPoints, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            vecmath::parallel::build_bvh(pts, bvh);
+            bench::doNotOptimize(bvh.nodes().size());
+        }
+    });
+
+    // The 8 nearest, by a pass over every point keeping the best.
+    std::vector<uint32_t> idx(8);
+    std::vector<float> d2(8);
+    r.run("bvh/nearest8/float/brute", kQueries, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            for (vecmath::Vector3f const& q : queries)
+            {
+                std::vector<std::pair<float, uint32_t> > best;
+                for (std::size_t k=0; k<kPoints; ++k)
+                {
+                    vecmath::Vector3f const d = pts[k] - q;
+                    std::pair<float, uint32_t> const e(vecmath::dot(d, d), uint32_t(k));
+                    if (best.size() < 8)
+                    {
+                        best.push_back(e);
+                        std::push_heap(best.begin(), best.end());
+                    }
+                    else if (e < best.front())
+                    {
+                        std::pop_heap(best.begin(), best.end());
+                        best.back() = e;
+                        std::push_heap(best.begin(), best.end());
+                    }
+                }
+                bench::doNotOptimize(best.front());
+            }
+        }
+    });
+    r.run("bvh/nearest8/float/bvh", kQueries, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+            for (vecmath::Vector3f const& q : queries)
+                bench::doNotOptimize(bvh.nearest(q, 8, idx, d2));
+    });
+
+    std::vector<uint32_t> found;
+    r.run("bvh/within/float/brute", kQueries, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            for (vecmath::Vector3f const& q : queries)
+            {
+                found.clear();
+                for (std::size_t k=0; k<kPoints; ++k)
+                {
+                    vecmath::Vector3f const d = pts[k] - q;
+                    if (vecmath::dot(d, d) <= 0.01f)
+                        found.push_back(uint32_t(k));
+                }
+                bench::doNotOptimize(found.size());
+            }
+        }
+    });
+    r.run("bvh/within/float/bvh", kQueries, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            for (vecmath::Vector3f const& q : queries)
+            {
+                found.clear();
+                bench::doNotOptimize(bvh.within(q, 0.1f, found));
+            }
+        }
+    });
+
+    vecmath::Matrix3f const m = vecmath::Matrix3f::rotateEuler(0.001f, 0.002f, -0.001f);
+    r.run("bvh/transform_refit/float/batch", kPoints, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            bvh.transform(m);
+            bench::doNotOptimize(bvh.nodes()[0]);
+        }
+    });
+}
+
+void benchVecN(bench::Runner& r)
+{
+    std::size_t const kPoints = 1 << 16;
+    std::vector<vecmath::Vector3f> const va = makeVectors<float>(kPoints, 17);
+    std::vector<vecmath::Vector3f> pts3(kPoints), out3(kPoints);
+    std::vector<vecmath::Vector2f> pts2(kPoints), out2(kPoints);
+    for (std::size_t k=0; k<kPoints; ++k)
+    {
+        pts3[k] = vecmath::Vector3f(va[k].X(), va[k].Y(), 0);
+        pts2[k] = vecmath::Vector2f(va[k].X(), va[k].Y());
+    }
+
+    // The same 2D affine transform, as Matrix3 and as a 3x3.
+    vecmath::Matrix3f const m3 = vecmath::Matrix3f::translation(1, -2, 0) * vecmath::Matrix3f::rotateZ(0.7f);
+    vecmath::Matrix3x3f const m2 = vecmath::Matrix3x3f::translation(vecmath::Vector2f(1, -2)) *
+                                   vecmath::Matrix3x3f::rotation(0.7f);
+    r.run("vecn/transform2d/float/matrix3", kPoints, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            for (std::size_t k=0; k<kPoints; ++k)
+                out3[k] = m3 * pts3[k];
+            bench::doNotOptimize(out3[0]);
+        }
+    });
+    r.run("vecn/transform2d/float/matrix3x3", kPoints, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            for (std::size_t k=0; k<kPoints; ++k)
+                out2[k] = vecmath::transform_point(m2, pts2[k]);
+            bench::doNotOptimize(out2[0]);
+        }
+    });
+
+    std::size_t const kTriples = kPoints / 3;
+    r.run("vecn/circle3pts/float/vector3", kTriples, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            for (std::size_t k=0; k<kTriples; ++k)
+                out3[k] = vecmath::circle3pts(pts3[3*k], pts3[3*k+1], pts3[3*k+2]);
+            bench::doNotOptimize(out3[0]);
+        }
+    });
+    r.run("vecn/circle3pts/float/vector2", kTriples, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            for (std::size_t k=0; k<kTriples; ++k)
+                out2[k] = vecmath::circle3pts(pts2[3*k], pts2[3*k+1], pts2[3*k+2]);
+            bench::doNotOptimize(out2[0]);
+        }
+    });
+}
+
+/*
+ * Projecting points to normalized device coordinates: the transform
+ * and the divide as two passes, against project_points() in one.
+ */
+void benchProject(bench::Runner& r)
+{
+    std::size_t const kPoints = 1 << 16;
+    std::vector<vecmath::Vector3f> const pts = makeVectors<float>(kPoints, 18);
+    std::vector<vecmath::Vector3f> out(kPoints);
+    std::vector<uint8_t> clip(kPoints);
+    vecmath::Matrix3f m = vecmath::Matrix3f::scale(1.2f, 1.6f, -1.05f) *
+                          vecmath::Matrix3f::translation(0, 0, -3);
+    m(2,3) = -1.02f;
+    m(3,2) = -1;
+    m(3,3) = 0;
+
+    r.run("project/Vector3f/two_pass", kPoints, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            vecmath::simd::transform(m, pts.data(), out.data(), kPoints);
+            for (vecmath::Vector3f& p : out)
+            {
+                float const inv = 1 / p.W();
+                p = vecmath::Vector3f(p.X() * inv, p.Y() * inv, p.Z() * inv);
+            }
+            bench::doNotOptimize(out[0]);
+        }
+    });
+
+    r.run("project/Vector3f/exact", kPoints, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            bench::doNotOptimize(vecmath::project_points(m, pts, out, clip));
+        }
+    });
+
+    r.run("project/Vector3f/refined", kPoints, [&](uint64_t n) {
+        for (uint64_t i=0; i<n; ++i)
+        {
+            bench::doNotOptimize(vecmath::project_points<vecmath::precision::refined>(m, pts, out, clip));
+        }
+    });
+}
+
+bool startsWith(std::string const& s, char const* prefix, std::string& rest)
+{
+    std::size_t const n = std::strlen(prefix);
+    if (s.compare(0, n, prefix) != 0)
+        return false;
+    rest = s.substr(n);
+    return true;
+}
+
+} // anonymous
+
+int main(int argc, char** argv)
+{
+    bench::Options opts;
+    for (int i=1; i<argc; ++i)
+    {
+        std::string const arg = argv[i];
+        std::string val;
+        if (startsWith(arg, "--filter=", val))
+            opts.filter = val;
+        else if (startsWith(arg, "--min-time=", val))
+            opts.minTime = std::atof(val.c_str());
+        else if (startsWith(arg, "--repetitions=", val))
+            opts.repetitions = std::max(1, std::atoi(val.c_str()));
+        else if (startsWith(arg, "--json=", val))
+            opts.jsonPath = val;
+        else if (startsWith(arg, "--compare=", val))
+            opts.comparePath = val;
+        else if (startsWith(arg, "--threshold=", val))
+            opts.threshold = std::atof(val.c_str());
+        else
+        {
+            std::printf("usage: %s [--filter=substr] [--min-time=sec] [--repetitions=n]\n"
+                        "       [--json=out.json] [--compare=baseline.json] [--threshold=frac]\n",
+                        argv[0]);
+            return 2;
+        }
+    }
+
+    bench::Runner runner(opts);
+    benchType<float>(runner, "float");
+    benchType<double>(runner, "double");
+    benchSimd(runner);
+    benchParallel(runner);
+    benchHierarchy(runner);
+    benchPack(runner);
+    benchFile(runner);
+    benchText(runner);
+    benchIntersect(runner);
+    benchBounds(runner);
+    benchBvh(runner);
+    benchVecN(runner);
+    benchProject(runner);
+
+    if (!opts.jsonPath.empty())
+    {
+        std::string const context =
+            std::string("{\"compiler\": \"") + __VERSION__ + "\", "
+            "\"cplusplus\": " + std::to_string(__cplusplus) + ", "
+            "\"simd\": \"" + vecmath::simd::active().name + "\"}";
+        if (!runner.writeJson(opts.jsonPath, context))
+        {
+            std::printf("cannot write %s\n", opts.jsonPath.c_str());
+            return 1;
+        }
+    }
+
+    if (!opts.comparePath.empty())
+    {
+        int const regressions = runner.compare(opts.comparePath);
+        if (regressions != 0)
+            return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,413 @@
+/*
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/*
+ * Axis-aligned bounding boxes
+ *
+ * An AABB<> is the low and high corners of a box. Bounding whole
+ * batches lets a culling pass reject them before transforming a
+ * single point:
+ *
+ *     AABB<float> const box = compute_bounds(points);
+ *     if (frustum.visible(transform(box, model)))
+ *         simd::transform(mvp, points.data(), out.data(), points.size());
+ *
+ * compute_bounds() and cull(), over an AABBArray<> of many boxes,
+ * use the SIMD kernels selected at runtime (see vecsimd.h) for
+ * float; double uses the scalar kernels. transform() is Arvo's
+ * method, which bounds the transformed box from the matrix
+ * elements instead of transforming its eight corners.
+ *
+ * A default constructed box is empty: lo is +infinity and hi is
+ * -infinity, so extending it by anything gives that thing's bounds.
+ * Empty boxes contain and overlap nothing, and are never visible.
+ */
+#ifndef VM_AABB_H
+#define VM_AABB_H
+
+#include "vecmath.h"
+#include "affine.h"
+#include "vecarray.h"
+#include "vecintersect.h"
+#include "vecsimd.h"
+#include "vecspan.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace vecmath {
+
+template <typename fptype>
+struct AABB
+{
+    Vector3<fptype> lo;
+    Vector3<fptype> hi;
+
+    AABB()
+        : lo(std::numeric_limits<fptype>::infinity(), std::numeric_limits<fptype>::infinity(),
+             std::numeric_limits<fptype>::infinity()),
+          hi(-std::numeric_limits<fptype>::infinity(), -std::numeric_limits<fptype>::infinity(),
+             -std::numeric_limits<fptype>::infinity())
+    { }
+
+    AABB(Vector3<fptype> const& l, Vector3<fptype> const& h)
+        : lo(l), hi(h)
+    { }
+
+    bool empty() const
+    {
+        return !(lo.X() <= hi.X() && lo.Y() <= hi.Y() && lo.Z() <= hi.Z());
+    }
+
+    /* Grow the box to hold point p, or box b */
+    void extend(Vector3<fptype> const& p)
+    {
+        lo = Vector3<fptype>(lesser(p.X(), lo.X()), lesser(p.Y(), lo.Y()), lesser(p.Z(), lo.Z()));
+        hi = Vector3<fptype>(greater(p.X(), hi.X()), greater(p.Y(), hi.Y()), greater(p.Z(), hi.Z()));
+    }
+
+    void extend(AABB const& b)
+    {
+        lo = Vector3<fptype>(lesser(b.lo.X(), lo.X()), lesser(b.lo.Y(), lo.Y()), lesser(b.lo.Z(), lo.Z()));
+        hi = Vector3<fptype>(greater(b.hi.X(), hi.X()), greater(b.hi.Y(), hi.Y()), greater(b.hi.Z(), hi.Z()));
+    }
+
+    /* Whether p is inside the box or on its surface */
+    bool contains(Vector3<fptype> const& p) const
+    {
+        return lo.X() <= p.X() && p.X() <= hi.X() &&
+               lo.Y() <= p.Y() && p.Y() <= hi.Y() &&
+               lo.Z() <= p.Z() && p.Z() <= hi.Z();
+    }
+
+    Vector3<fptype> center() const
+    {
+        return Vector3<fptype>((lo.X() + hi.X()) * fptype(0.5), (lo.Y() + hi.Y()) * fptype(0.5),
+                               (lo.Z() + hi.Z()) * fptype(0.5));
+    }
+
+    /* Half the size along each axis */
+    Vector3<fptype> extent() const
+    {
+        return Vector3<fptype>((hi.X() - lo.X()) * fptype(0.5), (hi.Y() - lo.Y()) * fptype(0.5),
+                               (hi.Z() - lo.Z()) * fptype(0.5));
+    }
+
+  private:
+    // As the kernels compare, which compiles to single instructions
+    static fptype lesser(fptype a, fptype b) { return (a < b) ? a : b; }
+    static fptype greater(fptype a, fptype b) { return (a > b) ? a : b; }
+};
+
+using AABBf = AABB<float>;
+using AABBd = AABB<double>;
+
+/**
+ * The smallest box holding both a and b.
+ */
+template <typename fptype>
+AABB<fptype> merge(AABB<fptype> const& a, AABB<fptype> const& b)
+{
+    AABB<fptype> r = a;
+    r.extend(b);
+    return r;
+}
+
+/**
+ * Whether a and b share any point, surfaces included.
+ */
+template <typename fptype>
+bool overlaps(AABB<fptype> const& a, AABB<fptype> const& b)
+{
+    return a.lo.X() <= b.hi.X() && b.lo.X() <= a.hi.X() &&
+           a.lo.Y() <= b.hi.Y() && b.lo.Y() <= a.hi.Y() &&
+           a.lo.Z() <= b.hi.Z() && b.lo.Z() <= a.hi.Z() &&
+           !a.empty() && !b.empty();
+}
+
+/**
+ * Boxes stored as structure of arrays, for cull().
+ */
+template <typename _fptype>
+class AABBArray
+{
+  public:
+    typedef _fptype fptype;
+
+    Vector3Array<fptype> lo;
+    Vector3Array<fptype> hi;
+
+    std::size_t size() const noexcept { return lo.size(); }
+    bool empty() const noexcept { return lo.empty(); }
+
+    void reserve(std::size_t n)
+    {
+        lo.reserve(n);
+        hi.reserve(n);
+    }
+
+    void clear() noexcept
+    {
+        lo.clear();
+        hi.clear();
+    }
+
+    void push_back(AABB<fptype> const& b)
+    {
+        lo.push_back(b.lo);
+        hi.push_back(b.hi);
+    }
+
+    /**
+     * Get box \c i. Throws index_error if \c i is out of range.
+     */
+    AABB<fptype> get(std::size_t i) const
+    {
+        return AABB<fptype>(lo.get(i), hi.get(i));
+    }
+};
+
+using AABBArrayf = AABBArray<float>;
+using AABBArrayd = AABBArray<double>;
+
+/**
+ * A view volume as six planes facing inward: left, right, bottom,
+ * top, near and far.
+ */
+template <typename fptype>
+struct Frustum
+{
+    Plane<fptype> planes[6];
+
+    /**
+     * The frustum of a projection (or view-projection) matrix, for
+     * clip coordinates with -w <= x, y, z <= w (OpenGL's
+     * convention). The planes are not normalized.
+     */
+    static Frustum from_matrix(Matrix3<fptype> const& m)
+    {
+        Frustum f;
+        for (int k=0; k<6; ++k)
+        {
+            uint32_t const row = uint32_t(k / 2);
+            fptype const sign = (k % 2) ? fptype(-1) : fptype(1);
+            f.planes[k] = Plane<fptype>(Vector3<fptype>(m(3,0) + sign * m(row,0),
+                                                        m(3,1) + sign * m(row,1),
+                                                        m(3,2) + sign * m(row,2)),
+                                        -(m(3,3) + sign * m(row,3)));
+        }
+        return f;
+    }
+
+    /**
+     * Whether box b is inside the frustum or straddles it. Boxes
+     * just outside a corner, beyond two planes but on the inner
+     * side of each, count as visible.
+     */
+    bool visible(AABB<fptype> const& b) const
+    {
+        fptype const l[3] = {b.lo.X(), b.lo.Y(), b.lo.Z()};
+        fptype const h[3] = {b.hi.X(), b.hi.Y(), b.hi.Z()};
+        fptype const* const box[6] = {l, l+1, l+2, h, h+1, h+2};
+        fptype v[24];
+        values(v);
+        uint8_t r;
+        simd::scalar::cull_boxes_n(&r, v, box, 1);
+        return r != 0;
+    }
+
+    /* The planes as the kernels take them, four values each */
+    void values(fptype* v) const
+    {
+        for (int k=0; k<6; ++k)
+        {
+            v[4*k+0] = planes[k].normal.X();
+            v[4*k+1] = planes[k].normal.Y();
+            v[4*k+2] = planes[k].normal.Z();
+            v[4*k+3] = planes[k].offset;
+        }
+    }
+};
+
+using Frustumf = Frustum<float>;
+using Frustumd = Frustum<double>;
+
+namespace detail {
+
+/*
+ * The kernels for each precision: the runtime-selected SIMD kernels
+ * for float, the scalar ones for double.
+ */
+template <typename fptype>
+struct bounds_kernels;
+
+template <>
+struct bounds_kernels<float>
+{
+    static simd::kernels const& k() { return simd::active(); }
+
+    static void bounds(float* lo, float* hi, float const* v, std::size_t n) { k().bounds_n(lo, hi, v, n); }
+    static void bounds_soa(float* lo, float* hi, float const* x, float const* y, float const* z,
+                           std::size_t n)
+    {
+        k().bounds_soa_n(lo, hi, x, y, z, n);
+    }
+    static void cull(uint8_t* visible, float const* planes, float const* const* box, std::size_t n)
+    {
+        k().cull_boxes_n(visible, planes, box, n);
+    }
+};
+
+template <>
+struct bounds_kernels<double>
+{
+    static void bounds(double* lo, double* hi, double const* v, std::size_t n)
+    {
+        simd::scalar::bounds_n(lo, hi, v, n);
+    }
+    static void bounds_soa(double* lo, double* hi, double const* x, double const* y, double const* z,
+                           std::size_t n)
+    {
+        simd::scalar::bounds_soa_n(lo, hi, x, y, z, n);
+    }
+    static void cull(uint8_t* visible, double const* planes, double const* const* box, std::size_t n)
+    {
+        simd::scalar::cull_boxes_n(visible, planes, box, n);
+    }
+};
+
+template <typename fptype>
+AABB<fptype> box_from(fptype const* lo, fptype const* hi)
+{
+    return AABB<fptype>(Vector3<fptype>(lo[0], lo[1], lo[2]), Vector3<fptype>(hi[0], hi[1], hi[2]));
+}
+
+template <typename fptype>
+AABB<fptype> compute_bounds(span<Vector3<fptype> const> v)
+{
+    fptype const inf = std::numeric_limits<fptype>::infinity();
+    fptype lo[3] = {inf, inf, inf}, hi[3] = {-inf, -inf, -inf};
+    bounds_kernels<fptype>::bounds(lo, hi, as_scalars(v.data(), v.size()).data(), v.size());
+    return box_from(lo, hi);
+}
+
+template <typename fptype>
+AABB<fptype> compute_bounds(Vector3Array<fptype> const& v)
+{
+    fptype const inf = std::numeric_limits<fptype>::infinity();
+    fptype lo[3] = {inf, inf, inf}, hi[3] = {-inf, -inf, -inf};
+    bounds_kernels<fptype>::bounds_soa(lo, hi, v.X(), v.Y(), v.Z(), v.size());
+    return box_from(lo, hi);
+}
+
+/*
+ * Arvo's method: each axis of the result is the translation plus,
+ * for each input axis, the smaller (or larger) of the matrix element
+ * times the low and the high bound.
+ */
+template <typename fptype, typename Matrix>
+AABB<fptype> transform(AABB<fptype> const& b, Matrix const& m)
+{
+    if (b.empty())
+    {
+        return b;
+    }
+    fptype const l[3] = {b.lo.X(), b.lo.Y(), b.lo.Z()};
+    fptype const h[3] = {b.hi.X(), b.hi.Y(), b.hi.Z()};
+    fptype lo[3], hi[3];
+    for (uint32_t i=0; i<3; ++i)
+    {
+        lo[i] = hi[i] = m(i,3);
+        for (uint32_t j=0; j<3; ++j)
+        {
+            fptype const e = m(i,j) * l[j];
+            fptype const f = m(i,j) * h[j];
+            lo[i] += (e < f) ? e : f;
+            hi[i] += (e < f) ? f : e;
+        }
+    }
+    return box_from(lo, hi);
+}
+
+template <typename fptype>
+std::size_t cull(Frustum<fptype> const& f, AABBArray<fptype> const& boxes, span<uint8_t> visible)
+{
+    std::size_t const n = boxes.size();
+    if (visible.size() != n)
+    {
+        throw index_error("cull(): sizes differ");
+    }
+    fptype planes[24];
+    f.values(planes);
+    fptype const* const box[6] = {boxes.lo.X(), boxes.lo.Y(), boxes.lo.Z(),
+                                  boxes.hi.X(), boxes.hi.Y(), boxes.hi.Z()};
+    bounds_kernels<fptype>::cull(visible.data(), planes, box, n);
+    return count_hits(visible.data(), n);
+}
+
+} // ::detail
+
+/**
+ * The bounds of an array of points; empty for an empty array. The
+ * points must not be NaN.
+ */
+inline AABBf compute_bounds(span<Vector3f const> v)
+{
+    return detail::compute_bounds(v);
+}
+
+inline AABBd compute_bounds(span<Vector3d const> v)
+{
+    return detail::compute_bounds(v);
+}
+
+inline AABBf compute_bounds(Vector3Arrayf const& v)
+{
+    return detail::compute_bounds(v);
+}
+
+inline AABBd compute_bounds(Vector3Arrayd const& v)
+{
+    return detail::compute_bounds(v);
+}
+
+/**
+ * The bounds of box b transformed by the affine matrix m; m's bottom
+ * row must be [0 0 0 1]. The result holds every transformed point of
+ * b, and is the smallest box that does. An empty box stays empty.
+ */
+template <typename fptype>
+AABB<fptype> transform(AABB<fptype> const& b, Matrix3<fptype> const& m)
+{
+    return detail::transform(b, m);
+}
+
+template <typename fptype>
+AABB<fptype> transform(AABB<fptype> const& b, AffineMatrix3<fptype> const& m)
+{
+    return detail::transform(b, m);
+}
+
+/**
+ * Cull many boxes at once: visible[i] = f.visible(boxes.get(i)).
+ * Returns the number visible. \c visible must have boxes.size()
+ * elements, or index_error is thrown.
+ */
+inline std::size_t cull(Frustumf const& f, AABBArrayf const& boxes, span<uint8_t> visible)
+{
+    return detail::cull(f, boxes, visible);
+}
+
+inline std::size_t cull(Frustumd const& f, AABBArrayd const& boxes, span<uint8_t> visible)
+{
+    return detail::cull(f, boxes, visible);
+}
+
+} // ::vecmath
+
+#endif // VM_AABB_H
@@ -0,0 +1,300 @@
+/*
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/*
+ * Affine transformation matrix with the projective row dropped
+ */
+#ifndef VM_AFFINE_H
+#define VM_AFFINE_H
+
+#include "vecmath.h"
+#include "vecarray.h"
+
+#include <cstdint>
+
+namespace vecmath {
+
+template <typename fptype>
+AffineMatrix3<fptype> operator*(AffineMatrix3<fptype> const& a,  // A' = A * B
+                                AffineMatrix3<fptype> const& b);
+
+/**
+ * A 3D affine transformation matrix.
+ *
+ * Only the top three rows of the 4x4 matrix are stored; the
+ * bottom row is always [0 0 0 1]. The storage is 3/4 the size of
+ * a Matrix3<>, and the products skip the multiplies by the
+ * constant row: 36 instead of 64 for a composition and 12 instead
+ * of 16 for a vector.
+ *
+ * All the Matrix3<> factories produce affine matrices, so this
+ * class has the same ones. Conversions to and from Matrix3<> are
+ * explicit.
+ */
+template <typename _fptype>
+class AffineMatrix3
+{
+  public:
+    typedef _fptype fptype;
+
+  protected:
+    alignas(detail::storage_align(12 * sizeof(_fptype), alignof(_fptype))) fptype m_m[3][4];
+
+  public:
+    constexpr static fptype zero = 0.0;
+    constexpr static fptype one  = 1.0;
+
+    constexpr AffineMatrix3()
+        : m_m {{one,  zero, zero, zero},    // identity is default
+               {zero, one,  zero, zero},
+               {zero, zero, one,  zero}}
+    { }
+
+    /**
+     * Take the top three rows of a Matrix3<>. The bottom row of
+     * \c m is assumed to be [0 0 0 1] and is not checked.
+     */
+    explicit AffineMatrix3(Matrix3<fptype> const& m)
+    {
+        std::memcpy(m_m, m.m_m, sizeof(m_m));
+    }
+
+    /**
+     * Expand to a full Matrix3<>, with a [0 0 0 1] bottom row.
+     */
+    explicit operator Matrix3<fptype>() const
+    {
+        Matrix3<fptype> r;                  // bottom row is identity's
+        std::memcpy(r.m_m, m_m, sizeof(m_m));
+        return r;
+    }
+
+    /**
+     * Get element (r, c) of the equivalent 4x4 matrix. Row 3
+     * reads as [0 0 0 1].
+     */
+    VECMATH_CONSTEXPR14 fptype get(uint32_t r, uint32_t c) const
+    {
+        if (r > 3 || c > 3)
+        {
+            throw index_error("AffineMatrix3::get()");
+        }
+        if (r == 3)
+        {
+            return (c == 3) ? one : zero;
+        }
+        return m_m[r][c];
+    }
+
+    /**
+     * Element (r, c) of the stored rows without bounds checks;
+     * \c r must be 0-2.
+     */
+    constexpr fptype operator()(uint32_t r, uint32_t c) const noexcept
+    {
+        return m_m[r][c];
+    }
+
+    VECMATH_CONSTEXPR14 fptype& operator()(uint32_t r, uint32_t c) noexcept
+    {
+        return m_m[r][c];
+    }
+
+    /**
+     * The 12 stored elements, contiguous in row-major order:
+     * element (r, c) is data()[4*r + c], for r 0-2.
+     */
+    fptype* data() noexcept { return &m_m[0][0]; }
+    fptype const* data() const noexcept { return &m_m[0][0]; }
+
+    // static factory methods:
+
+    static VECMATH_CONSTEXPR14 AffineMatrix3 translation(fptype dx, fptype dy, fptype dz)
+    {
+        AffineMatrix3 r;
+        r.m_m[0][3] = dx;                   // | 1 0 0 x |
+        r.m_m[1][3] = dy;                   // | 0 1 0 y |
+        r.m_m[2][3] = dz;                   // | 0 0 1 z |
+        return r;
+    }
+
+    static VECMATH_CONSTEXPR14 AffineMatrix3 scale(fptype sx, fptype sy, fptype sz)
+    {
+        AffineMatrix3 r;
+        r.m_m[0][0] = sx;                   // | x 0 0 0 |
+        r.m_m[1][1] = sy;                   // | 0 y 0 0 |
+        r.m_m[2][2] = sz;                   // | 0 0 z 0 |
+        return r;
+    }
+
+    static AffineMatrix3 rotateX(fptype theta)
+    {
+        fptype ct = std::cos(theta);
+        fptype st = std::sin(theta);
+
+        AffineMatrix3 r;
+        r.m_m[1][1] = r.m_m[2][2] = ct;
+        r.m_m[1][2] = -st;
+        r.m_m[2][1] = st;
+        return r;
+    }
+
+    static AffineMatrix3 rotateY(fptype theta)
+    {
+        fptype ct = std::cos(theta);
+        fptype st = std::sin(theta);
+
+        AffineMatrix3 r;
+        r.m_m[0][0] = r.m_m[2][2] = ct;
+        r.m_m[0][2] = st;
+        r.m_m[2][0] = -st;
+        return r;
+    }
+
+    static AffineMatrix3 rotateZ(fptype theta)
+    {
+        fptype ct = std::cos(theta);
+        fptype st = std::sin(theta);
+
+        AffineMatrix3 r;
+        r.m_m[0][0] = r.m_m[1][1] = ct;
+        r.m_m[0][1] = -st;
+        r.m_m[1][0] = st;
+        return r;
+    }
+
+    // Declare friend functions for data access:
+    template <typename FP>
+    friend AffineMatrix3<FP> operator*(AffineMatrix3<FP> const& a,
+                                       AffineMatrix3<FP> const& b);
+    template <typename FP>
+    friend Vector3<FP> operator*(Vector3<FP> const& v,
+                                 AffineMatrix3<FP> const& m);
+    template <typename FP>
+    friend Vector3<FP> operator*(AffineMatrix3<FP> const& m,
+                                 Vector3<FP> const& v);
+    template <typename FP>
+    friend void transform(AffineMatrix3<FP> const& m,
+                          Vector3Array<FP> const& in,
+                          Vector3Array<FP>& out);
+};
+
+template <typename _fptype>
+constexpr _fptype AffineMatrix3<_fptype>::zero;
+template <typename _fptype>
+constexpr _fptype AffineMatrix3<_fptype>::one;
+
+/**
+ * Affine-Affine multiplication (composition)
+ */
+template <typename fptype>
+AffineMatrix3<fptype> operator*(AffineMatrix3<fptype> const& mata,
+                                AffineMatrix3<fptype> const& matb)
+{
+    AffineMatrix3<fptype> result;
+    fptype const (&a)[3][4] = mata.m_m;
+    fptype const (&b)[3][4] = matb.m_m;
+
+    fptype (&r)[3][4] = result.m_m;
+
+    // Looping over the columns lets each row of the result be one
+    // vector expression of the rows of b.
+    for (int j=0; j<4; j++)
+    {
+        r[0][j] = (a[0][0]*b[0][j] + a[0][1]*b[1][j] + a[0][2]*b[2][j]);
+        r[1][j] = (a[1][0]*b[0][j] + a[1][1]*b[1][j] + a[1][2]*b[2][j]);
+        r[2][j] = (a[2][0]*b[0][j] + a[2][1]*b[1][j] + a[2][2]*b[2][j]);
+    }
+
+    // b's implied bottom row only contributes a[i][3] to column 3
+    r[0][3] += a[0][3];
+    r[1][3] += a[1][3];
+    r[2][3] += a[2][3];
+
+    return result;
+}
+
+/**
+ * Row vector-Affine multiplication
+ *
+ */
+template <typename fptype>
+Vector3<fptype> operator*(Vector3<fptype> const& vec,
+                          AffineMatrix3<fptype> const& mat)
+{
+    Vector3<fptype> result;
+    fptype (&r)[4] = result.m_v;
+    fptype const (&v)[4] = vec.m_v;
+    fptype const (&m)[3][4] = mat.m_m;
+
+    // vm_mult without the bottom row
+    r[0] = (v[0]*m[0][0] + v[1]*m[1][0] + v[2]*m[2][0]);
+    r[1] = (v[0]*m[0][1] + v[1]*m[1][1] + v[2]*m[2][1]);
+    r[2] = (v[0]*m[0][2] + v[1]*m[1][2] + v[2]*m[2][2]);
+    r[3] = (v[0]*m[0][3] + v[1]*m[1][3] + v[2]*m[2][3] + v[3]);
+
+    return result;
+}
+
+/**
+ * Affine-column Vector multiplication
+ *
+ */
+template <typename fptype>
+Vector3<fptype> operator*(AffineMatrix3<fptype> const& mat,
+                          Vector3<fptype> const& vec)
+{
+    Vector3<fptype> result;
+    fptype (&r)[4] = result.m_v;
+    fptype const (&v)[4] = vec.m_v;
+    fptype const (&m)[3][4] = mat.m_m;
+
+    // mv_mult without the bottom row
+    r[0] = (v[0]*m[0][0] + v[1]*m[0][1] + v[2]*m[0][2] + v[3]*m[0][3]);
+    r[1] = (v[0]*m[1][0] + v[1]*m[1][1] + v[2]*m[1][2] + v[3]*m[1][3]);
+    r[2] = (v[0]*m[2][0] + v[1]*m[2][1] + v[2]*m[2][2] + v[3]*m[2][3]);
+    r[3] = v[3];
+
+    return result;
+}
+
+/**
+ * Batch Affine-column Vector multiplication, out = A * in.
+ *
+ * The same as transform() for a Matrix3<>, which already skips the
+ * projective row. \c in and \c out may be the same array.
+ */
+template <typename fptype>
+void transform(AffineMatrix3<fptype> const& m,
+               Vector3Array<fptype> const& in,
+               Vector3Array<fptype>& out)
+{
+    fptype const (&a)[3][4] = m.m_m;
+    fptype const rows[12] = {a[0][0], a[0][1], a[0][2], a[0][3],
+                             a[1][0], a[1][1], a[1][2], a[1][3],
+                             a[2][0], a[2][1], a[2][2], a[2][3]};
+
+    if (&in == &out)
+    {
+        detail::transform_points(rows, out.X(), out.Y(), out.Z(), out.size());
+        return;
+    }
+
+    out.resize(in.size());
+    detail::transform_points(rows, in.X(), in.Y(), in.Z(),
+                             out.X(), out.Y(), out.Z(), in.size());
+}
+
+/*
+ * Type specializations for float and double variants
+ */
+using AffineMatrix3f = AffineMatrix3<float>;
+using AffineMatrix3d = AffineMatrix3<double>;
+
+} // ::vecmath
+
+#endif // VM_AFFINE_H
@@ -0,0 +1,733 @@
+/*
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/*
+ * Bounding volume hierarchy over a point cloud
+ *
+ * PointBVH<> sorts the points along a Morton (Z-order) curve and
+ * splits them into a binary tree of bounding boxes, with up to
+ * leaf_size points per leaf. The nodes sit in one array in
+ * depth-first order, a node's left child right after it, and the
+ * points are copied in leaf order into structure-of-arrays buffers,
+ * so a query walks memory mostly forwards:
+ *
+ *     PointBVH<float> const bvh(points);
+ *     std::vector<uint32_t> idx(8);
+ *     std::vector<float> dist2(8);
+ *     std::size_t const found = bvh.nearest(q, 8, idx, dist2);
+ *
+ * Queries take O(log n) time for well spread points instead of a
+ * pass over all of them, and report the indices of the points in
+ * the array the tree was built from.
+ *
+ * When the points move, refit() takes their new positions and
+ * transform() moves them all by a matrix; both recompute the boxes
+ * bottom-up in one pass over the nodes, keeping the tree. The
+ * queries stay exact, but after large relative motion a rebuild
+ * makes them faster again. parallel::build_bvh() in vecparallel.h
+ * builds the same tree on a thread pool.
+ */
+#ifndef VM_BVH_H
+#define VM_BVH_H
+
+#include "vecmath.h"
+#include "aabb.h"
+#include "vecarray.h"
+#include "vecintersect.h"
+#include "vecsimd.h"
+#include "vecspan.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace vecmath {
+
+namespace detail {
+
+/*
+ * Points per block for the block-parallel build steps, and the
+ * most points in a subtree built as one task.
+ */
+std::size_t const bvh_block = 4096;
+std::size_t const bvh_task = 1 << 16;
+
+/*
+ * Traversal stack entries: a tree is at most 30 levels of Morton
+ * splits and 32 halvings of equal codes deep, and a walk keeps at
+ * most one sibling per level, plus one.
+ */
+std::size_t const bvh_stack = 64;
+
+// Runs the blocks of a build on the calling thread.
+struct serial_blocks
+{
+    template <typename Fn>
+    void operator()(std::size_t blocks, Fn const& fn) const
+    {
+        for (std::size_t b=0; b<blocks; ++b)
+        {
+            fn(b);
+        }
+    }
+};
+
+// The input points, as an array of Vector3<> or a Vector3Array<>.
+template <typename fptype>
+struct aos_points
+{
+    Vector3<fptype> const* p;
+    std::size_t n;
+
+    std::size_t size() const { return n; }
+    fptype x(std::size_t i) const { return p[i].X(); }
+    fptype y(std::size_t i) const { return p[i].Y(); }
+    fptype z(std::size_t i) const { return p[i].Z(); }
+    AABB<fptype> bounds() const { return compute_bounds(span<Vector3<fptype> const>(p, n)); }
+};
+
+template <typename fptype>
+struct soa_points
+{
+    Vector3Array<fptype> const* a;
+
+    std::size_t size() const { return a->size(); }
+    fptype x(std::size_t i) const { return a->X()[i]; }
+    fptype y(std::size_t i) const { return a->Y()[i]; }
+    fptype z(std::size_t i) const { return a->Z()[i]; }
+    AABB<fptype> bounds() const { return compute_bounds(*a); }
+};
+
+// The low 10 bits of v, spread to every third bit.
+inline uint32_t spread_bits(uint32_t v)
+{
+    v &= 0x3ff;
+    v = (v | (v << 16)) & 0x030000ff;
+    v = (v | (v << 8)) & 0x0300f00f;
+    v = (v | (v << 4)) & 0x030c30c3;
+    v = (v | (v << 2)) & 0x09249249;
+    return v;
+}
+
+template <typename fptype>
+uint32_t quantize(fptype v, fptype lo, fptype scale)
+{
+    fptype const q = (v - lo) * scale;
+    return (q < fptype(1023)) ? uint32_t(q) : 1023u;
+}
+
+/*
+ * Sort the 30-bit codes, carrying the ids along: a stable radix sort
+ * of three 10-bit digits.
+ */
+inline void sort_codes(std::vector<uint32_t>& codes, std::vector<uint32_t>& ids)
+{
+    std::size_t const n = codes.size();
+    std::vector<uint32_t> c2(n), i2(n);
+    std::vector<std::size_t> start(1025);
+    for (int shift=0; shift<30; shift+=10)
+    {
+        std::fill(start.begin(), start.end(), 0);
+        for (std::size_t i=0; i<n; ++i)
+        {
+            ++start[((codes[i] >> shift) & 1023) + 1];
+        }
+        for (std::size_t d=1; d<1025; ++d)
+        {
+            start[d] += start[d-1];
+        }
+        for (std::size_t i=0; i<n; ++i)
+        {
+            std::size_t const at = start[(codes[i] >> shift) & 1023]++;
+            c2[at] = codes[i];
+            i2[at] = ids[i];
+        }
+        codes.swap(c2);
+        ids.swap(i2);
+    }
+}
+
+inline int highest_bit(uint32_t v)
+{
+    int b = -1;
+    while (v)
+    {
+        v >>= 1;
+        ++b;
+    }
+    return b;
+}
+
+} // ::detail
+
+/**
+ * A bounding volume hierarchy over a fixed set of points; see the
+ * top of bvh.h.
+ */
+template <typename _fptype>
+class PointBVH
+{
+  public:
+    typedef _fptype fptype;
+
+    /* The most points in a leaf */
+    static std::size_t const leaf_size = 8;
+
+    /**
+     * A box of the tree. A leaf (count > 0) holds the points
+     * [index, index + count) in leaf order; an inner node (count 0)
+     * has children at this node + 1 and at \c index.
+     */
+    struct Node
+    {
+        fptype lo[3];
+        fptype hi[3];
+        uint32_t index;
+        uint32_t count;
+    };
+
+  private:
+    std::vector<Node> m_nodes;
+    Vector3Array<fptype> m_points;          // in leaf order
+    std::vector<uint32_t> m_ids;            // input index of each
+    std::vector<uint32_t> m_codes;          // Morton codes, only while building
+
+  public:
+    PointBVH()
+    { }
+
+    explicit PointBVH(span<Vector3<fptype> const> pts)
+    {
+        build(pts);
+    }
+
+    explicit PointBVH(Vector3Array<fptype> const& pts)
+    {
+        build(pts);
+    }
+
+    /**
+     * Rebuild the tree over \c pts. Throws index_error for more than
+     * 2^32 - 1 points. The points must not be NaN.
+     */
+    void build(span<Vector3<fptype> const> pts)
+    {
+        build_blocks(detail::aos_points<fptype>{pts.data(), pts.size()}, detail::serial_blocks());
+    }
+
+    void build(Vector3Array<fptype> const& pts)
+    {
+        build_blocks(detail::soa_points<fptype>{&pts}, detail::serial_blocks());
+    }
+
+    std::size_t size() const noexcept { return m_ids.size(); }
+    bool empty() const noexcept { return m_ids.empty(); }
+
+    /* The nodes, root first, and the points in leaf order with their input indices */
+    std::vector<Node> const& nodes() const noexcept { return m_nodes; }
+    Vector3Array<fptype> const& points() const noexcept { return m_points; }
+    std::vector<uint32_t> const& ids() const noexcept { return m_ids; }
+
+    /* The bounds of all the points */
+    AABB<fptype> bounds() const
+    {
+        return m_nodes.empty() ? AABB<fptype>() : box(m_nodes[0]);
+    }
+
+    /**
+     * The \c k points nearest to \c q, nearest first: their input
+     * indices in index[0, found) and squared distances in dist2,
+     * where found, the return value, is the smaller of k and size().
+     * Throws index_error if \c index or \c dist2 hold fewer than k.
+     */
+    std::size_t nearest(Vector3<fptype> const& q, std::size_t k, span<uint32_t> index,
+                        span<fptype> dist2) const
+    {
+        if (index.size() < k || dist2.size() < k)
+        {
+            throw index_error("PointBVH::nearest(): output too small");
+        }
+        if (k == 0 || m_nodes.empty())
+        {
+            return 0;
+        }
+        typedef std::pair<fptype, uint32_t> entry;
+        std::vector<entry> best;
+        best.reserve(k);
+        fptype const qx = q.X(), qy = q.Y(), qz = q.Z();
+        fptype const* const px = m_points.X();
+        fptype const* const py = m_points.Y();
+        fptype const* const pz = m_points.Z();
+
+        std::pair<uint32_t, fptype> stack[detail::bvh_stack];
+        std::size_t top = 0;
+        stack[top++] = std::make_pair(0u, fptype(0));
+        while (top)
+        {
+            std::pair<uint32_t, fptype> const s = stack[--top];
+            if (best.size() == k && s.second > best.front().first)
+            {
+                continue;
+            }
+            Node const* node = &m_nodes[s.first];
+            while (node->count == 0)
+            {
+                uint32_t const a = uint32_t(node - m_nodes.data()) + 1, b = node->index;
+                fptype da = box_distance2(m_nodes[a], qx, qy, qz);
+                fptype db = box_distance2(m_nodes[b], qx, qy, qz);
+                uint32_t near = a, far = b;
+                if (db < da)
+                {
+                    std::swap(near, far);
+                    std::swap(da, db);
+                }
+                if (best.size() < k || db <= best.front().first)
+                {
+                    stack[top++] = std::make_pair(far, db);
+                }
+                if (best.size() == k && da > best.front().first)
+                {
+                    node = nullptr;
+                    break;
+                }
+                node = &m_nodes[near];
+            }
+            if (!node)
+            {
+                continue;
+            }
+            for (uint32_t i=node->index; i<node->index+node->count; ++i)
+            {
+                fptype const dx = px[i] - qx, dy = py[i] - qy, dz = pz[i] - qz;
+                entry const e(dx*dx + dy*dy + dz*dz, m_ids[i]);
+                if (best.size() < k)
+                {
+                    best.push_back(e);
+                    std::push_heap(best.begin(), best.end());
+                }
+                else if (e < best.front())
+                {
+                    std::pop_heap(best.begin(), best.end());
+                    best.back() = e;
+                    std::push_heap(best.begin(), best.end());
+                }
+            }
+        }
+        std::sort_heap(best.begin(), best.end());
+        for (std::size_t i=0; i<best.size(); ++i)
+        {
+            dist2[i] = best[i].first;
+            index[i] = best[i].second;
+        }
+        return best.size();
+    }
+
+    /**
+     * Append to \c out the input indices of the points within
+     * \c radius of \c q, surface included, in no particular order.
+     * Returns how many were appended.
+     */
+    std::size_t within(Vector3<fptype> const& q, fptype radius, std::vector<uint32_t>& out) const
+    {
+        if (m_nodes.empty())
+        {
+            return 0;
+        }
+        std::size_t const before = out.size();
+        fptype const r2 = radius * radius;
+        fptype const qx = q.X(), qy = q.Y(), qz = q.Z();
+        fptype const* const px = m_points.X();
+        fptype const* const py = m_points.Y();
+        fptype const* const pz = m_points.Z();
+
+        uint32_t stack[detail::bvh_stack];
+        std::size_t top = 0;
+        stack[top++] = 0;
+        while (top)
+        {
+            Node const& node = m_nodes[stack[--top]];
+            if (box_distance2(node, qx, qy, qz) > r2)
+            {
+                continue;
+            }
+            if (node.count == 0)
+            {
+                stack[top++] = node.index;
+                stack[top++] = uint32_t(&node - m_nodes.data()) + 1;
+                continue;
+            }
+            for (uint32_t i=node.index; i<node.index+node.count; ++i)
+            {
+                fptype const dx = px[i] - qx, dy = py[i] - qy, dz = pz[i] - qz;
+                if (dx*dx + dy*dy + dz*dz <= r2)
+                {
+                    out.push_back(m_ids[i]);
+                }
+            }
+        }
+        return out.size() - before;
+    }
+
+    /**
+     * The first point along a ray within \c radius of it: among the
+     * points at distance at most \c radius from the ray, the one
+     * with the smallest t >= 0, where r.at(t) is its projection on
+     * the ray. On a hit, sets \c index to its input index and \c t,
+     * and returns true; otherwise returns false and sets \c t to
+     * infinity. The direction must not be zero.
+     */
+    bool raycast(Ray<fptype> const& r, fptype radius, uint32_t& index, fptype& t) const
+    {
+        fptype const inf = std::numeric_limits<fptype>::infinity();
+        t = inf;
+        if (m_nodes.empty())
+        {
+            return false;
+        }
+        fptype const o[3] = {r.origin.X(), r.origin.Y(), r.origin.Z()};
+        fptype const d[3] = {r.direction.X(), r.direction.Y(), r.direction.Z()};
+        fptype const inv[3] = {1 / d[0], 1 / d[1], 1 / d[2]};
+        fptype const dd = d[0]*d[0] + d[1]*d[1] + d[2]*d[2];
+        fptype const r2 = radius * radius;
+        fptype const* const px = m_points.X();
+        fptype const* const py = m_points.Y();
+        fptype const* const pz = m_points.Z();
+
+        uint32_t stack[detail::bvh_stack];
+        std::size_t top = 0;
+        stack[top++] = 0;
+        while (top)
+        {
+            Node const& node = m_nodes[stack[--top]];
+            if (!(slab_entry(node, o, inv, radius) < t))
+            {
+                continue;
+            }
+            if (node.count == 0)
+            {
+                uint32_t const a = uint32_t(&node - m_nodes.data()) + 1, b = node.index;
+                if (slab_entry(m_nodes[a], o, inv, radius) <= slab_entry(m_nodes[b], o, inv, radius))
+                {
+                    stack[top++] = b;
+                    stack[top++] = a;
+                }
+                else
+                {
+                    stack[top++] = a;
+                    stack[top++] = b;
+                }
+                continue;
+            }
+            for (uint32_t i=node.index; i<node.index+node.count; ++i)
+            {
+                fptype const sx = px[i] - o[0], sy = py[i] - o[1], sz = pz[i] - o[2];
+                fptype const ti = (sx*d[0] + sy*d[1] + sz*d[2]) / dd;
+                fptype const ex = sx - ti*d[0], ey = sy - ti*d[1], ez = sz - ti*d[2];
+                if (ti >= 0 && ti < t && ex*ex + ey*ey + ez*ez <= r2)
+                {
+                    t = ti;
+                    index = m_ids[i];
+                }
+            }
+        }
+        return t != inf;
+    }
+
+    /**
+     * Move the points to \c pts, indexed as when built, and recompute
+     * the boxes. Throws index_error if the sizes differ.
+     */
+    void refit(span<Vector3<fptype> const> pts)
+    {
+        if (pts.size() != size())
+        {
+            throw index_error("PointBVH::refit(): sizes differ");
+        }
+        for (std::size_t i=0; i<size(); ++i)
+        {
+            Vector3<fptype> const& p = pts[m_ids[i]];
+            m_points.X()[i] = p.X();
+            m_points.Y()[i] = p.Y();
+            m_points.Z()[i] = p.Z();
+        }
+        refit_boxes();
+    }
+
+    void refit(Vector3Array<fptype> const& pts)
+    {
+        if (pts.size() != size())
+        {
+            throw index_error("PointBVH::refit(): sizes differ");
+        }
+        for (std::size_t i=0; i<size(); ++i)
+        {
+            m_points.X()[i] = pts.X()[m_ids[i]];
+            m_points.Y()[i] = pts.Y()[m_ids[i]];
+            m_points.Z()[i] = pts.Z()[m_ids[i]];
+        }
+        refit_boxes();
+    }
+
+    /**
+     * Transform every point by \c m, as vecmath::transform() does,
+     * and recompute the boxes.
+     */
+    void transform(Matrix3<fptype> const& m)
+    {
+        vecmath::transform(m, m_points, m_points);
+        refit_boxes();
+    }
+
+  private:
+    static AABB<fptype> box(Node const& n)
+    {
+        return AABB<fptype>(Vector3<fptype>(n.lo[0], n.lo[1], n.lo[2]),
+                            Vector3<fptype>(n.hi[0], n.hi[1], n.hi[2]));
+    }
+
+    static fptype box_distance2(Node const& n, fptype x, fptype y, fptype z)
+    {
+        fptype const dx = std::max(std::max(n.lo[0] - x, x - n.hi[0]), fptype(0));
+        fptype const dy = std::max(std::max(n.lo[1] - y, y - n.hi[1]), fptype(0));
+        fptype const dz = std::max(std::max(n.lo[2] - z, z - n.hi[2]), fptype(0));
+        return dx*dx + dy*dy + dz*dz;
+    }
+
+    // Where the ray enters the box grown by \c pad, or infinity.
+    static fptype slab_entry(Node const& n, fptype const* o, fptype const* inv, fptype pad)
+    {
+        fptype enter = 0;
+        fptype leave = std::numeric_limits<fptype>::infinity();
+        for (int a=0; a<3; ++a)
+        {
+            fptype const lo = n.lo[a] - pad, hi = n.hi[a] + pad;
+            if (inv[a] == std::numeric_limits<fptype>::infinity() ||
+                inv[a] == -std::numeric_limits<fptype>::infinity())
+            {
+                if (o[a] < lo || o[a] > hi)
+                {
+                    return std::numeric_limits<fptype>::infinity();
+                }
+                continue;
+            }
+            fptype t0 = (lo - o[a]) * inv[a], t1 = (hi - o[a]) * inv[a];
+            if (t0 > t1)
+            {
+                std::swap(t0, t1);
+            }
+            enter = std::max(enter, t0);
+            leave = std::min(leave, t1);
+        }
+        return (enter <= leave) ? enter : std::numeric_limits<fptype>::infinity();
+    }
+
+    void leaf_box(Node& n) const
+    {
+        fptype const inf = std::numeric_limits<fptype>::infinity();
+        fptype lo[3] = {inf, inf, inf}, hi[3] = {-inf, -inf, -inf};
+        simd::scalar::bounds_soa_n(lo, hi, m_points.X() + n.index, m_points.Y() + n.index,
+                                   m_points.Z() + n.index, n.count);
+        std::copy(lo, lo + 3, n.lo);
+        std::copy(hi, hi + 3, n.hi);
+    }
+
+    void inner_box(Node& n, Node const& a, Node const& b) const
+    {
+        for (int c=0; c<3; ++c)
+        {
+            n.lo[c] = std::min(a.lo[c], b.lo[c]);
+            n.hi[c] = std::max(a.hi[c], b.hi[c]);
+        }
+    }
+
+    // Children follow their parents, so reverse order is bottom-up.
+    void refit_boxes()
+    {
+        for (std::size_t i=m_nodes.size(); i-->0; )
+        {
+            Node& n = m_nodes[i];
+            if (n.count)
+            {
+                leaf_box(n);
+            }
+            else
+            {
+                inner_box(n, m_nodes[i+1], m_nodes[n.index]);
+            }
+        }
+    }
+
+    /*
+     * Where [b, e) splits: at the highest bit in which its first and
+     * last codes differ, or in the middle if they are equal.
+     */
+    std::size_t split(std::size_t b, std::size_t e) const
+    {
+        uint32_t const first = m_codes[b], last = m_codes[e-1];
+        if (first == last)
+        {
+            return b + (e - b) / 2;
+        }
+        uint32_t const bit = 1u << detail::highest_bit(first ^ last);
+        std::size_t lo = b, hi = e - 1;         // bit clear at lo, set at hi
+        while (lo + 1 < hi)
+        {
+            std::size_t const mid = lo + (hi - lo) / 2;
+            if (m_codes[mid] & bit)
+            {
+                hi = mid;
+            }
+            else
+            {
+                lo = mid;
+            }
+        }
+        return hi;
+    }
+
+    // Append the subtree of [b, e) to out, indices relative to out.
+    uint32_t build_range(std::vector<Node>& out, std::size_t b, std::size_t e) const
+    {
+        uint32_t const self = uint32_t(out.size());
+        out.push_back(Node());
+        if (e - b <= leaf_size)
+        {
+            out[self].index = uint32_t(b);
+            out[self].count = uint32_t(e - b);
+            leaf_box(out[self]);
+            return self;
+        }
+        std::size_t const s = split(b, e);
+        build_range(out, b, s);
+        uint32_t const right = build_range(out, s, e);
+        out[self].index = right;
+        out[self].count = 0;
+        inner_box(out[self], out[self+1], out[right]);
+        return self;
+    }
+
+    // The task ranges: the subtrees of at most bvh_task points.
+    void task_ranges(std::size_t b, std::size_t e, std::vector<std::pair<std::size_t, std::size_t> >& out) const
+    {
+        if (e - b <= detail::bvh_task)
+        {
+            out.push_back(std::make_pair(b, e));
+            return;
+        }
+        std::size_t const s = split(b, e);
+        task_ranges(b, s, out);
+        task_ranges(s, e, out);
+    }
+
+    // The nodes above the tasks, with the tasks' subtrees in place.
+    uint32_t assemble(std::size_t b, std::size_t e, std::vector<std::vector<Node> > const& built,
+                      std::size_t& next)
+    {
+        if (e - b <= detail::bvh_task)
+        {
+            uint32_t const self = uint32_t(m_nodes.size());
+            for (Node n : built[next++])
+            {
+                if (n.count == 0)
+                {
+                    n.index += self;
+                }
+                m_nodes.push_back(n);
+            }
+            return self;
+        }
+        uint32_t const self = uint32_t(m_nodes.size());
+        m_nodes.push_back(Node());
+        std::size_t const s = split(b, e);
+        assemble(b, s, built, next);
+        uint32_t const right = assemble(s, e, built, next);
+        m_nodes[self].index = right;
+        m_nodes[self].count = 0;
+        inner_box(m_nodes[self], m_nodes[self+1], m_nodes[right]);
+        return self;
+    }
+
+  public:
+    /*
+     * The build, its steps run in blocks by \c blocks(count, fn):
+     * Morton codes, a radix sort, the points gathered in order, and
+     * the subtrees, joined by the nodes above them. The tree does
+     * not depend on how the blocks are run.
+     */
+    template <typename Points, typename Blocks>
+    void build_blocks(Points const& pts, Blocks const& blocks)
+    {
+        std::size_t const n = pts.size();
+        if (n >= std::numeric_limits<uint32_t>::max())
+        {
+            throw index_error("PointBVH::build(): too many points");
+        }
+        m_nodes.clear();
+        m_points.resize(n);
+        m_ids.resize(n);
+        m_codes.resize(n);
+        if (n == 0)
+        {
+            return;
+        }
+
+        AABB<fptype> const b = pts.bounds();
+        fptype const lo[3] = {b.lo.X(), b.lo.Y(), b.lo.Z()};
+        fptype const size[3] = {b.hi.X() - lo[0], b.hi.Y() - lo[1], b.hi.Z() - lo[2]};
+        fptype scale[3];
+        for (int c=0; c<3; ++c)
+        {
+            scale[c] = (size[c] > 0) ? fptype(1024) / size[c] : fptype(0);
+        }
+        std::size_t const nblocks = (n + detail::bvh_block - 1) / detail::bvh_block;
+        blocks(nblocks, [&](std::size_t k) {
+            std::size_t const last = std::min(n, (k + 1) * detail::bvh_block);
+            for (std::size_t i=k*detail::bvh_block; i<last; ++i)
+            {
+                m_codes[i] = (detail::spread_bits(detail::quantize(pts.x(i), lo[0], scale[0])) << 2) |
+                             (detail::spread_bits(detail::quantize(pts.y(i), lo[1], scale[1])) << 1) |
+                             detail::spread_bits(detail::quantize(pts.z(i), lo[2], scale[2]));
+                m_ids[i] = uint32_t(i);
+            }
+        });
+        detail::sort_codes(m_codes, m_ids);
+        blocks(nblocks, [&](std::size_t k) {
+            std::size_t const last = std::min(n, (k + 1) * detail::bvh_block);
+            for (std::size_t i=k*detail::bvh_block; i<last; ++i)
+            {
+                m_points.X()[i] = pts.x(m_ids[i]);
+                m_points.Y()[i] = pts.y(m_ids[i]);
+                m_points.Z()[i] = pts.z(m_ids[i]);
+            }
+        });
+
+        std::vector<std::pair<std::size_t, std::size_t> > tasks;
+        task_ranges(0, n, tasks);
+        std::vector<std::vector<Node> > built(tasks.size());
+        blocks(tasks.size(), [&](std::size_t k) {
+            built[k].reserve(2 * (tasks[k].second - tasks[k].first) / leaf_size + 1);
+            build_range(built[k], tasks[k].first, tasks[k].second);
+        });
+        m_nodes.reserve(2 * n / leaf_size + 1);
+        std::size_t next = 0;
+        assemble(0, n, built, next);
+        std::vector<uint32_t>().swap(m_codes);
+    }
+};
+
+template <typename _fptype>
+std::size_t const PointBVH<_fptype>::leaf_size;
+
+using PointBVHf = PointBVH<float>;
+using PointBVHd = PointBVH<double>;
+
+} // ::vecmath
+
+#endif // VM_BVH_H
@@ -9,6 +9,11 @@
 #define CIRCLE3PTS_H
 
 #include "vecmath.h"
+#include "vecarray.h"
+#include "vecn.h"
+
+#include <cstddef>
+#include <cstdint>
 
 namespace vecmath {
 
@@ -65,6 +70,166 @@ Vector3<fptype> circle3pts(Vector3<fptype> a, Vector3<fptype> b, Vector3<fptype>
     return {x, y, 0.0};
 }
 
+namespace detail {
+
+/*
+ * Closed-form circumcenter of one triple, computed relative to
+ * \c a. Writes the center and returns true, or writes (0,0) and
+ * returns false for colinear input.
+ */
+template <typename fptype>
+inline bool circumcenter(fptype ax, fptype ay, fptype bx, fptype by,
+                         fptype cx, fptype cy, fptype& ux, fptype& uy)
+{
+    bx -= ax;  by -= ay;
+    cx -= ax;  cy -= ay;
+
+    // Twice the signed area; zero when a,b,c are colinear. This is
+    // the Z of cross(b-a, c-b) tested by circle3pts().
+    fptype const area2 = bx*cy - by*cx;
+    bool const ok = !fpequal(area2, fptype(0.0));
+
+    fptype const b2 = bx*bx + by*by;
+    fptype const c2 = cx*cx + cy*cy;
+    fptype const inv = fptype(0.5) / (ok ? area2 : fptype(1.0));
+
+    ux = ok ? ax + (cy*b2 - by*c2) * inv : fptype(0.0);
+    uy = ok ? ay + (bx*c2 - cx*b2) * inv : fptype(0.0);
+    return ok;
+}
+
+} // ::detail
+
+/**
+ * Calculate a circle from 3 points in the plane.
+ *
+ * The Vector2<> form of circle3pts(), by the closed form of the
+ * batch functions: it reads and returns only X and Y. Throws
+ * vecmath::degenerate_error for colinear points.
+ *
+ * @returns Vector2<> the center of the circle
+ */
+template <typename fptype>
+Vector2<fptype> circle3pts(Vector2<fptype> const& a, Vector2<fptype> const& b,
+                           Vector2<fptype> const& c)
+{
+    fptype x, y;
+    if (!detail::circumcenter(a.X(), a.Y(), b.X(), b.Y(), c.X(), c.Y(), x, y))
+    {
+        throw degenerate_error("circle3pts: points a,b,c are colinear");
+    }
+    return Vector2<fptype>(x, y);
+}
+
+namespace detail {
+
+/*
+ * The same solution over separate coordinate buffers. The loop has
+ * no selects or branches so that it vectorizes: the division runs
+ * unconditionally (colinear triples produce non-finite values,
+ * without trapping in the default floating point environment) and
+ * those results are zeroed in a second pass, which is skipped when
+ * every triple was solved. The buffers must not overlap.
+ */
+template <typename fptype>
+std::size_t circumcenters(fptype const* VM_RESTRICT ax, fptype const* VM_RESTRICT ay,
+                          fptype const* VM_RESTRICT bx, fptype const* VM_RESTRICT by,
+                          fptype const* VM_RESTRICT cx, fptype const* VM_RESTRICT cy,
+                          fptype* VM_RESTRICT ux, fptype* VM_RESTRICT uy,
+                          fptype* VM_RESTRICT uz, uint8_t* VM_RESTRICT status,
+                          std::size_t n)
+{
+    std::size_t solved = 0;
+    for (std::size_t i=0; i<n; ++i)
+    {
+        fptype const ex = bx[i] - ax[i], ey = by[i] - ay[i];
+        fptype const fx = cx[i] - ax[i], fy = cy[i] - ay[i];
+
+        fptype const area2 = ex*fy - ey*fx;
+        bool const ok = !fpequal(area2, fptype(0.0));
+
+        fptype const e2 = ex*ex + ey*ey;
+        fptype const f2 = fx*fx + fy*fy;
+        fptype const inv = fptype(0.5) / area2;
+
+        ux[i] = ax[i] + (fy*e2 - ey*f2) * inv;
+        uy[i] = ay[i] + (ex*f2 - fx*e2) * inv;
+        uz[i] = 0;
+        status[i] = ok;
+        solved += ok;
+    }
+
+    if (solved != n)
+    {
+        for (std::size_t i=0; i<n; ++i)
+        {
+            if (!status[i])
+                ux[i] = uy[i] = 0;
+        }
+    }
+    return solved;
+}
+
+} // ::detail
+
+/**
+ * Calculate circles from many triples of points.
+ *
+ * For each i in [0,n), calculates the center of the circle through
+ * \c a[i], \c b[i] and \c c[i] as circle3pts() does, and stores
+ * it in \c centers[i]. Z and W of the inputs are ignored.
+ *
+ * Colinear triples do not throw. Instead \c status[i] is set to 0
+ * and \c centers[i] to (0,0,0); successful results set
+ * \c status[i] to 1.
+ *
+ * @returns the number of triples that had a solution
+ */
+template <typename fptype>
+std::size_t circle3pts_batch(Vector3<fptype> const* a, Vector3<fptype> const* b,
+                             Vector3<fptype> const* c, Vector3<fptype>* centers,
+                             uint8_t* status, std::size_t n)
+{
+    std::size_t solved = 0;
+    for (std::size_t i=0; i<n; ++i)
+    {
+        fptype x, y;
+        bool const ok = detail::circumcenter(a[i].X(), a[i].Y(), b[i].X(), b[i].Y(),
+                                             c[i].X(), c[i].Y(), x, y);
+        centers[i] = Vector3<fptype>(x, y, 0.0);
+        status[i] = ok;
+        solved += ok;
+    }
+    return solved;
+}
+
+/**
+ * Calculate circles from many triples of points in Vector3Arrays.
+ *
+ * The structure-of-arrays form of circle3pts_batch(); it reads only
+ * the X and Y buffers and vectorizes. \c a, \c b and \c c must be
+ * the same size, and \c centers must be a different array from all
+ * of them. \c centers is resized to match and its Z buffer is
+ * zeroed. \c status must hold a.size() elements.
+ *
+ * @returns the number of triples that had a solution
+ */
+template <typename fptype>
+std::size_t circle3pts_batch(Vector3Array<fptype> const& a, Vector3Array<fptype> const& b,
+                             Vector3Array<fptype> const& c, Vector3Array<fptype>& centers,
+                             uint8_t* status)
+{
+    std::size_t const n = a.size();
+    if (b.size() != n || c.size() != n)
+    {
+        throw index_error("circle3pts_batch: array sizes differ");
+    }
+    centers.resize(n);
+
+    return detail::circumcenters(a.X(), a.Y(), b.X(), b.Y(), c.X(), c.Y(),
+                                 centers.X(), centers.Y(), centers.Z(), status, n);
+}
+
 } // ::vecmath
 
 #endif // CIRCLE3PTS_H
@@ -17,6 +17,7 @@ template <typename fptype>
 Matrix3<fptype> operator*(Matrix3<fptype> const& mata,
                           Matrix3<fptype> const& matb)
 {
+    VM_STATS_COUNT(mat_mults);
     Matrix3<fptype> result;
     fptype const (&a)[4][4] = mata.m_m;
     fptype const (&b)[4][4] = matb.m_m;
@@ -43,6 +44,7 @@ template <typename fptype>
 Vector3<fptype> operator*(Vector3<fptype> const& vec,
                           Matrix3<fptype> const& mat)
 {
+    VM_STATS_COUNT(vec_mults);
     Vector3<fptype> result;
     fptype (&r)[4] = result.m_v;
     fptype const (&v)[4] = vec.m_v;
@@ -65,6 +67,7 @@ template <typename fptype>
 Vector3<fptype> operator*(Matrix3<fptype> const& mat,
                           Vector3<fptype> const& vec)
 {
+    VM_STATS_COUNT(vec_mults);
     Vector3<fptype> result;
     fptype (&r)[4] = result.m_v;
     fptype const (&v)[4] = vec.m_v;
@@ -0,0 +1,294 @@
+/*
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/*
+ * Quaternions for composing and interpolating rotations
+ */
+#ifndef VM_QUATERNION_H
+#define VM_QUATERNION_H
+
+#include "vecmath.h"
+
+namespace vecmath {
+
+/**
+ * A rotation in 3D space, as a unit quaternion w + xi + yj + zk.
+ *
+ * Four values replace the 16 of a rotation Matrix3<>, and
+ * composing two rotations takes 16 multiplies instead of 64. The
+ * factories and conversions follow Matrix3<>'s conventions, so
+ * Quaternion::rotateX(t) rotates like Matrix3::rotateX(t), and
+ * q1 * q2 rotates like Matrix3(q1) * Matrix3(q2).
+ */
+template <typename _fptype>
+class Quaternion
+{
+  public:
+    typedef _fptype fptype;
+
+  private:
+    fptype m_w;
+    fptype m_x;
+    fptype m_y;
+    fptype m_z;
+
+    static constexpr _fptype EPS = 1.0e-6;
+
+  public:
+    constexpr Quaternion()                  // identity is default
+        : m_w(1), m_x(0), m_y(0), m_z(0)
+    { }
+
+    constexpr Quaternion(fptype w, fptype x, fptype y, fptype z)
+        : m_w(w), m_x(x), m_y(y), m_z(z)
+    { }
+
+    /**
+     * Take the rotation of a Matrix3<>. The upper 3x3 of \c m is
+     * assumed to be a rotation (orthonormal, determinant 1);
+     * translation is ignored.
+     */
+    explicit Quaternion(Matrix3<fptype> const& m)
+    {
+        fptype const m00 = m.get(0,0), m11 = m.get(1,1), m22 = m.get(2,2);
+        fptype const trace = m00 + m11 + m22;
+
+        // Divide by the largest component, for accuracy.
+        if (trace > 0)
+        {
+            fptype const s = 2 * std::sqrt(trace + 1);
+            m_w = s / 4;
+            m_x = (m.get(2,1) - m.get(1,2)) / s;
+            m_y = (m.get(0,2) - m.get(2,0)) / s;
+            m_z = (m.get(1,0) - m.get(0,1)) / s;
+        }
+        else if (m00 > m11 && m00 > m22)
+        {
+            fptype const s = 2 * std::sqrt(1 + m00 - m11 - m22);
+            m_w = (m.get(2,1) - m.get(1,2)) / s;
+            m_x = s / 4;
+            m_y = (m.get(0,1) + m.get(1,0)) / s;
+            m_z = (m.get(0,2) + m.get(2,0)) / s;
+        }
+        else if (m11 > m22)
+        {
+            fptype const s = 2 * std::sqrt(1 + m11 - m00 - m22);
+            m_w = (m.get(0,2) - m.get(2,0)) / s;
+            m_x = (m.get(0,1) + m.get(1,0)) / s;
+            m_y = s / 4;
+            m_z = (m.get(1,2) + m.get(2,1)) / s;
+        }
+        else
+        {
+            fptype const s = 2 * std::sqrt(1 + m22 - m00 - m11);
+            m_w = (m.get(1,0) - m.get(0,1)) / s;
+            m_x = (m.get(0,2) + m.get(2,0)) / s;
+            m_y = (m.get(1,2) + m.get(2,1)) / s;
+            m_z = s / 4;
+        }
+    }
+
+    /**
+     * Expand to a rotation Matrix3<>. The quaternion must be of
+     * unit length.
+     */
+    explicit operator Matrix3<fptype>() const
+    {
+        fptype const xx = m_x*m_x, yy = m_y*m_y, zz = m_z*m_z;
+        fptype const xy = m_x*m_y, xz = m_x*m_z, yz = m_y*m_z;
+        fptype const wx = m_w*m_x, wy = m_w*m_y, wz = m_w*m_z;
+
+        Matrix3<fptype> r;
+        fptype (&m)[4][4] = r.m_m;
+        m[0][0] = 1 - 2*(yy + zz);
+        m[0][1] = 2*(xy - wz);
+        m[0][2] = 2*(xz + wy);
+        m[1][0] = 2*(xy + wz);
+        m[1][1] = 1 - 2*(xx + zz);
+        m[1][2] = 2*(yz - wx);
+        m[2][0] = 2*(xz - wy);
+        m[2][1] = 2*(yz + wx);
+        m[2][2] = 1 - 2*(xx + yy);
+        return r;
+    }
+
+    /* Component getters */
+    constexpr fptype W() const noexcept { return m_w; }
+    constexpr fptype X() const noexcept { return m_x; }
+    constexpr fptype Y() const noexcept { return m_y; }
+    constexpr fptype Z() const noexcept { return m_z; }
+
+    constexpr fptype length_squared() const noexcept
+    {
+        return m_w*m_w + m_x*m_x + m_y*m_y + m_z*m_z;
+    }
+
+    /**
+     * The inverse of a unit quaternion: the opposite rotation.
+     */
+    constexpr Quaternion conjugate() const noexcept
+    {
+        return {m_w, -m_x, -m_y, -m_z};
+    }
+
+    /**
+     * Normalize to unit length, which keeps a quaternion a pure
+     * rotation after many compositions. A quaternion too short to
+     * normalize becomes the identity.
+     * Returns a reference to the quaternion.
+     */
+    Quaternion& normalize()
+    {
+        fptype const len = std::sqrt(length_squared());
+        if (len <= EPS)
+        {
+            *this = Quaternion();
+        }
+        else
+        {
+            m_w /= len;
+            m_x /= len;
+            m_y /= len;
+            m_z /= len;
+        }
+        return *this;
+    }
+
+    /**
+     * Rotate \c v. About 18 multiplies, against 9 for the upper
+     * 3x3 of a Matrix3<>; convert to a matrix when rotating many
+     * vectors by the same quaternion. W of the result is 1.
+     */
+    Vector3<fptype> rotate(Vector3<fptype> const& v) const
+    {
+        // v' = v + w*t + u x t, where t = 2 (u x v)
+        fptype const tx = 2 * (m_y*v.Z() - m_z*v.Y());
+        fptype const ty = 2 * (m_z*v.X() - m_x*v.Z());
+        fptype const tz = 2 * (m_x*v.Y() - m_y*v.X());
+
+        return {v.X() + m_w*tx + (m_y*tz - m_z*ty),
+                v.Y() + m_w*ty + (m_z*tx - m_x*tz),
+                v.Z() + m_w*tz + (m_x*ty - m_y*tx)};
+    }
+
+    // static factory methods:
+
+    /**
+     * Rotation by \c theta radians about \c axis, which must be
+     * of unit length.
+     */
+    static Quaternion axisAngle(Vector3<fptype> const& axis, fptype theta)
+    {
+        fptype const s = std::sin(theta / 2);
+        return {std::cos(theta / 2), axis.X()*s, axis.Y()*s, axis.Z()*s};
+    }
+
+    static Quaternion rotateX(fptype theta)
+    {
+        return {std::cos(theta / 2), std::sin(theta / 2), 0, 0};
+    }
+
+    static Quaternion rotateY(fptype theta)
+    {
+        return {std::cos(theta / 2), 0, std::sin(theta / 2), 0};
+    }
+
+    static Quaternion rotateZ(fptype theta)
+    {
+        return {std::cos(theta / 2), 0, 0, std::sin(theta / 2)};
+    }
+};
+
+template <typename _fptype>
+constexpr _fptype Quaternion<_fptype>::EPS;
+
+/**
+ * Quaternion multiplication (composition), 16 multiplies.
+ * Rotating by a * b rotates by b, then by a.
+ */
+template <typename fptype>
+constexpr Quaternion<fptype> operator*(Quaternion<fptype> const& a,
+                                       Quaternion<fptype> const& b)
+{
+    return {a.W()*b.W() - a.X()*b.X() - a.Y()*b.Y() - a.Z()*b.Z(),
+            a.W()*b.X() + a.X()*b.W() + a.Y()*b.Z() - a.Z()*b.Y(),
+            a.W()*b.Y() - a.X()*b.Z() + a.Y()*b.W() + a.Z()*b.X(),
+            a.W()*b.Z() + a.X()*b.Y() - a.Y()*b.X() + a.Z()*b.W()};
+}
+
+/**
+ * Rotate a vector, the same as \c q.rotate(v).
+ */
+template <typename fptype>
+Vector3<fptype> operator*(Quaternion<fptype> const& q, Vector3<fptype> const& v)
+{
+    return q.rotate(v);
+}
+
+/**
+ * The 4D dot product of two quaternions.
+ */
+template <typename fptype>
+constexpr fptype dot(Quaternion<fptype> const& a, Quaternion<fptype> const& b)
+{
+    return (a.W()*b.W() + a.X()*b.X() + a.Y()*b.Y() + a.Z()*b.Z());
+}
+
+/**
+ * Normalized linear interpolation from \c a (t = 0) to \c b
+ * (t = 1), along the shorter arc. Cheaper than slerp(), but the
+ * angular speed is not constant.
+ */
+template <typename fptype>
+Quaternion<fptype> nlerp(Quaternion<fptype> const& a, Quaternion<fptype> const& b, fptype t)
+{
+    // q and -q are the same rotation; flip b to take the short way.
+    fptype const sb = (dot(a, b) < 0) ? -t : t;
+    fptype const sa = 1 - t;
+    Quaternion<fptype> r(sa*a.W() + sb*b.W(), sa*a.X() + sb*b.X(),
+                         sa*a.Y() + sb*b.Y(), sa*a.Z() + sb*b.Z());
+    return r.normalize();
+}
+
+/**
+ * Spherical linear interpolation from \c a (t = 0) to \c b
+ * (t = 1), along the shorter arc at constant angular speed.
+ */
+template <typename fptype>
+Quaternion<fptype> slerp(Quaternion<fptype> const& a, Quaternion<fptype> const& b, fptype t)
+{
+    fptype d = dot(a, b);
+    fptype sign = 1;
+    if (d < 0)
+    {
+        d = -d;
+        sign = -1;
+    }
+
+    // Nearly parallel: sin(theta) is too small to divide by.
+    if (d > fptype(0.9995))
+    {
+        return nlerp(a, b, t);
+    }
+
+    fptype const theta = std::acos(d);
+    fptype const s = std::sin(theta);
+    fptype const sa = std::sin((1 - t) * theta) / s;
+    fptype const sb = sign * std::sin(t * theta) / s;
+    return {sa*a.W() + sb*b.W(), sa*a.X() + sb*b.X(),
+            sa*a.Y() + sb*b.Y(), sa*a.Z() + sb*b.Z()};
+}
+
+/*
+ * Type specializations for float and double variants
+ */
+using Quaternionf = Quaternion<float>;
+using Quaterniond = Quaternion<double>;
+
+} // ::vecmath
+
+#endif // VM_QUATERNION_H
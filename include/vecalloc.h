@@ -0,0 +1,288 @@
+/*
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/*
+ * Aligned and arena allocators for arrays of vectors and matrices
+ */
+#ifndef VM_VECALLOC_H
+#define VM_VECALLOC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <vector>
+
+namespace vecmath {
+
+/**
+ * The alignment of a cache line on current x86 and ARM cores.
+ */
+constexpr std::size_t cache_line = 64;
+
+namespace detail {
+
+/*
+ * The bytes of \c n objects of \c size bytes each. Throws
+ * std::bad_array_new_length if that overflows.
+ */
+inline std::size_t array_bytes(std::size_t n, std::size_t size)
+{
+    if (size != 0 && n > std::numeric_limits<std::size_t>::max() / size)
+    {
+        throw std::bad_array_new_length();
+    }
+    return n * size;
+}
+
+/*
+ * Allocate \c bytes aligned to \c align, a power of 2. The pointer
+ * malloc() returned is kept just below the aligned block.
+ */
+inline void* aligned_malloc(std::size_t bytes, std::size_t align)
+{
+    if (align < alignof(void*))
+    {
+        align = alignof(void*);
+    }
+    std::size_t const pad = align + sizeof(void*);
+    if (bytes > std::numeric_limits<std::size_t>::max() - pad)
+    {
+        throw std::bad_alloc();
+    }
+    void* const raw = std::malloc(bytes + pad);
+    if (raw == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    std::uintptr_t const addr = reinterpret_cast<std::uintptr_t>(raw) + sizeof(void*);
+    void** const aligned = reinterpret_cast<void**>((addr + align - 1) & ~(align - 1));
+    aligned[-1] = raw;
+    return aligned;
+}
+
+inline void aligned_free(void* p) noexcept
+{
+    if (p != nullptr)
+    {
+        std::free(static_cast<void**>(p)[-1]);
+    }
+}
+
+} // ::detail
+
+/**
+ * A standard allocator returning memory aligned to \c Align bytes,
+ * by default a cache line. With it, each element of a
+ * std::vector<Matrix3f> sits in its own cache line, and arrays of
+ * over-aligned types (see VECMATH_ALIGN) are allocated correctly
+ * before C++17:
+ *
+ *     std::vector<Matrix3f, aligned_allocator<Matrix3f> > mats;
+ *
+ * Throws std::bad_alloc if allocation fails, and
+ * std::bad_array_new_length for more than max_size() elements.
+ */
+template <typename T, std::size_t Align = cache_line>
+class aligned_allocator
+{
+    static_assert((Align & (Align - 1)) == 0, "alignment must be a power of 2");
+
+  public:
+    typedef T value_type;
+
+    template <typename U>
+    struct rebind { typedef aligned_allocator<U, Align> other; };
+
+    aligned_allocator() noexcept { }
+
+    template <typename U>
+    aligned_allocator(aligned_allocator<U, Align> const&) noexcept { }
+
+    std::size_t max_size() const noexcept
+    {
+        return std::numeric_limits<std::size_t>::max() / sizeof(T);
+    }
+
+    T* allocate(std::size_t n)
+    {
+        std::size_t const align = (alignof(T) > Align) ? alignof(T) : Align;
+        return static_cast<T*>(detail::aligned_malloc(detail::array_bytes(n, sizeof(T)), align));
+    }
+
+    void deallocate(T* p, std::size_t) noexcept
+    {
+        detail::aligned_free(p);
+    }
+};
+
+template <typename T, typename U, std::size_t Align>
+bool operator==(aligned_allocator<T, Align> const&, aligned_allocator<U, Align> const&) noexcept
+{
+    return true;
+}
+
+template <typename T, typename U, std::size_t Align>
+bool operator!=(aligned_allocator<T, Align> const&, aligned_allocator<U, Align> const&) noexcept
+{
+    return false;
+}
+
+/**
+ * A bump allocator for short-lived batches.
+ *
+ * Allocation takes memory from the end of the current block, and
+ * individual allocations are never freed; reset() releases them all
+ * at once but keeps the blocks, so a batch loop that resets each
+ * iteration stops touching the heap after the first. Objects in an
+ * arena are not destroyed, so it suits trivially destructible types
+ * such as Vector3<> and Matrix3<>.
+ *
+ * An arena is not thread safe; use one per thread.
+ */
+class arena
+{
+  private:
+    struct block
+    {
+        char* data;
+        std::size_t size;
+    };
+
+    std::vector<block> m_blocks;
+    std::size_t m_block_size;
+    std::size_t m_current;                  // index into m_blocks
+    std::size_t m_used;                     // bytes used in the current block
+
+  public:
+    /**
+     * Blocks are \c block_size bytes, or larger for allocations that
+     * don't fit one.
+     */
+    explicit arena(std::size_t block_size = 1 << 16)
+        : m_block_size(block_size), m_current(0), m_used(0)
+    { }
+
+    arena(arena const&) = delete;
+    arena& operator=(arena const&) = delete;
+
+    ~arena()
+    {
+        for (block const& b : m_blocks)
+        {
+            detail::aligned_free(b.data);
+        }
+    }
+
+    /**
+     * Allocate \c bytes aligned to \c align, a power of 2 no larger
+     * than a cache line. Throws std::bad_alloc if a new block cannot
+     * be allocated.
+     */
+    void* allocate(std::size_t bytes, std::size_t align = alignof(std::max_align_t))
+    {
+        // Move on to the first block with room, reusing blocks kept
+        // by reset() before allocating new ones.
+        while (m_current < m_blocks.size())
+        {
+            std::size_t const start = (m_used + align - 1) & ~(align - 1);
+            std::size_t const size = m_blocks[m_current].size;
+            if (start <= size && bytes <= size - start)
+            {
+                m_used = start + bytes;
+                return m_blocks[m_current].data + start;
+            }
+            ++m_current;
+            m_used = 0;
+        }
+
+        // Blocks are cache-line aligned, so any offset 0 is aligned.
+        std::size_t const size = (bytes > m_block_size) ? bytes : m_block_size;
+        m_blocks.push_back({static_cast<char*>(detail::aligned_malloc(size, cache_line)), size});
+        m_current = m_blocks.size() - 1;
+        m_used = bytes;
+        return m_blocks[m_current].data;
+    }
+
+    /**
+     * Allocate uninitialized storage for \c n objects of type \c T.
+     * Throws std::bad_array_new_length if their size overflows.
+     */
+    template <typename T>
+    T* allocate(std::size_t n)
+    {
+        return static_cast<T*>(allocate(detail::array_bytes(n, sizeof(T)), alignof(T)));
+    }
+
+    /**
+     * Release every allocation, keeping the blocks for reuse.
+     */
+    void reset() noexcept
+    {
+        m_current = 0;
+        m_used = 0;
+    }
+
+    /**
+     * The total size of the blocks held.
+     */
+    std::size_t capacity() const noexcept
+    {
+        std::size_t total = 0;
+        for (block const& b : m_blocks)
+        {
+            total += b.size;
+        }
+        return total;
+    }
+};
+
+/**
+ * A standard allocator drawing from an arena, for containers that
+ * live no longer than the arena's next reset():
+ *
+ *     arena scratch;
+ *     std::vector<Vector3f, arena_allocator<Vector3f> > tmp(n, {}, scratch);
+ *
+ * deallocate() does nothing; the memory returns at reset().
+ */
+template <typename T>
+class arena_allocator
+{
+  private:
+    arena* m_arena;
+
+    template <typename U>
+    friend class arena_allocator;
+
+  public:
+    typedef T value_type;
+
+    arena_allocator(arena& a) noexcept : m_arena(&a) { }
+
+    template <typename U>
+    arena_allocator(arena_allocator<U> const& o) noexcept : m_arena(o.m_arena) { }
+
+    T* allocate(std::size_t n)
+    {
+        return m_arena->allocate<T>(n);
+    }
+
+    void deallocate(T*, std::size_t) noexcept
+    { }
+
+    template <typename U>
+    bool operator==(arena_allocator<U> const& o) const noexcept { return m_arena == o.m_arena; }
+
+    template <typename U>
+    bool operator!=(arena_allocator<U> const& o) const noexcept { return m_arena != o.m_arena; }
+};
+
+} // ::vecmath
+
+#endif // VM_VECALLOC_H
@@ -0,0 +1,242 @@
+/*
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/*
+ * Structure-of-arrays point container and batch kernels
+ */
+#ifndef VM_VECARRAY_H
+#define VM_VECARRAY_H
+
+#include "vecmath.h"
+#include "vecalloc.h"
+
+#include <cstddef>
+#include <vector>
+
+/*
+ * VM_RESTRICT marks batch kernel arguments that never overlap,
+ * which lets the compiler vectorize without runtime alias checks.
+ */
+#if defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER)
+#  define VM_RESTRICT __restrict
+#else
+#  define VM_RESTRICT
+#endif
+
+namespace vecmath {
+
+/**
+ * An array of 3D points stored as a structure of arrays.
+ *
+ * The X, Y and Z components are kept in three separate
+ * contiguous buffers. W is not stored: every element is
+ * implicitly a point with W = 1, which saves a quarter of the
+ * memory of an equivalent array of Vector3<>.
+ *
+ * Batch kernels such as transform() walk the buffers linearly
+ * so the compiler can process several points per instruction.
+ * Each buffer starts on a cache line.
+ */
+template <typename _fptype>
+class Vector3Array
+{
+  public:
+    typedef _fptype fptype;
+
+  private:
+    typedef std::vector<fptype, aligned_allocator<fptype> > buffer;
+
+    buffer m_x;
+    buffer m_y;
+    buffer m_z;
+
+  public:
+    Vector3Array()
+    { }
+
+    explicit Vector3Array(std::size_t n)
+        : m_x(n), m_y(n), m_z(n)
+    { }
+
+    std::size_t size() const noexcept { return m_x.size(); }
+    bool empty() const noexcept { return m_x.empty(); }
+
+    void resize(std::size_t n)
+    {
+        m_x.resize(n);
+        m_y.resize(n);
+        m_z.resize(n);
+    }
+
+    void reserve(std::size_t n)
+    {
+        m_x.reserve(n);
+        m_y.reserve(n);
+        m_z.reserve(n);
+    }
+
+    void clear() noexcept
+    {
+        m_x.clear();
+        m_y.clear();
+        m_z.clear();
+    }
+
+    void push_back(Vector3<fptype> const& v)
+    {
+        m_x.push_back(v.X());
+        m_y.push_back(v.Y());
+        m_z.push_back(v.Z());
+    }
+
+    /**
+     * Get element \c i as a Vector3<>.
+     * Throws index_error if \c i is out of range.
+     */
+    Vector3<fptype> get(std::size_t i) const
+    {
+        if (i >= size())
+        {
+            throw index_error("Vector3Array::get()");
+        }
+        return {m_x[i], m_y[i], m_z[i]};
+    }
+
+    /**
+     * Set element \c i from a Vector3<>. W is discarded.
+     * Throws index_error if \c i is out of range.
+     */
+    void set(std::size_t i, Vector3<fptype> const& v)
+    {
+        if (i >= size())
+        {
+            throw index_error("Vector3Array::set()");
+        }
+        m_x[i] = v.X();
+        m_y[i] = v.Y();
+        m_z[i] = v.Z();
+    }
+
+    /* Component buffers, each holding size() values */
+    inline fptype* X() noexcept { return m_x.data(); }
+    inline fptype* Y() noexcept { return m_y.data(); }
+    inline fptype* Z() noexcept { return m_z.data(); }
+
+    inline fptype const* X() const noexcept { return m_x.data(); }
+    inline fptype const* Y() const noexcept { return m_y.data(); }
+    inline fptype const* Z() const noexcept { return m_z.data(); }
+};
+
+namespace detail {
+
+/*
+ * The transform loops, given the top three rows of the matrix.
+ * Distinct and in-place buffers get separate overloads so both can
+ * be restrict-qualified; with six unqualified pointers the compiler
+ * needs too many runtime alias checks and does not vectorize.
+ */
+template <typename fptype>
+void transform_points(fptype const (&m)[12],
+                      fptype const* VM_RESTRICT ix, fptype const* VM_RESTRICT iy,
+                      fptype const* VM_RESTRICT iz, fptype* VM_RESTRICT ox,
+                      fptype* VM_RESTRICT oy, fptype* VM_RESTRICT oz, std::size_t n)
+{
+    fptype const m00 = m[0], m01 = m[1], m02 = m[2],  m03 = m[3];
+    fptype const m10 = m[4], m11 = m[5], m12 = m[6],  m13 = m[7];
+    fptype const m20 = m[8], m21 = m[9], m22 = m[10], m23 = m[11];
+
+    for (std::size_t i=0; i<n; ++i)
+    {
+        fptype const x = ix[i];
+        fptype const y = iy[i];
+        fptype const z = iz[i];
+
+        ox[i] = x*m00 + y*m01 + z*m02 + m03;
+        oy[i] = x*m10 + y*m11 + z*m12 + m13;
+        oz[i] = x*m20 + y*m21 + z*m22 + m23;
+    }
+}
+
+template <typename fptype>
+void transform_points(fptype const (&m)[12], fptype* VM_RESTRICT px,
+                      fptype* VM_RESTRICT py, fptype* VM_RESTRICT pz, std::size_t n)
+{
+    fptype const m00 = m[0], m01 = m[1], m02 = m[2],  m03 = m[3];
+    fptype const m10 = m[4], m11 = m[5], m12 = m[6],  m13 = m[7];
+    fptype const m20 = m[8], m21 = m[9], m22 = m[10], m23 = m[11];
+
+    for (std::size_t i=0; i<n; ++i)
+    {
+        fptype const x = px[i];
+        fptype const y = py[i];
+        fptype const z = pz[i];
+
+        px[i] = x*m00 + y*m01 + z*m02 + m03;
+        py[i] = x*m10 + y*m11 + z*m12 + m13;
+        pz[i] = x*m20 + y*m21 + z*m22 + m23;
+    }
+}
+
+/*
+ * Copy the top three rows of \c m, the part of the matrix that
+ * the transform loops use, so the loops work on local values.
+ */
+template <typename fptype>
+void top_rows(Matrix3<fptype> const& m, fptype (&rows)[12])
+{
+    for (uint32_t r=0; r<3; ++r)
+    {
+        for (uint32_t c=0; c<4; ++c)
+        {
+            rows[4*r + c] = m.get(r, c);
+        }
+    }
+}
+
+} // ::detail
+
+/**
+ * Batch Matrix-column Vector multiplication, out = M * in.
+ *
+ * Every point of \c in is transformed by \c m as if it were a
+ * Vector3<> with W = 1. The projective (bottom) row of \c m is
+ * not evaluated, since the result has no W to store.
+ *
+ * \c out is resized to match \c in. \c in and \c out may be the
+ * same array.
+ */
+template <typename fptype>
+void transform(Matrix3<fptype> const& m,
+               Vector3Array<fptype> const& in,
+               Vector3Array<fptype>& out)
+{
+    VM_STATS_TIMER("transform");
+
+    // Hoist the coefficients so the loop body is pure arithmetic.
+    fptype rows[12];
+    detail::top_rows(m, rows);
+
+    if (&in == &out)
+    {
+        detail::transform_points(rows, out.X(), out.Y(), out.Z(), out.size());
+        return;
+    }
+
+    out.resize(in.size());
+    detail::transform_points(rows, in.X(), in.Y(), in.Z(),
+                             out.X(), out.Y(), out.Z(), in.size());
+}
+
+/*
+ * Type specializations for float and double variants
+ */
+using Vector3Arrayf = Vector3Array<float>;
+using Vector3Arrayd = Vector3Array<double>;
+
+} // ::vecmath
+
+#endif // VM_VECARRAY_H
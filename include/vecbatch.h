@@ -0,0 +1,427 @@
+/*
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/*
+ * Batched vector operations over arrays of vectors
+ *
+ * Each function applies the one-vector operation of the same name to
+ * every element of its arguments:
+ *
+ *     std::vector<Vector3f> normals = ..., lights = ...;
+ *     std::vector<float> ndotl(normals.size());
+ *     dot_batch(normals, lights, ndotl);
+ *
+ * Arrays of Vector3f go through the SIMD kernels selected at runtime
+ * (see vecsimd.h), which work on several vectors per instruction and
+ * finish the last few with masked or scalar code, as do the lengths
+ * and normalization of a Vector3Arrayf. The other Vector3Array<>
+ * operations are plain loops, one component at a time, that the
+ * compiler vectorizes; Vector3d arrays use the scalar kernels.
+ *
+ * The results are those of Vector3<>::fast_length<precision::exact>()
+ * and fast_normalize<precision::exact>(), dot() and cross(), with W
+ * set to 1; the AVX2 and AVX-512 kernels use FMA, so they may differ
+ * in the last bit unless VECMATH_DETERMINISTIC is defined. Input and
+ * output arrays must have the same size, or index_error is thrown; a
+ * vector output may be one of the inputs.
+ */
+#ifndef VM_VECBATCH_H
+#define VM_VECBATCH_H
+
+#include "vecmath.h"
+#include "vecarray.h"
+#include "vecsimd.h"
+#include "vecspan.h"
+
+#include <cstddef>
+#include <utility>
+
+namespace vecmath {
+
+namespace detail {
+
+inline void check_batch(std::size_t n, std::size_t m, char const* what)
+{
+    if (n != m)
+    {
+        throw index_error(what);
+    }
+}
+
+template <typename fptype>
+fptype const* flat(span<Vector3<fptype> const> v) noexcept
+{
+    return as_scalars(v.data(), v.size()).data();
+}
+
+template <typename fptype>
+fptype* flat(span<Vector3<fptype> > v) noexcept
+{
+    return as_scalars(v.data(), v.size()).data();
+}
+
+/*
+ * The kernels for arrays of Vector3<fptype>: the runtime-selected
+ * SIMD kernels for float, the scalar ones for double.
+ */
+template <typename fptype>
+struct batch_kernels;
+
+template <>
+struct batch_kernels<float>
+{
+    static simd::kernels const& k() { return simd::active(); }
+
+    static void dot(float* r, float const* a, float const* b, std::size_t n) { k().dot_n(r, a, b, n); }
+    static void cross(float* r, float const* a, float const* b, std::size_t n) { k().cross_n(r, a, b, n); }
+    static void length(float* r, float const* v, std::size_t n) { k().length_n(r, v, n); }
+    static void normalize(float* r, float const* v, std::size_t n) { k().normalize_n(r, v, n); }
+    static void add(float* r, float const* a, float const* b, std::size_t n) { k().add_n(r, a, b, n); }
+    static void sub(float* r, float const* a, float const* b, std::size_t n) { k().sub_n(r, a, b, n); }
+    static void scale(float* r, float const* v, float s, std::size_t n) { k().scale_n(r, v, s, n); }
+
+    static void length_soa(float* r, float const* x, float const* y, float const* z, std::size_t n)
+    {
+        k().length_soa_n(r, x, y, z, n);
+    }
+    static void normalize_soa(float* rx, float* ry, float* rz, float const* x, float const* y,
+                              float const* z, std::size_t n)
+    {
+        k().normalize_soa_n(rx, ry, rz, x, y, z, n);
+    }
+};
+
+template <>
+struct batch_kernels<double>
+{
+    static void dot(double* r, double const* a, double const* b, std::size_t n) { simd::scalar::dot_n(r, a, b, n); }
+    static void cross(double* r, double const* a, double const* b, std::size_t n) { simd::scalar::cross_n(r, a, b, n); }
+    static void length(double* r, double const* v, std::size_t n) { simd::scalar::length_n(r, v, n); }
+    static void normalize(double* r, double const* v, std::size_t n) { simd::scalar::normalize_n(r, v, n); }
+    static void add(double* r, double const* a, double const* b, std::size_t n) { simd::scalar::add_n(r, a, b, n); }
+    static void sub(double* r, double const* a, double const* b, std::size_t n) { simd::scalar::sub_n(r, a, b, n); }
+    static void scale(double* r, double const* v, double s, std::size_t n) { simd::scalar::scale_n(r, v, s, n); }
+
+    static void length_soa(double* r, double const* x, double const* y, double const* z, std::size_t n)
+    {
+        simd::scalar::length_soa_n(r, x, y, z, n);
+    }
+    static void normalize_soa(double* rx, double* ry, double* rz, double const* x, double const* y,
+                              double const* z, std::size_t n)
+    {
+        simd::scalar::normalize_soa_n(rx, ry, rz, x, y, z, n);
+    }
+};
+
+template <typename fptype>
+void dot_batch(span<Vector3<fptype> const> a, span<Vector3<fptype> const> b, span<fptype> out)
+{
+    check_batch(a.size(), b.size(), "dot_batch(): sizes differ");
+    check_batch(a.size(), out.size(), "dot_batch(): sizes differ");
+    batch_kernels<fptype>::dot(out.data(), flat(a), flat(b), a.size());
+}
+
+template <typename fptype>
+void cross_batch(span<Vector3<fptype> const> a, span<Vector3<fptype> const> b,
+                 span<Vector3<fptype> > out)
+{
+    check_batch(a.size(), b.size(), "cross_batch(): sizes differ");
+    check_batch(a.size(), out.size(), "cross_batch(): sizes differ");
+    batch_kernels<fptype>::cross(flat(out), flat(a), flat(b), a.size());
+}
+
+template <typename fptype>
+void length_batch(span<Vector3<fptype> const> v, span<fptype> out)
+{
+    check_batch(v.size(), out.size(), "length_batch(): sizes differ");
+    batch_kernels<fptype>::length(out.data(), flat(v), v.size());
+}
+
+template <typename fptype>
+void normalize_batch(span<Vector3<fptype> const> v, span<Vector3<fptype> > out)
+{
+    check_batch(v.size(), out.size(), "normalize_batch(): sizes differ");
+    batch_kernels<fptype>::normalize(flat(out), flat(v), v.size());
+}
+
+template <typename fptype>
+void add_batch(span<Vector3<fptype> const> a, span<Vector3<fptype> const> b,
+               span<Vector3<fptype> > out)
+{
+    check_batch(a.size(), b.size(), "add_batch(): sizes differ");
+    check_batch(a.size(), out.size(), "add_batch(): sizes differ");
+    batch_kernels<fptype>::add(flat(out), flat(a), flat(b), a.size());
+}
+
+template <typename fptype>
+void sub_batch(span<Vector3<fptype> const> a, span<Vector3<fptype> const> b,
+               span<Vector3<fptype> > out)
+{
+    check_batch(a.size(), b.size(), "sub_batch(): sizes differ");
+    check_batch(a.size(), out.size(), "sub_batch(): sizes differ");
+    batch_kernels<fptype>::sub(flat(out), flat(a), flat(b), a.size());
+}
+
+template <typename fptype>
+void scale_batch(span<Vector3<fptype> const> v, fptype s, span<Vector3<fptype> > out)
+{
+    check_batch(v.size(), out.size(), "scale_batch(): sizes differ");
+    batch_kernels<fptype>::scale(flat(out), flat(v), s, v.size());
+}
+
+/*
+ * The SoA loops. Those producing scalars write to a separate array
+ * and are restrict-qualified; the element-wise ones run once per
+ * component, which leaves the compiler few enough alias checks to
+ * vectorize even when the output is an input.
+ */
+template <typename fptype>
+void dot_points(fptype const* VM_RESTRICT ax, fptype const* VM_RESTRICT ay,
+                fptype const* VM_RESTRICT az, fptype const* VM_RESTRICT bx,
+                fptype const* VM_RESTRICT by, fptype const* VM_RESTRICT bz,
+                fptype* VM_RESTRICT r, std::size_t n)
+{
+    for (std::size_t i=0; i<n; ++i)
+    {
+        r[i] = (ax[i]*bx[i] + ay[i]*by[i] + az[i]*bz[i]);
+    }
+}
+
+template <typename fptype>
+void cross_points(fptype const* VM_RESTRICT ax, fptype const* VM_RESTRICT ay,
+                  fptype const* VM_RESTRICT az, fptype const* VM_RESTRICT bx,
+                  fptype const* VM_RESTRICT by, fptype const* VM_RESTRICT bz,
+                  fptype* VM_RESTRICT rx, fptype* VM_RESTRICT ry,
+                  fptype* VM_RESTRICT rz, std::size_t n)
+{
+    for (std::size_t i=0; i<n; ++i)
+    {
+        rx[i] = ay[i]*bz[i] - az[i]*by[i];
+        ry[i] = az[i]*bx[i] - ax[i]*bz[i];
+        rz[i] = ax[i]*by[i] - ay[i]*bx[i];
+    }
+}
+
+template <typename fptype>
+void add_component(fptype const* a, fptype const* b, fptype* r, std::size_t n)
+{
+    for (std::size_t i=0; i<n; ++i)
+    {
+        r[i] = a[i] + b[i];
+    }
+}
+
+template <typename fptype>
+void sub_component(fptype const* a, fptype const* b, fptype* r, std::size_t n)
+{
+    for (std::size_t i=0; i<n; ++i)
+    {
+        r[i] = a[i] - b[i];
+    }
+}
+
+template <typename fptype>
+void scale_component(fptype const* a, fptype s, fptype* r, std::size_t n)
+{
+    for (std::size_t i=0; i<n; ++i)
+    {
+        r[i] = a[i] * s;
+    }
+}
+
+} // ::detail
+
+/**
+ * out[i] = dot(a[i], b[i]) for arrays of Vector3f or Vector3d.
+ */
+inline void dot_batch(span<Vector3f const> a, span<Vector3f const> b, span<float> out)
+{
+    detail::dot_batch(a, b, out);
+}
+
+inline void dot_batch(span<Vector3d const> a, span<Vector3d const> b, span<double> out)
+{
+    detail::dot_batch(a, b, out);
+}
+
+/**
+ * out[i] = cross(a[i], b[i]).
+ */
+inline void cross_batch(span<Vector3f const> a, span<Vector3f const> b, span<Vector3f> out)
+{
+    detail::cross_batch(a, b, out);
+}
+
+inline void cross_batch(span<Vector3d const> a, span<Vector3d const> b, span<Vector3d> out)
+{
+    detail::cross_batch(a, b, out);
+}
+
+/**
+ * out[i] = the length of v[i].
+ */
+inline void length_batch(span<Vector3f const> v, span<float> out)
+{
+    detail::length_batch(v, out);
+}
+
+inline void length_batch(span<Vector3d const> v, span<double> out)
+{
+    detail::length_batch(v, out);
+}
+
+/**
+ * out[i] = v[i] normalized to unit length. A zero vector stays
+ * zero; nothing is thrown for it, unlike Vector3<>::normalize().
+ */
+inline void normalize_batch(span<Vector3f const> v, span<Vector3f> out)
+{
+    detail::normalize_batch(v, out);
+}
+
+inline void normalize_batch(span<Vector3d const> v, span<Vector3d> out)
+{
+    detail::normalize_batch(v, out);
+}
+
+/**
+ * out[i] = a[i] + b[i], a[i] - b[i], or v[i] * s.
+ */
+inline void add_batch(span<Vector3f const> a, span<Vector3f const> b, span<Vector3f> out)
+{
+    detail::add_batch(a, b, out);
+}
+
+inline void add_batch(span<Vector3d const> a, span<Vector3d const> b, span<Vector3d> out)
+{
+    detail::add_batch(a, b, out);
+}
+
+inline void sub_batch(span<Vector3f const> a, span<Vector3f const> b, span<Vector3f> out)
+{
+    detail::sub_batch(a, b, out);
+}
+
+inline void sub_batch(span<Vector3d const> a, span<Vector3d const> b, span<Vector3d> out)
+{
+    detail::sub_batch(a, b, out);
+}
+
+inline void scale_batch(span<Vector3f const> v, float s, span<Vector3f> out)
+{
+    detail::scale_batch(v, s, out);
+}
+
+inline void scale_batch(span<Vector3d const> v, double s, span<Vector3d> out)
+{
+    detail::scale_batch(v, s, out);
+}
+
+/*
+ * The same operations on Vector3Array<>. Array outputs are resized
+ * to match the inputs, as transform() does.
+ */
+
+/**
+ * out[i] = dot(a[i], b[i]); \c out must have a.size() elements.
+ */
+template <typename fptype>
+void dot_batch(Vector3Array<fptype> const& a, Vector3Array<fptype> const& b,
+               span<typename Vector3Array<fptype>::fptype> out)
+{
+    detail::check_batch(a.size(), b.size(), "dot_batch(): sizes differ");
+    detail::check_batch(a.size(), out.size(), "dot_batch(): sizes differ");
+    detail::dot_points(a.X(), a.Y(), a.Z(), b.X(), b.Y(), b.Z(), out.data(), a.size());
+}
+
+/**
+ * out[i] = the length of v[i]; \c out must have v.size() elements.
+ */
+template <typename fptype>
+void length_batch(Vector3Array<fptype> const& v, span<typename Vector3Array<fptype>::fptype> out)
+{
+    detail::check_batch(v.size(), out.size(), "length_batch(): sizes differ");
+    detail::batch_kernels<fptype>::length_soa(out.data(), v.X(), v.Y(), v.Z(), v.size());
+}
+
+/**
+ * out[i] = cross(a[i], b[i]).
+ */
+template <typename fptype>
+void cross_batch(Vector3Array<fptype> const& a, Vector3Array<fptype> const& b,
+                 Vector3Array<fptype>& out)
+{
+    detail::check_batch(a.size(), b.size(), "cross_batch(): sizes differ");
+    if (&out == &a || &out == &b)
+    {
+        // Each component needs all of the others, so go via a copy.
+        Vector3Array<fptype> tmp(a.size());
+        detail::cross_points(a.X(), a.Y(), a.Z(), b.X(), b.Y(), b.Z(),
+                             tmp.X(), tmp.Y(), tmp.Z(), a.size());
+        out = std::move(tmp);
+        return;
+    }
+    out.resize(a.size());
+    detail::cross_points(a.X(), a.Y(), a.Z(), b.X(), b.Y(), b.Z(),
+                         out.X(), out.Y(), out.Z(), a.size());
+}
+
+/**
+ * out[i] = in[i] normalized to unit length; zero stays zero.
+ */
+template <typename fptype>
+void normalize_batch(Vector3Array<fptype> const& in, Vector3Array<fptype>& out)
+{
+    out.resize(in.size());
+    detail::batch_kernels<fptype>::normalize_soa(out.X(), out.Y(), out.Z(),
+                                                 in.X(), in.Y(), in.Z(), in.size());
+}
+
+/**
+ * out[i] = a[i] + b[i].
+ */
+template <typename fptype>
+void add_batch(Vector3Array<fptype> const& a, Vector3Array<fptype> const& b,
+               Vector3Array<fptype>& out)
+{
+    detail::check_batch(a.size(), b.size(), "add_batch(): sizes differ");
+    out.resize(a.size());
+    detail::add_component(a.X(), b.X(), out.X(), a.size());
+    detail::add_component(a.Y(), b.Y(), out.Y(), a.size());
+    detail::add_component(a.Z(), b.Z(), out.Z(), a.size());
+}
+
+/**
+ * out[i] = a[i] - b[i].
+ */
+template <typename fptype>
+void sub_batch(Vector3Array<fptype> const& a, Vector3Array<fptype> const& b,
+               Vector3Array<fptype>& out)
+{
+    detail::check_batch(a.size(), b.size(), "sub_batch(): sizes differ");
+    out.resize(a.size());
+    detail::sub_component(a.X(), b.X(), out.X(), a.size());
+    detail::sub_component(a.Y(), b.Y(), out.Y(), a.size());
+    detail::sub_component(a.Z(), b.Z(), out.Z(), a.size());
+}
+
+/**
+ * out[i] = in[i] * s.
+ */
+template <typename fptype>
+void scale_batch(Vector3Array<fptype> const& in, typename Vector3Array<fptype>::fptype s,
+                 Vector3Array<fptype>& out)
+{
+    out.resize(in.size());
+    detail::scale_component(in.X(), s, out.X(), in.size());
+    detail::scale_component(in.Y(), s, out.Y(), in.size());
+    detail::scale_component(in.Z(), s, out.Z(), in.size());
+}
+
+} // ::vecmath
+
+#endif // VM_VECBATCH_H
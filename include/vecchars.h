@@ -0,0 +1,1137 @@
+/*
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/*
+ * Locale-free conversion of floats and doubles to and from text
+ *
+ * to_chars() formats one value into a character buffer and
+ * from_chars() parses one back, without streams, locales or
+ * allocation, in the manner of C++17's <charconv>:
+ *
+ *     char buf[64];
+ *     char* end = to_chars(buf, buf + sizeof(buf), 0.1f);
+ *     float f;
+ *     from_chars(buf, end, f);             // f == 0.1f exactly
+ *
+ * Both are exact. chars_format::fixed gives the same text as
+ * printf's "%.*f" and chars_format::general that of "%.*g", in the
+ * "C" locale; general with max_digits10 digits (the default) is the
+ * shortest fixed precision that reads back to the same value, and
+ * from_chars() rounds correctly, to nearest even, whatever the
+ * number of digits. The work is done in 128-bit integers where the
+ * compiler has them, with a small big-number fallback for extreme
+ * exponents and long inputs.
+ */
+#ifndef VM_VECCHARS_H
+#define VM_VECCHARS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace vecmath {
+
+/**
+ * Text formats: fixed is printf's "%.*f", general its "%.*g".
+ */
+enum class chars_format { fixed, general };
+
+namespace detail {
+
+// The largest precisions chars_format::fixed and ::general take.
+int const max_fixed_digits = 30;
+int const max_general_digits = 19;
+
+template <typename fptype> struct float_bits;
+
+template <> struct float_bits<float>
+{
+    typedef uint32_t bits;
+    static int const mantissa = 24;         // significant bits, with the hidden one
+    static int const bias = 127;
+    static int const max_exp = 127;
+    static int const min_exp = -126;
+    static int const max_int_digits = 39;   // digits before the point of FLT_MAX
+    static int const min_mag = -46;         // 10^min_mag rounds to 0
+    static int const exact_pow10 = 10;      // 10^k is a float, w*10^k exact for w <= 2^24
+};
+
+template <> struct float_bits<double>
+{
+    typedef uint64_t bits;
+    static int const mantissa = 53;
+    static int const bias = 1023;
+    static int const max_exp = 1023;
+    static int const min_exp = -1022;
+    static int const max_int_digits = 309;
+    static int const min_mag = -324;
+    static int const exact_pow10 = 22;
+};
+
+inline uint64_t pow5_u64(int k)
+{
+    static uint64_t const table[28] = {
+        1u, 5u, 25u, 125u, 625u, 3125u, 15625u, 78125u, 390625u, 1953125u,
+        9765625u, 48828125u, 244140625u, 1220703125u, 6103515625ull,
+        30517578125ull, 152587890625ull, 762939453125ull, 3814697265625ull,
+        19073486328125ull, 95367431640625ull, 476837158203125ull,
+        2384185791015625ull, 11920928955078125ull, 59604644775390625ull,
+        298023223876953125ull, 1490116119384765625ull, 7450580596923828125ull
+    };
+    return table[k];
+}
+
+inline uint64_t pow10_u64(int k)
+{
+    static uint64_t const table[20] = {
+        1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull,
+        10000000ull, 100000000ull, 1000000000ull, 10000000000ull,
+        100000000000ull, 1000000000000ull, 10000000000000ull,
+        100000000000000ull, 1000000000000000ull, 10000000000000000ull,
+        100000000000000000ull, 1000000000000000000ull, 10000000000000000000ull
+    };
+    return table[k];
+}
+
+template <typename fptype>
+inline fptype pow10_exact(int k)
+{
+    static fptype const table[23] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    return table[k];
+}
+
+inline int bit_length(uint64_t v)
+{
+    return v ? 64 - __builtin_clzll(v) : 0;
+}
+
+inline char const* digit_pairs()
+{
+    return "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+           "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+           "8081828384858687888990919293949596979899";
+}
+
+// Write the n low decimal digits of v, with leading zeros, ending at
+// end, and return the digits above them.
+inline uint64_t write_digits(char* end, uint64_t v, int n)
+{
+    char const* pairs = digit_pairs();
+    for (; n >= 2; n -= 2)
+    {
+        std::memcpy(end - 2, pairs + 2 * (v % 100), 2);
+        v /= 100;
+        end -= 2;
+    }
+    if (n)
+    {
+        end[-1] = char('0' + v % 10);
+        v /= 10;
+    }
+    return v;
+}
+
+inline int decimal_length(uint64_t v)
+{
+    int const t = (bit_length(v | 1) * 1233) >> 12;   // floor(bits * log10(2))
+    return t + 1 - ((v | 1) < pow10_u64(t));
+}
+
+/*
+ * An unsigned integer of up to 4096 bits, for the conversions whose
+ * exact intermediates don't fit in 128 bits. Only what they need.
+ */
+struct bignum
+{
+    static int const capacity = 128;        // 32-bit words
+
+    uint32_t w[capacity];                   // little-endian
+    int n = 0;                              // words in use; w[n-1] != 0
+
+    void set(uint64_t v)
+    {
+        w[0] = uint32_t(v);
+        w[1] = uint32_t(v >> 32);
+        n = w[1] ? 2 : (w[0] ? 1 : 0);
+    }
+
+    bool is_zero() const { return n == 0; }
+
+    int bits() const { return n ? 32 * (n - 1) + bit_length(w[n-1]) : 0; }
+
+    void mul_add_small(uint32_t m, uint32_t a)
+    {
+        uint64_t carry = a;
+        for (int i=0; i<n; ++i)
+        {
+            uint64_t const t = uint64_t(w[i]) * m + carry;
+            w[i] = uint32_t(t);
+            carry = t >> 32;
+        }
+        if (carry && n < capacity)
+        {
+            w[n++] = uint32_t(carry);
+        }
+    }
+
+    void mul_pow5(int k)
+    {
+        for (; k >= 13; k -= 13)
+        {
+            mul_add_small(1220703125u, 0);
+        }
+        if (k)
+        {
+            mul_add_small(uint32_t(pow5_u64(k)), 0);
+        }
+    }
+
+    // *this /= d, returning the remainder.
+    uint32_t div_small(uint32_t d)
+    {
+        uint64_t rem = 0;
+        for (int i=n-1; i>=0; --i)
+        {
+            uint64_t const t = (rem << 32) | w[i];
+            w[i] = uint32_t(t / d);
+            rem = t % d;
+        }
+        while (n && !w[n-1])
+        {
+            --n;
+        }
+        return uint32_t(rem);
+    }
+
+    // *this /= 5^k, rounding down; true if it was inexact.
+    bool div_pow5(int k)
+    {
+        bool inexact = false;
+        for (; k >= 13; k -= 13)
+        {
+            inexact |= div_small(1220703125u) != 0;
+        }
+        if (k)
+        {
+            inexact |= div_small(uint32_t(pow5_u64(k))) != 0;
+        }
+        return inexact;
+    }
+
+    void shl(int s)
+    {
+        if (!n || s <= 0)
+        {
+            return;
+        }
+        int const words = s / 32, b = s % 32;
+        int top = n + words + 1;
+        if (top > capacity)
+        {
+            top = capacity;
+        }
+        for (int i=top-1; i>=0; --i)
+        {
+            int const src = i - words;
+            uint64_t v = 0;
+            if (src >= 0 && src < n)
+            {
+                v = uint64_t(w[src]) << b;
+            }
+            if (b && src - 1 >= 0 && src - 1 < n)
+            {
+                v |= w[src-1] >> (32 - b);
+            }
+            w[i] = uint32_t(v);
+        }
+        n = top;
+        while (n && !w[n-1])
+        {
+            --n;
+        }
+    }
+
+    // *this >>= s, rounding down; true if any 1 bits were dropped.
+    bool shr(int s)
+    {
+        if (s <= 0)
+        {
+            return false;
+        }
+        int const words = s / 32, b = s % 32;
+        bool dropped = false;
+        for (int i=0; i<words && i<n; ++i)
+        {
+            dropped |= w[i] != 0;
+        }
+        if (words >= n)
+        {
+            n = 0;
+            return dropped;
+        }
+        if (b)
+        {
+            dropped |= (w[words] & ((1u << b) - 1)) != 0;
+        }
+        int const m = n - words;
+        for (int i=0; i<m; ++i)
+        {
+            uint64_t v = w[i+words] >> b;
+            if (b && i + words + 1 < n)
+            {
+                v |= uint64_t(w[i+words+1]) << (32 - b);
+            }
+            w[i] = uint32_t(v);
+        }
+        n = m;
+        while (n && !w[n-1])
+        {
+            --n;
+        }
+        return dropped;
+    }
+
+    void add_one()
+    {
+        for (int i=0; i<n; ++i)
+        {
+            if (++w[i])
+            {
+                return;
+            }
+        }
+        if (n < capacity)
+        {
+            w[n++] = 1;
+        }
+    }
+
+    uint64_t low64() const
+    {
+        return (n > 0 ? w[0] : 0) | (n > 1 ? uint64_t(w[1]) << 32 : 0);
+    }
+
+    // Decimal digits into buf, most significant first; returns the
+    // count. Destroys the value.
+    int to_decimal(char* buf)
+    {
+        char tmp[capacity * 10];
+        int len = 0;
+        while (n)
+        {
+            uint32_t chunk = div_small(1000000000u);
+            for (int d=0; d<9; ++d)
+            {
+                tmp[len++] = char('0' + chunk % 10);
+                chunk /= 10;
+            }
+        }
+        while (len > 1 && tmp[len-1] == '0')
+        {
+            --len;
+        }
+        if (!len)
+        {
+            tmp[len++] = '0';
+        }
+        for (int i=0; i<len; ++i)
+        {
+            buf[i] = tmp[len-1-i];
+        }
+        return len;
+    }
+};
+
+/*
+ * round(m * 2^e * 10^k) to nearest even, as a bignum: the floor of
+ * twice the value and whether anything was dropped decide the
+ * rounding.
+ */
+inline void scaled_big(uint64_t m, int e, int k, bignum& r)
+{
+    r.set(m);
+    int const s = e + k + 1;
+    if (k > 0)
+    {
+        r.mul_pow5(k);
+    }
+    r.shl(s);
+    bool inexact = false;
+    if (k < 0)
+    {
+        inexact = r.div_pow5(-k);
+    }
+    inexact |= r.shr(-s);
+    bool const half = (r.low64() & 1) != 0;
+    r.shr(1);
+    if (half && (inexact || (r.low64() & 1)))
+    {
+        r.add_one();
+    }
+}
+
+/*
+ * round(m * 2^e * 10^k) to nearest even into n, or false if it is
+ * 2^64 or more.
+ */
+inline bool scaled(uint64_t m, int e, int k, uint64_t& n)
+{
+    uint64_t p;
+    int const s = e + k + 1;
+    if (k >= 0 && k <= 27 && s <= 0 && s > -64 && !__builtin_mul_overflow(m, pow5_u64(k), &p))
+    {
+        // the usual case for floats, and doubles of moderate size
+        bool const inexact = s < 0 && (p & ((uint64_t(1) << -s) - 1)) != 0;
+        p >>= -s;
+        bool const half = (p & 1) != 0;
+        p >>= 1;
+        if (half && (inexact || (p & 1)))
+        {
+            ++p;
+        }
+        n = p;
+        return true;
+    }
+#if defined(__SIZEOF_INT128__)
+    if (k >= 0 && k <= 27)
+    {
+        typedef unsigned __int128 u128;
+        u128 p = u128(m) * pow5_u64(k);     // < 2^127
+        int const s = e + k + 1;
+        bool inexact = false;
+        if (s > 0)
+        {
+            if (s >= 128 || (p >> (128 - s)) != 0)
+            {
+                return false;
+            }
+            p <<= s;
+        }
+        else if (s < 0)
+        {
+            if (s <= -128)
+            {
+                inexact = p != 0;
+                p = 0;
+            }
+            else
+            {
+                inexact = (p & ((u128(1) << -s) - 1)) != 0;
+                p >>= -s;
+            }
+        }
+        bool const half = (p & 1) != 0;
+        p >>= 1;
+        if (half && (inexact || (p & 1)))
+        {
+            ++p;
+        }
+        if (p >> 64)
+        {
+            return false;
+        }
+        n = uint64_t(p);
+        return true;
+    }
+#endif
+    bignum r;
+    scaled_big(m, e, k, r);
+    if (r.n > 2)
+    {
+        return false;
+    }
+    n = r.low64();
+    return true;
+}
+
+// x = m * 2^e, with m an integer.
+template <typename fptype>
+inline void decompose(fptype x, uint64_t& m, int& e)
+{
+    typedef float_bits<fptype> traits;
+    typename traits::bits b;
+    std::memcpy(&b, &x, sizeof(b));
+    int const fraction = traits::mantissa - 1;
+    int const biased = int((b >> fraction) & ((1u << (8 * sizeof(b) - traits::mantissa)) - 1));
+    m = uint64_t(b) & ((uint64_t(1) << fraction) - 1);
+    if (biased)
+    {
+        m |= uint64_t(1) << fraction;
+        e = biased - traits::bias - fraction;
+    }
+    else
+    {
+        e = traits::min_exp - fraction;
+    }
+}
+
+template <typename fptype>
+inline bool sign_of(fptype x)
+{
+    typename float_bits<fptype>::bits b;
+    std::memcpy(&b, &x, sizeof(b));
+    return (b >> (8 * sizeof(b) - 1)) != 0;
+}
+
+// "nan", "inf", with a '-' if negative, for a non-finite x, or null.
+template <typename fptype>
+inline char* format_special(char* p, fptype x)
+{
+    if (x != x)
+    {
+        if (sign_of(x))
+        {
+            *p++ = '-';
+        }
+        std::memcpy(p, "nan", 3);
+        return p + 3;
+    }
+    if (x == std::numeric_limits<fptype>::infinity())
+    {
+        std::memcpy(p, "inf", 3);
+        return p + 3;
+    }
+    if (x == -std::numeric_limits<fptype>::infinity())
+    {
+        std::memcpy(p, "-inf", 4);
+        return p + 4;
+    }
+    return nullptr;
+}
+
+/*
+ * The most characters format_fixed() and format_general() write
+ * for a precision.
+ */
+template <typename fptype>
+constexpr std::size_t max_fixed_chars(int digits)
+{
+    return std::size_t(2 + float_bits<fptype>::max_int_digits + digits);
+}
+
+constexpr std::size_t max_general_chars(int digits)
+{
+    return std::size_t(8 + 5 + digits);     // sign, "0.000", point, e-308
+}
+
+// The digits of round(m * 2^e * 10^digits) as "int.frac", when it
+// doesn't fit in 64 bits.
+inline char* format_fixed_big(char* p, uint64_t m, int e, int digits)
+{
+    char text[bignum::capacity * 10];
+    bignum r;
+    scaled_big(m, e, digits, r);
+    int len = r.to_decimal(text);
+    char const* t = text;
+    if (len > digits)
+    {
+        std::memcpy(p, t, len - digits);
+        p += len - digits;
+        t += len - digits;
+        len = digits;
+    }
+    else
+    {
+        *p++ = '0';
+    }
+    if (digits)
+    {
+        *p++ = '.';
+        std::memset(p, '0', digits - len);
+        p += digits - len;
+        std::memcpy(p, t, len);
+        p += len;
+    }
+    return p;
+}
+
+// printf("%.*f", digits, x), with 0 <= digits <= max_fixed_digits.
+template <typename fptype>
+char* format_fixed(char* p, fptype x, int digits)
+{
+    if (char* end = format_special(p, x))
+    {
+        return end;
+    }
+    if (sign_of(x))
+    {
+        *p++ = '-';
+    }
+
+    uint64_t m;
+    int e;
+    decompose(x, m, e);
+    uint64_t n;
+    if (!scaled(m, e, digits, n))
+    {
+        return format_fixed_big(p, m, e, digits);
+    }
+
+    // backwards from the end of a scratch buffer: the fraction,
+    // the point, the integer part
+    char tmp[24 + max_fixed_digits];
+    char* t = tmp + sizeof(tmp);
+    uint64_t const whole = write_digits(t, n, digits);
+    t -= digits;
+    if (digits)
+    {
+        *--t = '.';
+    }
+    int const len = decimal_length(whole);
+    write_digits(t, whole, len);
+    t -= len;
+    std::size_t const size = std::size_t(tmp + sizeof(tmp) - t);
+    std::memcpy(p, t, size);
+    return p + size;
+}
+
+// printf("%.*g", digits, x), with 1 <= digits <= max_general_digits.
+template <typename fptype>
+char* format_general(char* p, fptype x, int digits)
+{
+    if (char* end = format_special(p, x))
+    {
+        return end;
+    }
+    if (sign_of(x))
+    {
+        *p++ = '-';
+    }
+    if (x == 0)
+    {
+        *p++ = '0';
+        return p;
+    }
+
+    uint64_t m;
+    int e;
+    decompose(x, m, e);
+
+    // x is in [2^b, 2^(b+1)), so its decimal exponent is
+    // floor(b log10(2)) or one more.
+    int const b = e + bit_length(m) - 1;
+    int exp10 = (b >= 0) ? (b * 78913) >> 18 : -((-b * 78913 + 262143) >> 18);
+    uint64_t n = 0;
+    if (!scaled(m, e, digits - 1 - exp10, n) || n >= pow10_u64(digits))
+    {
+        ++exp10;
+        scaled(m, e, digits - 1 - exp10, n);
+    }
+    if (n == pow10_u64(digits))            // rounded up to the next power
+    {
+        n /= 10;
+        ++exp10;
+    }
+
+    char d[20];
+    write_digits(d + digits, n, digits);
+    int len = digits;
+    if (exp10 < -4 || exp10 >= digits)
+    {
+        while (len > 1 && d[len-1] == '0')
+        {
+            --len;
+        }
+        *p++ = d[0];
+        if (len > 1)
+        {
+            *p++ = '.';
+            std::memcpy(p, d + 1, len - 1);
+            p += len - 1;
+        }
+        *p++ = 'e';
+        *p++ = exp10 < 0 ? '-' : '+';
+        int const a = exp10 < 0 ? -exp10 : exp10;
+        int const alen = a >= 100 ? 3 : 2;
+        write_digits(p + alen, uint64_t(a), alen);
+        return p + alen;
+    }
+
+    int const whole = exp10 + 1;          // digits before the point, maybe <= 0
+    while (len > whole && len > 0 && d[len-1] == '0')
+    {
+        --len;
+    }
+    if (whole > 0)
+    {
+        std::memcpy(p, d, whole);
+        p += whole;
+        if (len > whole)
+        {
+            *p++ = '.';
+            std::memcpy(p, d + whole, len - whole);
+            p += len - whole;
+        }
+        return p;
+    }
+    *p++ = '0';
+    *p++ = '.';
+    std::memset(p, '0', -whole);
+    p += -whole;
+    std::memcpy(p, d, len);
+    return p + len;
+}
+
+/*
+ * The nearest fptype, ties to even, to the value that x, normalized
+ * to a 64-bit integer with its top bit set, times 2^e is, plus a
+ * little more if inexact is set.
+ */
+template <typename fptype>
+fptype assemble(uint64_t x, int e, bool inexact, bool negative)
+{
+    typedef float_bits<fptype> traits;
+    typedef typename traits::bits bits_t;
+    int const top = e + 63;                 // the value is in [2^top, 2^(top+1))
+    bits_t bits;
+    if (top > traits::max_exp)
+    {
+        bits = bits_t((traits::max_exp + traits::bias + 1)) << (traits::mantissa - 1);
+    }
+    else
+    {
+        int keep = traits::mantissa;
+        if (top < traits::min_exp)
+        {
+            keep -= traits::min_exp - top;
+        }
+        uint64_t mant = 0;
+        if (keep >= 0)
+        {
+            int const drop = 64 - keep;
+            mant = (drop == 64) ? 0 : x >> drop;
+            bool const half = ((x >> (drop - 1)) & 1) != 0;
+            bool const rest = inexact || (drop > 1 && (x & ((uint64_t(1) << (drop - 1)) - 1)) != 0);
+            if (half && (rest || (mant & 1)))
+            {
+                ++mant;
+            }
+        }
+        if (top >= traits::min_exp)
+        {
+            // a carry out of the mantissa moves into the exponent,
+            // up to infinity
+            bits = (bits_t(top + traits::bias) << (traits::mantissa - 1)) +
+                   bits_t(mant - (uint64_t(1) << (traits::mantissa - 1)));
+        }
+        else
+        {
+            bits = bits_t(mant);
+        }
+    }
+    if (negative)
+    {
+        bits |= bits_t(1) << (8 * sizeof(bits_t) - 1);
+    }
+    fptype r;
+    std::memcpy(&r, &bits, sizeof(r));
+    return r;
+}
+
+inline bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+inline bool match_word(char const* p, char const* last, char const* word)
+{
+    for (; *word; ++word, ++p)
+    {
+        if (p == last || (*p | 0x20) != *word)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * The digits of a decimal number: its value is (the digits) *
+ * 10^exp10, plus a little more if inexact (digits dropped beyond the
+ * first 800, which can't change the rounding otherwise).
+ */
+struct decimal
+{
+    static int const max_digits = 800;
+
+    uint64_t head = 0;                      // the first 19 significant digits
+    int count = 0;                          // significant digits kept
+    int exp10 = 0;
+    bool inexact = false;
+    char const* digits = nullptr;           // where they start, for count > 19
+};
+
+// Add the digits at p to d, those after the point if fraction.
+inline char const* take_digits(char const* p, char const* last, decimal& d, bool fraction)
+{
+    // the first 19 significant digits, the common case
+    for (; p != last && d.count < 19; ++p)
+    {
+        unsigned const c = unsigned(*p) - '0';
+        if (c > 9)
+        {
+            return p;
+        }
+        d.head = d.head * 10 + c;
+        ++d.count;
+        d.exp10 -= fraction;
+    }
+    for (; p != last && is_digit(*p); ++p)
+    {
+        if (d.count < decimal::max_digits)
+        {
+            ++d.count;
+            d.exp10 -= fraction;
+        }
+        else
+        {
+            d.inexact |= *p != '0';
+            d.exp10 += !fraction;
+        }
+    }
+    return p;
+}
+
+// Parse 12.34e-5 style digits, no sign; null if there are none.
+inline char const* parse_decimal(char const* p, char const* last, decimal& d)
+{
+    char const* const begin = p;
+    while (p != last && *p == '0')
+    {
+        ++p;
+    }
+    bool any = p != begin;
+    d.digits = p;
+    char const* q = take_digits(p, last, d, false);
+    any |= q != p;
+    p = q;
+    if (p != last && *p == '.')
+    {
+        ++p;
+        if (!d.count)
+        {
+            char const* const zeros = p;
+            while (p != last && *p == '0')
+            {
+                ++p;
+            }
+            d.exp10 -= int(p - zeros);
+            any |= p != zeros;
+            d.digits = p;
+        }
+        q = take_digits(p, last, d, true);
+        any |= q != p;
+        p = q;
+    }
+    if (!any)
+    {
+        return nullptr;
+    }
+
+    if (p != last && (*p == 'e' || *p == 'E'))
+    {
+        q = p + 1;
+        bool negative = false;
+        if (q != last && (*q == '+' || *q == '-'))
+        {
+            negative = *q++ == '-';
+        }
+        if (q != last && is_digit(*q))
+        {
+            int x = 0;
+            for (; q != last && is_digit(*q); ++q)
+            {
+                if (x < 100000)
+                {
+                    x = x * 10 + (*q - '0');
+                }
+            }
+            d.exp10 += negative ? -x : x;
+            p = q;
+        }
+    }
+    return p;
+}
+
+// The kept digits of d as a bignum.
+inline void decimal_digits(decimal const& d, bignum& b)
+{
+    b.set(0);
+    int seen = 0;
+    for (char const* p=d.digits; seen < d.count; ++p)
+    {
+        if (*p == '.')
+        {
+            continue;
+        }
+        b.mul_add_small(10, uint32_t(*p - '0'));
+        ++seen;
+    }
+}
+
+// The nearest fptype to a nonzero decimal.
+template <typename fptype>
+fptype decimal_to_float(decimal const& d, bool negative)
+{
+    typedef float_bits<fptype> traits;
+
+    // the value is in [10^(mag-1), 10^mag)
+    int const mag = d.exp10 + d.count;
+    if (mag > traits::max_int_digits)
+    {
+        return negative ? -std::numeric_limits<fptype>::infinity()
+                        : std::numeric_limits<fptype>::infinity();
+    }
+    if (mag <= traits::min_mag)
+    {
+        return negative ? fptype(-0.0) : fptype(0);
+    }
+
+    if (d.count <= 19 && !d.inexact)
+    {
+        // Clinger's fast path: both operands exact, one rounding
+        if (d.head <= (uint64_t(1) << traits::mantissa) &&
+            d.exp10 >= -traits::exact_pow10 && d.exp10 <= traits::exact_pow10)
+        {
+            fptype const w = fptype(d.head);
+            fptype const r = (d.exp10 >= 0) ? w * pow10_exact<fptype>(d.exp10)
+                                            : w / pow10_exact<fptype>(-d.exp10);
+            return negative ? -r : r;
+        }
+        if (sizeof(fptype) == sizeof(float) &&
+            d.head <= (uint64_t(1) << 53) && d.exp10 >= -22 && d.exp10 <= 22)
+        {
+            // the same in double, which rounds to the nearest float
+            // unless it lands within an ulp of a float halfway point
+            double const w = double(d.head);
+            double const r = (d.exp10 >= 0) ? w * pow10_exact<double>(d.exp10)
+                                            : w / pow10_exact<double>(-d.exp10);
+            uint64_t b;
+            std::memcpy(&b, &r, sizeof(b));
+            uint64_t const below = b & ((uint64_t(1) << 29) - 1);
+            if (below - ((uint64_t(1) << 28) - 1) > 2)
+            {
+                return fptype(negative ? -r : r);
+            }
+        }
+#if defined(__SIZEOF_INT128__)
+        typedef unsigned __int128 u128;
+        if (d.exp10 >= -27 && d.exp10 <= 27)
+        {
+            int const lz = __builtin_clzll(d.head);
+            u128 v;
+            int e;
+            bool inexact = false;
+            if (d.exp10 >= 0)
+            {
+                v = u128(d.head) * pow5_u64(d.exp10);
+                e = d.exp10;
+            }
+            else
+            {
+                // a 64-bit quotient, one hardware divide: head / 5^j
+                // is q * 2^(dz - 63 - lz)
+                uint64_t const den = pow5_u64(-d.exp10);
+                int const dz = __builtin_clzll(den);
+                u128 const num = u128(d.head << lz) << 63;
+                uint64_t const q = uint64_t(num / (den << dz));
+                inexact = uint64_t(num % (den << dz)) != 0;
+                v = q;
+                e = dz - 63 - lz + d.exp10;
+            }
+            uint64_t const hi = uint64_t(v >> 64);
+            uint64_t x;
+            if (hi)
+            {
+                int const s = 64 - __builtin_clzll(hi);
+                x = uint64_t(v >> s);
+                inexact |= (uint64_t(v) & ((uint64_t(1) << s) - 1)) != 0;
+                e += s;
+            }
+            else
+            {
+                x = uint64_t(v);
+            }
+            int const shift = __builtin_clzll(x);
+            return assemble<fptype>(x << shift, e - shift, inexact, negative);
+        }
+#endif
+    }
+
+    bignum b;
+    if (d.count <= 19)
+    {
+        b.set(d.head);
+    }
+    else
+    {
+        decimal_digits(d, b);
+    }
+    bool inexact = d.inexact;
+    int e;
+    if (d.exp10 >= 0)
+    {
+        b.mul_pow5(d.exp10);
+        e = d.exp10;
+    }
+    else
+    {
+        // enough bits before dividing by 5^j that the quotient has
+        // more than 64
+        int const j = -d.exp10;
+        int const s = 66 + (j * 2378 + 1023) / 1024 - b.bits();
+        if (s > 0)
+        {
+            b.shl(s);
+        }
+        inexact |= b.div_pow5(j);
+        e = -(s > 0 ? s : 0) - j;
+    }
+    int const drop = b.bits() - 64;
+    if (drop > 0)
+    {
+        inexact |= b.shr(drop);
+        e += drop;
+    }
+    uint64_t const x = b.low64();
+    int const shift = __builtin_clzll(x);
+    return assemble<fptype>(x << shift, e - shift, inexact, negative);
+}
+
+template <typename fptype>
+char const* parse_float(char const* first, char const* last, fptype& v)
+{
+    char const* p = first;
+    bool negative = false;
+    if (p != last && (*p == '-' || *p == '+'))
+    {
+        negative = *p++ == '-';
+    }
+    if (p != last && (*p | 0x20) == 'i')
+    {
+        if (!match_word(p, last, "inf"))
+        {
+            return nullptr;
+        }
+        p += match_word(p, last, "infinity") ? 8 : 3;
+        v = negative ? -std::numeric_limits<fptype>::infinity()
+                     : std::numeric_limits<fptype>::infinity();
+        return p;
+    }
+    if (p != last && (*p | 0x20) == 'n')
+    {
+        if (!match_word(p, last, "nan"))
+        {
+            return nullptr;
+        }
+        v = negative ? -std::numeric_limits<fptype>::quiet_NaN()
+                     : std::numeric_limits<fptype>::quiet_NaN();
+        return p + 3;
+    }
+
+    decimal d;
+    p = parse_decimal(p, last, d);
+    if (!p)
+    {
+        return nullptr;
+    }
+    v = d.count ? decimal_to_float<fptype>(d, negative) : (negative ? fptype(-0.0) : fptype(0));
+    return p;
+}
+
+template <typename fptype>
+char* to_chars(char* first, char* last, fptype x, chars_format fmt, int precision)
+{
+    if (precision < 0)
+    {
+        precision = std::numeric_limits<fptype>::max_digits10;
+    }
+    char buf[max_fixed_chars<double>(max_fixed_digits)];
+    std::size_t const room = std::size_t(last - first);
+    char* p;
+    char* end;
+    if (fmt == chars_format::fixed)
+    {
+        if (precision > max_fixed_digits)
+        {
+            precision = max_fixed_digits;
+        }
+        p = (room >= max_fixed_chars<fptype>(precision)) ? first : buf;
+        end = format_fixed(p, x, precision);
+    }
+    else
+    {
+        if (precision > max_general_digits)
+        {
+            precision = max_general_digits;
+        }
+        if (precision == 0)
+        {
+            precision = 1;
+        }
+        p = (room >= max_general_chars(precision)) ? first : buf;
+        end = format_general(p, x, precision);
+    }
+    if (p == first)
+    {
+        return end;
+    }
+    if (std::size_t(end - p) > room)
+    {
+        return nullptr;
+    }
+    std::memcpy(first, p, end - p);
+    return first + (end - p);
+}
+
+} // ::detail
+
+/**
+ * Format \c x into [first, last) and return the end of the text,
+ * or null if it didn't fit. Nothing is terminated.
+ *
+ * chars_format::fixed writes \c precision digits after the point,
+ * as "%.*f" does, and chars_format::general \c precision significant
+ * digits, as "%.*g" does. A negative precision is
+ * std::numeric_limits<fptype>::max_digits10, which for general
+ * reads back exactly; precisions are limited to 30 (fixed) and 19
+ * (general). NaN and infinity are written "nan" and "inf".
+ */
+inline char* to_chars(char* first, char* last, float x,
+                      chars_format fmt = chars_format::general, int precision = -1)
+{
+    return detail::to_chars(first, last, x, fmt, precision);
+}
+
+inline char* to_chars(char* first, char* last, double x,
+                      chars_format fmt = chars_format::general, int precision = -1)
+{
+    return detail::to_chars(first, last, x, fmt, precision);
+}
+
+/**
+ * Parse a number at \c first: an optional sign and decimal digits
+ * with an optional point and exponent, as strtod() reads them, or
+ * "inf", "infinity" or "nan" in any case. Returns the end of the
+ * number, or null if there is none at \c first (\c v is unchanged).
+ * The result is correctly rounded; out-of-range numbers become
+ * infinity or zero. No whitespace is skipped.
+ */
+inline char const* from_chars(char const* first, char const* last, float& v)
+{
+    return detail::parse_float(first, last, v);
+}
+
+inline char const* from_chars(char const* first, char const* last, double& v)
+{
+    return detail::parse_float(first, last, v);
+}
+
+} // ::vecmath
+
+#endif // VM_VECCHARS_H
@@ -0,0 +1,298 @@
+/*
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/*
+ * Lazily evaluated vector arithmetic (expression templates)
+ *
+ * The operators in vecops.h build a Vector3<> temporary for every
+ * operation. Wrapping the operands in lazy() instead builds a small
+ * expression object, which is evaluated without temporaries when
+ * it is converted to a Vector3<> or passed to evaluate():
+ *
+ *     Vector3f v = lazy(a) + lazy(b) * 2.0f - lazy(c);
+ *     evaluate(lazy(xs) * s + lazy(ys), out);    // Vector3Array
+ *
+ * Expressions refer to their Vector3<> and Vector3Array<> operands,
+ * so they must be evaluated before the operands go away; don't keep
+ * them in variables beyond the statement that built them.
+ */
+#ifndef VM_VECEXPR_H
+#define VM_VECEXPR_H
+
+#include "vecmath.h"
+#include "vecarray.h"
+
+#include <cstddef>
+
+namespace vecmath {
+namespace expr {
+
+/**
+ * The size() of an expression with only Vector3<> and scalar
+ * operands, which apply to every element.
+ */
+constexpr std::size_t any_size = std::size_t(-1);
+
+/**
+ * Base of all expression types. \c D is the derived type, which
+ * provides x(i), y(i), z(i) and size().
+ *
+ * size() is the number of elements of the array operands, or
+ * any_size if the expression has none. Throws index_error if the
+ * array operands differ in size.
+ */
+template <typename D, typename _fptype>
+struct base
+{
+    typedef _fptype fptype;
+
+    D const& self() const { return static_cast<D const&>(*this); }
+
+    /**
+     * Evaluate a single-vector expression. W is 1. Throws
+     * index_error for an expression with array operands, which
+     * evaluate(e, out) takes instead.
+     */
+    operator Vector3<fptype>() const
+    {
+        if (self().size() != any_size)
+        {
+            throw index_error("expr::base: array expression used as a Vector3");
+        }
+        return {self().x(0), self().y(0), self().z(0)};
+    }
+};
+
+/**
+ * A Vector3<> operand.
+ */
+template <typename fptype>
+class vector : public base<vector<fptype>, fptype>
+{
+  private:
+    Vector3<fptype> const& m_v;
+
+  public:
+    explicit vector(Vector3<fptype> const& v) : m_v(v) { }
+
+    fptype x(std::size_t) const { return m_v.X(); }
+    fptype y(std::size_t) const { return m_v.Y(); }
+    fptype z(std::size_t) const { return m_v.Z(); }
+    std::size_t size() const { return any_size; }
+};
+
+/**
+ * A Vector3Array<> operand.
+ */
+template <typename fptype>
+class array : public base<array<fptype>, fptype>
+{
+  private:
+    fptype const* m_x;
+    fptype const* m_y;
+    fptype const* m_z;
+    std::size_t m_n;
+
+  public:
+    explicit array(Vector3Array<fptype> const& a)
+        : m_x(a.X()), m_y(a.Y()), m_z(a.Z()), m_n(a.size())
+    { }
+
+    fptype x(std::size_t i) const { return m_x[i]; }
+    fptype y(std::size_t i) const { return m_y[i]; }
+    fptype z(std::size_t i) const { return m_z[i]; }
+    std::size_t size() const { return m_n; }
+};
+
+/*
+ * Binary operations, applied per component.
+ */
+struct add { template <typename T> static T apply(T a, T b) { return a + b; } };
+struct sub { template <typename T> static T apply(T a, T b) { return a - b; } };
+struct mul { template <typename T> static T apply(T a, T b) { return a * b; } };
+struct dvd { template <typename T> static T apply(T a, T b) { return a / b; } };
+
+/**
+ * Two expressions combined by \c Op.
+ */
+template <typename Op, typename L, typename R>
+class binary : public base<binary<Op, L, R>, typename L::fptype>
+{
+  private:
+    L const m_l;
+    R const m_r;
+
+  public:
+    typedef typename L::fptype fptype;
+
+    binary(L const& l, R const& r) : m_l(l), m_r(r) { }
+
+    fptype x(std::size_t i) const { return Op::apply(m_l.x(i), m_r.x(i)); }
+    fptype y(std::size_t i) const { return Op::apply(m_l.y(i), m_r.y(i)); }
+    fptype z(std::size_t i) const { return Op::apply(m_l.z(i), m_r.z(i)); }
+
+    std::size_t size() const
+    {
+        std::size_t const l = m_l.size(), r = m_r.size();
+        if (l != r && l != any_size && r != any_size)
+        {
+            throw index_error("evaluate(): sizes differ");
+        }
+        return (l == any_size) ? r : l;
+    }
+};
+
+/**
+ * An expression combined with a scalar by \c Op. \c Left says
+ * which side the scalar is on.
+ */
+template <typename Op, typename E, bool Left>
+class scaled : public base<scaled<Op, E, Left>, typename E::fptype>
+{
+  public:
+    typedef typename E::fptype fptype;
+
+  private:
+    E const m_e;
+    fptype const m_s;
+
+    fptype apply(fptype v) const
+    {
+        return Left ? Op::apply(m_s, v) : Op::apply(v, m_s);
+    }
+
+  public:
+    scaled(E const& e, fptype s) : m_e(e), m_s(s) { }
+
+    fptype x(std::size_t i) const { return apply(m_e.x(i)); }
+    fptype y(std::size_t i) const { return apply(m_e.y(i)); }
+    fptype z(std::size_t i) const { return apply(m_e.z(i)); }
+    std::size_t size() const { return m_e.size(); }
+};
+
+template <typename L, typename R, typename FP>
+binary<add, L, R> operator+(base<L, FP> const& l, base<R, FP> const& r)
+{
+    return {l.self(), r.self()};
+}
+
+template <typename L, typename R, typename FP>
+binary<sub, L, R> operator-(base<L, FP> const& l, base<R, FP> const& r)
+{
+    return {l.self(), r.self()};
+}
+
+template <typename E, typename FP>
+scaled<mul, E, false> operator*(base<E, FP> const& e, typename E::fptype s)
+{
+    return {e.self(), s};
+}
+
+template <typename E, typename FP>
+scaled<mul, E, true> operator*(typename E::fptype s, base<E, FP> const& e)
+{
+    return {e.self(), s};
+}
+
+template <typename E, typename FP>
+scaled<dvd, E, false> operator/(base<E, FP> const& e, typename E::fptype s)
+{
+    return {e.self(), s};
+}
+
+template <typename E, typename FP>
+scaled<mul, E, false> operator-(base<E, FP> const& e)
+{
+    return {e.self(), FP(-1)};
+}
+
+/**
+ * Lazy midpoint(), (a+b)/2.
+ */
+template <typename L, typename R, typename FP>
+scaled<dvd, binary<add, L, R>, false> midpoint(base<L, FP> const& a, base<R, FP> const& b)
+{
+    return {binary<add, L, R>(a.self(), b.self()), FP(2)};
+}
+
+} // ::expr
+
+/**
+ * Start a lazy expression from a Vector3<> or Vector3Array<>.
+ * Temporaries are not accepted, since the expression refers to
+ * its operands.
+ */
+template <typename fptype>
+expr::vector<fptype> lazy(Vector3<fptype> const& v)
+{
+    return expr::vector<fptype>(v);
+}
+
+template <typename fptype>
+expr::array<fptype> lazy(Vector3Array<fptype> const& a)
+{
+    return expr::array<fptype>(a);
+}
+
+template <typename fptype>
+void lazy(Vector3<fptype> const&&) = delete;
+
+template <typename fptype>
+void lazy(Vector3Array<fptype> const&&) = delete;
+
+/**
+ * Evaluate expression \c e into a Vector3<>.
+ */
+template <typename E, typename fptype>
+Vector3<fptype> evaluate(expr::base<E, fptype> const& e)
+{
+    return e;
+}
+
+/**
+ * Evaluate array expression \c e into \c out.
+ *
+ * \c out is resized to the size of the array operands, which must
+ * all be the same size, or index_error is thrown; to 0 if there are
+ * none. \c out may also be one of the operands.
+ *
+ * Each component only depends on the same component of the
+ * operands, so the X, Y and Z buffers are written by separate
+ * loops. Each loop reads one buffer per array operand, few enough
+ * for the compiler's alias checks, and is vectorized; each buffer
+ * is still read only once.
+ */
+template <typename E, typename fptype>
+void evaluate(expr::base<E, fptype> const& e, Vector3Array<fptype>& out)
+{
+    E const& ex = e.self();
+    std::size_t const size = ex.size();
+    std::size_t const n = (size == expr::any_size) ? 0 : size;
+    out.resize(n);
+
+    fptype* const ox = out.X();
+    for (std::size_t i=0; i<n; ++i)
+    {
+        ox[i] = ex.x(i);
+    }
+
+    fptype* const oy = out.Y();
+    for (std::size_t i=0; i<n; ++i)
+    {
+        oy[i] = ex.y(i);
+    }
+
+    fptype* const oz = out.Z();
+    for (std::size_t i=0; i<n; ++i)
+    {
+        oz[i] = ex.z(i);
+    }
+}
+
+} // ::vecmath
+
+#endif // VM_VECEXPR_H
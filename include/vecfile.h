@@ -0,0 +1,772 @@
+/*
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/*
+ * A binary file format for arrays of points and matrices
+ *
+ * A file is a 64-byte header followed by the data, which starts on a
+ * 64-byte boundary:
+ *
+ *   points, AoS     count records laid out as Vector3f (4 floats,
+ *                   W included), Vector3d, or Vector3h (3 halves)
+ *   points, SoA     the X, Y and Z arrays of count scalars each,
+ *                   every array starting on a 64-byte boundary
+ *   matrices, AoS   count records laid out as Matrix3f or Matrix3d
+ *
+ * AoS data has exactly the in-memory layout of the vecmath types, so
+ * mapped_file can map a file and view the records in place, without
+ * parsing or copying. transform_file() streams a points file through
+ * a matrix in fixed-size chunks, so its memory use doesn't depend on
+ * the file size.
+ *
+ * Values are stored in the native byte order; files carry a marker
+ * and are rejected on a machine of the other byte order.
+ */
+#ifndef VM_VECFILE_H
+#define VM_VECFILE_H
+
+#include "vecmath.h"
+#include "vecarray.h"
+#include "vecpack.h"
+#include "vecspan.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#  define VM_FILE_MMAP 1
+#endif
+
+namespace vecmath {
+
+/**
+ * The file_error exception is thrown when a file cannot be
+ * opened, read or written, or is not a valid vecmath file.
+ */
+class file_error : public std::runtime_error
+{
+  public:
+    file_error(std::string const& msg)
+        : std::runtime_error(msg)
+    { }
+};
+
+constexpr uint32_t file_version = 1;
+
+enum class file_kind : uint8_t { points = 1, matrices = 2 };
+enum class file_scalar : uint8_t { f32 = 1, f64 = 2, f16 = 3 };
+enum class file_layout : uint8_t { aos = 1, soa = 2 };
+
+/**
+ * The file header, 64 bytes.
+ */
+struct file_header
+{
+    char magic[4];                          // "VMF1"
+    uint32_t version;                       // file_version
+    file_kind kind;
+    file_scalar scalar;
+    file_layout layout;
+    uint8_t reserved0;
+    uint32_t byte_order;                    // 0x01020304, as written
+    uint64_t count;                         // points or matrices
+    uint64_t data_offset;                   // from the start of the file
+    uint64_t component_stride;              // SoA: bytes from X to Y to Z
+    uint8_t reserved[24];
+};
+
+static_assert(sizeof(file_header) == 64, "file_header must be 64 bytes");
+
+namespace detail {
+
+constexpr char file_magic[4] = {'V', 'M', 'F', '1'};
+constexpr uint32_t file_byte_order = 0x01020304;
+constexpr std::size_t file_align = 64;
+
+inline std::size_t scalar_size(file_scalar s)
+{
+    return (s == file_scalar::f64) ? 8 : (s == file_scalar::f32) ? 4 : 2;
+}
+
+/*
+ * Scalars per AoS record: Vector3f/d include W, Vector3h does not.
+ */
+inline std::size_t record_scalars(file_kind k, file_scalar s)
+{
+    return (k == file_kind::matrices) ? 16 : (s == file_scalar::f16) ? 3 : 4;
+}
+
+inline std::size_t round_up(std::size_t n, std::size_t align)
+{
+    return (n + align - 1) & ~(align - 1);
+}
+
+inline file_header make_header(file_kind k, file_scalar s, file_layout l, std::size_t count)
+{
+    file_header h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, file_magic, sizeof(h.magic));
+    h.version = file_version;
+    h.kind = k;
+    h.scalar = s;
+    h.layout = l;
+    h.byte_order = file_byte_order;
+    h.count = count;
+    h.data_offset = file_align;
+    h.component_stride = (l == file_layout::soa) ? round_up(count * scalar_size(s), file_align) : 0;
+    return h;
+}
+
+/*
+ * The size of the data, and a check of everything a reader relies
+ * on. Throws file_error naming \c path.
+ */
+inline uint64_t check_header(file_header const& h, uint64_t file_size, std::string const& path)
+{
+    if (file_size < sizeof(h) || std::memcmp(h.magic, file_magic, sizeof(h.magic)) != 0)
+    {
+        throw file_error(path + ": not a vecmath file");
+    }
+    if (h.byte_order != file_byte_order)
+    {
+        throw file_error(path + ": written with the other byte order");
+    }
+    if (h.version != file_version)
+    {
+        throw file_error(path + ": unsupported version " + std::to_string(h.version));
+    }
+
+    bool const points = (h.kind == file_kind::points);
+    bool const valid =
+        (points || h.kind == file_kind::matrices) &&
+        (h.scalar == file_scalar::f32 || h.scalar == file_scalar::f64 ||
+         (points && h.scalar == file_scalar::f16)) &&
+        (h.layout == file_layout::aos || (points && h.layout == file_layout::soa)) &&
+        h.data_offset >= sizeof(h) && h.data_offset % file_align == 0 &&
+        h.component_stride % file_align == 0;
+    if (!valid)
+    {
+        throw file_error(path + ": unsupported format");
+    }
+
+    // Compared by division, so that no corrupt count can overflow.
+    if (h.data_offset > file_size)
+    {
+        throw file_error(path + ": truncated");
+    }
+    uint64_t const avail = file_size - h.data_offset;
+    uint64_t const ssize = scalar_size(h.scalar);
+    if (h.layout == file_layout::soa)
+    {
+        if (h.component_stride > avail / 3 || h.count > h.component_stride / ssize)
+        {
+            throw file_error(path + ": truncated");
+        }
+        return 3 * h.component_stride;
+    }
+    uint64_t const record_bytes = record_scalars(h.kind, h.scalar) * ssize;
+    if (h.count > avail / record_bytes)
+    {
+        throw file_error(path + ": truncated");
+    }
+    return h.count * record_bytes;
+}
+
+/*
+ * The header fields that describe record type \c T.
+ */
+template <typename T> struct file_format;
+
+template <> struct file_format<Vector3f>
+{ static constexpr file_kind kind = file_kind::points;   static constexpr file_scalar scalar = file_scalar::f32; };
+template <> struct file_format<Vector3d>
+{ static constexpr file_kind kind = file_kind::points;   static constexpr file_scalar scalar = file_scalar::f64; };
+template <> struct file_format<Vector3h>
+{ static constexpr file_kind kind = file_kind::points;   static constexpr file_scalar scalar = file_scalar::f16; };
+template <> struct file_format<Matrix3f>
+{ static constexpr file_kind kind = file_kind::matrices; static constexpr file_scalar scalar = file_scalar::f32; };
+template <> struct file_format<Matrix3d>
+{ static constexpr file_kind kind = file_kind::matrices; static constexpr file_scalar scalar = file_scalar::f64; };
+
+// The stored type of each scalar format, for SoA component views
+template <typename T> struct scalar_format;
+template <> struct scalar_format<float>    { static constexpr file_scalar value = file_scalar::f32; };
+template <> struct scalar_format<double>   { static constexpr file_scalar value = file_scalar::f64; };
+template <> struct scalar_format<uint16_t> { static constexpr file_scalar value = file_scalar::f16; };
+
+/*
+ * A stdio file with positioned reads and writes.
+ */
+class stdio_file
+{
+  private:
+    std::FILE* m_f;
+    std::string m_path;
+
+    void seek(uint64_t offset)
+    {
+#if defined(_WIN32)
+        int const rc = _fseeki64(m_f, static_cast<long long>(offset), SEEK_SET);
+#else
+        int const rc = fseeko(m_f, static_cast<off_t>(offset), SEEK_SET);
+#endif
+        if (rc != 0)
+        {
+            throw file_error(m_path + ": seek failed");
+        }
+    }
+
+  public:
+    stdio_file(std::string const& path, char const* mode)
+        : m_f(std::fopen(path.c_str(), mode)), m_path(path)
+    {
+        if (m_f == nullptr)
+        {
+            throw file_error(path + ": cannot open");
+        }
+    }
+
+    stdio_file(stdio_file const&) = delete;
+    stdio_file& operator=(stdio_file const&) = delete;
+
+    ~stdio_file()
+    {
+        std::fclose(m_f);
+    }
+
+    void read_at(uint64_t offset, void* buf, std::size_t bytes)
+    {
+        seek(offset);
+        if (bytes != 0 && std::fread(buf, 1, bytes, m_f) != bytes)
+        {
+            throw file_error(m_path + ": read failed");
+        }
+    }
+
+    void write_at(uint64_t offset, void const* buf, std::size_t bytes)
+    {
+        seek(offset);
+        if (bytes != 0 && std::fwrite(buf, 1, bytes, m_f) != bytes)
+        {
+            throw file_error(m_path + ": write failed");
+        }
+    }
+
+    /* Flush, reporting errors the destructor could not. */
+    void close()
+    {
+        if (std::fflush(m_f) != 0)
+        {
+            throw file_error(m_path + ": write failed");
+        }
+    }
+
+    uint64_t size()
+    {
+#if defined(_WIN32)
+        _fseeki64(m_f, 0, SEEK_END);
+        return static_cast<uint64_t>(_ftelli64(m_f));
+#else
+        fseeko(m_f, 0, SEEK_END);
+        return static_cast<uint64_t>(ftello(m_f));
+#endif
+    }
+};
+
+/*
+ * Convert \c n values of component \c c between file data and a
+ * Vector3Array<> buffer. AoS data interleaves the components with a
+ * stride of one record; SoA data has a stride of 1. Half precision is
+ * converted as a whole chunk beforehand, so only f32 and f64 appear
+ * here.
+ */
+template <typename fptype>
+void decode_component(file_scalar s, void const* data, std::size_t stride,
+                      std::size_t c, fptype* out, std::size_t n)
+{
+    if (s == file_scalar::f64)
+    {
+        double const* p = static_cast<double const*>(data) + c;
+        for (std::size_t i=0; i<n; ++i)
+        {
+            out[i] = fptype(p[i * stride]);
+        }
+    }
+    else
+    {
+        float const* p = static_cast<float const*>(data) + c;
+        for (std::size_t i=0; i<n; ++i)
+        {
+            out[i] = fptype(p[i * stride]);
+        }
+    }
+}
+
+template <typename fptype>
+void encode_component(file_scalar s, fptype const* in, std::size_t n,
+                      void* data, std::size_t stride, std::size_t c)
+{
+    if (s == file_scalar::f64)
+    {
+        double* p = static_cast<double*>(data) + c;
+        for (std::size_t i=0; i<n; ++i)
+        {
+            p[i * stride] = double(in[i]);
+        }
+    }
+    else
+    {
+        float* p = static_cast<float*>(data) + c;
+        for (std::size_t i=0; i<n; ++i)
+        {
+            p[i * stride] = float(in[i]);
+        }
+    }
+}
+
+/*
+ * Reads and writes chunks of points in any points format, converting
+ * through a Vector3Array<fptype>.
+ */
+class point_chunks
+{
+  private:
+    file_header m_h;
+    std::size_t m_ssize;
+    std::size_t m_rscalars;
+
+  public:
+    explicit point_chunks(file_header const& h)
+        : m_h(h), m_ssize(scalar_size(h.scalar)), m_rscalars(record_scalars(h.kind, h.scalar))
+    { }
+
+    /* Read points [first, first + n) as raw file data. */
+    void read(stdio_file& f, std::size_t first, std::size_t n, std::vector<char>& raw) const
+    {
+        if (m_h.layout == file_layout::aos)
+        {
+            raw.resize(n * m_rscalars * m_ssize);
+            f.read_at(m_h.data_offset + first * m_rscalars * m_ssize, raw.data(), raw.size());
+            return;
+        }
+        raw.resize(3 * n * m_ssize);
+        for (std::size_t c=0; c<3; ++c)
+        {
+            f.read_at(m_h.data_offset + c * m_h.component_stride + first * m_ssize,
+                      raw.data() + c * n * m_ssize, n * m_ssize);
+        }
+    }
+
+    template <typename fptype>
+    void decode(std::vector<char> const& raw, std::size_t n, Vector3Array<fptype>& out,
+                std::vector<float>& tmp) const
+    {
+        void const* data = raw.data();
+        file_scalar s = m_h.scalar;
+        if (s == file_scalar::f16)
+        {
+            tmp.resize(raw.size() / 2);
+            halves_to_floats(reinterpret_cast<uint16_t const*>(raw.data()), tmp.data(), tmp.size());
+            data = tmp.data();
+            s = file_scalar::f32;
+        }
+        std::size_t const ssize = scalar_size(s);
+
+        out.resize(n);
+        fptype* const dst[3] = {out.X(), out.Y(), out.Z()};
+        for (std::size_t c=0; c<3; ++c)
+        {
+            if (m_h.layout == file_layout::aos)
+            {
+                decode_component(s, data, m_rscalars, c, dst[c], n);
+            }
+            else
+            {
+                decode_component(s, static_cast<char const*>(data) + c * n * ssize, 1, 0, dst[c], n);
+            }
+        }
+    }
+
+    /* Encode points as raw file data, for write_raw(). */
+    template <typename fptype>
+    void encode(Vector3Array<fptype> const& in, std::vector<char>& raw,
+                std::vector<float>& tmp) const
+    {
+        std::size_t const n = in.size();
+        bool const half = (m_h.scalar == file_scalar::f16);
+        file_scalar const s = half ? file_scalar::f32 : m_h.scalar;
+        std::size_t const ssize = scalar_size(s);
+        std::size_t const scalars = (m_h.layout == file_layout::aos) ? n * m_rscalars : 3 * n;
+
+        // Half precision is encoded as floats first, then rounded.
+        raw.resize(scalars * m_ssize);
+        if (half)
+        {
+            tmp.resize(scalars);
+        }
+        void* const data = half ? static_cast<void*>(tmp.data()) : static_cast<void*>(raw.data());
+
+        fptype const* const src[3] = {in.X(), in.Y(), in.Z()};
+        for (std::size_t c=0; c<3; ++c)
+        {
+            if (m_h.layout == file_layout::aos)
+            {
+                encode_component(s, src[c], n, data, m_rscalars, c);
+            }
+            else
+            {
+                encode_component(s, src[c], n, static_cast<char*>(data) + c * n * ssize, 1, 0);
+            }
+        }
+        if (m_h.layout == file_layout::aos && m_rscalars == 4)
+        {
+            for (std::size_t i=0; i<n; ++i)             // W
+            {
+                if (s == file_scalar::f64)
+                {
+                    static_cast<double*>(data)[4*i + 3] = 1;
+                }
+                else
+                {
+                    static_cast<float*>(data)[4*i + 3] = 1;
+                }
+            }
+        }
+        if (half)
+        {
+            floats_to_halves(tmp.data(), reinterpret_cast<uint16_t*>(raw.data()), scalars);
+        }
+    }
+
+    /* Write raw file data for points [first, first + n). */
+    void write_raw(stdio_file& f, std::size_t first, std::size_t n, std::vector<char> const& raw) const
+    {
+        if (m_h.layout == file_layout::aos)
+        {
+            f.write_at(m_h.data_offset + first * m_rscalars * m_ssize, raw.data(), raw.size());
+            return;
+        }
+        for (std::size_t c=0; c<3; ++c)
+        {
+            f.write_at(m_h.data_offset + c * m_h.component_stride + first * m_ssize,
+                       raw.data() + c * n * m_ssize, n * m_ssize);
+        }
+    }
+
+    /* Write points [first, first + in.size()). */
+    template <typename fptype>
+    void write(stdio_file& f, std::size_t first, Vector3Array<fptype> const& in,
+               std::vector<char>& raw, std::vector<float>& tmp) const
+    {
+        encode(in, raw, tmp);
+        write_raw(f, first, in.size(), raw);
+    }
+};
+
+/* Write \c n zero bytes at \c offset. */
+inline void write_zeros(stdio_file& f, uint64_t offset, uint64_t n)
+{
+    static char const zeros[file_align] = {};
+    while (n != 0)
+    {
+        std::size_t const len = (n < file_align) ? std::size_t(n) : file_align;
+        f.write_at(offset, zeros, len);
+        offset += len;
+        n -= len;
+    }
+}
+
+/*
+ * Write header \c h, whose data_offset check_header() or
+ * make_header() has checked to be past the header.
+ */
+inline void write_header(stdio_file& f, file_header const& h, uint64_t data_bytes)
+{
+    f.write_at(0, &h, sizeof(h));
+    // Pad to the data offset, and out to the end for sparse layouts.
+    write_zeros(f, sizeof(h), h.data_offset - sizeof(h));
+    if (data_bytes != 0)
+    {
+        write_zeros(f, h.data_offset + data_bytes - 1, 1);
+    }
+}
+
+/*
+ * Read and check the header of a points file, for transform_file().
+ * Returns the size of the data.
+ */
+inline uint64_t read_points_header(stdio_file& in, std::string const& path, file_header& h)
+{
+    uint64_t const file_size = in.size();
+    if (file_size >= sizeof(h))
+    {
+        in.read_at(0, &h, sizeof(h));
+    }
+    uint64_t const data_bytes = check_header(h, file_size, path);
+    if (h.kind != file_kind::points)
+    {
+        throw file_error(path + ": transform_file() needs a points file");
+    }
+    return data_bytes;
+}
+
+} // ::detail
+
+/**
+ * A read-only view of a vecmath file, memory mapped where the
+ * platform allows (elsewhere it is read into memory). The views
+ * it returns are valid as long as the mapped_file is.
+ *
+ * Throws file_error if the file cannot be opened or is not a valid
+ * vecmath file.
+ */
+class mapped_file
+{
+  private:
+    std::string m_path;
+    char const* m_base;
+    std::size_t m_size;
+    file_header m_h;
+#if !defined(VM_FILE_MMAP)
+    std::vector<char, aligned_allocator<char> > m_buffer;
+#endif
+
+    template <typename T>
+    T const* at(uint64_t offset) const
+    {
+        return reinterpret_cast<T const*>(m_base + offset);
+    }
+
+  public:
+    explicit mapped_file(std::string const& path)
+        : m_path(path), m_base(nullptr), m_size(0)
+    {
+#if defined(VM_FILE_MMAP)
+        int const fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            throw file_error(path + ": cannot open");
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0)
+        {
+            ::close(fd);
+            throw file_error(path + ": cannot stat");
+        }
+        m_size = static_cast<std::size_t>(st.st_size);
+        if (m_size != 0)
+        {
+            void* const p = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED)
+            {
+                ::close(fd);
+                throw file_error(path + ": cannot map");
+            }
+            m_base = static_cast<char const*>(p);
+        }
+        ::close(fd);                        // the mapping stays valid
+#else
+        detail::stdio_file f(path, "rb");
+        m_buffer.resize(static_cast<std::size_t>(f.size()));
+        f.read_at(0, m_buffer.data(), m_buffer.size());
+        m_base = m_buffer.data();
+        m_size = m_buffer.size();
+#endif
+        try
+        {
+            if (m_size >= sizeof(m_h))
+            {
+                std::memcpy(&m_h, m_base, sizeof(m_h));
+            }
+            detail::check_header(m_h, m_size, path);
+        }
+        catch (...)
+        {
+            release();
+            throw;
+        }
+    }
+
+    mapped_file(mapped_file const&) = delete;
+    mapped_file& operator=(mapped_file const&) = delete;
+
+    ~mapped_file()
+    {
+        release();
+    }
+
+    file_header const& header() const noexcept { return m_h; }
+    std::size_t size() const noexcept { return static_cast<std::size_t>(m_h.count); }
+
+    /**
+     * View an AoS file's records as an array of \c T: Vector3f,
+     * Vector3d, Vector3h, Matrix3f or Matrix3d. Throws file_error
+     * if the file holds another type or layout.
+     */
+    template <typename T>
+    span<T const> records() const
+    {
+        typedef detail::file_format<T> format;
+        if (m_h.layout != file_layout::aos || m_h.kind != format::kind ||
+            m_h.scalar != format::scalar)
+        {
+            throw file_error(m_path + ": records are not of the requested type");
+        }
+        return {at<T>(m_h.data_offset), size()};
+    }
+
+    /**
+     * View component \c c (0-2 for X, Y, Z) of an SoA points file
+     * as an array of \c T: float, double, or uint16_t for the bit
+     * patterns of halves. Throws file_error if the file holds
+     * another scalar type or layout.
+     */
+    template <typename T>
+    span<T const> component(std::size_t c) const
+    {
+        if (m_h.layout != file_layout::soa || m_h.scalar != detail::scalar_format<T>::value || c > 2)
+        {
+            throw file_error(m_path + ": no such component of the requested type");
+        }
+        return {at<T>(m_h.data_offset + c * m_h.component_stride), size()};
+    }
+
+  private:
+    void release() noexcept
+    {
+#if defined(VM_FILE_MMAP)
+        if (m_base != nullptr)
+        {
+            ::munmap(const_cast<char*>(m_base), m_size);
+        }
+#endif
+        m_base = nullptr;
+    }
+};
+
+/**
+ * Write \c n records of \c T (Vector3f, Vector3d, Vector3h, Matrix3f
+ * or Matrix3d) as an AoS file. Throws file_error on failure.
+ */
+template <typename T>
+void write_file(std::string const& path, T const* records, std::size_t n)
+{
+    typedef detail::file_format<T> format;
+    file_header const h = detail::make_header(format::kind, format::scalar, file_layout::aos, n);
+
+    detail::stdio_file f(path, "wb");
+    detail::write_header(f, h, 0);
+    f.write_at(h.data_offset, records, n * sizeof(T));
+    f.close();
+}
+
+template <typename T>
+void write_file(std::string const& path, std::vector<T> const& records)
+{
+    write_file(path, records.data(), records.size());
+}
+
+/**
+ * Write points as an SoA file, storing \c scalar values: by default
+ * those of the array, or f16 to halve a float file. Throws
+ * file_error on failure.
+ */
+template <typename fptype>
+void write_file(std::string const& path, Vector3Array<fptype> const& points,
+                file_scalar scalar = detail::scalar_format<fptype>::value)
+{
+    file_header const h = detail::make_header(file_kind::points, scalar, file_layout::soa,
+                                              points.size());
+    detail::stdio_file f(path, "wb");
+    detail::write_header(f, h, 3 * h.component_stride);
+    std::vector<char> raw;
+    std::vector<float> tmp;
+    detail::point_chunks(h).write(f, 0, points, raw, tmp);
+    f.close();
+}
+
+/**
+ * Transform every point of the file \c in_path by \c m, writing a
+ * file of the same format to \c out_path. The file is processed
+ * \c chunk points at a time, with the next chunk read on another
+ * thread while the current one is transformed and written, so the
+ * memory used is a few chunks whatever the file size. Half
+ * precision points are computed in float and rounded back.
+ *
+ * The two paths must name different files. Throws file_error on
+ * failure, or if \c in_path does not hold points.
+ */
+template <typename fptype>
+void transform_file(std::string const& in_path, std::string const& out_path,
+                    Matrix3<fptype> const& m, std::size_t chunk = 1 << 16)
+{
+    VM_STATS_TIMER("transform_file");
+    detail::stdio_file in(in_path, "rb");
+    file_header h;
+    uint64_t const data_bytes = detail::read_points_header(in, in_path, h);
+
+    detail::stdio_file out(out_path, "wb");
+    detail::write_header(out, h, data_bytes);
+
+    detail::point_chunks const io(h);
+    std::size_t const n = static_cast<std::size_t>(h.count);
+    if (chunk == 0)
+    {
+        chunk = 1;
+    }
+
+    std::vector<char> raw[2];
+    std::vector<char> outraw;
+    std::vector<float> tmp;
+    Vector3Array<fptype> points;
+
+    if (n != 0)
+    {
+        io.read(in, 0, (chunk < n) ? chunk : n, raw[0]);
+    }
+
+    for (std::size_t first=0, k=0; first<n; first+=chunk, k^=1)
+    {
+        std::size_t const count = (n - first < chunk) ? (n - first) : chunk;
+
+        // Read ahead while this chunk is processed.
+        std::size_t const next = first + count;
+        std::future<void> ahead;
+        if (next < n)
+        {
+            std::size_t const ncount = (n - next < chunk) ? (n - next) : chunk;
+            std::vector<char>& buf = raw[k ^ 1];
+            ahead = std::async(std::launch::async, [&, next, ncount] {
+                io.read(in, next, ncount, buf);
+            });
+        }
+
+        io.decode(raw[k], count, points, tmp);
+        transform(m, points, points);
+        io.write(out, first, points, outraw, tmp);
+
+        if (ahead.valid())
+        {
+            ahead.get();                    // rethrows read errors
+        }
+    }
+    out.close();
+}
+
+} // ::vecmath
+
+#endif // VM_VECFILE_H
@@ -19,7 +19,7 @@ namespace vecmath {
  * @return Vector3<> result of (a+b)/2
  */
 template <typename fptype>
-Vector3<fptype> midpoint(Vector3<fptype> const &a, Vector3<fptype> const &b)
+constexpr Vector3<fptype> midpoint(Vector3<fptype> const &a, Vector3<fptype> const &b)
 {
     return {(a.X()+b.X())/2, (a.Y()+b.Y())/2, (a.Z()+b.Z())/2};
 }
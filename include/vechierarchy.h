@@ -0,0 +1,369 @@
+/*
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/*
+ * World transforms of a transform hierarchy
+ *
+ * A scene graph, skeleton or other hierarchy of transforms is held
+ * as flat arrays: each node has a parent index (negative for a
+ * root) and a local transform relative to its parent. With the
+ * nodes sorted so that every parent comes before its children, as
+ * a depth-first or breadth-first walk leaves them, the world
+ * transforms are one pass in order:
+ *
+ *     std::vector<int32_t> parents = ...;
+ *     std::vector<Matrix3f> locals = ..., world(locals.size());
+ *     compose_hierarchy(parents, locals, world);
+ *
+ * which gives world[i] = world[parents[i]] * locals[i], or
+ * locals[i] for a root, the same product as operator* without the
+ * recursion. Matrix3f hierarchies go through the SIMD kernels
+ * selected at runtime (see vecsimd.h); the AVX2 and AVX-512 kernels
+ * use FMA, so they may differ from operator* in the last bit unless
+ * VECMATH_DETERMINISTIC is defined.
+ * parallel::compose_hierarchy() in vecparallel.h splits the
+ * independent subtrees of large hierarchies across threads.
+ *
+ * When only a few nodes move between frames, a TransformCache
+ * holds the hierarchy and recomputes just the world transforms,
+ * and inverses, that the moved nodes affect.
+ */
+#ifndef VM_VECHIERARCHY_H
+#define VM_VECHIERARCHY_H
+
+#include "vecmath.h"
+#include "vecsimd.h"
+#include "vecspan.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace vecmath {
+
+namespace detail {
+
+/*
+ * Throws index_error unless the arrays have the same size and
+ * every parent comes before its child.
+ */
+inline void check_hierarchy(span<int32_t const> parents, std::size_t locals, std::size_t out)
+{
+    std::size_t const n = parents.size();
+    if (n != locals || n != out)
+    {
+        throw index_error("compose_hierarchy(): sizes differ");
+    }
+    if (n > static_cast<std::size_t>(std::numeric_limits<int32_t>::max()))
+    {
+        throw index_error("compose_hierarchy(): too many nodes");
+    }
+    for (std::size_t i=0; i<n; ++i)
+    {
+        if (parents[i] >= static_cast<int32_t>(i))
+        {
+            throw index_error("compose_hierarchy(): parent does not precede child");
+        }
+    }
+}
+
+/*
+ * Compose the \c n nodes listed in \c node (all of them, in order,
+ * if it is null): the runtime-selected kernel for float, the scalar
+ * one for double.
+ */
+inline void compose_nodes(int32_t const* parents, Matrix3f const* locals, Matrix3f* out,
+                          int32_t const* node, std::size_t n)
+{
+    simd::active().compose_n(as_scalars(out, n).data(), as_scalars(locals, n).data(),
+                             parents, node, n);
+}
+
+inline void compose_nodes(int32_t const* parents, Matrix3d const* locals, Matrix3d* out,
+                          int32_t const* node, std::size_t n)
+{
+    simd::scalar::compose_n(as_scalars(out, n).data(), as_scalars(locals, n).data(),
+                            parents, node, n);
+}
+
+} // ::detail
+
+/**
+ * World transforms of a hierarchy: out[i] = out[parents[i]] *
+ * locals[i], or locals[i] where parents[i] is negative (a root).
+ *
+ * Every parent must come before its children, parents[i] < i, and
+ * the arrays must have the same size, or index_error is thrown
+ * before anything is written. \c out may be \c locals.
+ */
+inline void compose_hierarchy(span<int32_t const> parents, span<Matrix3f const> locals,
+                              span<Matrix3f> out)
+{
+    VM_STATS_TIMER("compose_hierarchy");
+    detail::check_hierarchy(parents, locals.size(), out.size());
+    detail::compose_nodes(parents.data(), locals.data(), out.data(), nullptr, out.size());
+}
+
+inline void compose_hierarchy(span<int32_t const> parents, span<Matrix3d const> locals,
+                              span<Matrix3d> out)
+{
+    VM_STATS_TIMER("compose_hierarchy");
+    detail::check_hierarchy(parents, locals.size(), out.size());
+    detail::compose_nodes(parents.data(), locals.data(), out.data(), nullptr, out.size());
+}
+
+/**
+ * A transform hierarchy that caches world transforms and their
+ * inverses, and recomputes them only when a local transform they
+ * depend on has changed.
+ *
+ * Nodes are added parents first, and setLocal() just marks the
+ * node dirty. Each cached world transform carries the generation
+ * at which it was computed; it is stale if its node is dirty or
+ * its parent's world is newer, so a change reaches every
+ * descendant without visiting them. world() and inverse() bring
+ * the node and its ancestors up to date on query; update() does
+ * the whole hierarchy in one pass. The products are those of
+ * compose_hierarchy().
+ *
+ * Queries update the cache, so a TransformCache must not be
+ * queried from several threads at once.
+ */
+template <typename _fptype>
+class TransformCache
+{
+  public:
+    typedef _fptype fptype;
+    typedef Matrix3<fptype> matrix;
+
+    /**
+     * Recomputations done and skipped since the last
+     * resetCounters(). A query counts each node on the path from
+     * the root as computed or skipped; update() counts every node.
+     */
+    struct counters
+    {
+        uint64_t worlds_computed = 0;
+        uint64_t worlds_skipped = 0;
+        uint64_t inverses_computed = 0;
+        uint64_t inverses_skipped = 0;
+    };
+
+  private:
+    std::vector<int32_t> m_parent;
+    std::vector<matrix> m_local;
+    std::vector<matrix> m_world;
+    std::vector<matrix> m_inverse;
+    std::vector<uint8_t> m_dirty;           // local changed since world was computed
+    std::vector<uint64_t> m_stamp;          // generation of world, 0 if never computed
+    std::vector<uint64_t> m_inverse_stamp;  // generation of the world that was inverted
+    std::vector<int32_t> m_path;            // scratch for world()
+    std::vector<int32_t> m_stale;           // nodes to recompute, in order
+    uint64_t m_generation = 0;
+    counters m_counters;
+
+    void check(std::size_t i, char const* what) const
+    {
+        if (i >= size())
+        {
+            throw index_error(what);
+        }
+    }
+
+    /*
+     * If node i's world is stale, give it a new generation and list
+     * it for recomputing; its parent must be current or listed.
+     */
+    void mark(std::size_t i)
+    {
+        int32_t const p = m_parent[i];
+        if (!m_dirty[i] && (p < 0 || m_stamp[p] < m_stamp[i]))
+        {
+            ++m_counters.worlds_skipped;
+            return;
+        }
+        m_stamp[i] = ++m_generation;
+        m_dirty[i] = 0;
+        m_stale.push_back(static_cast<int32_t>(i));
+    }
+
+    // Recompute the listed nodes, in order, in one kernel call.
+    void recompute()
+    {
+        detail::compose_nodes(m_parent.data(), m_local.data(), m_world.data(),
+                              m_stale.data(), m_stale.size());
+        m_counters.worlds_computed += m_stale.size();
+        m_stale.clear();
+    }
+
+  public:
+    TransformCache()
+    { }
+
+    std::size_t size() const noexcept { return m_parent.size(); }
+
+    void reserve(std::size_t n)
+    {
+        m_parent.reserve(n);
+        m_local.reserve(n);
+        m_world.reserve(n);
+        m_inverse.reserve(n);
+        m_dirty.reserve(n);
+        m_stamp.reserve(n);
+        m_inverse_stamp.reserve(n);
+    }
+
+    /**
+     * Add a node with a local transform relative to \c parent, an
+     * existing node or -1 for a root, and return its index.
+     * Throws index_error if \c parent is not a node.
+     */
+    std::size_t add(int32_t parent, matrix const& local = matrix())
+    {
+        if (parent >= static_cast<int32_t>(size()) ||
+            size() >= static_cast<std::size_t>(std::numeric_limits<int32_t>::max()))
+        {
+            throw index_error("TransformCache::add()");
+        }
+        m_parent.push_back(parent < 0 ? -1 : parent);
+        m_local.push_back(local);
+        m_world.push_back(local);
+        m_inverse.push_back(matrix());
+        m_dirty.push_back(1);
+        m_stamp.push_back(0);
+        m_inverse_stamp.push_back(0);
+        return size() - 1;
+    }
+
+    /*
+     * Node \c i's parent (negative for a root) and local transform.
+     * Throw index_error if \c i is out of range.
+     */
+    int32_t parent(std::size_t i) const
+    {
+        check(i, "TransformCache::parent()");
+        return m_parent[i];
+    }
+
+    matrix const& local(std::size_t i) const
+    {
+        check(i, "TransformCache::local()");
+        return m_local[i];
+    }
+
+    /**
+     * Replace node \c i's local transform. Its world transform,
+     * and those of its descendants, are recomputed when next
+     * queried. Throws index_error if \c i is out of range.
+     */
+    void setLocal(std::size_t i, matrix const& local)
+    {
+        check(i, "TransformCache::setLocal()");
+        m_local[i] = local;
+        m_dirty[i] = 1;
+    }
+
+    /**
+     * Node \c i's world transform, recomputing it and any stale
+     * ancestors. The reference is valid until the next change to
+     * the cache. Throws index_error if \c i is out of range.
+     */
+    matrix const& world(std::size_t i)
+    {
+        check(i, "TransformCache::world()");
+        m_path.clear();
+        for (int32_t n=static_cast<int32_t>(i); n>=0; n=m_parent[n])
+        {
+            m_path.push_back(n);
+        }
+        for (std::size_t k=m_path.size(); k>0; --k)
+        {
+            mark(m_path[k-1]);
+        }
+        recompute();
+        return m_world[i];
+    }
+
+    /**
+     * The inverse of node \c i's world transform, by
+     * Matrix3::inverse(), recomputed only when the world transform
+     * has changed. Throws index_error if \c i is out of range, or
+     * degenerate_error if the world transform is singular.
+     */
+    matrix const& inverse(std::size_t i)
+    {
+        world(i);
+        if (m_inverse_stamp[i] == m_stamp[i])
+        {
+            ++m_counters.inverses_skipped;
+            return m_inverse[i];
+        }
+
+        if (!m_world[i].inverse(m_inverse[i]))
+        {
+            throw degenerate_error("TransformCache::inverse(): matrix is singular");
+        }
+        m_inverse_stamp[i] = m_stamp[i];
+        ++m_counters.inverses_computed;
+        return m_inverse[i];
+    }
+
+    /**
+     * Bring every world transform up to date, in one pass in node
+     * order. Inverses are still computed on query.
+     */
+    void update()
+    {
+        // mark() with the state in locals, which the compiler could
+        // not keep in registers across the counter stores.
+        int32_t const* parent = m_parent.data();
+        uint8_t* dirty = m_dirty.data();
+        uint64_t* stamp = m_stamp.data();
+        uint64_t generation = m_generation;
+        std::size_t const n = size();
+        for (std::size_t i=0; i<n; ++i)
+        {
+            int32_t const p = parent[i];
+            if (dirty[i] || (p >= 0 && stamp[p] > stamp[i]))
+            {
+                stamp[i] = ++generation;
+                dirty[i] = 0;
+                m_stale.push_back(static_cast<int32_t>(i));
+            }
+        }
+        m_generation = generation;
+        m_counters.worlds_skipped += n - m_stale.size();
+        recompute();
+    }
+
+    /**
+     * The generation at which node \c i's world transform was last
+     * computed, without updating it: it changes whenever world(i)
+     * does, so callers can cache data derived from it. 0 if it has
+     * never been computed. Throws index_error if \c i is out of
+     * range.
+     */
+    uint64_t generation(std::size_t i) const
+    {
+        check(i, "TransformCache::generation()");
+        return m_stamp[i];
+    }
+
+    counters const& stats() const noexcept { return m_counters; }
+    void resetCounters() noexcept { m_counters = counters(); }
+};
+
+/*
+ * Type specializations for float and double variants
+ */
+using TransformCachef = TransformCache<float>;
+using TransformCached = TransformCache<double>;
+
+} // ::vecmath
+
+#endif // VM_VECHIERARCHY_H
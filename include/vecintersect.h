@@ -0,0 +1,373 @@
+/*
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/*
+ * Ray intersection with triangles and planes
+ *
+ * A Ray<> is an origin and a direction, a Plane<> the points p with
+ * dot(normal, p) == offset. Besides one ray against one triangle or
+ * plane, the batch forms test one ray against a TriangleArray<>, or
+ * a RayArray<> against one plane, and report every result:
+ *
+ *     TriangleArray<float> mesh = ...;
+ *     std::vector<float> t(mesh.size());
+ *     std::vector<uint8_t> hit(mesh.size());
+ *     std::size_t const hits = intersect(ray, mesh, t, hit);
+ *
+ * Both arrays store separate component arrays, so float batches go
+ * through the SIMD kernels selected at runtime (see vecsimd.h),
+ * several triangles or rays per instruction and without branches;
+ * double batches use the scalar kernels.
+ *
+ * t is the distance along the direction, in units of its length,
+ * and hits are at t >= 0; a miss has hit 0 and t infinity. A ray
+ * parallel to its target misses: like fpequal(), \c eps is the
+ * tolerance below which the determinant counts as zero. Triangles
+ * are hit from either side, edges included. The AVX2 and AVX-512
+ * kernels use FMA, so hits within rounding of an edge may differ
+ * from the one-ray forms unless VECMATH_DETERMINISTIC is defined.
+ */
+#ifndef VM_VECINTERSECT_H
+#define VM_VECINTERSECT_H
+
+#include "vecmath.h"
+#include "vecarray.h"
+#include "vecsimd.h"
+#include "vecspan.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace vecmath {
+
+template <typename fptype>
+struct Ray
+{
+    Vector3<fptype> origin;
+    Vector3<fptype> direction;
+
+    Ray()
+    { }
+
+    Ray(Vector3<fptype> const& o, Vector3<fptype> const& d)
+        : origin(o), direction(d)
+    { }
+
+    /* The point at distance t along the direction */
+    Vector3<fptype> at(fptype t) const
+    {
+        return Vector3<fptype>(origin.X() + direction.X() * t, origin.Y() + direction.Y() * t,
+                               origin.Z() + direction.Z() * t);
+    }
+};
+
+/**
+ * The plane dot(normal, p) == offset. The normal need not be unit
+ * length, but then offset is scaled by its length too.
+ */
+template <typename fptype>
+struct Plane
+{
+    Vector3<fptype> normal;
+    fptype offset;
+
+    Plane()
+        : offset(0)
+    { }
+
+    Plane(Vector3<fptype> const& n, fptype d)
+        : normal(n), offset(d)
+    { }
+
+    /* The plane through \c point with normal \c n */
+    static Plane through(Vector3<fptype> const& point, Vector3<fptype> const& n)
+    {
+        return Plane(n, dot(n, point));
+    }
+};
+
+/**
+ * Triangles stored as structure of arrays: the first vertex and the
+ * two edges from it, which is what the intersection test reads.
+ */
+template <typename _fptype>
+class TriangleArray
+{
+  public:
+    typedef _fptype fptype;
+
+    Vector3Array<fptype> v0;
+    Vector3Array<fptype> e1;        // v1 - v0
+    Vector3Array<fptype> e2;        // v2 - v0
+
+    std::size_t size() const noexcept { return v0.size(); }
+    bool empty() const noexcept { return v0.empty(); }
+
+    void reserve(std::size_t n)
+    {
+        v0.reserve(n);
+        e1.reserve(n);
+        e2.reserve(n);
+    }
+
+    void clear() noexcept
+    {
+        v0.clear();
+        e1.clear();
+        e2.clear();
+    }
+
+    void push_back(Vector3<fptype> const& a, Vector3<fptype> const& b, Vector3<fptype> const& c)
+    {
+        v0.push_back(a);
+        e1.push_back(b - a);
+        e2.push_back(c - a);
+    }
+};
+
+/**
+ * Rays stored as structure of arrays, origins and directions.
+ */
+template <typename _fptype>
+class RayArray
+{
+  public:
+    typedef _fptype fptype;
+
+    Vector3Array<fptype> origins;
+    Vector3Array<fptype> directions;
+
+    std::size_t size() const noexcept { return origins.size(); }
+    bool empty() const noexcept { return origins.empty(); }
+
+    void reserve(std::size_t n)
+    {
+        origins.reserve(n);
+        directions.reserve(n);
+    }
+
+    void clear() noexcept
+    {
+        origins.clear();
+        directions.clear();
+    }
+
+    void push_back(Ray<fptype> const& r)
+    {
+        origins.push_back(r.origin);
+        directions.push_back(r.direction);
+    }
+};
+
+using Rayf = Ray<float>;
+using Rayd = Ray<double>;
+using Planef = Plane<float>;
+using Planed = Plane<double>;
+using TriangleArrayf = TriangleArray<float>;
+using TriangleArrayd = TriangleArray<double>;
+using RayArrayf = RayArray<float>;
+using RayArrayd = RayArray<double>;
+
+namespace detail {
+
+/*
+ * The kernels for each precision: the runtime-selected SIMD kernels
+ * for float, the scalar ones for double.
+ */
+template <typename fptype>
+struct intersect_kernels;
+
+template <>
+struct intersect_kernels<float>
+{
+    static void triangles(float* t, uint8_t* hit, float const* ray, float const* const* tri,
+                          float eps, std::size_t n)
+    {
+        simd::active().ray_triangles_n(t, hit, ray, tri, eps, n);
+    }
+    static void plane(float* t, uint8_t* hit, float const* const* rays, float const* plane,
+                      float eps, std::size_t n)
+    {
+        simd::active().rays_plane_n(t, hit, rays, plane, eps, n);
+    }
+};
+
+template <>
+struct intersect_kernels<double>
+{
+    static void triangles(double* t, uint8_t* hit, double const* ray, double const* const* tri,
+                          double eps, std::size_t n)
+    {
+        simd::scalar::ray_triangles_n(t, hit, ray, tri, eps, n);
+    }
+    static void plane(double* t, uint8_t* hit, double const* const* rays, double const* plane,
+                      double eps, std::size_t n)
+    {
+        simd::scalar::rays_plane_n(t, hit, rays, plane, eps, n);
+    }
+};
+
+template <typename fptype>
+void ray_values(Ray<fptype> const& r, fptype* v)
+{
+    v[0] = r.origin.X();
+    v[1] = r.origin.Y();
+    v[2] = r.origin.Z();
+    v[3] = r.direction.X();
+    v[4] = r.direction.Y();
+    v[5] = r.direction.Z();
+}
+
+template <typename fptype>
+void plane_values(Plane<fptype> const& p, fptype* v)
+{
+    v[0] = p.normal.X();
+    v[1] = p.normal.Y();
+    v[2] = p.normal.Z();
+    v[3] = p.offset;
+}
+
+inline std::size_t count_hits(uint8_t const* hit, std::size_t n)
+{
+    std::size_t count = 0;
+    for (std::size_t i=0; i<n; ++i)
+    {
+        count += hit[i];
+    }
+    return count;
+}
+
+// The one-ray forms run the scalar kernels on arrays of one.
+template <typename fptype>
+bool intersect(Ray<fptype> const& r, Vector3<fptype> const& a, Vector3<fptype> const& b,
+               Vector3<fptype> const& c, fptype& t, fptype eps)
+{
+    Vector3<fptype> const e1 = b - a, e2 = c - a;
+    fptype const v[9] = {a.X(), a.Y(), a.Z(), e1.X(), e1.Y(), e1.Z(), e2.X(), e2.Y(), e2.Z()};
+    fptype const* const tri[9] = {v, v+1, v+2, v+3, v+4, v+5, v+6, v+7, v+8};
+    fptype ray[6];
+    ray_values(r, ray);
+    uint8_t hit;
+    simd::scalar::ray_triangles_n(&t, &hit, ray, tri, eps, 1);
+    return hit != 0;
+}
+
+template <typename fptype>
+bool intersect(Ray<fptype> const& r, Plane<fptype> const& p, fptype& t, fptype eps)
+{
+    fptype v[6], plane[4];
+    ray_values(r, v);
+    plane_values(p, plane);
+    fptype const* const rays[6] = {v, v+1, v+2, v+3, v+4, v+5};
+    uint8_t hit;
+    simd::scalar::rays_plane_n(&t, &hit, rays, plane, eps, 1);
+    return hit != 0;
+}
+
+template <typename fptype>
+std::size_t intersect(Ray<fptype> const& r, TriangleArray<fptype> const& tris,
+                      span<fptype> t, span<uint8_t> hit, fptype eps)
+{
+    std::size_t const n = tris.size();
+    if (t.size() != n || hit.size() != n)
+    {
+        throw index_error("intersect(): sizes differ");
+    }
+    fptype ray[6];
+    ray_values(r, ray);
+    fptype const* const tri[9] = {tris.v0.X(), tris.v0.Y(), tris.v0.Z(),
+                                  tris.e1.X(), tris.e1.Y(), tris.e1.Z(),
+                                  tris.e2.X(), tris.e2.Y(), tris.e2.Z()};
+    intersect_kernels<fptype>::triangles(t.data(), hit.data(), ray, tri, eps, n);
+    return count_hits(hit.data(), n);
+}
+
+template <typename fptype>
+std::size_t intersect(RayArray<fptype> const& r, Plane<fptype> const& p,
+                      span<fptype> t, span<uint8_t> hit, fptype eps)
+{
+    std::size_t const n = r.size();
+    if (t.size() != n || hit.size() != n)
+    {
+        throw index_error("intersect(): sizes differ");
+    }
+    fptype plane[4];
+    plane_values(p, plane);
+    fptype const* const rays[6] = {r.origins.X(), r.origins.Y(), r.origins.Z(),
+                                   r.directions.X(), r.directions.Y(), r.directions.Z()};
+    intersect_kernels<fptype>::plane(t.data(), hit.data(), rays, plane, eps, n);
+    return count_hits(hit.data(), n);
+}
+
+} // ::detail
+
+/**
+ * Intersect a ray with triangle (a, b, c). On a hit, returns true
+ * and sets \c t; otherwise returns false and sets \c t to infinity.
+ */
+inline bool intersect(Rayf const& r, Vector3f const& a, Vector3f const& b, Vector3f const& c,
+                      float& t, float eps = 1.0e-6f)
+{
+    return detail::intersect(r, a, b, c, t, eps);
+}
+
+inline bool intersect(Rayd const& r, Vector3d const& a, Vector3d const& b, Vector3d const& c,
+                      double& t, double eps = 1.0e-6)
+{
+    return detail::intersect(r, a, b, c, t, eps);
+}
+
+/**
+ * Intersect a ray with a plane, as for a triangle.
+ */
+inline bool intersect(Rayf const& r, Planef const& p, float& t, float eps = 1.0e-6f)
+{
+    return detail::intersect(r, p, t, eps);
+}
+
+inline bool intersect(Rayd const& r, Planed const& p, double& t, double eps = 1.0e-6)
+{
+    return detail::intersect(r, p, t, eps);
+}
+
+/**
+ * Intersect one ray with every triangle: t[i] and hit[i] are the
+ * results for tris[i]. Returns the number of hits. \c t and \c hit
+ * must have tris.size() elements, or index_error is thrown.
+ */
+inline std::size_t intersect(Rayf const& r, TriangleArrayf const& tris, span<float> t,
+                             span<uint8_t> hit, float eps = 1.0e-6f)
+{
+    return detail::intersect(r, tris, t, hit, eps);
+}
+
+inline std::size_t intersect(Rayd const& r, TriangleArrayd const& tris, span<double> t,
+                             span<uint8_t> hit, double eps = 1.0e-6)
+{
+    return detail::intersect(r, tris, t, hit, eps);
+}
+
+/**
+ * Intersect every ray with one plane: t[i] and hit[i] are the
+ * results for ray i. Returns the number of hits. \c t and \c hit
+ * must have rays.size() elements, or index_error is thrown.
+ */
+inline std::size_t intersect(RayArrayf const& rays, Planef const& p, span<float> t,
+                             span<uint8_t> hit, float eps = 1.0e-6f)
+{
+    return detail::intersect(rays, p, t, hit, eps);
+}
+
+inline std::size_t intersect(RayArrayd const& rays, Planed const& p, span<double> t,
+                             span<uint8_t> hit, double eps = 1.0e-6)
+{
+    return detail::intersect(rays, p, t, hit, eps);
+}
+
+} // ::vecmath
+
+#endif // VM_VECINTERSECT_H
@@ -12,7 +12,61 @@
 #include <iomanip>
 #include <stdexcept>
 #include <cmath>
+#include <algorithm>                        // std::min(), std::max()
 #include <cstring>                          // std::memcpy()
+#include <cstdint>
+#include <limits>
+
+#include "vecstats.h"
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>                      // _mm_rsqrt_ss()
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>                       // vrsqrtes_f32()
+#endif
+
+/*
+ * VECMATH_CONSTEXPR14 marks functions that can only be constexpr
+ * with C++14's relaxed rules (local variables, assignments and
+ * throws); under C++11 they are ordinary functions.
+ */
+#if defined(__cpp_constexpr) && __cpp_constexpr >= 201304
+#  define VECMATH_CONSTEXPR14 constexpr
+#else
+#  define VECMATH_CONSTEXPR14
+#endif
+
+/*
+ * VECMATH_ALIGN is the alignment in bytes requested for the element
+ * storage of Vector3<>, Matrix3<> and AffineMatrix3<>; a power of 2,
+ * or 0 for natural alignment. Each type is aligned to at most the
+ * largest power of 2 dividing its size, so sizes never change: with
+ * 64, a Matrix3f fills exactly one cache line but a Vector3f is
+ * still aligned to 16. Alignments above 16 make the types
+ * over-aligned; before C++17 heap arrays of them need
+ * vecmath::aligned_allocator (vecalloc.h).
+ */
+#ifndef VECMATH_ALIGN
+#  define VECMATH_ALIGN 16
+#endif
+
+/*
+ * VECMATH_DETERMINISTIC, defined in every translation unit before
+ * including vecmath.h, makes results bit-identical between builds,
+ * machines and instruction sets. Sums are taken in source order, and
+ * the SIMD kernels multiply and add separately, without FMA, so
+ * every kernel rounds as the scalar ones do. Vector3<>::length() and
+ * normalize() always take the correctly rounded square root and
+ * divide. The estimate behind precision::approx and
+ * precision::refined is computed in integer arithmetic, since
+ * RSQRTSS differs between x86 vendors. The compiler must not
+ * contract products into FMA either: build with -ffp-contract=off,
+ * which is GCC's default for -std=c++NN but not for -std=gnu++NN.
+ * -ffast-math is an error.
+ */
+#if defined(VECMATH_DETERMINISTIC) && defined(__FAST_MATH__)
+#  error "VECMATH_DETERMINISTIC cannot be used with -ffast-math"
+#endif
 
 namespace vecmath {
 
@@ -25,7 +79,9 @@ class degenerate_error : public std::domain_error
   public:
     degenerate_error(char const* msg)
         : std::domain_error(msg)
-    { }
+    {
+        VM_STATS_COUNT(degenerate_errors);
+    }
 };
 
 /**
@@ -51,6 +107,128 @@ inline bool fpequal(fptype const a, fptype const b, fptype EPS = 1.0e-6)
     return (std::abs(a - b) < EPS);
 }
 
+namespace detail {
+
+#if defined(VECMATH_DETERMINISTIC)
+constexpr bool deterministic = true;
+#else
+constexpr bool deterministic = false;
+#endif
+
+/*
+ * The hardware reciprocal square root estimate: about 12 bits on
+ * SSE, 8 bits on NEON. Elsewhere, and with VECMATH_DETERMINISTIC, a
+ * bit-level initial guess is used, which is good to about 4 bits.
+ * \c x must be positive.
+ */
+inline float rsqrt_estimate(float x)
+{
+#if !defined(VECMATH_DETERMINISTIC) && (defined(__SSE__) || defined(_M_X64))
+    return _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x)));
+#elif !defined(VECMATH_DETERMINISTIC) && defined(__aarch64__) && defined(__ARM_NEON)
+    return vrsqrtes_f32(x);
+#else
+    uint32_t i;
+    std::memcpy(&i, &x, sizeof(i));
+    i = 0x5f3759df - (i >> 1);
+    float y;
+    std::memcpy(&y, &i, sizeof(y));
+    return y;
+#endif
+}
+
+/*
+ * Doubles use the float estimate, so the approximate policies are
+ * only accurate for doubles within the float range. The clamp keeps
+ * the estimate finite for zero and out-of-range inputs.
+ */
+inline double rsqrt_estimate(double x)
+{
+    double const lo = std::numeric_limits<float>::min();
+    double const hi = std::numeric_limits<float>::max();
+    return rsqrt_estimate(float(std::min(std::max(x, lo), hi)));
+}
+
+/*
+ * The alignment for \c size bytes of storage with natural alignment
+ * \c natural, as described for VECMATH_ALIGN.
+ */
+constexpr std::size_t storage_align(std::size_t size, std::size_t natural)
+{
+    // size & -size is the largest power of 2 dividing size
+    return (VECMATH_ALIGN <= natural) ? natural
+         : ((size & (0 - size)) >= VECMATH_ALIGN) ? VECMATH_ALIGN
+         : ((size & (0 - size)) > natural) ? (size & (0 - size))
+         : natural;
+}
+
+// One Newton-Raphson step for y ~= 1/sqrt(x); roughly doubles the bits.
+template <typename fptype>
+inline fptype rsqrt_newton(fptype x, fptype y)
+{
+    return y * (fptype(1.5) - fptype(0.5) * x * y * y);
+}
+
+} // ::detail
+
+/**
+ * Precision policies for Vector3<>::fast_length() and
+ * Vector3<>::fast_normalize().
+ *
+ * Each policy provides sqrt() and rsqrt() (1/sqrt). None of them
+ * branch, so loops that use them stay straight-line code.
+ */
+namespace precision {
+
+/**
+ * Correctly rounded std::sqrt(), and a division for rsqrt().
+ */
+struct exact
+{
+    template <typename fptype>
+    static fptype sqrt(fptype x) { return std::sqrt(x); }
+
+    template <typename fptype>
+    static fptype rsqrt(fptype x) { return 1 / std::sqrt(x); }
+};
+
+/**
+ * The hardware estimate alone: fastest, about 3-4 significant
+ * digits on x86.
+ */
+struct approx
+{
+    template <typename fptype>
+    static fptype rsqrt(fptype x) { return fptype(detail::rsqrt_estimate(x)); }
+
+    template <typename fptype>
+    static fptype sqrt(fptype x)
+    {
+        return x * rsqrt(x + std::numeric_limits<fptype>::min());
+    }
+};
+
+/**
+ * The hardware estimate plus one Newton-Raphson step: close to
+ * full float precision on x86.
+ */
+struct refined
+{
+    template <typename fptype>
+    static fptype rsqrt(fptype x)
+    {
+        return detail::rsqrt_newton(x, fptype(detail::rsqrt_estimate(x)));
+    }
+
+    template <typename fptype>
+    static fptype sqrt(fptype x)
+    {
+        return x * rsqrt(x + std::numeric_limits<fptype>::min());
+    }
+};
+
+} // ::precision
+
 /*
  * Forward declarations of Vector3 and Matrix3, and the operator
  * overloads that work with multiple argument types at
@@ -59,6 +237,8 @@ inline bool fpequal(fptype const a, fptype const b, fptype EPS = 1.0e-6)
  */
 template <typename fptype> class Vector3;
 template <typename fptype> class Matrix3;
+template <typename fptype> class AffineMatrix3;
+template <typename fptype> class Quaternion;
 
 template <typename fptype>
 Vector3<fptype> operator*(Vector3<fptype> const& v,  // V' = V * M
@@ -68,6 +248,14 @@ template <typename fptype>
 Vector3<fptype> operator*(Matrix3<fptype> const& m,  // V' = M * V
                           Vector3<fptype> const& v);
 
+template <typename fptype>
+Vector3<fptype> operator*(Vector3<fptype> const& v,  // V' = V * A
+                          AffineMatrix3<fptype> const& m);
+
+template <typename fptype>
+Vector3<fptype> operator*(AffineMatrix3<fptype> const& m,  // V' = A * V
+                          Vector3<fptype> const& v);
+
 /**
  * A direction in 3D space.
  */
@@ -75,32 +263,24 @@ template <typename _fptype>
 class Vector3
 {
   private:
-    _fptype m_v[4];
+    alignas(detail::storage_align(4 * sizeof(_fptype), alignof(_fptype))) _fptype m_v[4];
 
     static constexpr _fptype EPS = 1.0e-6;
 
   public:
     typedef _fptype fptype;
 
-    Vector3()
+    constexpr Vector3()
         : m_v {0, 0, 0, 1}
     { }
 
-    Vector3(_fptype x, _fptype y, _fptype z = 0)
+    constexpr Vector3(_fptype x, _fptype y, _fptype z = 0)
         : m_v {x, y, z, 1}
     { }
 
-    Vector3(Vector3 const &o)
-    {
-        std::memcpy(m_v, o.m_v, sizeof(m_v));
-    }
-
-    Vector3& operator=(Vector3 const &o)
-    {
-        if (this != &o)
-            std::memcpy(m_v, o.m_v, sizeof(m_v));
-        return *this;
-    }
+    // Defaulted copies keep Vector3 trivially copyable.
+    Vector3(Vector3 const &o) = default;
+    Vector3& operator=(Vector3 const &o) = default;
 
     /**
      * Calculate length of vector.
@@ -108,14 +288,19 @@ class Vector3
      */
     _fptype length() const
     {
+        VM_STATS_COUNT(lengths);
         _fptype result = (X() * X() +
                           Y() * Y() +
                           Z() * Z());
 
-        if ( !fpequal(result, _fptype(1.0)) )
+        if ( detail::deterministic || !fpequal(result, _fptype(1.0)) )
         {
             result = std::sqrt(result);
         }
+        else
+        {
+            VM_STATS_COUNT(sqrt_skips);
+        }
 
         if (result <= EPS)            // snap to zero if close
         {
@@ -131,6 +316,7 @@ class Vector3
      */
     Vector3& normalize()
     {
+        VM_STATS_COUNT(normalizes);
         _fptype len = length();
 
         if (len == 0)              // length() snaps to zero
@@ -138,7 +324,7 @@ class Vector3
             m_v[0] = m_v[1] = m_v[2] = 0;
             m_v[3] = 1.0;
         }
-        else if ( !fpequal(len, _fptype(1.0)) )
+        else if ( detail::deterministic || !fpequal(len, _fptype(1.0)) )
         {
             m_v[0] /= len;
             m_v[1] /= len;
@@ -149,11 +335,73 @@ class Vector3
         return *this;
     }
 
+    /**
+     * Calculate the squared length of the vector.
+     * This needs no square root and is enough for comparing lengths.
+     */
+    constexpr _fptype length_squared() const noexcept
+    {
+        return (X() * X() +
+                Y() * Y() +
+                Z() * Z());
+    }
+
+    /**
+     * Calculate length of vector without branching.
+     *
+     * Unlike length(), this has no shortcut for unit vectors and
+     * does not snap short lengths to zero. The \c Policy is one of
+     * precision::exact, precision::approx or precision::refined.
+     */
+    template <typename Policy = precision::refined>
+    _fptype fast_length() const noexcept
+    {
+        VM_STATS_COUNT(lengths);
+        return Policy::sqrt(length_squared());
+    }
+
+    /**
+     * Normalize a vector to unit length without branching.
+     *
+     * One reciprocal square root and three multiplies replace the
+     * square root and three divides of normalize(). A zero vector
+     * stays zero; unlike normalize(), very short vectors are scaled
+     * up rather than snapped to zero. W is set to 1.
+     *
+     * Returns a reference to the vector.
+     */
+    template <typename Policy = precision::refined>
+    Vector3& fast_normalize() noexcept
+    {
+        VM_STATS_COUNT(normalizes);
+        // Adding the smallest normal keeps 0 * rsqrt() finite.
+        _fptype const inv = Policy::rsqrt(length_squared() +
+                                          std::numeric_limits<_fptype>::min());
+        m_v[0] *= inv;
+        m_v[1] *= inv;
+        m_v[2] *= inv;
+        m_v[3]  = 1.0;
+        return *this;
+    }
+
     /* Component getters */
-    inline fptype X() const noexcept { return m_v[0]; }
-    inline fptype Y() const noexcept { return m_v[1]; }
-    inline fptype Z() const noexcept { return m_v[2]; }
-    inline fptype W() const noexcept { return m_v[3]; }
+    constexpr fptype X() const noexcept { return m_v[0]; }
+    constexpr fptype Y() const noexcept { return m_v[1]; }
+    constexpr fptype Z() const noexcept { return m_v[2]; }
+    constexpr fptype W() const noexcept { return m_v[3]; }
+
+    /**
+     * Component \c i, 0-3 for X, Y, Z, W, without bounds checks.
+     */
+    constexpr fptype operator[](uint32_t i) const noexcept { return m_v[i]; }
+    VECMATH_CONSTEXPR14 fptype& operator[](uint32_t i) noexcept { return m_v[i]; }
+
+    /**
+     * The four components X, Y, Z, W, contiguous and in that order.
+     * An array of Vector3<> is an array of 4*n fptypes.
+     */
+    fptype* data() noexcept { return m_v; }
+    fptype const* data() const noexcept { return m_v; }
 
     template <typename FP>
     friend Vector3<FP> operator*(Vector3<FP> const& v,
@@ -161,8 +409,18 @@ class Vector3
     template <typename FP>
     friend Vector3<FP> operator*(Matrix3<FP> const& m,
                                  Vector3<FP> const& v);
+    template <typename FP>
+    friend Vector3<FP> operator*(Vector3<FP> const& v,
+                                 AffineMatrix3<FP> const& m);
+    template <typename FP>
+    friend Vector3<FP> operator*(AffineMatrix3<FP> const& m,
+                                 Vector3<FP> const& v);
 };
 
+// C++11 needs a definition where the constants are odr-used
+template <typename _fptype>
+constexpr _fptype Vector3<_fptype>::EPS;
+
 /**
  * A 3D transformation matrix
  */
@@ -173,45 +431,230 @@ class Matrix3
     typedef _fptype fptype;
 
   protected:
-    fptype m_m[4][4];
+    alignas(detail::storage_align(16 * sizeof(_fptype), alignof(_fptype))) fptype m_m[4][4];
 
   public:
     constexpr static fptype zero = 0.0;
     constexpr static fptype one  = 1.0;
 
-    Matrix3()
+    constexpr Matrix3()
         : m_m {{one,  zero, zero, zero},    // identity is default
                {zero, one,  zero, zero},
                {zero, zero, one,  zero},
                {zero, zero, zero, one}}
     { }
 
-    Matrix3(Matrix3 const &o)
+    // Defaulted copies keep Matrix3 trivially copyable.
+    Matrix3(Matrix3 const &o) = default;
+    Matrix3& operator=(Matrix3 const &o) = default;
+
+    VECMATH_CONSTEXPR14 fptype get(uint32_t r, uint32_t c) const
+    {
+        if (r > 3 || c > 3)
+        {
+            throw index_error("Matrix3::get()");
+        }
+        return m_m[r][c];
+    }
+
+    /**
+     * Element (r, c) without bounds checks, for inner loops and
+     * for setting elements.
+     */
+    constexpr fptype operator()(uint32_t r, uint32_t c) const noexcept
     {
-        std::memcpy(m_m, o.m_m, sizeof(m_m));
+        return m_m[r][c];
     }
 
-    Matrix3& operator=(Matrix3 const &o)
+    VECMATH_CONSTEXPR14 fptype& operator()(uint32_t r, uint32_t c) noexcept
     {
-        if (this != &o)
+        return m_m[r][c];
+    }
+
+    /**
+     * The 16 elements, contiguous in row-major order: element
+     * (r, c) is data()[4*r + c]. The storage is aligned to
+     * detail::storage_align(16 * sizeof(fptype), alignof(fptype)),
+     * 16 bytes by default (see VECMATH_ALIGN). OpenGL expects
+     * column-major matrices, so pass GL_TRUE for
+     * glUniformMatrix4fv()'s transpose argument.
+     */
+    fptype* data() noexcept { return &m_m[0][0]; }
+    fptype const* data() const noexcept { return &m_m[0][0]; }
+
+    /*
+     * Inverses. Each throwing form has a non-throwing overload for
+     * hot paths, which stores the result in \c out and returns
+     * true, or returns false for a singular matrix and leaves \c out
+     * unchanged. A matrix is singular when its determinant is 0.
+     */
+
+    /**
+     * The inverse of a general 4x4 matrix, by cofactors. Throws
+     * degenerate_error if the matrix is singular.
+     */
+    Matrix3 inverse() const
+    {
+        Matrix3 r;
+        if (!inverse(r))
         {
-            std::memcpy(m_m, o.m_m, sizeof(m_m));
+            throw degenerate_error("Matrix3::inverse(): matrix is singular");
         }
-        return *this;
+        return r;
     }
 
-    fptype get(uint32_t r, uint32_t c) const
+    bool inverse(Matrix3& out) const noexcept
     {
-        if (r > 3 || c > 3)
+        fptype const (&a)[4][4] = m_m;
+
+        // 2x2 determinants of the top two and the bottom two rows
+        fptype const s0 = a[0][0]*a[1][1] - a[1][0]*a[0][1];
+        fptype const s1 = a[0][0]*a[1][2] - a[1][0]*a[0][2];
+        fptype const s2 = a[0][0]*a[1][3] - a[1][0]*a[0][3];
+        fptype const s3 = a[0][1]*a[1][2] - a[1][1]*a[0][2];
+        fptype const s4 = a[0][1]*a[1][3] - a[1][1]*a[0][3];
+        fptype const s5 = a[0][2]*a[1][3] - a[1][2]*a[0][3];
+
+        fptype const c0 = a[2][0]*a[3][1] - a[3][0]*a[2][1];
+        fptype const c1 = a[2][0]*a[3][2] - a[3][0]*a[2][2];
+        fptype const c2 = a[2][0]*a[3][3] - a[3][0]*a[2][3];
+        fptype const c3 = a[2][1]*a[3][2] - a[3][1]*a[2][2];
+        fptype const c4 = a[2][1]*a[3][3] - a[3][1]*a[2][3];
+        fptype const c5 = a[2][2]*a[3][3] - a[3][2]*a[2][3];
+
+        fptype const det = s0*c5 - s1*c4 + s2*c3 + s3*c2 - s4*c1 + s5*c0;
+        if (det == 0)
         {
-            throw index_error("Matrix3::get()");
+            return false;
         }
-        return m_m[r][c];
+        fptype const inv = 1 / det;
+
+        fptype (&b)[4][4] = out.m_m;
+        b[0][0] = ( a[1][1]*c5 - a[1][2]*c4 + a[1][3]*c3) * inv;
+        b[0][1] = (-a[0][1]*c5 + a[0][2]*c4 - a[0][3]*c3) * inv;
+        b[0][2] = ( a[3][1]*s5 - a[3][2]*s4 + a[3][3]*s3) * inv;
+        b[0][3] = (-a[2][1]*s5 + a[2][2]*s4 - a[2][3]*s3) * inv;
+
+        b[1][0] = (-a[1][0]*c5 + a[1][2]*c2 - a[1][3]*c1) * inv;
+        b[1][1] = ( a[0][0]*c5 - a[0][2]*c2 + a[0][3]*c1) * inv;
+        b[1][2] = (-a[3][0]*s5 + a[3][2]*s2 - a[3][3]*s1) * inv;
+        b[1][3] = ( a[2][0]*s5 - a[2][2]*s2 + a[2][3]*s1) * inv;
+
+        b[2][0] = ( a[1][0]*c4 - a[1][1]*c2 + a[1][3]*c0) * inv;
+        b[2][1] = (-a[0][0]*c4 + a[0][1]*c2 - a[0][3]*c0) * inv;
+        b[2][2] = ( a[3][0]*s4 - a[3][1]*s2 + a[3][3]*s0) * inv;
+        b[2][3] = (-a[2][0]*s4 + a[2][1]*s2 - a[2][3]*s0) * inv;
+
+        b[3][0] = (-a[1][0]*c3 + a[1][1]*c1 - a[1][2]*c0) * inv;
+        b[3][1] = ( a[0][0]*c3 - a[0][1]*c1 + a[0][2]*c0) * inv;
+        b[3][2] = (-a[3][0]*s3 + a[3][1]*s1 - a[3][2]*s0) * inv;
+        b[3][3] = ( a[2][0]*s3 - a[2][1]*s1 + a[2][2]*s0) * inv;
+        return true;
+    }
+
+    /**
+     * The inverse of an affine matrix, as built by the factories
+     * and their products: the bottom row is assumed to be
+     * [0 0 0 1] and is not checked. Inverts the upper 3x3 and
+     * transforms the translation by it, in about a third of the
+     * work of inverse(). Throws degenerate_error if the matrix is
+     * singular.
+     */
+    Matrix3 inverseAffine() const
+    {
+        Matrix3 r;
+        if (!inverseAffine(r))
+        {
+            throw degenerate_error("Matrix3::inverseAffine(): matrix is singular");
+        }
+        return r;
+    }
+
+    bool inverseAffine(Matrix3& out) const noexcept
+    {
+        fptype adj[3][3];
+        fptype const det = adjugate3(adj);
+        if (det == 0)
+        {
+            return false;
+        }
+        fptype const inv = 1 / det;
+
+        fptype (&b)[4][4] = out.m_m;
+        for (int i=0; i<3; i++)
+        {
+            b[i][0] = adj[i][0] * inv;
+            b[i][1] = adj[i][1] * inv;
+            b[i][2] = adj[i][2] * inv;
+            b[i][3] = -(b[i][0]*m_m[0][3] + b[i][1]*m_m[1][3] + b[i][2]*m_m[2][3]);
+        }
+        b[3][0] = b[3][1] = b[3][2] = zero;
+        b[3][3] = one;
+        return true;
+    }
+
+    /**
+     * The inverse of a rigid transform: a rotation followed by a
+     * translation, as from rotateX() * translation(). The upper 3x3
+     * is assumed to be orthonormal and the bottom row [0 0 0 1];
+     * neither is checked. Transposes the rotation and rotates the
+     * negated translation back, so it cannot fail.
+     */
+    Matrix3 inverseRigid() const noexcept
+    {
+        Matrix3 r;
+        fptype (&b)[4][4] = r.m_m;
+        fptype const (&a)[4][4] = m_m;
+        for (int i=0; i<3; i++)
+        {
+            b[i][0] = a[0][i];
+            b[i][1] = a[1][i];
+            b[i][2] = a[2][i];
+            b[i][3] = -(a[0][i]*a[0][3] + a[1][i]*a[1][3] + a[2][i]*a[2][3]);
+        }
+        return r;
+    }
+
+    /**
+     * The matrix that transforms surface normals: the inverse
+     * transpose of the upper 3x3, with no translation. Normals
+     * transformed by it need renormalizing unless the matrix is
+     * rigid. Throws degenerate_error if the upper 3x3 is singular.
+     */
+    Matrix3 normalMatrix() const
+    {
+        Matrix3 r;
+        if (!normalMatrix(r))
+        {
+            throw degenerate_error("Matrix3::normalMatrix(): matrix is singular");
+        }
+        return r;
+    }
+
+    bool normalMatrix(Matrix3& out) const noexcept
+    {
+        fptype adj[3][3];
+        fptype const det = adjugate3(adj);
+        if (det == 0)
+        {
+            return false;
+        }
+        fptype const inv = 1 / det;
+
+        out = Matrix3();
+        fptype (&b)[4][4] = out.m_m;
+        for (int i=0; i<3; i++)
+        {
+            b[i][0] = adj[0][i] * inv;
+            b[i][1] = adj[1][i] * inv;
+            b[i][2] = adj[2][i] * inv;
+        }
+        return true;
     }
 
     // static factory methods:
 
-    static Matrix3 translation(fptype dx, fptype dy, fptype dz)
+    static VECMATH_CONSTEXPR14 Matrix3 translation(fptype dx, fptype dy, fptype dz)
     {
         Matrix3 r;
         r.m_m[0][3] = dx;                   // | 1 0 0 x |
@@ -220,7 +663,7 @@ class Matrix3
         return r;
     }
 
-    static Matrix3 scale(fptype sx, fptype sy, fptype sz)
+    static VECMATH_CONSTEXPR14 Matrix3 scale(fptype sx, fptype sy, fptype sz)
     {
         Matrix3 r;
         r.m_m[0][0] = sx;                   // | x 0 0 0 |
@@ -265,6 +708,86 @@ class Matrix3
         return r;
     }
 
+    /**
+     * Rotation by \c x about X, \c y about Y and \c z about Z,
+     * equal to rotateX(x) * rotateY(y) * rotateZ(z) (so applied
+     * to a column vector in Z, Y, X order), built directly.
+     */
+    static Matrix3 rotateEuler(fptype x, fptype y, fptype z)
+    {
+        return rotateEulerSinCos(std::sin(x), std::cos(x),
+                                 std::sin(y), std::cos(y),
+                                 std::sin(z), std::cos(z));
+    }
+
+    /**
+     * rotateEuler() from the sines and cosines of its angles, for
+     * callers that compute them in bulk.
+     */
+    static VECMATH_CONSTEXPR14 Matrix3 rotateEulerSinCos(fptype sx, fptype cx,
+                                                         fptype sy, fptype cy,
+                                                         fptype sz, fptype cz)
+    {
+        Matrix3 r;
+        fptype (&m)[4][4] = r.m_m;
+        m[0][0] = cy*cz;
+        m[0][1] = -cy*sz;
+        m[0][2] = sy;
+        m[1][0] = cx*sz + sx*sy*cz;
+        m[1][1] = cx*cz - sx*sy*sz;
+        m[1][2] = -sx*cy;
+        m[2][0] = sx*sz - cx*sy*cz;
+        m[2][1] = sx*cz + cx*sy*sz;
+        m[2][2] = cx*cy;
+        return r;
+    }
+
+    /**
+     * Rotation by \c theta about \c axis, which must be of unit
+     * length (Rodrigues' formula).
+     */
+    static Matrix3 rotateAxis(Vector3<fptype> const& axis, fptype theta)
+    {
+        fptype const c = std::cos(theta);
+        fptype const s = std::sin(theta);
+        fptype const t = 1 - c;
+        fptype const x = axis.X(), y = axis.Y(), z = axis.Z();
+
+        Matrix3 r;
+        fptype (&m)[4][4] = r.m_m;
+        m[0][0] = t*x*x + c;
+        m[0][1] = t*x*y - s*z;
+        m[0][2] = t*x*z + s*y;
+        m[1][0] = t*x*y + s*z;
+        m[1][1] = t*y*y + c;
+        m[1][2] = t*y*z - s*x;
+        m[2][0] = t*x*z - s*y;
+        m[2][1] = t*y*z + s*x;
+        m[2][2] = t*z*z + c;
+        return r;
+    }
+
+  protected:
+    /**
+     * The adjugate (transposed cofactors) of the upper 3x3, which
+     * is its inverse times its determinant. Returns the determinant.
+     */
+    fptype adjugate3(fptype (&adj)[3][3]) const noexcept
+    {
+        fptype const (&a)[4][4] = m_m;
+        adj[0][0] = a[1][1]*a[2][2] - a[1][2]*a[2][1];
+        adj[0][1] = a[0][2]*a[2][1] - a[0][1]*a[2][2];
+        adj[0][2] = a[0][1]*a[1][2] - a[0][2]*a[1][1];
+        adj[1][0] = a[1][2]*a[2][0] - a[1][0]*a[2][2];
+        adj[1][1] = a[0][0]*a[2][2] - a[0][2]*a[2][0];
+        adj[1][2] = a[0][2]*a[1][0] - a[0][0]*a[1][2];
+        adj[2][0] = a[1][0]*a[2][1] - a[1][1]*a[2][0];
+        adj[2][1] = a[0][1]*a[2][0] - a[0][0]*a[2][1];
+        adj[2][2] = a[0][0]*a[1][1] - a[0][1]*a[1][0];
+        return a[0][0]*adj[0][0] + a[0][1]*adj[1][0] + a[0][2]*adj[2][0];
+    }
+
+  public:
     // Declare friend functions for data access:
     template <typename FP>
     friend Matrix3<FP> operator*(Matrix3<FP> const& a,
@@ -275,8 +798,19 @@ class Matrix3
     template <typename FP>
     friend Vector3<FP> operator*(Matrix3<FP> const& m,
                                  Vector3<FP> const& v);
+
+    // AffineMatrix3 and Quaternion convert to and from Matrix3
+    template <typename FP>
+    friend class AffineMatrix3;
+    template <typename FP>
+    friend class Quaternion;
 };
 
+template <typename _fptype>
+constexpr _fptype Matrix3<_fptype>::zero;
+template <typename _fptype>
+constexpr _fptype Matrix3<_fptype>::one;
+
 /*
  * Type specializations for float and double variants
  */
@@ -293,4 +827,8 @@ using Matrix3d = Matrix3<double>;
 #include "vecprint.h"
 #include "matops.h"
 
+#if defined(VECMATH_SIMD)
+#include "vecsimd.h"
+#endif
+
 #endif // VECMATH_H
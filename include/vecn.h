@@ -0,0 +1,503 @@
+/*
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/*
+ * Vectors and matrices of any small size
+ *
+ * VectorN<T, N> holds exactly N components and MatrixN<T, R, C> exactly
+ * R x C elements, so a 2D pipeline stores and computes 2 components
+ * where Vector3<> carries 4:
+ *
+ *     Matrix3x3f const m = Matrix3x3f::translation(Vector2f(1, 2)) *
+ *                          Matrix3x3f::rotation(0.5f);  // 2D affine
+ *     Vector2f const p = transform_point(m, Vector2f(3, 4));
+ *
+ * The loops over components are unrolled at compile time by template
+ * recursion, and sums are accumulated in index order. N is 2, 3 or 4.
+ * circle3pts.h has a Vector2<> circle3pts().
+ *
+ * Vector3<> and Matrix3<> stay as they are. to_vectorn(),
+ * to_vector3(), to_matrixn() and to_matrix3() convert between them
+ * and the 4-component forms.
+ */
+#ifndef VM_VECN_H
+#define VM_VECN_H
+
+#include "vecmath.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+namespace vecmath {
+
+namespace detail {
+
+/*
+ * fn(I), ..., fn(N-1) for compile-time I and N, unrolled by the
+ * recursion; sum() adds the results left to right.
+ */
+template <std::size_t I, std::size_t N>
+struct unroll
+{
+    template <typename Fn>
+    static void apply(Fn const& fn)
+    {
+        fn(I);
+        unroll<I + 1, N>::apply(fn);
+    }
+
+    template <typename T, typename Fn>
+    static T sum(T acc, Fn const& fn)
+    {
+        return unroll<I + 1, N>::sum(acc + fn(I), fn);
+    }
+};
+
+template <std::size_t N>
+struct unroll<N, N>
+{
+    template <typename Fn>
+    static void apply(Fn const&)
+    { }
+
+    template <typename T, typename Fn>
+    static T sum(T acc, Fn const&)
+    {
+        return acc;
+    }
+};
+
+// fn(0) + fn(1) + ... + fn(N-1), for N >= 1
+template <std::size_t N, typename T, typename Fn>
+T unrolled_sum(Fn const& fn)
+{
+    return unroll<1, N>::sum(T(fn(0)), fn);
+}
+
+} // ::detail
+
+/**
+ * A vector of N components, without the W of Vector3<>.
+ */
+template <typename _fptype, std::size_t N>
+class VectorN
+{
+    static_assert(N >= 2 && N <= 4, "VectorN<>: N must be 2, 3 or 4");
+
+  private:
+    alignas(detail::storage_align(N * sizeof(_fptype), alignof(_fptype))) _fptype m_v[N];
+
+  public:
+    typedef _fptype fptype;
+
+    static constexpr std::size_t size() noexcept { return N; }
+
+    /* The zero vector */
+    VectorN() noexcept
+    {
+        detail::unroll<0, N>::apply([this](std::size_t i) { m_v[i] = 0; });
+    }
+
+    /* Exactly N components */
+    template <typename... Rest,
+              typename = typename std::enable_if<sizeof...(Rest) + 1 == N>::type>
+    constexpr VectorN(fptype x, Rest... rest)
+        : m_v {x, fptype(rest)...}
+    { }
+
+    // Defaulted copies keep VectorN trivially copyable.
+    VectorN(VectorN const &o) = default;
+    VectorN& operator=(VectorN const &o) = default;
+
+    /* Component getters; Z needs N >= 3 and W needs N == 4 */
+    constexpr fptype X() const noexcept { return m_v[0]; }
+    constexpr fptype Y() const noexcept { return m_v[1]; }
+
+    fptype Z() const noexcept
+    {
+        static_assert(N >= 3, "VectorN<>::Z(): no Z component");
+        return m_v[2];
+    }
+
+    fptype W() const noexcept
+    {
+        static_assert(N >= 4, "VectorN<>::W(): no W component");
+        return m_v[3];
+    }
+
+    /**
+     * Component \c i, in [0, N), without bounds checks.
+     */
+    constexpr fptype operator[](std::size_t i) const noexcept { return m_v[i]; }
+    VECMATH_CONSTEXPR14 fptype& operator[](std::size_t i) noexcept { return m_v[i]; }
+
+    /* The N components, contiguous */
+    fptype* data() noexcept { return m_v; }
+    fptype const* data() const noexcept { return m_v; }
+
+    fptype length_squared() const noexcept
+    {
+        return detail::unrolled_sum<N, fptype>([this](std::size_t i) { return m_v[i] * m_v[i]; });
+    }
+
+    /**
+     * The length, std::sqrt() of length_squared(). Unlike
+     * Vector3<>::length() there is no shortcut for unit vectors and
+     * short lengths are not snapped to zero.
+     */
+    fptype length() const
+    {
+        return std::sqrt(length_squared());
+    }
+
+    /**
+     * Scale to unit length; a zero vector stays zero.
+     * Returns a reference to the vector.
+     */
+    VectorN& normalize()
+    {
+        fptype const len = length();
+        if (len != 0)
+        {
+            detail::unroll<0, N>::apply([this, len](std::size_t i) { m_v[i] /= len; });
+        }
+        return *this;
+    }
+};
+
+/**
+ * A matrix of R rows and C columns, stored row-major. Square ones
+ * act on column vectors as Matrix3<> does.
+ */
+template <typename _fptype, std::size_t R, std::size_t C>
+class MatrixN
+{
+    static_assert(R >= 2 && R <= 4 && C >= 2 && C <= 4, "MatrixN<>: R and C must be 2, 3 or 4");
+
+  public:
+    typedef _fptype fptype;
+
+  private:
+    alignas(detail::storage_align(R * C * sizeof(_fptype), alignof(_fptype))) fptype m_m[R][C];
+
+  public:
+    static constexpr std::size_t rows() noexcept { return R; }
+    static constexpr std::size_t cols() noexcept { return C; }
+
+    /* Ones on the diagonal, as Matrix3<>'s identity default */
+    MatrixN() noexcept
+    {
+        detail::unroll<0, R>::apply([this](std::size_t r) {
+            detail::unroll<0, C>::apply([this, r](std::size_t c) { m_m[r][c] = (r == c) ? 1 : 0; });
+        });
+    }
+
+    // Defaulted copies keep MatrixN trivially copyable.
+    MatrixN(MatrixN const &o) = default;
+    MatrixN& operator=(MatrixN const &o) = default;
+
+    static MatrixN identity() noexcept { return MatrixN(); }
+
+    static MatrixN zero() noexcept
+    {
+        MatrixN m;
+        detail::unroll<0, R>::apply([&m](std::size_t r) {
+            detail::unroll<0, C>::apply([&m, r](std::size_t c) { m.m_m[r][c] = 0; });
+        });
+        return m;
+    }
+
+    fptype get(std::size_t r, std::size_t c) const
+    {
+        if (r >= R || c >= C)
+        {
+            throw index_error("MatrixN::get()");
+        }
+        return m_m[r][c];
+    }
+
+    /**
+     * Element (r, c) without bounds checks, for inner loops and
+     * for setting elements.
+     */
+    constexpr fptype operator()(std::size_t r, std::size_t c) const noexcept
+    {
+        return m_m[r][c];
+    }
+
+    VECMATH_CONSTEXPR14 fptype& operator()(std::size_t r, std::size_t c) noexcept
+    {
+        return m_m[r][c];
+    }
+
+    /* The R*C elements, contiguous in row-major order */
+    fptype* data() noexcept { return &m_m[0][0]; }
+    fptype const* data() const noexcept { return &m_m[0][0]; }
+
+    MatrixN<fptype, C, R> transpose() const noexcept
+    {
+        MatrixN<fptype, C, R> t;
+        detail::unroll<0, R>::apply([this, &t](std::size_t r) {
+            detail::unroll<0, C>::apply([this, &t, r](std::size_t c) { t(c, r) = m_m[r][c]; });
+        });
+        return t;
+    }
+
+    /**
+     * The transform of Matrix3<>::translation(), for square
+     * matrices: translation of the first R-1 axes by \c d.
+     */
+    static MatrixN translation(VectorN<fptype, R - 1> const& d) noexcept
+    {
+        static_assert(R == C, "MatrixN<>::translation(): matrix is not square");
+        MatrixN m;
+        detail::unroll<0, R - 1>::apply([&m, &d](std::size_t r) { m.m_m[r][C - 1] = d[r]; });
+        return m;
+    }
+
+    /**
+     * The scale of the first R-1 axes by \c s, for square matrices,
+     * as Matrix3<>::scale().
+     */
+    static MatrixN scale(VectorN<fptype, R - 1> const& s) noexcept
+    {
+        static_assert(R == C, "MatrixN<>::scale(): matrix is not square");
+        MatrixN m;
+        detail::unroll<0, R - 1>::apply([&m, &s](std::size_t r) { m.m_m[r][r] = s[r]; });
+        return m;
+    }
+
+    /**
+     * Rotation by \c theta in the plane of the first two axes, as
+     * Matrix3<>::rotateZ().
+     */
+    static MatrixN rotation(fptype theta)
+    {
+        static_assert(R == C, "MatrixN<>::rotation(): matrix is not square");
+        fptype const ct = std::cos(theta);
+        fptype const st = std::sin(theta);
+
+        MatrixN m;
+        m.m_m[0][0] = m.m_m[1][1] = ct;
+        m.m_m[0][1] = -st;
+        m.m_m[1][0] = st;
+        return m;
+    }
+};
+
+/*
+ * Type specializations. Vector2<> is for 2D points and directions,
+ * Matrix3x3<> for their affine transforms (transform_point()), and
+ * Matrix2x2<> for their linear ones.
+ */
+template <typename fptype> using Vector2 = VectorN<fptype, 2>;
+template <typename fptype> using Vector4 = VectorN<fptype, 4>;
+template <typename fptype> using Matrix2x2 = MatrixN<fptype, 2, 2>;
+template <typename fptype> using Matrix3x3 = MatrixN<fptype, 3, 3>;
+template <typename fptype> using Matrix4x4 = MatrixN<fptype, 4, 4>;
+
+using Vector2f = Vector2<float>;
+using Vector2d = Vector2<double>;
+using Vector4f = Vector4<float>;
+using Vector4d = Vector4<double>;
+using Matrix2x2f = Matrix2x2<float>;
+using Matrix2x2d = Matrix2x2<double>;
+using Matrix3x3f = Matrix3x3<float>;
+using Matrix3x3d = Matrix3x3<double>;
+using Matrix4x4f = Matrix4x4<float>;
+using Matrix4x4d = Matrix4x4<double>;
+
+/**
+ * The dot product of two VectorN<>, summed in index order.
+ */
+template <typename fptype, std::size_t N>
+fptype dot(VectorN<fptype, N> const& a, VectorN<fptype, N> const& b) noexcept
+{
+    return detail::unrolled_sum<N, fptype>([&a, &b](std::size_t i) { return a[i] * b[i]; });
+}
+
+/**
+ * The cross product of two 3-component vectors.
+ */
+template <typename fptype>
+VectorN<fptype, 3> cross(VectorN<fptype, 3> const& a, VectorN<fptype, 3> const& b) noexcept
+{
+    return VectorN<fptype, 3>(a[1]*b[2] - a[2]*b[1],
+                              a[2]*b[0] - a[0]*b[2],
+                              a[0]*b[1] - a[1]*b[0]);
+}
+
+/*
+ * Componentwise arithmetic, and scaling by a scalar.
+ */
+template <typename fptype, std::size_t N>
+VectorN<fptype, N> operator+(VectorN<fptype, N> const& a, VectorN<fptype, N> const& b) noexcept
+{
+    VectorN<fptype, N> r;
+    detail::unroll<0, N>::apply([&](std::size_t i) { r[i] = a[i] + b[i]; });
+    return r;
+}
+
+template <typename fptype, std::size_t N>
+VectorN<fptype, N> operator-(VectorN<fptype, N> const& a, VectorN<fptype, N> const& b) noexcept
+{
+    VectorN<fptype, N> r;
+    detail::unroll<0, N>::apply([&](std::size_t i) { r[i] = a[i] - b[i]; });
+    return r;
+}
+
+template <typename fptype, std::size_t N>
+VectorN<fptype, N> operator-(VectorN<fptype, N> const& a) noexcept
+{
+    VectorN<fptype, N> r;
+    detail::unroll<0, N>::apply([&](std::size_t i) { r[i] = -a[i]; });
+    return r;
+}
+
+template <typename fptype, std::size_t N>
+VectorN<fptype, N> operator*(VectorN<fptype, N> const& a, fptype s) noexcept
+{
+    VectorN<fptype, N> r;
+    detail::unroll<0, N>::apply([&](std::size_t i) { r[i] = a[i] * s; });
+    return r;
+}
+
+template <typename fptype, std::size_t N>
+VectorN<fptype, N> operator*(fptype s, VectorN<fptype, N> const& a) noexcept
+{
+    return a * s;
+}
+
+template <typename fptype, std::size_t N>
+bool operator==(VectorN<fptype, N> const& a, VectorN<fptype, N> const& b) noexcept
+{
+    bool same = true;
+    detail::unroll<0, N>::apply([&](std::size_t i) { same = same && (a[i] == b[i]); });
+    return same;
+}
+
+template <typename fptype, std::size_t N>
+bool operator!=(VectorN<fptype, N> const& a, VectorN<fptype, N> const& b) noexcept
+{
+    return !(a == b);
+}
+
+/**
+ * Matrix-Matrix multiplication
+ */
+template <typename fptype, std::size_t R, std::size_t K, std::size_t C>
+MatrixN<fptype, R, C> operator*(MatrixN<fptype, R, K> const& a, MatrixN<fptype, K, C> const& b) noexcept
+{
+    MatrixN<fptype, R, C> result;
+    detail::unroll<0, R>::apply([&](std::size_t r) {
+        detail::unroll<0, C>::apply([&](std::size_t c) {
+            result(r, c) = detail::unrolled_sum<K, fptype>([&](std::size_t k) { return a(r, k) * b(k, c); });
+        });
+    });
+    return result;
+}
+
+/**
+ * Matrix-column Vector multiplication
+ */
+template <typename fptype, std::size_t R, std::size_t C>
+VectorN<fptype, R> operator*(MatrixN<fptype, R, C> const& m, VectorN<fptype, C> const& v) noexcept
+{
+    VectorN<fptype, R> result;
+    detail::unroll<0, R>::apply([&](std::size_t r) {
+        result[r] = detail::unrolled_sum<C, fptype>([&](std::size_t c) { return m(r, c) * v[c]; });
+    });
+    return result;
+}
+
+/**
+ * Row vector-Matrix multiplication
+ */
+template <typename fptype, std::size_t R, std::size_t C>
+VectorN<fptype, C> operator*(VectorN<fptype, R> const& v, MatrixN<fptype, R, C> const& m) noexcept
+{
+    VectorN<fptype, C> result;
+    detail::unroll<0, C>::apply([&](std::size_t c) {
+        result[c] = detail::unrolled_sum<R, fptype>([&](std::size_t r) { return v[r] * m(r, c); });
+    });
+    return result;
+}
+
+/**
+ * Transform a point by an affine matrix one size larger, as
+ * Matrix3<> * Vector3<> does with W = 1: the last row is assumed to
+ * be [0 ... 0 1] and is not read.
+ */
+template <typename fptype, std::size_t N>
+VectorN<fptype, N> transform_point(MatrixN<fptype, N + 1, N + 1> const& m,
+                                   VectorN<fptype, N> const& p) noexcept
+{
+    VectorN<fptype, N> result;
+    detail::unroll<0, N>::apply([&](std::size_t r) {
+        result[r] = detail::unrolled_sum<N, fptype>([&](std::size_t c) { return m(r, c) * p[c]; }) + m(r, N);
+    });
+    return result;
+}
+
+/**
+ * Transform a direction by an affine matrix one size larger: as
+ * transform_point() without the translation.
+ */
+template <typename fptype, std::size_t N>
+VectorN<fptype, N> transform_direction(MatrixN<fptype, N + 1, N + 1> const& m,
+                                       VectorN<fptype, N> const& d) noexcept
+{
+    VectorN<fptype, N> result;
+    detail::unroll<0, N>::apply([&](std::size_t r) {
+        result[r] = detail::unrolled_sum<N, fptype>([&](std::size_t c) { return m(r, c) * d[c]; });
+    });
+    return result;
+}
+
+/*
+ * Conversions to and from Vector3<> and Matrix3<>. A Vector3<> is
+ * the 4 components X, Y, Z, W; the shorter forms take the first N
+ * of them, and to_vector3() of a 2 or 3 component vector fills in
+ * Z = 0 and W = 1 as Vector3<>'s constructors do.
+ */
+template <std::size_t N, typename fptype>
+VectorN<fptype, N> to_vectorn(Vector3<fptype> const& v) noexcept
+{
+    VectorN<fptype, N> r;
+    detail::unroll<0, N>::apply([&](std::size_t i) { r[i] = v[uint32_t(i)]; });
+    return r;
+}
+
+template <typename fptype, std::size_t N>
+Vector3<fptype> to_vector3(VectorN<fptype, N> const& v) noexcept
+{
+    Vector3<fptype> r(0, 0, 0);
+    detail::unroll<0, N>::apply([&](std::size_t i) { r[uint32_t(i)] = v[i]; });
+    return r;
+}
+
+template <typename fptype>
+Matrix4x4<fptype> to_matrixn(Matrix3<fptype> const& m) noexcept
+{
+    Matrix4x4<fptype> r;
+    std::copy(m.data(), m.data() + 16, r.data());
+    return r;
+}
+
+template <typename fptype>
+Matrix3<fptype> to_matrix3(Matrix4x4<fptype> const& m) noexcept
+{
+    Matrix3<fptype> r;
+    std::copy(m.data(), m.data() + 16, r.data());
+    return r;
+}
+
+} // ::vecmath
+
+#endif // VM_VECN_H
@@ -18,7 +18,7 @@ namespace vecmath {
  * @return the <fptype> dot result
  */
 template <typename fptype>
-fptype dot(Vector3<fptype> const &a, Vector3<fptype> const &b)
+constexpr fptype dot(Vector3<fptype> const &a, Vector3<fptype> const &b)
 {
     return (a.X()*b.X() + a.Y()*b.Y() + a.Z()*b.Z());
 }
@@ -31,7 +31,7 @@ fptype dot(Vector3<fptype> const &a, Vector3<fptype> const &b)
  * @return the Vector3<fptype> cross result
  */
 template <typename fptype>
-Vector3<fptype> cross(Vector3<fptype> const &a, Vector3<fptype> const &b)
+constexpr Vector3<fptype> cross(Vector3<fptype> const &a, Vector3<fptype> const &b)
 {
     return {a.Y()*b.Z() - a.Z()*b.Y(),
             a.Z()*b.X() - a.X()*b.Z(),
@@ -50,7 +50,7 @@ Vector3<fptype> cross(Vector3<fptype> const &a, Vector3<fptype> const &b)
  * @return Vector3<> sum of a and b
  */
 template <typename fptype>
-Vector3<fptype> operator+(Vector3<fptype> const &a, Vector3<fptype> const &b)
+constexpr Vector3<fptype> operator+(Vector3<fptype> const &a, Vector3<fptype> const &b)
 {
     return {a.X()+b.X(), a.Y()+b.Y(), a.Z()+b.Z()};
 }
@@ -63,7 +63,7 @@ Vector3<fptype> operator+(Vector3<fptype> const &a, Vector3<fptype> const &b)
  * @return Vector3<> result of a - b
  */
 template <typename fptype>
-Vector3<fptype> operator-(Vector3<fptype> const &a, Vector3<fptype> const &b)
+constexpr Vector3<fptype> operator-(Vector3<fptype> const &a, Vector3<fptype> const &b)
 {
     return {a.X()-b.X(), a.Y()-b.Y(), a.Z()-b.Z()};
 }
@@ -0,0 +1,507 @@
+/*
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/*
+ * Compact storage types for large arrays of points and normals
+ *
+ * A Vector3f is 16 bytes: three components and W. Arrays that are
+ * mostly stored and streamed, rather than computed on, can use:
+ *
+ *   PackedVector3f   12 bytes, exact (three floats, no W)
+ *   Vector3h          6 bytes, IEEE half precision (11 bits, |v| < 65504)
+ *   PackedNormal3     6 bytes, signed 16-bit fixed point in [-1, 1]
+ *
+ * Conversions that lose nothing are implicit; those that round are
+ * explicit. The batch pack() and unpack() functions convert arrays
+ * to and from Vector3f or a Vector3Array<float>; the half precision
+ * ones use F16C on x86 (detected at runtime) and NEON on AArch64.
+ */
+#ifndef VM_VECPACK_H
+#define VM_VECPACK_H
+
+#include "vecmath.h"
+#include "vecarray.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>                          // std::getenv()
+#include <cstring>
+#include <type_traits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#  include <immintrin.h>
+#  define VM_PACK_F16C 1
+#  define VM_TARGET_F16C __attribute__((target("avx,f16c")))
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#  define VM_PACK_NEON 1
+#endif
+
+namespace vecmath {
+
+namespace detail {
+
+/*
+ * Scalar IEEE half conversions, rounding to nearest even. After
+ * F. Giesen, "half_to_float / float_to_half" (public domain).
+ */
+inline uint16_t float_to_half(float f)
+{
+    uint32_t x;
+    std::memcpy(&x, &f, sizeof(x));
+    uint32_t const sign = x & 0x80000000u;
+    x ^= sign;
+
+    uint32_t h;
+    if (x >= 0x47800000u)                   // too large: Inf, or NaN
+    {
+        h = (x > 0x7f800000u) ? 0x7e00u : 0x7c00u;
+    }
+    else if (x < 0x38800000u)               // subnormal half, or zero
+    {
+        // Adding 0.5 aligns the 10 mantissa bits at the bottom, and
+        // the FPU's own rounding is to nearest even.
+        uint32_t const magic_bits = 126u << 23;
+        float magic, v;
+        std::memcpy(&magic, &magic_bits, sizeof(magic));
+        std::memcpy(&v, &x, sizeof(v));
+        v += magic;
+        std::memcpy(&h, &v, sizeof(h));
+        h -= magic_bits;
+    }
+    else
+    {
+        uint32_t const odd = (x >> 13) & 1;
+        x += (uint32_t(15 - 127) << 23) + 0xfff + odd;
+        h = x >> 13;
+    }
+    return uint16_t(h | (sign >> 16));
+}
+
+inline float half_to_float(uint16_t h)
+{
+    uint32_t const shifted_exp = 0x7c00u << 13;
+    uint32_t x = uint32_t(h & 0x7fff) << 13;
+    uint32_t const exp = x & shifted_exp;
+    x += uint32_t(127 - 15) << 23;
+
+    float f;
+    if (exp == shifted_exp)                 // Inf or NaN
+    {
+        x += uint32_t(128 - 16) << 23;
+        std::memcpy(&f, &x, sizeof(f));
+    }
+    else if (exp == 0)                      // zero or subnormal: renormalize
+    {
+        uint32_t const magic_bits = 113u << 23;
+        float magic;
+        std::memcpy(&magic, &magic_bits, sizeof(magic));
+        x += 1u << 23;
+        std::memcpy(&f, &x, sizeof(f));
+        f -= magic;
+    }
+    else
+    {
+        std::memcpy(&f, &x, sizeof(f));
+    }
+    return (h & 0x8000) ? -f : f;
+}
+
+// Signed normalized 16-bit values, 32767 steps per unit.
+inline int16_t float_to_snorm16(float v)
+{
+    v = (v > 1) ? 1.0f : ((v < -1) ? -1.0f : v);
+    return int16_t(v * 32767.0f + ((v < 0) ? -0.5f : 0.5f));
+}
+
+inline float snorm16_to_float(int16_t s)
+{
+    float const v = float(s) * (1.0f / 32767.0f);
+    return (v < -1) ? -1.0f : v;            // -32768 is also -1
+}
+
+} // ::detail
+
+/**
+ * A 3D vector stored as three components, without W: 3/4 the size
+ * of a Vector3<>. Converts implicitly to Vector3<> (W = 1).
+ */
+template <typename _fptype>
+class PackedVector3
+{
+  public:
+    typedef _fptype fptype;
+
+  private:
+    fptype m_v[3];
+
+  public:
+    constexpr PackedVector3()
+        : m_v {0, 0, 0}
+    { }
+
+    constexpr PackedVector3(fptype x, fptype y, fptype z)
+        : m_v {x, y, z}
+    { }
+
+    explicit constexpr PackedVector3(Vector3<fptype> const& v)
+        : m_v {v.X(), v.Y(), v.Z()}
+    { }
+
+    constexpr operator Vector3<fptype>() const
+    {
+        return {m_v[0], m_v[1], m_v[2]};
+    }
+
+    /* Component getters */
+    constexpr fptype X() const noexcept { return m_v[0]; }
+    constexpr fptype Y() const noexcept { return m_v[1]; }
+    constexpr fptype Z() const noexcept { return m_v[2]; }
+
+    /* X, Y and Z, contiguous */
+    fptype* data() noexcept { return m_v; }
+    fptype const* data() const noexcept { return m_v; }
+};
+
+using PackedVector3f = PackedVector3<float>;
+using PackedVector3d = PackedVector3<double>;
+
+/**
+ * A 3D vector with half precision components: 6 bytes. Rounding
+ * to half keeps about 3 significant digits; magnitudes above
+ * 65504 become infinite.
+ */
+class Vector3h
+{
+  private:
+    uint16_t m_v[3];
+
+  public:
+    constexpr Vector3h()
+        : m_v {0, 0, 0}
+    { }
+
+    explicit Vector3h(Vector3f const& v)
+        : m_v {detail::float_to_half(v.X()), detail::float_to_half(v.Y()),
+               detail::float_to_half(v.Z())}
+    { }
+
+    operator Vector3f() const
+    {
+        return {X(), Y(), Z()};
+    }
+
+    /* Component getters */
+    float X() const noexcept { return detail::half_to_float(m_v[0]); }
+    float Y() const noexcept { return detail::half_to_float(m_v[1]); }
+    float Z() const noexcept { return detail::half_to_float(m_v[2]); }
+
+    /* The IEEE half bit patterns of X, Y and Z */
+    uint16_t* bits() noexcept { return m_v; }
+    uint16_t const* bits() const noexcept { return m_v; }
+};
+
+/**
+ * A unit vector, such as a surface normal, as three signed 16-bit
+ * fixed point values: 6 bytes, with a resolution of about 3e-5.
+ * Components outside [-1, 1] are clamped. Unpacked normals are
+ * within the resolution of unit length, not exactly unit length.
+ */
+class PackedNormal3
+{
+  private:
+    int16_t m_v[3];
+
+  public:
+    constexpr PackedNormal3()
+        : m_v {0, 0, 0}
+    { }
+
+    explicit PackedNormal3(Vector3f const& n)
+        : m_v {detail::float_to_snorm16(n.X()), detail::float_to_snorm16(n.Y()),
+               detail::float_to_snorm16(n.Z())}
+    { }
+
+    operator Vector3f() const
+    {
+        return {X(), Y(), Z()};
+    }
+
+    /* Component getters */
+    float X() const noexcept { return detail::snorm16_to_float(m_v[0]); }
+    float Y() const noexcept { return detail::snorm16_to_float(m_v[1]); }
+    float Z() const noexcept { return detail::snorm16_to_float(m_v[2]); }
+};
+
+namespace detail {
+
+static_assert(sizeof(PackedVector3f) == 12 && sizeof(Vector3h) == 6 && sizeof(PackedNormal3) == 6,
+              "packed types must have no padding");
+static_assert(std::is_standard_layout<Vector3h>::value && std::is_standard_layout<PackedNormal3>::value,
+              "packed types must be standard layout");
+
+/*
+ * Flat conversions of \c count halves. The F16C and NEON variants
+ * convert 8 and 4 values per instruction.
+ */
+inline void halves_to_floats_scalar(uint16_t const* VM_RESTRICT in, float* VM_RESTRICT out,
+                                    std::size_t count)
+{
+    for (std::size_t i=0; i<count; ++i)
+    {
+        out[i] = half_to_float(in[i]);
+    }
+}
+
+inline void floats_to_halves_scalar(float const* VM_RESTRICT in, uint16_t* VM_RESTRICT out,
+                                    std::size_t count)
+{
+    for (std::size_t i=0; i<count; ++i)
+    {
+        out[i] = float_to_half(in[i]);
+    }
+}
+
+#if defined(VM_PACK_F16C)
+VM_TARGET_F16C
+inline void halves_to_floats_f16c(uint16_t const* VM_RESTRICT in, float* VM_RESTRICT out,
+                                  std::size_t count)
+{
+    std::size_t i = 0;
+    for (; i+8 <= count; i+=8)
+    {
+        __m128i const h = _mm_loadu_si128(reinterpret_cast<__m128i const*>(in + i));
+        _mm256_storeu_ps(out + i, _mm256_cvtph_ps(h));
+    }
+    halves_to_floats_scalar(in + i, out + i, count - i);
+}
+
+VM_TARGET_F16C
+inline void floats_to_halves_f16c(float const* VM_RESTRICT in, uint16_t* VM_RESTRICT out,
+                                  std::size_t count)
+{
+    std::size_t i = 0;
+    for (; i+8 <= count; i+=8)
+    {
+        __m128i const h = _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), h);
+    }
+    floats_to_halves_scalar(in + i, out + i, count - i);
+}
+
+/*
+ * Whether to use F16C: the CPU has it, and VECMATH_ISA (see
+ * vecsimd.h) doesn't ask for scalar code.
+ */
+inline bool use_f16c()
+{
+    static bool const f16c = [] {
+        char const* env = std::getenv("VECMATH_ISA");
+        if (env && std::strcmp(env, "scalar") == 0)
+            return false;
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("f16c") != 0 && __builtin_cpu_supports("avx") != 0;
+    }();
+    return f16c;
+}
+#endif
+
+inline void halves_to_floats(uint16_t const* VM_RESTRICT in, float* VM_RESTRICT out,
+                             std::size_t count)
+{
+#if defined(VM_PACK_F16C)
+    if (use_f16c())
+    {
+        halves_to_floats_f16c(in, out, count);
+        return;
+    }
+#elif defined(VM_PACK_NEON)
+    std::size_t i = 0;
+    for (; i+4 <= count; i+=4)
+    {
+        vst1q_f32(out + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(in + i))));
+    }
+    in += i;
+    out += i;
+    count -= i;
+#endif
+    halves_to_floats_scalar(in, out, count);
+}
+
+inline void floats_to_halves(float const* VM_RESTRICT in, uint16_t* VM_RESTRICT out,
+                             std::size_t count)
+{
+#if defined(VM_PACK_F16C)
+    if (use_f16c())
+    {
+        floats_to_halves_f16c(in, out, count);
+        return;
+    }
+#elif defined(VM_PACK_NEON)
+    std::size_t i = 0;
+    for (; i+4 <= count; i+=4)
+    {
+        vst1_u16(out + i, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(in + i))));
+    }
+    in += i;
+    out += i;
+    count -= i;
+#endif
+    floats_to_halves_scalar(in, out, count);
+}
+
+/*
+ * Spread \c n packed triples out to Vector3<> layout with W = 1.
+ * Written on the flat arrays so the compiler can vectorize it.
+ */
+template <typename fptype>
+inline void expand_w(fptype const* VM_RESTRICT in, fptype* VM_RESTRICT out, std::size_t n)
+{
+    for (std::size_t i=0; i<n; ++i)
+    {
+        out[4*i]     = in[3*i];
+        out[4*i + 1] = in[3*i + 1];
+        out[4*i + 2] = in[3*i + 2];
+        out[4*i + 3] = 1;
+    }
+}
+
+/*
+ * Half arrays are converted through a stack buffer of this many
+ * points, small enough to stay in L1.
+ */
+constexpr std::size_t pack_chunk = 256;
+
+} // ::detail
+
+/*
+ * Batch conversions to Vector3<> arrays. W of the results is 1.
+ */
+
+template <typename fptype>
+void unpack(PackedVector3<fptype> const* in, Vector3<fptype>* out, std::size_t n)
+{
+    if (n != 0)
+    {
+        detail::expand_w(in[0].data(), out[0].data(), n);
+    }
+}
+
+inline void unpack(Vector3h const* in, Vector3f* out, std::size_t n)
+{
+    float f[3 * detail::pack_chunk];
+    for (std::size_t first=0; first<n; first+=detail::pack_chunk)
+    {
+        std::size_t const count = (n - first < detail::pack_chunk) ? (n - first) : detail::pack_chunk;
+        detail::halves_to_floats(in[first].bits(), f, 3 * count);
+        detail::expand_w(f, out[first].data(), count);
+    }
+}
+
+inline void unpack(PackedNormal3 const* VM_RESTRICT in, Vector3f* VM_RESTRICT out, std::size_t n)
+{
+    for (std::size_t i=0; i<n; ++i)
+    {
+        out[i] = in[i];
+    }
+}
+
+/*
+ * Batch conversions to a Vector3Array<>, which is resized to \c n.
+ */
+
+template <typename fptype>
+void unpack(PackedVector3<fptype> const* in, std::size_t n, Vector3Array<fptype>& out)
+{
+    out.resize(n);
+    fptype* VM_RESTRICT const x = out.X();
+    fptype* VM_RESTRICT const y = out.Y();
+    fptype* VM_RESTRICT const z = out.Z();
+    for (std::size_t i=0; i<n; ++i)
+    {
+        x[i] = in[i].X();
+        y[i] = in[i].Y();
+        z[i] = in[i].Z();
+    }
+}
+
+inline void unpack(Vector3h const* in, std::size_t n, Vector3Array<float>& out)
+{
+    out.resize(n);
+    float f[3 * detail::pack_chunk];
+    for (std::size_t first=0; first<n; first+=detail::pack_chunk)
+    {
+        std::size_t const count = (n - first < detail::pack_chunk) ? (n - first) : detail::pack_chunk;
+        detail::halves_to_floats(in[first].bits(), f, 3 * count);
+
+        float* VM_RESTRICT const x = out.X() + first;
+        float* VM_RESTRICT const y = out.Y() + first;
+        float* VM_RESTRICT const z = out.Z() + first;
+        for (std::size_t i=0; i<count; ++i)
+        {
+            x[i] = f[3*i];
+            y[i] = f[3*i + 1];
+            z[i] = f[3*i + 2];
+        }
+    }
+}
+
+inline void unpack(PackedNormal3 const* in, std::size_t n, Vector3Array<float>& out)
+{
+    out.resize(n);
+    float* VM_RESTRICT const x = out.X();
+    float* VM_RESTRICT const y = out.Y();
+    float* VM_RESTRICT const z = out.Z();
+    for (std::size_t i=0; i<n; ++i)
+    {
+        x[i] = in[i].X();
+        y[i] = in[i].Y();
+        z[i] = in[i].Z();
+    }
+}
+
+/*
+ * Batch conversions from Vector3<> arrays. W is dropped.
+ */
+
+template <typename fptype>
+void pack(Vector3<fptype> const* VM_RESTRICT in, PackedVector3<fptype>* VM_RESTRICT out,
+          std::size_t n)
+{
+    for (std::size_t i=0; i<n; ++i)
+    {
+        out[i] = PackedVector3<fptype>(in[i]);
+    }
+}
+
+inline void pack(Vector3f const* in, Vector3h* out, std::size_t n)
+{
+    float f[3 * detail::pack_chunk];
+    for (std::size_t first=0; first<n; first+=detail::pack_chunk)
+    {
+        std::size_t const count = (n - first < detail::pack_chunk) ? (n - first) : detail::pack_chunk;
+        for (std::size_t i=0; i<count; ++i)
+        {
+            Vector3f const& v = in[first + i];
+            f[3*i] = v.X();
+            f[3*i + 1] = v.Y();
+            f[3*i + 2] = v.Z();
+        }
+        detail::floats_to_halves(f, out[first].bits(), 3 * count);
+    }
+}
+
+inline void pack(Vector3f const* VM_RESTRICT in, PackedNormal3* VM_RESTRICT out, std::size_t n)
+{
+    for (std::size_t i=0; i<n; ++i)
+    {
+        out[i] = PackedNormal3(in[i]);
+    }
+}
+
+} // ::vecmath
+
+#endif // VM_VECPACK_H
@@ -0,0 +1,740 @@
+/*
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/*
+ * Multithreaded batch kernels
+ *
+ * The batches are cut into fixed-size blocks which a work-stealing
+ * thread pool spreads over the cores. Every block writes only its
+ * own part of the output, and the block size does not depend on
+ * the number of threads, so results are the same on any machine.
+ *
+ * Programs using this header must link with the platform thread
+ * library (-pthread, or Threads::Threads in CMake).
+ */
+#ifndef VM_VECPARALLEL_H
+#define VM_VECPARALLEL_H
+
+#include "vecmath.h"
+#include "vecarray.h"
+#include "bvh.h"
+#include "vechierarchy.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vecmath {
+namespace parallel {
+
+/*
+ * Points per block: 4096 float points in and out are 96KB of SoA
+ * buffers, which fits a core's L2 cache.
+ */
+std::size_t const point_block = 4096;
+
+/*
+ * Matrices per block for compose_chain(), and the fewest per
+ * subtree group for compose_hierarchy().
+ */
+std::size_t const matrix_block = 256;
+
+/**
+ * A pool of worker threads for running blocks of work.
+ *
+ * run() hands each participant, the workers and the calling
+ * thread, an equal share of the blocks. A participant that runs
+ * out of work steals half of the remaining blocks of another, so
+ * uneven blocks or busy cores don't leave threads idle.
+ *
+ * One run() executes at a time; concurrent calls wait. A run()
+ * from inside a block, or on a pool of one thread, runs serially
+ * on the calling thread.
+ */
+class thread_pool
+{
+  private:
+    // The unclaimed blocks [begin, end) of one participant
+    struct queue
+    {
+        std::mutex mutex;
+        std::size_t begin = 0;
+        std::size_t end = 0;
+    };
+
+    std::vector<std::thread> m_threads;
+    std::unique_ptr<queue[]> m_queues;      // one per thread, plus the caller's
+
+    std::mutex m_run;                       // serializes run()
+    std::mutex m_mutex;                     // guards the fields below
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    std::function<void(std::size_t)> m_task;
+    std::exception_ptr m_error;
+    unsigned long m_generation = 0;
+    std::size_t m_active = 0;
+    bool m_stop = false;
+
+    static bool& inside_block()
+    {
+        static thread_local bool inside = false;
+        return inside;
+    }
+
+    std::size_t participants() const { return m_threads.size() + 1; }
+
+    bool take(std::size_t self, std::size_t& block)
+    {
+        queue& q = m_queues[self];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.begin == q.end)
+            return false;
+        block = q.begin++;
+        return true;
+    }
+
+    // Take the back half of another participant's blocks.
+    bool steal(std::size_t self, std::size_t& block)
+    {
+        std::size_t const n = participants();
+        for (std::size_t k=1; k<n; ++k)
+        {
+            std::size_t begin, end;
+            {
+                queue& victim = m_queues[(self + k) % n];
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if (victim.begin == victim.end)
+                    continue;
+                end = victim.end;
+                begin = victim.begin + (victim.end - victim.begin) / 2;
+                victim.end = begin;
+            }
+
+            queue& own = m_queues[self];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            block = begin;
+            own.begin = begin + 1;
+            own.end = end;
+            return true;
+        }
+        return false;
+    }
+
+    void work(std::size_t self)
+    {
+        bool& inside = inside_block();
+        bool const was = inside;
+        inside = true;
+
+        std::size_t block;
+        while (take(self, block) || steal(self, block))
+        {
+            try
+            {
+                m_task(block);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!m_error)
+                    m_error = std::current_exception();
+            }
+        }
+
+        inside = was;
+    }
+
+    void worker(std::size_t self)
+    {
+        unsigned long seen = 0;
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [&] { return m_stop || m_generation != seen; });
+                if (m_stop)
+                    return;
+                seen = m_generation;
+            }
+
+            work(self);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_active == 0)
+                m_done.notify_one();
+        }
+    }
+
+  public:
+    /**
+     * Create a pool in which \c threads threads, including the
+     * caller of run(), share the work. 0 means one per hardware
+     * thread.
+     */
+    explicit thread_pool(std::size_t threads = 0)
+    {
+        if (threads == 0)
+            threads = std::thread::hardware_concurrency();
+        if (threads == 0)
+            threads = 1;
+
+        m_queues.reset(new queue[threads]);
+        for (std::size_t i=0; i+1<threads; ++i)
+        {
+            m_threads.emplace_back(&thread_pool::worker, this, i);
+        }
+    }
+
+    thread_pool(thread_pool const&) = delete;
+    thread_pool& operator=(thread_pool const&) = delete;
+
+    ~thread_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (std::thread& t : m_threads)
+        {
+            t.join();
+        }
+    }
+
+    /**
+     * Number of threads sharing the work, including the caller.
+     */
+    std::size_t size() const noexcept { return participants(); }
+
+    /**
+     * Call \c fn(b) for every block b in [0, blocks), and return
+     * when all have finished. If any call throws, the first
+     * exception is rethrown here after the rest have run.
+     */
+    template <typename Fn>
+    void run(std::size_t blocks, Fn fn)
+    {
+        if (blocks == 0)
+            return;
+
+        if (m_threads.empty() || blocks == 1 || inside_block())
+        {
+            for (std::size_t b=0; b<blocks; ++b)
+            {
+                fn(b);
+            }
+            return;
+        }
+
+        std::lock_guard<std::mutex> serial(m_run);
+
+        std::size_t const n = participants();
+        for (std::size_t p=0; p<n; ++p)
+        {
+            queue& q = m_queues[p];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            q.begin = blocks * p / n;
+            q.end = blocks * (p + 1) / n;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_task = fn;
+            m_error = nullptr;
+            m_active = m_threads.size();
+            ++m_generation;
+        }
+        m_wake.notify_all();
+
+        work(n - 1);
+
+        std::exception_ptr error;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_done.wait(lock, [&] { return m_active == 0; });
+            m_task = nullptr;
+            std::swap(error, m_error);
+        }
+        if (error)
+            std::rethrow_exception(error);
+    }
+};
+
+/**
+ * The pool used when none is given: one thread per hardware
+ * thread, created on first use.
+ */
+inline thread_pool& default_pool()
+{
+    static thread_pool pool;
+    return pool;
+}
+
+namespace detail {
+
+/*
+ * 1/sqrt(len2) for normalizing. std::sqrt() may set errno, which
+ * puts a branch in each element and stops the loops from being
+ * vectorized, so this is a bit-level initial guess refined by
+ * Newton-Raphson steps to full precision, all plain arithmetic.
+ * \c len2 must be positive and finite.
+ */
+inline float unit_scale(float len2)
+{
+    uint32_t i;
+    std::memcpy(&i, &len2, sizeof(i));
+    i = 0x5f375a86u - (i >> 1);
+    float y;
+    std::memcpy(&y, &i, sizeof(y));
+
+    y = vecmath::detail::rsqrt_newton(len2, y);
+    y = vecmath::detail::rsqrt_newton(len2, y);
+    return vecmath::detail::rsqrt_newton(len2, y);
+}
+
+inline double unit_scale(double len2)
+{
+    uint64_t i;
+    std::memcpy(&i, &len2, sizeof(i));
+    i = 0x5fe6eb50c7b537a9ull - (i >> 1);
+    double y;
+    std::memcpy(&y, &i, sizeof(y));
+
+    y = vecmath::detail::rsqrt_newton(len2, y);
+    y = vecmath::detail::rsqrt_newton(len2, y);
+    y = vecmath::detail::rsqrt_newton(len2, y);
+    return vecmath::detail::rsqrt_newton(len2, y);
+}
+
+/*
+ * The normal transform loops: the 3x3 matrix \c n, then scaling to
+ * unit length. A zero normal stays zero.
+ */
+template <typename fptype>
+void transform_normals(fptype const (&n)[9],
+                       fptype const* VM_RESTRICT ix, fptype const* VM_RESTRICT iy,
+                       fptype const* VM_RESTRICT iz, fptype* VM_RESTRICT ox,
+                       fptype* VM_RESTRICT oy, fptype* VM_RESTRICT oz, std::size_t count)
+{
+    for (std::size_t i=0; i<count; ++i)
+    {
+        fptype const x = ix[i]*n[0] + iy[i]*n[1] + iz[i]*n[2];
+        fptype const y = ix[i]*n[3] + iy[i]*n[4] + iz[i]*n[5];
+        fptype const z = ix[i]*n[6] + iy[i]*n[7] + iz[i]*n[8];
+        fptype const inv = unit_scale(x*x + y*y + z*z +
+                                      std::numeric_limits<fptype>::min());
+        ox[i] = x * inv;
+        oy[i] = y * inv;
+        oz[i] = z * inv;
+    }
+}
+
+template <typename fptype>
+void transform_normals(fptype const (&n)[9], fptype* VM_RESTRICT px,
+                       fptype* VM_RESTRICT py, fptype* VM_RESTRICT pz, std::size_t count)
+{
+    for (std::size_t i=0; i<count; ++i)
+    {
+        fptype const x = px[i]*n[0] + py[i]*n[1] + pz[i]*n[2];
+        fptype const y = px[i]*n[3] + py[i]*n[4] + pz[i]*n[5];
+        fptype const z = px[i]*n[6] + py[i]*n[7] + pz[i]*n[8];
+        fptype const inv = unit_scale(x*x + y*y + z*z +
+                                      std::numeric_limits<fptype>::min());
+        px[i] = x * inv;
+        py[i] = y * inv;
+        pz[i] = z * inv;
+    }
+}
+
+inline std::size_t blocks(std::size_t n, std::size_t block)
+{
+    return (n + block - 1) / block;
+}
+
+} // ::detail
+
+/**
+ * Parallel batch Matrix-column Vector multiplication, out = M * in,
+ * for points stored as a structure of arrays.
+ *
+ * The same as vecmath::transform(), split over the pool. \c out
+ * is resized to match \c in; \c in and \c out may be the same array.
+ */
+template <typename fptype>
+void transform_points(Matrix3<fptype> const& m,
+                      Vector3Array<fptype> const& in,
+                      Vector3Array<fptype>& out,
+                      thread_pool& pool = default_pool())
+{
+    fptype rows[12];
+    vecmath::detail::top_rows(m, rows);
+
+    std::size_t const n = in.size();
+    bool const inplace = (&in == &out);
+    if (!inplace)
+        out.resize(n);
+
+    pool.run(detail::blocks(n, point_block), [&](std::size_t b) {
+        std::size_t const first = b * point_block;
+        std::size_t const count = std::min(point_block, n - first);
+        if (inplace)
+        {
+            vecmath::detail::transform_points(rows, out.X() + first, out.Y() + first,
+                                              out.Z() + first, count);
+        }
+        else
+        {
+            vecmath::detail::transform_points(rows, in.X() + first, in.Y() + first,
+                                              in.Z() + first, out.X() + first,
+                                              out.Y() + first, out.Z() + first, count);
+        }
+    });
+}
+
+/**
+ * Parallel out[i] = m * in[i] for an array of Vector3<>, using
+ * the Matrix-column Vector operator*. \c in and \c out may be the
+ * same array.
+ */
+template <typename fptype>
+void transform_points(Matrix3<fptype> const& m,
+                      Vector3<fptype> const* in,
+                      Vector3<fptype>* out,
+                      std::size_t n,
+                      thread_pool& pool = default_pool())
+{
+    pool.run(detail::blocks(n, point_block), [&](std::size_t b) {
+        std::size_t const last = std::min(n, (b + 1) * point_block);
+        for (std::size_t i=b*point_block; i<last; ++i)
+        {
+            out[i] = m * in[i];
+        }
+    });
+}
+
+/**
+ * Parallel batch transformation of surface normals.
+ *
+ * Normals are transformed by the inverse transpose of the upper
+ * 3x3 of \c m, which keeps them perpendicular to transformed
+ * surfaces under non-uniform scaling, and are then scaled to unit
+ * length. Translation does not apply to normals.
+ *
+ * \c out is resized to match \c in; \c in and \c out may be the
+ * same array. Throws degenerate_error if \c m is singular.
+ */
+template <typename fptype>
+void transform_normals(Matrix3<fptype> const& m,
+                       Vector3Array<fptype> const& in,
+                       Vector3Array<fptype>& out,
+                       thread_pool& pool = default_pool())
+{
+    fptype a[12];
+    vecmath::detail::top_rows(m, a);
+
+    // The cofactor matrix is det * inverse transpose. Only the
+    // sign of det matters, since the results are normalized.
+    fptype const c[9] = {a[5]*a[10] - a[6]*a[9], a[6]*a[8] - a[4]*a[10], a[4]*a[9] - a[5]*a[8],
+                         a[2]*a[9] - a[1]*a[10], a[0]*a[10] - a[2]*a[8], a[1]*a[8] - a[0]*a[9],
+                         a[1]*a[6] - a[2]*a[5],  a[2]*a[4] - a[0]*a[6],  a[0]*a[5] - a[1]*a[4]};
+    fptype const det = a[0]*c[0] + a[1]*c[1] + a[2]*c[2];
+    if (det == 0)
+    {
+        throw degenerate_error("transform_normals: matrix is singular");
+    }
+
+    fptype const s = (det < 0) ? fptype(-1) : fptype(1);
+    fptype const nm[9] = {s*c[0], s*c[1], s*c[2],
+                          s*c[3], s*c[4], s*c[5],
+                          s*c[6], s*c[7], s*c[8]};
+
+    std::size_t const n = in.size();
+    bool const inplace = (&in == &out);
+    if (!inplace)
+        out.resize(n);
+
+    pool.run(detail::blocks(n, point_block), [&](std::size_t b) {
+        std::size_t const first = b * point_block;
+        std::size_t const count = std::min(point_block, n - first);
+        if (inplace)
+        {
+            detail::transform_normals(nm, out.X() + first, out.Y() + first,
+                                      out.Z() + first, count);
+        }
+        else
+        {
+            detail::transform_normals(nm, in.X() + first, in.Y() + first,
+                                      in.Z() + first, out.X() + first,
+                                      out.Y() + first, out.Z() + first, count);
+        }
+    });
+}
+
+/**
+ * Parallel running composition of a chain of transforms:
+ * out[i] = in[0] * in[1] * ... * in[i].
+ *
+ * Works for any matrix type with an associative operator*, such as
+ * Matrix3<> and AffineMatrix3<>. It is a three-pass scan: each
+ * block's running products in parallel, then the products of
+ * whole blocks in order, then the prefix of the preceding blocks
+ * applied to each block in parallel. The grouping of products
+ * depends only on \c n, so the results are the same for any pool,
+ * though they may differ from a serial left-to-right product in
+ * the last bits.
+ *
+ * \c in and \c out may be the same array.
+ */
+template <typename M>
+void compose_chain(M const* in, M* out, std::size_t n,
+                   thread_pool& pool = default_pool())
+{
+    std::size_t const blocks = detail::blocks(n, matrix_block);
+
+    pool.run(blocks, [&](std::size_t b) {
+        std::size_t const first = b * matrix_block;
+        std::size_t const last = std::min(n, first + matrix_block);
+        out[first] = in[first];
+        for (std::size_t i=first+1; i<last; ++i)
+        {
+            out[i] = out[i-1] * in[i];
+        }
+    });
+
+    if (blocks < 2)
+        return;
+
+    // carry[b] is the product of all of blocks [0, b]; the last
+    // block's is not needed.
+    std::vector<M> carry(blocks - 1);
+    carry[0] = out[matrix_block - 1];
+    for (std::size_t b=1; b+1<blocks; ++b)
+    {
+        carry[b] = carry[b-1] * out[(b + 1) * matrix_block - 1];
+    }
+
+    pool.run(blocks - 1, [&](std::size_t k) {
+        std::size_t const b = k + 1;
+        std::size_t const last = std::min(n, (b + 1) * matrix_block);
+        M const& prefix = carry[b-1];
+        for (std::size_t i=b*matrix_block; i<last; ++i)
+        {
+            out[i] = prefix * out[i];
+        }
+    });
+}
+
+namespace detail {
+
+/*
+ * How compose_hierarchy() splits a hierarchy: the nodes above a
+ * chosen depth, in order, and below them the nodes of each group
+ * of subtrees, in order, group g being
+ * nodes[group[g], group[g+1]). A plan with no groups means the
+ * hierarchy is composed serially.
+ */
+struct hierarchy_plan
+{
+    std::vector<int32_t> top;
+    std::vector<int32_t> nodes;
+    std::vector<std::size_t> group;
+};
+
+/*
+ * The subtrees are those of the nodes at the shallowest depth that
+ * has a few of them for each thread (or at the widest depth), cut
+ * into groups of about equal node counts so that stealing can even
+ * out the rest.
+ */
+inline hierarchy_plan plan_hierarchy(int32_t const* parents, std::size_t n, std::size_t threads)
+{
+    hierarchy_plan plan;
+    std::size_t const want = 4 * threads;
+    if (threads < 2 || n < 2 * matrix_block)
+    {
+        return plan;
+    }
+
+    std::vector<int32_t> depth(n);
+    std::vector<std::size_t> width;
+    for (std::size_t i=0; i<n; ++i)
+    {
+        depth[i] = (parents[i] < 0) ? 0 : depth[parents[i]] + 1;
+        if (static_cast<std::size_t>(depth[i]) == width.size())
+        {
+            width.push_back(0);
+        }
+        ++width[depth[i]];
+    }
+
+    std::size_t level = 0;
+    for (std::size_t d=0; d<width.size(); ++d)
+    {
+        if (width[d] > width[level])
+        {
+            level = d;
+        }
+        if (width[d] >= want)
+        {
+            level = d;
+            break;
+        }
+    }
+
+    // anchor[i] is the subtree root of node i, or -1 above the level
+    std::vector<int32_t>& anchor = depth;
+    std::vector<std::size_t> size(n, 0);
+    int32_t const split = static_cast<int32_t>(level);
+    for (std::size_t i=0; i<n; ++i)
+    {
+        if (depth[i] < split)
+        {
+            plan.top.push_back(static_cast<int32_t>(i));
+            anchor[i] = -1;
+            continue;
+        }
+        anchor[i] = (depth[i] == split) ? static_cast<int32_t>(i) : anchor[parents[i]];
+        ++size[anchor[i]];
+    }
+
+    std::size_t const below = n - plan.top.size();
+    std::size_t groups = std::min(width[level], want);
+    groups = std::min(groups, below / matrix_block);
+    if (groups < 2)
+    {
+        plan.top.clear();
+        return plan;
+    }
+
+    // Consecutive subtrees to each group, then a stable counting
+    // sort of the nodes by group; size[] becomes the group index.
+    plan.group.assign(groups + 1, 0);
+    std::size_t seen = 0;
+    for (std::size_t i=0; i<n; ++i)
+    {
+        if (anchor[i] == static_cast<int32_t>(i))
+        {
+            std::size_t const g = seen * groups / below;
+            seen += size[i];
+            plan.group[g + 1] += size[i];
+            size[i] = g;
+        }
+    }
+    for (std::size_t g=0; g<groups; ++g)
+    {
+        plan.group[g + 1] += plan.group[g];
+    }
+
+    std::vector<std::size_t> fill(plan.group.begin(), plan.group.end() - 1);
+    plan.nodes.resize(below);
+    for (std::size_t i=0; i<n; ++i)
+    {
+        if (anchor[i] >= 0)
+        {
+            plan.nodes[fill[size[anchor[i]]]++] = static_cast<int32_t>(i);
+        }
+    }
+    return plan;
+}
+
+template <typename M>
+void compose_hierarchy(span<int32_t const> parents, span<M const> locals, span<M> out,
+                       thread_pool& pool)
+{
+    VM_STATS_TIMER("compose_hierarchy");
+    vecmath::detail::check_hierarchy(parents, locals.size(), out.size());
+
+    std::size_t const n = out.size();
+    hierarchy_plan const plan = plan_hierarchy(parents.data(), n, pool.size());
+    if (plan.group.empty())
+    {
+        vecmath::detail::compose_nodes(parents.data(), locals.data(), out.data(), nullptr, n);
+        return;
+    }
+
+    vecmath::detail::compose_nodes(parents.data(), locals.data(), out.data(),
+                                   plan.top.data(), plan.top.size());
+    pool.run(plan.group.size() - 1, [&](std::size_t g) {
+        std::size_t const first = plan.group[g];
+        vecmath::detail::compose_nodes(parents.data(), locals.data(), out.data(),
+                                       plan.nodes.data() + first, plan.group[g + 1] - first);
+    });
+}
+
+} // ::detail
+
+/**
+ * Parallel world transforms of a hierarchy, as
+ * vecmath::compose_hierarchy().
+ *
+ * The nodes down to some depth are composed first, then groups of
+ * the subtrees below them in parallel. Each node's product is the
+ * one the serial pass computes, so the results are the same for
+ * any pool. Small hierarchies, and ones too narrow to split, are
+ * composed serially on the calling thread.
+ */
+inline void compose_hierarchy(span<int32_t const> parents, span<Matrix3f const> locals,
+                              span<Matrix3f> out, thread_pool& pool = default_pool())
+{
+    detail::compose_hierarchy(parents, locals, out, pool);
+}
+
+inline void compose_hierarchy(span<int32_t const> parents, span<Matrix3d const> locals,
+                              span<Matrix3d> out, thread_pool& pool = default_pool())
+{
+    detail::compose_hierarchy(parents, locals, out, pool);
+}
+
+namespace detail {
+
+// Runs the blocks of a PointBVH<> build on a pool.
+struct pool_blocks
+{
+    thread_pool& pool;
+
+    template <typename Fn>
+    void operator()(std::size_t blocks, Fn const& fn) const
+    {
+        pool.run(blocks, fn);
+    }
+};
+
+} // ::detail
+
+/**
+ * Build \c bvh over \c pts on a pool, as PointBVH<>::build(). The
+ * Morton codes, the gathering of the points and the subtrees of up
+ * to 65536 points are spread over the threads; the sort and the few
+ * nodes above the subtrees are serial. The tree is the same as the
+ * serial build's.
+ */
+inline void build_bvh(span<Vector3f const> pts, PointBVHf& bvh, thread_pool& pool = default_pool())
+{
+    bvh.build_blocks(vecmath::detail::aos_points<float>{pts.data(), pts.size()}, detail::pool_blocks{pool});
+}
+
+inline void build_bvh(span<Vector3d const> pts, PointBVHd& bvh, thread_pool& pool = default_pool())
+{
+    bvh.build_blocks(vecmath::detail::aos_points<double>{pts.data(), pts.size()}, detail::pool_blocks{pool});
+}
+
+template <typename fptype>
+void build_bvh(Vector3Array<fptype> const& pts, PointBVH<fptype>& bvh, thread_pool& pool = default_pool())
+{
+    bvh.build_blocks(vecmath::detail::soa_points<fptype>{&pts}, detail::pool_blocks{pool});
+}
+
+} // ::parallel
+} // ::vecmath
+
+#endif // VM_VECPARALLEL_H
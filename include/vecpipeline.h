@@ -0,0 +1,247 @@
+/*
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/*
+ * Pipelined chunk processing
+ *
+ * run_pipeline() passes a sequence of chunks through three stages,
+ * load, compute and store, each on its own thread, so that while
+ * one chunk is computed the next is loaded and the one before is
+ * stored. The chunks go through a ring of a fixed number of slots;
+ * a chunk's slot is reused only after it has been stored, which
+ * bounds the memory used whatever the number of chunks.
+ *
+ * parallel::transform_file() is the file transform of vecfile.h
+ * built on it, with each chunk transformed on a thread_pool.
+ *
+ * Programs using this header must link with the platform thread
+ * library (-pthread, or Threads::Threads in CMake).
+ */
+#ifndef VM_VECPIPELINE_H
+#define VM_VECPIPELINE_H
+
+#include "vecmath.h"
+#include "vecarray.h"
+#include "vecfile.h"
+#include "vecparallel.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace vecmath {
+namespace parallel {
+
+namespace detail {
+
+/*
+ * The progress of the three stages of run_pipeline(): each takes
+ * the chunks in order, and waits until the stage before has
+ * finished the chunk, or for load, until its slot has been stored.
+ */
+class pipeline_ring
+{
+  private:
+    std::mutex m_mutex;
+    std::condition_variable m_changed;
+    std::size_t const m_depth;
+    std::size_t m_done[3] = {};             // chunks finished, per stage
+    std::exception_ptr m_error;
+
+    bool ready(std::size_t stage, std::size_t k) const
+    {
+        if (stage == 0)
+        {
+            return k < m_done[2] + m_depth;
+        }
+        return k < m_done[stage - 1];
+    }
+
+  public:
+    explicit pipeline_ring(std::size_t depth)
+        : m_depth(depth)
+    { }
+
+    /* Record the first failure, and stop every stage. */
+    void fail(std::exception_ptr e)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_error)
+            {
+                m_error = e;
+            }
+        }
+        m_changed.notify_all();
+    }
+
+    std::exception_ptr error()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_error;
+    }
+
+    /* Call fn(k, slot) for chunks [0, chunks) as stage \c stage. */
+    template <typename Fn>
+    void stage(std::size_t stage, std::size_t chunks, Fn& fn)
+    {
+        for (std::size_t k=0; k<chunks; ++k)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_changed.wait(lock, [&] { return m_error || ready(stage, k); });
+                if (m_error)
+                {
+                    return;
+                }
+            }
+
+            try
+            {
+                fn(k, k % m_depth);
+            }
+            catch (...)
+            {
+                fail(std::current_exception());
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                ++m_done[stage];
+            }
+            m_changed.notify_all();
+        }
+    }
+};
+
+} // ::detail
+
+/**
+ * Process \c chunks chunks through the stages \c load, \c compute
+ * and \c store, each called as fn(k, slot) for every chunk k in
+ * order. Load and store run on threads of their own and compute on
+ * the calling thread, which may hand it on to a thread_pool.
+ *
+ * \c slot is k % depth, the index of the buffers the chunk uses
+ * from its load until its store. A depth of 3 lets all three
+ * stages run at once; more absorbs chunks of uneven cost. If a
+ * stage throws, the others stop at their next chunk and the first
+ * exception is rethrown here.
+ */
+template <typename Load, typename Compute, typename Store>
+void run_pipeline(std::size_t chunks, std::size_t depth,
+                  Load load, Compute compute, Store store)
+{
+    if (chunks == 0)
+    {
+        return;
+    }
+    detail::pipeline_ring ring(depth == 0 ? 1 : depth);
+
+    std::thread loader([&] { ring.stage(0, chunks, load); });
+    std::thread storer;
+    try
+    {
+        storer = std::thread([&] { ring.stage(2, chunks, store); });
+    }
+    catch (...)
+    {
+        ring.fail(std::current_exception());
+        loader.join();
+        throw;
+    }
+
+    ring.stage(1, chunks, compute);
+    loader.join();
+    storer.join();
+
+    std::exception_ptr const error = ring.error();
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+/**
+ * Transform every point of the file \c in_path by \c m, writing a
+ * file of the same format to \c out_path, as vecmath::transform_file()
+ * does and with the same result.
+ *
+ * The file is processed \c chunk points at a time through
+ * run_pipeline() with \c depth slots, so the next chunk is read and
+ * the previous one written while the current one is decoded,
+ * transformed on \c pool and encoded. The memory used is about
+ * \c depth chunks of points whatever the file size.
+ *
+ * The two paths must name different files. Throws file_error on
+ * failure, or if \c in_path does not hold points.
+ */
+template <typename fptype>
+void transform_file(std::string const& in_path, std::string const& out_path,
+                    Matrix3<fptype> const& m, thread_pool& pool = default_pool(),
+                    std::size_t chunk = 1 << 16, std::size_t depth = 3)
+{
+    VM_STATS_TIMER("transform_file");
+    vecmath::detail::stdio_file in(in_path, "rb");
+    file_header h;
+    uint64_t const data_bytes = vecmath::detail::read_points_header(in, in_path, h);
+
+    vecmath::detail::stdio_file out(out_path, "wb");
+    vecmath::detail::write_header(out, h, data_bytes);
+
+    vecmath::detail::point_chunks const io(h);
+    std::size_t const n = static_cast<std::size_t>(h.count);
+    if (chunk == 0)
+    {
+        chunk = 1;
+    }
+    if (depth == 0)
+    {
+        depth = 1;
+    }
+
+    // The buffers of one chunk, from its read to its write
+    struct slot
+    {
+        std::vector<char> raw;
+        std::vector<char> outraw;
+        std::vector<float> tmp;
+        Vector3Array<fptype> points;
+    };
+    std::vector<slot> slots(depth);
+
+    auto count = [&](std::size_t k) {
+        return std::min(chunk, n - k * chunk);
+    };
+
+    run_pipeline(detail::blocks(n, chunk), depth,
+        [&](std::size_t k, std::size_t s) {
+            io.read(in, k * chunk, count(k), slots[s].raw);
+        },
+        [&](std::size_t k, std::size_t s) {
+            slot& b = slots[s];
+            io.decode(b.raw, count(k), b.points, b.tmp);
+            transform_points(m, b.points, b.points, pool);
+            io.encode(b.points, b.outraw, b.tmp);
+        },
+        [&](std::size_t k, std::size_t s) {
+            io.write_raw(out, k * chunk, count(k), slots[s].outraw);
+        });
+    out.close();
+}
+
+} // ::parallel
+} // ::vecmath
+
+#endif // VM_VECPIPELINE_H
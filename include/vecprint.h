@@ -7,10 +7,80 @@
  */
 /*
  * Printing utility functions
+ *
+ * On a stream with the "C" locale, the usual case, the values are
+ * formatted with to_chars() into one buffer and written at once;
+ * the text is the same as the stream's own std::fixed output. For
+ * bulk dumps see write_text() in vectext.h.
  */
 #ifndef VM_VECPRINT_H
 #define VM_VECPRINT_H
 
+#include "vecchars.h"
+
+#include <locale>
+
+namespace vecmath {
+namespace detail {
+
+// Whether os would format fixed numbers as to_chars() does, with
+// no field width, which would pad the opening bracket.
+inline bool plain_stream(std::ostream& os)
+{
+    return !(os.flags() & (std::ios::showpos | std::ios::uppercase)) &&
+           os.width() == 0 && os.getloc() == std::locale::classic();
+}
+
+template <typename fptype>
+int print_precision()
+{
+    return (sizeof(fptype) == 4) ? 5 : 8;
+}
+
+// \c open, the 4 values separated by ", ", and \c close.
+template <typename fptype>
+char* print_row(char* p, char const* open, fptype const* v, char const* close)
+{
+    int const prec = print_precision<fptype>();
+    std::size_t const lo = std::strlen(open), lc = std::strlen(close);
+    std::memcpy(p, open, lo);
+    p += lo;
+    for (int i=0; i<4; ++i)
+    {
+        if (i)
+        {
+            *p++ = ',';
+            *p++ = ' ';
+        }
+        p = format_fixed(p, v[i], prec);
+    }
+    std::memcpy(p, close, lc);
+    return p + lc;
+}
+
+// Room for print_row(), n times.
+template <typename fptype>
+constexpr std::size_t print_row_size(std::size_t n)
+{
+    return n * (4 * (max_fixed_chars<fptype>(8) + 2) + 4);
+}
+
+/*
+ * Write buf[0, end), leaving the stream's precision and float field
+ * as operator<< always has.
+ */
+template <typename fptype>
+std::ostream& print_text(std::ostream& os, char const* buf, char const* end)
+{
+    os.write(buf, end - buf);
+    os.precision(print_precision<fptype>());
+    os.unsetf(std::ios::floatfield);
+    return os;
+}
+
+} // ::detail
+} // ::vecmath
+
 // NOT in ::vecmath namespace
 
 /**
@@ -26,7 +96,13 @@
 template <typename fptype>
 std::ostream& operator<<(std::ostream &os, vecmath::Vector3<fptype> const& v)
 {
-    int const prec = (sizeof(fptype) == 4) ? 5 : 8;
+    if (vecmath::detail::plain_stream(os))
+    {
+        char buf[vecmath::detail::print_row_size<fptype>(1)];
+        char* const end = vecmath::detail::print_row(buf, "[", v.data(), "]");
+        return vecmath::detail::print_text<fptype>(os, buf, end);
+    }
+    int const prec = vecmath::detail::print_precision<fptype>();
     os << std::fixed << std::setprecision(prec)
        << '[' << v.X() << ", " << v.Y() << ", " << v.Z() << ", " << v.W() << "]"
        << std::defaultfloat;
@@ -36,12 +112,44 @@ std::ostream& operator<<(std::ostream &os, vecmath::Vector3<fptype> const& v)
 template <typename fptype>
 std::ostream& operator<<(std::ostream &os, vecmath::Matrix3<fptype> const& m)
 {
-    int const prec = (sizeof(fptype) == 4) ? 5 : 8;
+    if (vecmath::detail::plain_stream(os))
+    {
+        char buf[vecmath::detail::print_row_size<fptype>(4)];
+        char* p = vecmath::detail::print_row(buf, "[[", m.data(), "],\n");
+        p = vecmath::detail::print_row(p, " [", m.data() + 4, "],\n");
+        p = vecmath::detail::print_row(p, " [", m.data() + 8, "],\n");
+        p = vecmath::detail::print_row(p, " [", m.data() + 12, "]]\n");
+        return vecmath::detail::print_text<fptype>(os, buf, p);
+    }
+    int const prec = vecmath::detail::print_precision<fptype>();
+    os << std::fixed << std::setprecision(prec)
+       << "[[" << m(0,0) << ", " << m(0,1) << ", " << m(0,2) << ", " << m(0,3) << "],\n"
+       << " [" << m(1,0) << ", " << m(1,1) << ", " << m(1,2) << ", " << m(1,3) << "],\n"
+       << " [" << m(2,0) << ", " << m(2,1) << ", " << m(2,2) << ", " << m(2,3) << "],\n"
+       << " [" << m(3,0) << ", " << m(3,1) << ", " << m(3,2) << ", " << m(3,3) << "]]\n"
+       << std::defaultfloat;
+    return os;
+}
+
+template <typename fptype>
+std::ostream& operator<<(std::ostream &os, vecmath::AffineMatrix3<fptype> const& m)
+{
+    return os << vecmath::Matrix3<fptype>(m);
+}
+
+template <typename fptype>
+std::ostream& operator<<(std::ostream &os, vecmath::Quaternion<fptype> const& q)
+{
+    if (vecmath::detail::plain_stream(os))
+    {
+        fptype const v[4] = {q.W(), q.X(), q.Y(), q.Z()};
+        char buf[vecmath::detail::print_row_size<fptype>(1)];
+        char* const end = vecmath::detail::print_row(buf, "[", v, "]");
+        return vecmath::detail::print_text<fptype>(os, buf, end);
+    }
+    int const prec = vecmath::detail::print_precision<fptype>();
     os << std::fixed << std::setprecision(prec)
-       << "[[" << m.get(0,0) << ", " << m.get(0,1) << ", " << m.get(0,2) << ", " << m.get(0,3) << "],\n"
-       << " [" << m.get(1,0) << ", " << m.get(1,1) << ", " << m.get(1,2) << ", " << m.get(1,3) << "],\n"
-       << " [" << m.get(2,0) << ", " << m.get(2,1) << ", " << m.get(2,2) << ", " << m.get(2,3) << "],\n"
-       << " [" << m.get(3,0) << ", " << m.get(3,1) << ", " << m.get(3,2) << ", " << m.get(3,3) << "]]\n"
+       << '[' << q.W() << ", " << q.X() << ", " << q.Y() << ", " << q.Z() << "]"
        << std::defaultfloat;
     return os;
 }
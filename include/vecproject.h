@@ -0,0 +1,238 @@
+/*
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/*
+ * Projection of points with the homogeneous divide
+ *
+ * project_points() transforms points by a projection matrix, divides
+ * by the resulting W and tests against the clip volume in one pass:
+ *
+ *     Matrix3f const mvp = projection * view * model;
+ *     std::vector<uint8_t> clip(points.size());
+ *     project_points(mvp, points, ndc, clip);
+ *
+ * The AoS forms use the W of each Vector3<> and store 1/w in the W
+ * of the result, for perspective-correct interpolation; the SoA
+ * forms take W = 1 and keep X, Y and Z. Float batches go through
+ * the SIMD kernels selected at runtime (see vecsimd.h), double
+ * batches through the scalar kernels.
+ *
+ * The clip codes are tested before the divide, against the OpenGL
+ * clip volume -w <= x, y, z <= w that Frustum<>::from_matrix()
+ * uses. The precision::approx and precision::refined policies
+ * replace the divide by the hardware reciprocal estimate with
+ * Newton-Raphson refinement, to within a few units in the last
+ * place; with VECMATH_DETERMINISTIC every policy divides.
+ */
+#ifndef VM_VECPROJECT_H
+#define VM_VECPROJECT_H
+
+#include "vecmath.h"
+#include "vecarray.h"
+#include "vecsimd.h"
+#include "vecspan.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace vecmath {
+
+/**
+ * Bits of a clip code, each set when the point is outside one
+ * plane of the clip volume. A point inside has a code of 0.
+ */
+enum clip_bits : uint8_t
+{
+    clip_left   = 0x01,                     // x < -w
+    clip_right  = 0x02,                     // x > w
+    clip_bottom = 0x04,                     // y < -w
+    clip_top    = 0x08,                     // y > w
+    clip_near   = 0x10,                     // z < -w, or w <= 0
+    clip_far    = 0x20                      // z > w
+};
+
+namespace detail {
+
+template <typename Precision>
+struct fast_reciprocal
+{
+    static constexpr bool value = true;
+};
+
+template <>
+struct fast_reciprocal<precision::exact>
+{
+    static constexpr bool value = false;
+};
+
+/*
+ * The kernels for each precision: the runtime-selected SIMD kernels
+ * for float, the scalar ones for double.
+ */
+template <typename fptype>
+struct project_kernels;
+
+template <>
+struct project_kernels<float>
+{
+    static void aos(float* r, uint8_t* clip, float const* m, float const* v, bool fast,
+                    std::size_t n)
+    {
+        simd::active().project_n(r, clip, m, v, fast, n);
+    }
+    static void soa(float* const* r, uint8_t* clip, float const* m, float const* const* v,
+                    bool fast, std::size_t n)
+    {
+        simd::active().project_soa_n(r, clip, m, v, fast, n);
+    }
+};
+
+template <>
+struct project_kernels<double>
+{
+    static void aos(double* r, uint8_t* clip, double const* m, double const* v, bool fast,
+                    std::size_t n)
+    {
+        simd::scalar::project_n(r, clip, m, v, fast, n);
+    }
+    static void soa(double* const* r, uint8_t* clip, double const* m, double const* const* v,
+                    bool fast, std::size_t n)
+    {
+        simd::scalar::project_soa_n(r, clip, m, v, fast, n);
+    }
+};
+
+inline std::size_t count_inside(uint8_t const* clip, std::size_t n)
+{
+    std::size_t count = 0;
+    for (std::size_t i=0; i<n; ++i)
+    {
+        count += (clip[i] == 0);
+    }
+    return count;
+}
+
+template <typename Precision, typename fptype>
+void project_points(Matrix3<fptype> const& m, span<Vector3<fptype> const> in,
+                    span<Vector3<fptype>> out, uint8_t* clip)
+{
+    std::size_t const n = in.size();
+    if (out.size() != n)
+    {
+        throw index_error("project_points(): sizes differ");
+    }
+    project_kernels<fptype>::aos(as_scalars(out.data(), n).data(), clip, m.data(),
+                                 as_scalars(in.data(), n).data(),
+                                 fast_reciprocal<Precision>::value, n);
+}
+
+template <typename Precision, typename fptype>
+void project_points(Matrix3<fptype> const& m, Vector3Array<fptype> const& in,
+                    Vector3Array<fptype>& out, uint8_t* clip)
+{
+    std::size_t const n = in.size();
+    if (&in != &out)
+    {
+        out.resize(n);
+    }
+    fptype const* const v[3] = {in.X(), in.Y(), in.Z()};
+    fptype* const r[3] = {out.X(), out.Y(), out.Z()};
+    project_kernels<fptype>::soa(r, clip, m.data(), v, fast_reciprocal<Precision>::value, n);
+}
+
+} // ::detail
+
+/**
+ * out[i] = m * in[i] divided by its W, with 1/w stored in W. \c out
+ * must have in.size() elements, or index_error is thrown; it may be
+ * \c in. A point with w = 0 comes out infinite or NaN.
+ */
+template <typename Precision = precision::exact>
+void project_points(Matrix3f const& m, span<Vector3f const> in, span<Vector3f> out)
+{
+    detail::project_points<Precision>(m, in, out, nullptr);
+}
+
+template <typename Precision = precision::exact>
+void project_points(Matrix3d const& m, span<Vector3d const> in, span<Vector3d> out)
+{
+    detail::project_points<Precision>(m, in, out, nullptr);
+}
+
+/**
+ * As above, and set clip[i] to the clip code of point i. Returns the
+ * number of points inside the clip volume. \c clip must have
+ * in.size() elements, or index_error is thrown.
+ */
+template <typename Precision = precision::exact>
+std::size_t project_points(Matrix3f const& m, span<Vector3f const> in, span<Vector3f> out,
+                           span<uint8_t> clip)
+{
+    if (clip.size() != in.size())
+    {
+        throw index_error("project_points(): sizes differ");
+    }
+    detail::project_points<Precision>(m, in, out, clip.data());
+    return detail::count_inside(clip.data(), clip.size());
+}
+
+template <typename Precision = precision::exact>
+std::size_t project_points(Matrix3d const& m, span<Vector3d const> in, span<Vector3d> out,
+                           span<uint8_t> clip)
+{
+    if (clip.size() != in.size())
+    {
+        throw index_error("project_points(): sizes differ");
+    }
+    detail::project_points<Precision>(m, in, out, clip.data());
+    return detail::count_inside(clip.data(), clip.size());
+}
+
+/**
+ * The same for points stored as a structure of arrays, each with
+ * W = 1. \c out is resized to match \c in; \c in and \c out may be
+ * the same array.
+ */
+template <typename Precision = precision::exact>
+void project_points(Matrix3f const& m, Vector3Arrayf const& in, Vector3Arrayf& out)
+{
+    detail::project_points<Precision>(m, in, out, nullptr);
+}
+
+template <typename Precision = precision::exact>
+void project_points(Matrix3d const& m, Vector3Arrayd const& in, Vector3Arrayd& out)
+{
+    detail::project_points<Precision>(m, in, out, nullptr);
+}
+
+template <typename Precision = precision::exact>
+std::size_t project_points(Matrix3f const& m, Vector3Arrayf const& in, Vector3Arrayf& out,
+                           span<uint8_t> clip)
+{
+    if (clip.size() != in.size())
+    {
+        throw index_error("project_points(): sizes differ");
+    }
+    detail::project_points<Precision>(m, in, out, clip.data());
+    return detail::count_inside(clip.data(), clip.size());
+}
+
+template <typename Precision = precision::exact>
+std::size_t project_points(Matrix3d const& m, Vector3Arrayd const& in, Vector3Arrayd& out,
+                           span<uint8_t> clip)
+{
+    if (clip.size() != in.size())
+    {
+        throw index_error("project_points(): sizes differ");
+    }
+    detail::project_points<Precision>(m, in, out, clip.data());
+    return detail::count_inside(clip.data(), clip.size());
+}
+
+} // ::vecmath
+
+#endif // VM_VECPROJECT_H
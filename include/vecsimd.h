@@ -0,0 +1,761 @@
+/*
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/*
+ * Runtime-dispatched SIMD backend for Matrix3f and Vector3f
+ */
+#ifndef VM_VECSIMD_H
+#define VM_VECSIMD_H
+
+#include "vecmath.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>                          // std::getenv()
+#include <cstring>                          // std::strcmp()
+#include <limits>
+#include <type_traits>
+
+/*
+ * The x86 kernels are compiled with per-function target attributes,
+ * so one binary carries every variant and picks one from CPUID at
+ * runtime. AArch64 always has NEON.
+ */
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#  define VM_SIMD_X86 1
+#  define VM_TARGET_SSE    __attribute__((target("sse2")))
+#  define VM_TARGET_AVX2   __attribute__((target("avx2,fma")))
+#  define VM_TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#  define VM_SIMD_NEON 1
+#endif
+
+namespace vecmath {
+namespace simd {
+
+/**
+ * Instruction sets with a kernel implementation.
+ */
+enum class isa
+{
+    scalar,
+    sse,                                    // SSE2
+    avx2,                                   // AVX2 + FMA
+    avx512,                                 // AVX-512F
+    neon                                    // AArch64 Advanced SIMD
+};
+
+/**
+ * A table of float kernels for one instruction set.
+ *
+ * Matrices are 16 floats in row-major order, vectors are 4 floats
+ * (X, Y, Z, W); this is the layout of Matrix3f and Vector3f.
+ * Results may alias the inputs.
+ */
+struct kernels
+{
+    isa id;
+    char const* name;
+
+    void (*mm_mult)(float* r, float const* a, float const* b);   // r = a * b
+    void (*vm_mult)(float* r, float const* v, float const* m);   // r = v * m
+    void (*mv_mult)(float* r, float const* m, float const* v);   // r = m * v
+    void (*mv_mult_n)(float* r, float const* m, float const* v,  // r[i] = m * v[i]
+                      std::size_t n);
+
+    // Batches over n vectors. Vector results have W = 1 and may
+    // alias the inputs.
+    void (*dot_n)(float* r, float const* a, float const* b,      // r[i] = a[i] . b[i]
+                  std::size_t n);
+    void (*cross_n)(float* r, float const* a, float const* b,    // r[i] = a[i] x b[i]
+                    std::size_t n);
+    void (*length_n)(float* r, float const* v, std::size_t n);   // r[i] = |v[i]|
+    void (*normalize_n)(float* r, float const* v, std::size_t n); // r[i] = v[i] / |v[i]|
+    void (*add_n)(float* r, float const* a, float const* b,      // r[i] = a[i] + b[i]
+                  std::size_t n);
+    void (*sub_n)(float* r, float const* a, float const* b,      // r[i] = a[i] - b[i]
+                  std::size_t n);
+    void (*scale_n)(float* r, float const* v, float s,           // r[i] = v[i] * s
+                    std::size_t n);
+
+    // The same on separate X, Y and Z arrays, for the operations
+    // whose square root keeps plain loops from vectorizing.
+    void (*length_soa_n)(float* r, float const* x, float const* y,
+                         float const* z, std::size_t n);
+    void (*normalize_soa_n)(float* rx, float* ry, float* rz, float const* x,
+                            float const* y, float const* z, std::size_t n);
+
+    // Transform hierarchies. For k < n, node i = node[k] (or k, if
+    // node is null) gets world[i] = world[parent[i]] * local[i], or
+    // local[i] if parent[i] < 0. A parent must come before its
+    // children in that order. world may be local.
+    void (*compose_n)(float* world, float const* local, int32_t const* parent,
+                      int32_t const* node, std::size_t n);
+
+    // Ray intersection on separate component arrays; see
+    // scalar::ray_triangles_n().
+    void (*ray_triangles_n)(float* t, uint8_t* hit, float const* ray,   // one ray, n triangles
+                            float const* const* tri, float eps, std::size_t n);
+    void (*rays_plane_n)(float* t, uint8_t* hit, float const* const* rays,  // n rays, one plane
+                         float const* plane, float eps, std::size_t n);
+
+    // Bounding boxes; see scalar::bounds_n() and cull_boxes_n().
+    void (*bounds_n)(float* lo, float* hi, float const* v, std::size_t n);
+    void (*bounds_soa_n)(float* lo, float* hi, float const* x, float const* y,
+                         float const* z, std::size_t n);
+    void (*cull_boxes_n)(uint8_t* visible, float const* planes, float const* const* box,
+                         std::size_t n);
+
+    // Projection with the homogeneous divide; see scalar::project_n().
+    void (*project_n)(float* r, uint8_t* clip, float const* m, float const* v,
+                      bool fast, std::size_t n);
+    void (*project_soa_n)(float* const* r, uint8_t* clip, float const* m,
+                          float const* const* v, bool fast, std::size_t n);
+};
+
+/*
+ * compose_n() helpers: the k-th node computed, and a prefetch of
+ * the matrices a later node reads, since with a node list (or a
+ * shallow, wide tree) they are far from the ones just written.
+ */
+inline std::size_t node_at(int32_t const* node, std::size_t k)
+{
+    return node ? static_cast<std::size_t>(node[k]) : k;
+}
+
+std::size_t const prefetch_nodes = 4;       // how many nodes ahead
+
+template <typename T>
+inline void prefetch_node(T const* world, T const* local, int32_t const* parent,
+                          int32_t const* node, std::size_t k, std::size_t n)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    if (k + prefetch_nodes < n)
+    {
+        std::size_t const i = node_at(node, k + prefetch_nodes);
+        __builtin_prefetch(local + 16*i);
+        if (parent[i] >= 0)
+        {
+            __builtin_prefetch(world + 16*parent[i]);
+        }
+    }
+#else
+    (void) world; (void) local; (void) parent; (void) node; (void) k; (void) n;
+#endif
+}
+
+namespace scalar {
+
+inline void mm_mult(float* r, float const* a, float const* b)
+{
+    float t[16];
+    for (int i=0; i<16; i+=4)
+    {
+        for (int j=0; j<4; ++j)
+        {
+            t[i+j] = (a[i+0]*b[0+j] + a[i+1]*b[4+j] + a[i+2]*b[8+j] + a[i+3]*b[12+j]);
+        }
+    }
+    std::memcpy(r, t, sizeof(t));
+}
+
+inline void vm_mult(float* r, float const* v, float const* m)
+{
+    float t[4];
+    for (int j=0; j<4; ++j)
+    {
+        t[j] = (v[0]*m[0+j] + v[1]*m[4+j] + v[2]*m[8+j] + v[3]*m[12+j]);
+    }
+    std::memcpy(r, t, sizeof(t));
+}
+
+inline void mv_mult_n(float* r, float const* m, float const* v, std::size_t n)
+{
+    for (std::size_t k=0; k<n; ++k, v+=4, r+=4)
+    {
+        float t[4];
+        for (int i=0; i<4; ++i)
+        {
+            t[i] = (v[0]*m[4*i+0] + v[1]*m[4*i+1] + v[2]*m[4*i+2] + v[3]*m[4*i+3]);
+        }
+        std::memcpy(r, t, sizeof(t));
+    }
+}
+
+inline void mv_mult(float* r, float const* m, float const* v)
+{
+    mv_mult_n(r, m, v, 1);
+}
+
+/*
+ * The batch kernels are templates so that vecbatch.h can use them
+ * for double as well. They take the same steps as dot(), cross()
+ * and Vector3<>::fast_normalize<precision::exact>(). The SSE and
+ * NEON kernels round the same way; AVX2 and AVX-512 use FMA, except
+ * with VECMATH_DETERMINISTIC.
+ */
+template <typename T>
+inline void dot_n(T* r, T const* a, T const* b, std::size_t n)
+{
+    for (std::size_t i=0; i<n; ++i, a+=4, b+=4)
+    {
+        r[i] = (a[0]*b[0] + a[1]*b[1] + a[2]*b[2]);
+    }
+}
+
+template <typename T>
+inline void cross_n(T* r, T const* a, T const* b, std::size_t n)
+{
+    for (std::size_t i=0; i<n; ++i, a+=4, b+=4, r+=4)
+    {
+        T const x = a[1]*b[2] - a[2]*b[1];
+        T const y = a[2]*b[0] - a[0]*b[2];
+        T const z = a[0]*b[1] - a[1]*b[0];
+        r[0] = x;
+        r[1] = y;
+        r[2] = z;
+        r[3] = 1;
+    }
+}
+
+template <typename T>
+inline void length_n(T* r, T const* v, std::size_t n)
+{
+    for (std::size_t i=0; i<n; ++i, v+=4)
+    {
+        r[i] = std::sqrt(v[0]*v[0] + v[1]*v[1] + v[2]*v[2]);
+    }
+}
+
+// A zero vector stays zero, as with fast_normalize().
+template <typename T>
+inline void normalize_n(T* r, T const* v, std::size_t n)
+{
+    for (std::size_t i=0; i<n; ++i, v+=4, r+=4)
+    {
+        T const d = v[0]*v[0] + v[1]*v[1] + v[2]*v[2];
+        T const inv = 1 / std::sqrt(d + std::numeric_limits<T>::min());
+        r[0] = v[0] * inv;
+        r[1] = v[1] * inv;
+        r[2] = v[2] * inv;
+        r[3] = 1;
+    }
+}
+
+template <typename T>
+inline void length_soa_n(T* r, T const* x, T const* y, T const* z, std::size_t n)
+{
+    for (std::size_t i=0; i<n; ++i)
+    {
+        r[i] = std::sqrt(x[i]*x[i] + y[i]*y[i] + z[i]*z[i]);
+    }
+}
+
+template <typename T>
+inline void normalize_soa_n(T* rx, T* ry, T* rz, T const* x, T const* y, T const* z,
+                            std::size_t n)
+{
+    for (std::size_t i=0; i<n; ++i)
+    {
+        T const d = x[i]*x[i] + y[i]*y[i] + z[i]*z[i];
+        T const inv = 1 / std::sqrt(d + std::numeric_limits<T>::min());
+        T const vx = x[i], vy = y[i], vz = z[i];
+        rx[i] = vx * inv;
+        ry[i] = vy * inv;
+        rz[i] = vz * inv;
+    }
+}
+
+template <typename T>
+inline void add_n(T* r, T const* a, T const* b, std::size_t n)
+{
+    for (std::size_t i=0; i<n; ++i, a+=4, b+=4, r+=4)
+    {
+        r[0] = a[0] + b[0];
+        r[1] = a[1] + b[1];
+        r[2] = a[2] + b[2];
+        r[3] = 1;
+    }
+}
+
+template <typename T>
+inline void sub_n(T* r, T const* a, T const* b, std::size_t n)
+{
+    for (std::size_t i=0; i<n; ++i, a+=4, b+=4, r+=4)
+    {
+        r[0] = a[0] - b[0];
+        r[1] = a[1] - b[1];
+        r[2] = a[2] - b[2];
+        r[3] = 1;
+    }
+}
+
+template <typename T>
+inline void scale_n(T* r, T const* v, T s, std::size_t n)
+{
+    for (std::size_t i=0; i<n; ++i, v+=4, r+=4)
+    {
+        r[0] = v[0] * s;
+        r[1] = v[1] * s;
+        r[2] = v[2] * s;
+        r[3] = 1;
+    }
+}
+
+// A template, like the batch kernels, for double hierarchies.
+template <typename T>
+inline void compose_n(T* world, T const* local, int32_t const* parent,
+                      int32_t const* node, std::size_t n)
+{
+    for (std::size_t k=0; k<n; ++k)
+    {
+        prefetch_node(world, local, parent, node, k, n);
+        std::size_t const i = node_at(node, k);
+        T const* b = local + 16*i;
+        if (parent[i] < 0)
+        {
+            std::memmove(world + 16*i, b, 16*sizeof(T));
+            continue;
+        }
+
+        T const* a = world + 16*parent[i];
+        T t[16];
+        for (int r=0; r<16; r+=4)
+        {
+            for (int j=0; j<4; ++j)
+            {
+                t[r+j] = (a[r+0]*b[0+j] + a[r+1]*b[4+j] + a[r+2]*b[8+j] + a[r+3]*b[12+j]);
+            }
+        }
+        std::memcpy(world + 16*i, t, sizeof(t));
+    }
+}
+
+/*
+ * Ray intersection kernels, on arrays of separate components.
+ *
+ * Triangles are nine arrays, tri[0..8]: the x, y and z of a vertex
+ * v0, then of the edges e1 = v1 - v0 and e2 = v2 - v0. A ray is
+ * ray[0..5], its origin and direction, and n rays are six arrays in
+ * the same order. A plane is plane[0..3], the points p with
+ * (plane[0], plane[1], plane[2]) . p = plane[3].
+ *
+ * A hit sets t[i] to the distance along the direction, in units of
+ * its length, and hit[i] to 1; a miss sets infinity and 0. Hits are
+ * at t >= 0, and a ray parallel to its target misses: the
+ * determinant (or n . direction) must not be fpequal() to zero with
+ * EPS \c eps. Triangles are Moller-Trumbore, both sides, with the
+ * edges included. The SSE and NEON kernels round as these do; AVX2
+ * and AVX-512 use FMA, except with VECMATH_DETERMINISTIC, so hits
+ * within rounding of an edge may differ.
+ */
+template <typename T>
+inline void ray_triangles_n(T* t, uint8_t* hit, T const* ray, T const* const* tri, T eps,
+                            std::size_t n)
+{
+    T const ox = ray[0], oy = ray[1], oz = ray[2];
+    T const dx = ray[3], dy = ray[4], dz = ray[5];
+    for (std::size_t i=0; i<n; ++i)
+    {
+        T const e1x = tri[3][i], e1y = tri[4][i], e1z = tri[5][i];
+        T const e2x = tri[6][i], e2y = tri[7][i], e2z = tri[8][i];
+        T const px = dy*e2z - dz*e2y;
+        T const py = dz*e2x - dx*e2z;
+        T const pz = dx*e2y - dy*e2x;
+        T const det = (e1x*px + e1y*py + e1z*pz);
+        T const inv = 1 / det;
+        T const sx = ox - tri[0][i], sy = oy - tri[1][i], sz = oz - tri[2][i];
+        T const u = (sx*px + sy*py + sz*pz) * inv;
+        T const qx = sy*e1z - sz*e1y;
+        T const qy = sz*e1x - sx*e1z;
+        T const qz = sx*e1y - sy*e1x;
+        T const v = (dx*qx + dy*qy + dz*qz) * inv;
+        T const d = (e2x*qx + e2y*qy + e2z*qz) * inv;
+        bool const ok = std::abs(det) >= eps && u >= 0 && v >= 0 && u + v <= 1 && d >= 0;
+        t[i] = ok ? d : std::numeric_limits<T>::infinity();
+        hit[i] = ok;
+    }
+}
+
+template <typename T>
+inline void rays_plane_n(T* t, uint8_t* hit, T const* const* rays, T const* plane, T eps,
+                         std::size_t n)
+{
+    T const nx = plane[0], ny = plane[1], nz = plane[2], offset = plane[3];
+    for (std::size_t i=0; i<n; ++i)
+    {
+        T const denom = (nx*rays[3][i] + ny*rays[4][i] + nz*rays[5][i]);
+        T const d = (offset - (nx*rays[0][i] + ny*rays[1][i] + nz*rays[2][i])) / denom;
+        bool const ok = std::abs(denom) >= eps && d >= 0;
+        t[i] = ok ? d : std::numeric_limits<T>::infinity();
+        hit[i] = ok;
+    }
+}
+
+/*
+ * Bounding box kernels.
+ *
+ * bounds_n() grows the box lo[0..2], hi[0..2] to hold n vectors of
+ * four values (W is ignored), and bounds_soa_n() n points on
+ * separate arrays; start from lo = +inf and hi = -inf for the bounds
+ * of the points alone. The points must not be NaN.
+ *
+ * cull_boxes_n() sets visible[i] to whether box i, six arrays
+ * box[0..5] holding the x, y and z of its low corner then of its
+ * high one, is on the inner side of all six planes[0..23] (each a
+ * normal n and offset d, inside where n . p >= d), or straddles
+ * one. An empty box, with lo > hi, is never visible.
+ */
+template <typename T>
+inline void bounds_n(T* lo, T* hi, T const* v, std::size_t n)
+{
+    T lx = lo[0], ly = lo[1], lz = lo[2];
+    T hx = hi[0], hy = hi[1], hz = hi[2];
+    for (std::size_t i=0; i<n; ++i, v+=4)
+    {
+        lx = (v[0] < lx) ? v[0] : lx;  hx = (v[0] > hx) ? v[0] : hx;
+        ly = (v[1] < ly) ? v[1] : ly;  hy = (v[1] > hy) ? v[1] : hy;
+        lz = (v[2] < lz) ? v[2] : lz;  hz = (v[2] > hz) ? v[2] : hz;
+    }
+    lo[0] = lx; lo[1] = ly; lo[2] = lz;
+    hi[0] = hx; hi[1] = hy; hi[2] = hz;
+}
+
+template <typename T>
+inline void bounds_soa_n(T* lo, T* hi, T const* x, T const* y, T const* z, std::size_t n)
+{
+    T lx = lo[0], ly = lo[1], lz = lo[2];
+    T hx = hi[0], hy = hi[1], hz = hi[2];
+    for (std::size_t i=0; i<n; ++i)
+    {
+        lx = (x[i] < lx) ? x[i] : lx;  hx = (x[i] > hx) ? x[i] : hx;
+        ly = (y[i] < ly) ? y[i] : ly;  hy = (y[i] > hy) ? y[i] : hy;
+        lz = (z[i] < lz) ? z[i] : lz;  hz = (z[i] > hz) ? z[i] : hz;
+    }
+    lo[0] = lx; lo[1] = ly; lo[2] = lz;
+    hi[0] = hx; hi[1] = hy; hi[2] = hz;
+}
+
+template <typename T>
+inline void cull_boxes_n(uint8_t* visible, T const* planes, T const* const* box, std::size_t n)
+{
+    for (std::size_t i=0; i<n; ++i)
+    {
+        T const cx = (box[0][i] + box[3][i]) * T(0.5), ex = (box[3][i] - box[0][i]) * T(0.5);
+        T const cy = (box[1][i] + box[4][i]) * T(0.5), ey = (box[4][i] - box[1][i]) * T(0.5);
+        T const cz = (box[2][i] + box[5][i]) * T(0.5), ez = (box[5][i] - box[2][i]) * T(0.5);
+        bool ok = ex >= 0 && ey >= 0 && ez >= 0;
+        for (int k=0; k<24; k+=4)
+        {
+            T const* pl = planes + k;
+            T const s = (pl[0]*cx + pl[1]*cy + pl[2]*cz) - pl[3];
+            T const r = (std::abs(pl[0])*ex + std::abs(pl[1])*ey + std::abs(pl[2])*ez);
+            ok = ok && s + r >= 0;
+        }
+        visible[i] = ok;
+    }
+}
+
+/*
+ * Projection kernels.
+ *
+ * project_n() computes c = m * v[i] for n vectors of four values,
+ * W included, and sets r[i] = (c.x/c.w, c.y/c.w, c.z/c.w, 1/c.w).
+ * project_soa_n() does the same for points on three arrays v[0..2],
+ * with W = 1, writing the three arrays r[0..2]. r may alias v.
+ *
+ * If clip is not null, clip[i] gets the outcode of c against the
+ * clip volume -w <= x, y, z <= w: bit 0 for x < -w, 1 for x > w,
+ * 2 and 3 for y, 4 for z < -w or w <= 0, and 5 for z > w. A point
+ * inside has a code of 0.
+ *
+ * With \c fast the SIMD kernels take the hardware reciprocal
+ * estimate of w with refinement steps instead of dividing, unless
+ * VECMATH_DETERMINISTIC is defined; these kernels always divide.
+ */
+template <typename T>
+inline uint8_t clip_code(T x, T y, T z, T w)
+{
+    return uint8_t((x < -w) | (x > w) << 1 | (y < -w) << 2 | (y > w) << 3 |
+                   (z < -w || !(w > 0)) << 4 | (z > w) << 5);
+}
+
+template <typename T>
+inline void project_n(T* r, uint8_t* clip, T const* m, T const* v, bool fast, std::size_t n)
+{
+    (void) fast;
+    for (std::size_t i=0; i<n; ++i, v+=4, r+=4)
+    {
+        T c[4];
+        for (int k=0; k<4; ++k)
+        {
+            c[k] = (v[0]*m[4*k+0] + v[1]*m[4*k+1] + v[2]*m[4*k+2] + v[3]*m[4*k+3]);
+        }
+        if (clip)
+        {
+            clip[i] = clip_code(c[0], c[1], c[2], c[3]);
+        }
+        T const inv = 1 / c[3];
+        r[0] = c[0] * inv;
+        r[1] = c[1] * inv;
+        r[2] = c[2] * inv;
+        r[3] = inv;
+    }
+}
+
+template <typename T>
+inline void project_soa_n(T* const* r, uint8_t* clip, T const* m, T const* const* v, bool fast,
+                          std::size_t n)
+{
+    (void) fast;
+    for (std::size_t i=0; i<n; ++i)
+    {
+        T const x = v[0][i], y = v[1][i], z = v[2][i];
+        T c[4];
+        for (int k=0; k<4; ++k)
+        {
+            c[k] = (x*m[4*k+0] + y*m[4*k+1] + z*m[4*k+2] + m[4*k+3]);
+        }
+        if (clip)
+        {
+            clip[i] = clip_code(c[0], c[1], c[2], c[3]);
+        }
+        T const inv = 1 / c[3];
+        r[0][i] = c[0] * inv;
+        r[1][i] = c[1] * inv;
+        r[2][i] = c[2] * inv;
+    }
+}
+
+} // ::scalar
+
+/*
+ * Intersection kernel helpers: the component arrays advanced to
+ * the tail a narrower kernel finishes, and the bytes of a hit mask.
+ */
+template <typename T>
+struct arrays_from
+{
+    T const* p[9];
+
+    arrays_from(T const* const* a, int count, std::size_t i)
+    {
+        for (int k=0; k<count; ++k)
+        {
+            p[k] = a[k] + i;
+        }
+    }
+};
+
+template <typename T>
+struct outputs_from
+{
+    T* p[3];
+
+    outputs_from(T* const* a, int count, std::size_t i)
+    {
+        for (int k=0; k<count; ++k)
+        {
+            p[k] = a[k] + i;
+        }
+    }
+};
+
+inline void store_hits(uint8_t* hit, unsigned mask, int lanes)
+{
+    for (int k=0; k<lanes; ++k)
+    {
+        hit[k] = uint8_t((mask >> k) & 1);
+    }
+}
+
+} // ::simd
+} // ::vecmath
+
+#if defined(VM_SIMD_X86)
+#  include "vecsimd_sse.h"
+#  include "vecsimd_avx2.h"
+#  include "vecsimd_avx512.h"
+#elif defined(VM_SIMD_NEON)
+#  include "vecsimd_neon.h"
+#endif
+
+namespace vecmath {
+namespace simd {
+
+#define VM_SIMD_KERNELS(ns) \
+    {isa::ns, #ns, &ns::mm_mult, &ns::vm_mult, &ns::mv_mult, &ns::mv_mult_n, \
+     &ns::dot_n, &ns::cross_n, &ns::length_n, &ns::normalize_n,           \
+     &ns::add_n, &ns::sub_n, &ns::scale_n, &ns::length_soa_n,             \
+     &ns::normalize_soa_n, &ns::compose_n, &ns::ray_triangles_n,         \
+     &ns::rays_plane_n, &ns::bounds_n, &ns::bounds_soa_n,               \
+     &ns::cull_boxes_n, &ns::project_n, &ns::project_soa_n}
+
+/**
+ * Determine if this CPU can run kernels for \c id, and whether
+ * they were compiled in.
+ */
+inline bool supported(isa id)
+{
+    switch (id)
+    {
+      case isa::scalar:
+        return true;
+#if defined(VM_SIMD_X86)
+      case isa::sse:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("sse2");
+      case isa::avx2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+      case isa::avx512:
+        __builtin_cpu_init();
+        return (__builtin_cpu_supports("avx512f") &&
+                __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"));
+#elif defined(VM_SIMD_NEON)
+      case isa::neon:
+        return true;
+#endif
+      default:
+        return false;
+    }
+}
+
+/**
+ * Get the kernel table for \c id.
+ *
+ * @return the table, or nullptr if supported(id) is false.
+ */
+inline kernels const* find(isa id)
+{
+    static kernels const scalar_k = VM_SIMD_KERNELS(scalar);
+#if defined(VM_SIMD_X86)
+    static kernels const sse_k    = VM_SIMD_KERNELS(sse);
+    static kernels const avx2_k   = VM_SIMD_KERNELS(avx2);
+    static kernels const avx512_k = VM_SIMD_KERNELS(avx512);
+#elif defined(VM_SIMD_NEON)
+    static kernels const neon_k   = VM_SIMD_KERNELS(neon);
+#endif
+
+    if (!supported(id))
+        return nullptr;
+
+    switch (id)
+    {
+#if defined(VM_SIMD_X86)
+      case isa::sse:    return &sse_k;
+      case isa::avx2:   return &avx2_k;
+      case isa::avx512: return &avx512_k;
+#elif defined(VM_SIMD_NEON)
+      case isa::neon:   return &neon_k;
+#endif
+      default:          return &scalar_k;
+    }
+}
+
+#undef VM_SIMD_KERNELS
+
+/**
+ * Select the kernels to use on this CPU.
+ *
+ * The best supported instruction set is chosen, unless the
+ * VECMATH_ISA environment variable names one ("scalar", "sse",
+ * "avx2", "avx512" or "neon"). Unsupported requests fall back
+ * to the best supported set.
+ */
+inline kernels const& select()
+{
+    static isa const order[] = {isa::avx512, isa::avx2, isa::neon, isa::sse, isa::scalar};
+
+    if (char const* env = std::getenv("VECMATH_ISA"))
+    {
+        for (isa id : order)
+        {
+            kernels const* k = find(id);
+            if (k && std::strcmp(env, k->name) == 0)
+                return *k;
+        }
+    }
+
+    for (isa id : order)
+    {
+        if (kernels const* k = find(id))
+            return *k;
+    }
+    return *find(isa::scalar);
+}
+
+/**
+ * The kernels used by the Matrix3f/Vector3f operators.
+ * select() runs once, on first use.
+ */
+inline kernels const& active()
+{
+    static kernels const& k = select();
+    return k;
+}
+
+/**
+ * Batch Matrix-column Vector multiplication over Vector3f arrays,
+ * out[i] = M * in[i]. The matrix is prepared once for the whole
+ * batch. \c in and \c out may be the same array.
+ */
+inline void transform(Matrix3f const& m, Vector3f const* in, Vector3f* out, std::size_t n)
+{
+    static_assert(std::is_standard_layout<Vector3f>::value && sizeof(Vector3f) == 4*sizeof(float),
+                  "Vector3f must be 4 packed floats");
+    static_assert(std::is_standard_layout<Matrix3f>::value && sizeof(Matrix3f) == 16*sizeof(float),
+                  "Matrix3f must be 16 packed floats");
+
+    active().mv_mult_n(reinterpret_cast<float*>(out),
+                       reinterpret_cast<float const*>(&m),
+                       reinterpret_cast<float const*>(in), n);
+}
+
+} // ::simd
+
+#if defined(VECMATH_SIMD)
+/*
+ * With VECMATH_SIMD defined (in every translation unit, before
+ * including vecmath.h) the float operators in matops.h are routed
+ * through the active kernels. Matrix3d/Vector3d are unaffected.
+ */
+template <>
+inline Matrix3<float> operator*(Matrix3<float> const& a,
+                                Matrix3<float> const& b)
+{
+    VM_STATS_COUNT(mat_mults);
+    Matrix3<float> result;
+    simd::active().mm_mult(&result.m_m[0][0], &a.m_m[0][0], &b.m_m[0][0]);
+    return result;
+}
+
+template <>
+inline Vector3<float> operator*(Vector3<float> const& v,
+                                Matrix3<float> const& m)
+{
+    VM_STATS_COUNT(vec_mults);
+    Vector3<float> result;
+    simd::active().vm_mult(result.m_v, v.m_v, &m.m_m[0][0]);
+    return result;
+}
+
+template <>
+inline Vector3<float> operator*(Matrix3<float> const& m,
+                                Vector3<float> const& v)
+{
+    VM_STATS_COUNT(vec_mults);
+    Vector3<float> result;
+    simd::active().mv_mult(result.m_v, &m.m_m[0][0], v.m_v);
+    return result;
+}
+#endif // VECMATH_SIMD
+
+} // ::vecmath
+
+#endif // VM_VECSIMD_H
@@ -0,0 +1,661 @@
+/*
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/*
+ * AVX2+FMA kernels for the SIMD backend. Included by vecsimd.h.
+ * With VECMATH_DETERMINISTIC they use no FMA.
+ */
+#ifndef VM_VECSIMD_AVX2_H
+#define VM_VECSIMD_AVX2_H
+
+#include <immintrin.h>
+
+#include <limits>
+
+namespace vecmath {
+namespace simd {
+namespace avx2 {
+
+/*
+ * a * b + c and a * b - c: fused, or with VECMATH_DETERMINISTIC
+ * rounded after the multiply, as the scalar kernels round.
+ */
+VM_TARGET_AVX2
+inline __m256 fmadd(__m256 a, __m256 b, __m256 c)
+{
+#if defined(VECMATH_DETERMINISTIC)
+    return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#else
+    return _mm256_fmadd_ps(a, b, c);
+#endif
+}
+
+VM_TARGET_AVX2
+inline __m128 fmadd(__m128 a, __m128 b, __m128 c)
+{
+#if defined(VECMATH_DETERMINISTIC)
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+#else
+    return _mm_fmadd_ps(a, b, c);
+#endif
+}
+
+VM_TARGET_AVX2
+inline __m256 fmsub(__m256 a, __m256 b, __m256 c)
+{
+#if defined(VECMATH_DETERMINISTIC)
+    return _mm256_sub_ps(_mm256_mul_ps(a, b), c);
+#else
+    return _mm256_fmsub_ps(a, b, c);
+#endif
+}
+
+/*
+ * The 256-bit registers hold two matrix rows (or two vectors)
+ * at a time. _mm256_permute_ps() broadcasts an element within
+ * each 128-bit lane, so both rows get their own multiplier.
+ */
+
+// r = a * b; r may alias a or b.
+VM_TARGET_AVX2
+inline void mm_mult(float* r, float const* a, float const* b)
+{
+    __m256 const b0 = _mm256_broadcast_ps(reinterpret_cast<__m128 const*>(b + 0));
+    __m256 const b1 = _mm256_broadcast_ps(reinterpret_cast<__m128 const*>(b + 4));
+    __m256 const b2 = _mm256_broadcast_ps(reinterpret_cast<__m128 const*>(b + 8));
+    __m256 const b3 = _mm256_broadcast_ps(reinterpret_cast<__m128 const*>(b + 12));
+
+    for (int i=0; i<16; i+=8)
+    {
+        __m256 const rows = _mm256_loadu_ps(a + i);
+        __m256 acc = _mm256_mul_ps(_mm256_permute_ps(rows, 0x00), b0);
+        acc = fmadd(_mm256_permute_ps(rows, 0x55), b1, acc);
+        acc = fmadd(_mm256_permute_ps(rows, 0xAA), b2, acc);
+        acc = fmadd(_mm256_permute_ps(rows, 0xFF), b3, acc);
+        _mm256_storeu_ps(r + i, acc);
+    }
+}
+
+// r = v * m (row vector)
+VM_TARGET_AVX2
+inline void vm_mult(float* r, float const* v, float const* m)
+{
+    __m128 acc = _mm_mul_ps(_mm_broadcast_ss(v + 0), _mm_loadu_ps(m + 0));
+    acc = fmadd(_mm_broadcast_ss(v + 1), _mm_loadu_ps(m + 4), acc);
+    acc = fmadd(_mm_broadcast_ss(v + 2), _mm_loadu_ps(m + 8), acc);
+    acc = fmadd(_mm_broadcast_ss(v + 3), _mm_loadu_ps(m + 12), acc);
+    _mm_storeu_ps(r, acc);
+}
+
+// r[i] = m * v[i] for n packed 4-float vectors; r may alias v.
+VM_TARGET_AVX2
+inline void mv_mult_n(float* r, float const* m, float const* v, std::size_t n)
+{
+    __m128 c0 = _mm_loadu_ps(m + 0);
+    __m128 c1 = _mm_loadu_ps(m + 4);
+    __m128 c2 = _mm_loadu_ps(m + 8);
+    __m128 c3 = _mm_loadu_ps(m + 12);
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+    __m256 const d0 = _mm256_set_m128(c0, c0);
+    __m256 const d1 = _mm256_set_m128(c1, c1);
+    __m256 const d2 = _mm256_set_m128(c2, c2);
+    __m256 const d3 = _mm256_set_m128(c3, c3);
+
+    std::size_t i = 0;
+    for ( ; i+2<=n; i+=2, v+=8, r+=8)
+    {
+        __m256 const x = _mm256_loadu_ps(v);
+        __m256 acc = _mm256_mul_ps(_mm256_permute_ps(x, 0x00), d0);
+        acc = fmadd(_mm256_permute_ps(x, 0x55), d1, acc);
+        acc = fmadd(_mm256_permute_ps(x, 0xAA), d2, acc);
+        acc = fmadd(_mm256_permute_ps(x, 0xFF), d3, acc);
+        _mm256_storeu_ps(r, acc);
+    }
+
+    if (i < n)                              // odd tail vector
+    {
+        __m128 const x = _mm_loadu_ps(v);
+        __m128 acc = _mm_mul_ps(_mm_permute_ps(x, 0x00), c0);
+        acc = fmadd(_mm_permute_ps(x, 0x55), c1, acc);
+        acc = fmadd(_mm_permute_ps(x, 0xAA), c2, acc);
+        acc = fmadd(_mm_permute_ps(x, 0xFF), c3, acc);
+        _mm_storeu_ps(r, acc);
+    }
+}
+
+// r = m * v (column vector)
+VM_TARGET_AVX2
+inline void mv_mult(float* r, float const* m, float const* v)
+{
+    mv_mult_n(r, m, v, 1);
+}
+
+/*
+ * The batch kernels load eight vectors as four registers of two
+ * and transpose each 128-bit lane, so X, Y and Z each fill a
+ * register in the order [0 2 4 6 | 1 3 5 7]. Vector results are
+ * transposed back into place; scalar results are permuted into
+ * order. Products are summed with FMA (unless VECMATH_DETERMINISTIC),
+ * so results can differ from the SSE and scalar kernels in the last
+ * bit. Tails go to the SSE
+ * kernels.
+ */
+VM_TARGET_AVX2
+inline void transpose4(__m256& r0, __m256& r1, __m256& r2, __m256& r3)
+{
+    __m256 const t0 = _mm256_unpacklo_ps(r0, r1);
+    __m256 const t1 = _mm256_unpacklo_ps(r2, r3);
+    __m256 const t2 = _mm256_unpackhi_ps(r0, r1);
+    __m256 const t3 = _mm256_unpackhi_ps(r2, r3);
+    r0 = _mm256_shuffle_ps(t0, t1, 0x44);
+    r1 = _mm256_shuffle_ps(t0, t1, 0xEE);
+    r2 = _mm256_shuffle_ps(t2, t3, 0x44);
+    r3 = _mm256_shuffle_ps(t2, t3, 0xEE);
+}
+
+VM_TARGET_AVX2
+inline void load8(float const* v, __m256& x, __m256& y, __m256& z)
+{
+    __m256 w = _mm256_loadu_ps(v + 24);
+    x = _mm256_loadu_ps(v + 0);
+    y = _mm256_loadu_ps(v + 8);
+    z = _mm256_loadu_ps(v + 16);
+    transpose4(x, y, z, w);
+}
+
+VM_TARGET_AVX2
+inline void store8(float* v, __m256 x, __m256 y, __m256 z)
+{
+    __m256 w = _mm256_set1_ps(1.0f);
+    transpose4(x, y, z, w);
+    _mm256_storeu_ps(v + 0, x);
+    _mm256_storeu_ps(v + 8, y);
+    _mm256_storeu_ps(v + 16, z);
+    _mm256_storeu_ps(v + 24, w);
+}
+
+VM_TARGET_AVX2
+inline __m256 dot3(__m256 ax, __m256 ay, __m256 az, __m256 bx, __m256 by, __m256 bz)
+{
+    return fmadd(az, bz, fmadd(ay, by, _mm256_mul_ps(ax, bx)));
+}
+
+// Put scalar results from the transposed order back in order.
+VM_TARGET_AVX2
+inline __m256 in_order(__m256 d)
+{
+    return _mm256_permutevar8x32_ps(d, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+}
+
+VM_TARGET_AVX2
+inline void dot_n(float* r, float const* a, float const* b, std::size_t n)
+{
+    std::size_t i = 0;
+    for ( ; i+8<=n; i+=8, a+=32, b+=32)
+    {
+        __m256 ax, ay, az, bx, by, bz;
+        load8(a, ax, ay, az);
+        load8(b, bx, by, bz);
+        _mm256_storeu_ps(r + i, in_order(dot3(ax, ay, az, bx, by, bz)));
+    }
+    sse::dot_n(r + i, a, b, n - i);
+}
+
+VM_TARGET_AVX2
+inline void cross_n(float* r, float const* a, float const* b, std::size_t n)
+{
+    std::size_t i = 0;
+    for ( ; i+8<=n; i+=8, a+=32, b+=32, r+=32)
+    {
+        __m256 ax, ay, az, bx, by, bz;
+        load8(a, ax, ay, az);
+        load8(b, bx, by, bz);
+        store8(r, fmsub(ay, bz, _mm256_mul_ps(az, by)),
+                  fmsub(az, bx, _mm256_mul_ps(ax, bz)),
+                  fmsub(ax, by, _mm256_mul_ps(ay, bx)));
+    }
+    sse::cross_n(r, a, b, n - i);
+}
+
+VM_TARGET_AVX2
+inline void length_n(float* r, float const* v, std::size_t n)
+{
+    std::size_t i = 0;
+    for ( ; i+8<=n; i+=8, v+=32)
+    {
+        __m256 x, y, z;
+        load8(v, x, y, z);
+        _mm256_storeu_ps(r + i, in_order(_mm256_sqrt_ps(dot3(x, y, z, x, y, z))));
+    }
+    sse::length_n(r + i, v, n - i);
+}
+
+VM_TARGET_AVX2
+inline void normalize_n(float* r, float const* v, std::size_t n)
+{
+    __m256 const one = _mm256_set1_ps(1.0f);
+    __m256 const tiny = _mm256_set1_ps(std::numeric_limits<float>::min());
+
+    std::size_t i = 0;
+    for ( ; i+8<=n; i+=8, v+=32, r+=32)
+    {
+        __m256 x, y, z;
+        load8(v, x, y, z);
+        __m256 const d = _mm256_add_ps(dot3(x, y, z, x, y, z), tiny);
+        __m256 const inv = _mm256_div_ps(one, _mm256_sqrt_ps(d));
+        store8(r, _mm256_mul_ps(x, inv), _mm256_mul_ps(y, inv), _mm256_mul_ps(z, inv));
+    }
+    sse::normalize_n(r, v, n - i);
+}
+
+// Separate X, Y and Z arrays need no transpose.
+VM_TARGET_AVX2
+inline void length_soa_n(float* r, float const* x, float const* y, float const* z, std::size_t n)
+{
+    std::size_t i = 0;
+    for ( ; i+8<=n; i+=8)
+    {
+        __m256 const vx = _mm256_loadu_ps(x + i);
+        __m256 const vy = _mm256_loadu_ps(y + i);
+        __m256 const vz = _mm256_loadu_ps(z + i);
+        _mm256_storeu_ps(r + i, _mm256_sqrt_ps(dot3(vx, vy, vz, vx, vy, vz)));
+    }
+    sse::length_soa_n(r + i, x + i, y + i, z + i, n - i);
+}
+
+VM_TARGET_AVX2
+inline void normalize_soa_n(float* rx, float* ry, float* rz, float const* x,
+                            float const* y, float const* z, std::size_t n)
+{
+    __m256 const one = _mm256_set1_ps(1.0f);
+    __m256 const tiny = _mm256_set1_ps(std::numeric_limits<float>::min());
+
+    std::size_t i = 0;
+    for ( ; i+8<=n; i+=8)
+    {
+        __m256 const vx = _mm256_loadu_ps(x + i);
+        __m256 const vy = _mm256_loadu_ps(y + i);
+        __m256 const vz = _mm256_loadu_ps(z + i);
+        __m256 const d = _mm256_add_ps(dot3(vx, vy, vz, vx, vy, vz), tiny);
+        __m256 const inv = _mm256_div_ps(one, _mm256_sqrt_ps(d));
+        _mm256_storeu_ps(rx + i, _mm256_mul_ps(vx, inv));
+        _mm256_storeu_ps(ry + i, _mm256_mul_ps(vy, inv));
+        _mm256_storeu_ps(rz + i, _mm256_mul_ps(vz, inv));
+    }
+    sse::normalize_soa_n(rx + i, ry + i, rz + i, x + i, y + i, z + i, n - i);
+}
+
+// The element-wise kernels take two vectors per register.
+VM_TARGET_AVX2
+inline void add_n(float* r, float const* a, float const* b, std::size_t n)
+{
+    __m256 const one = _mm256_set1_ps(1.0f);
+    std::size_t i = 0;
+    for ( ; i+2<=n; i+=2, a+=8, b+=8, r+=8)
+    {
+        __m256 const s = _mm256_add_ps(_mm256_loadu_ps(a), _mm256_loadu_ps(b));
+        _mm256_storeu_ps(r, _mm256_blend_ps(s, one, 0x88));
+    }
+    sse::add_n(r, a, b, n - i);
+}
+
+VM_TARGET_AVX2
+inline void sub_n(float* r, float const* a, float const* b, std::size_t n)
+{
+    __m256 const one = _mm256_set1_ps(1.0f);
+    std::size_t i = 0;
+    for ( ; i+2<=n; i+=2, a+=8, b+=8, r+=8)
+    {
+        __m256 const s = _mm256_sub_ps(_mm256_loadu_ps(a), _mm256_loadu_ps(b));
+        _mm256_storeu_ps(r, _mm256_blend_ps(s, one, 0x88));
+    }
+    sse::sub_n(r, a, b, n - i);
+}
+
+VM_TARGET_AVX2
+inline void scale_n(float* r, float const* v, float s, std::size_t n)
+{
+    __m256 const one = _mm256_set1_ps(1.0f);
+    __m256 const k = _mm256_set1_ps(s);
+    std::size_t i = 0;
+    for ( ; i+2<=n; i+=2, v+=8, r+=8)
+    {
+        __m256 const p = _mm256_mul_ps(_mm256_loadu_ps(v), k);
+        _mm256_storeu_ps(r, _mm256_blend_ps(p, one, 0x88));
+    }
+    sse::scale_n(r, v, s, n - i);
+}
+
+// The broadcast mm_mult() for each node of a hierarchy.
+VM_TARGET_AVX2
+inline void compose_n(float* world, float const* local, int32_t const* parent,
+                      int32_t const* node, std::size_t n)
+{
+    for (std::size_t k=0; k<n; ++k)
+    {
+        prefetch_node(world, local, parent, node, k, n);
+        std::size_t const i = node_at(node, k);
+        if (parent[i] < 0)
+        {
+            std::memmove(world + 16*i, local + 16*i, 16*sizeof(float));
+        }
+        else
+        {
+            mm_mult(world + 16*i, world + 16*parent[i], local + 16*i);
+        }
+    }
+}
+
+// Ray intersection, eight triangles or rays per register.
+VM_TARGET_AVX2
+inline void ray_triangles_n(float* t, uint8_t* hit, float const* ray, float const* const* tri,
+                            float eps, std::size_t n)
+{
+    __m256 const ox = _mm256_set1_ps(ray[0]), oy = _mm256_set1_ps(ray[1]), oz = _mm256_set1_ps(ray[2]);
+    __m256 const dx = _mm256_set1_ps(ray[3]), dy = _mm256_set1_ps(ray[4]), dz = _mm256_set1_ps(ray[5]);
+    __m256 const veps = _mm256_set1_ps(eps);
+    __m256 const zero = _mm256_setzero_ps();
+    __m256 const one = _mm256_set1_ps(1.0f);
+    __m256 const inf = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+    __m256 const sign = _mm256_set1_ps(-0.0f);
+
+    std::size_t i = 0;
+    for ( ; i+8<=n; i+=8)
+    {
+        __m256 const e1x = _mm256_loadu_ps(tri[3] + i);
+        __m256 const e1y = _mm256_loadu_ps(tri[4] + i);
+        __m256 const e1z = _mm256_loadu_ps(tri[5] + i);
+        __m256 const e2x = _mm256_loadu_ps(tri[6] + i);
+        __m256 const e2y = _mm256_loadu_ps(tri[7] + i);
+        __m256 const e2z = _mm256_loadu_ps(tri[8] + i);
+        __m256 const px = fmsub(dy, e2z, _mm256_mul_ps(dz, e2y));
+        __m256 const py = fmsub(dz, e2x, _mm256_mul_ps(dx, e2z));
+        __m256 const pz = fmsub(dx, e2y, _mm256_mul_ps(dy, e2x));
+        __m256 const det = dot3(e1x, e1y, e1z, px, py, pz);
+        __m256 const inv = _mm256_div_ps(one, det);
+        __m256 const sx = _mm256_sub_ps(ox, _mm256_loadu_ps(tri[0] + i));
+        __m256 const sy = _mm256_sub_ps(oy, _mm256_loadu_ps(tri[1] + i));
+        __m256 const sz = _mm256_sub_ps(oz, _mm256_loadu_ps(tri[2] + i));
+        __m256 const u = _mm256_mul_ps(dot3(sx, sy, sz, px, py, pz), inv);
+        __m256 const qx = fmsub(sy, e1z, _mm256_mul_ps(sz, e1y));
+        __m256 const qy = fmsub(sz, e1x, _mm256_mul_ps(sx, e1z));
+        __m256 const qz = fmsub(sx, e1y, _mm256_mul_ps(sy, e1x));
+        __m256 const v = _mm256_mul_ps(dot3(dx, dy, dz, qx, qy, qz), inv);
+        __m256 const d = _mm256_mul_ps(dot3(e2x, e2y, e2z, qx, qy, qz), inv);
+
+        __m256 ok = _mm256_cmp_ps(_mm256_andnot_ps(sign, det), veps, _CMP_GE_OQ);
+        ok = _mm256_and_ps(ok, _mm256_cmp_ps(u, zero, _CMP_GE_OQ));
+        ok = _mm256_and_ps(ok, _mm256_cmp_ps(v, zero, _CMP_GE_OQ));
+        ok = _mm256_and_ps(ok, _mm256_cmp_ps(_mm256_add_ps(u, v), one, _CMP_LE_OQ));
+        ok = _mm256_and_ps(ok, _mm256_cmp_ps(d, zero, _CMP_GE_OQ));
+        _mm256_storeu_ps(t + i, _mm256_blendv_ps(inf, d, ok));
+        store_hits(hit + i, unsigned(_mm256_movemask_ps(ok)), 8);
+    }
+    arrays_from<float> const rest(tri, 9, i);
+    sse::ray_triangles_n(t + i, hit + i, ray, rest.p, eps, n - i);
+}
+
+VM_TARGET_AVX2
+inline void rays_plane_n(float* t, uint8_t* hit, float const* const* rays, float const* plane,
+                         float eps, std::size_t n)
+{
+    __m256 const nx = _mm256_set1_ps(plane[0]), ny = _mm256_set1_ps(plane[1]);
+    __m256 const nz = _mm256_set1_ps(plane[2]), offset = _mm256_set1_ps(plane[3]);
+    __m256 const veps = _mm256_set1_ps(eps);
+    __m256 const zero = _mm256_setzero_ps();
+    __m256 const inf = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+    __m256 const sign = _mm256_set1_ps(-0.0f);
+
+    std::size_t i = 0;
+    for ( ; i+8<=n; i+=8)
+    {
+        __m256 const denom = dot3(nx, ny, nz, _mm256_loadu_ps(rays[3] + i),
+                                  _mm256_loadu_ps(rays[4] + i), _mm256_loadu_ps(rays[5] + i));
+        __m256 const dist = _mm256_sub_ps(offset, dot3(nx, ny, nz, _mm256_loadu_ps(rays[0] + i),
+                                                       _mm256_loadu_ps(rays[1] + i),
+                                                       _mm256_loadu_ps(rays[2] + i)));
+        __m256 const d = _mm256_div_ps(dist, denom);
+        __m256 const ok = _mm256_and_ps(_mm256_cmp_ps(_mm256_andnot_ps(sign, denom), veps, _CMP_GE_OQ),
+                                        _mm256_cmp_ps(d, zero, _CMP_GE_OQ));
+        _mm256_storeu_ps(t + i, _mm256_blendv_ps(inf, d, ok));
+        store_hits(hit + i, unsigned(_mm256_movemask_ps(ok)), 8);
+    }
+    arrays_from<float> const rest(rays, 6, i);
+    sse::rays_plane_n(t + i, hit + i, rest.p, plane, eps, n - i);
+}
+
+// Bounding boxes, two vectors per register.
+VM_TARGET_AVX2
+inline void bounds_n(float* lo, float* hi, float const* v, std::size_t n)
+{
+    __m128 const l = _mm_setr_ps(lo[0], lo[1], lo[2], 0.0f);
+    __m128 const h = _mm_setr_ps(hi[0], hi[1], hi[2], 0.0f);
+    __m256 l0 = _mm256_set_m128(l, l), l1 = l0;
+    __m256 h0 = _mm256_set_m128(h, h), h1 = h0;
+
+    std::size_t i = 0;
+    for ( ; i+4<=n; i+=4, v+=16)
+    {
+        __m256 const a = _mm256_loadu_ps(v);
+        __m256 const b = _mm256_loadu_ps(v + 8);
+        l0 = _mm256_min_ps(a, l0);
+        h0 = _mm256_max_ps(a, h0);
+        l1 = _mm256_min_ps(b, l1);
+        h1 = _mm256_max_ps(b, h1);
+    }
+    l0 = _mm256_min_ps(l0, l1);
+    h0 = _mm256_max_ps(h0, h1);
+    sse::store3(lo, _mm_min_ps(_mm256_castps256_ps128(l0), _mm256_extractf128_ps(l0, 1)));
+    sse::store3(hi, _mm_max_ps(_mm256_castps256_ps128(h0), _mm256_extractf128_ps(h0, 1)));
+    sse::bounds_n(lo, hi, v, n - i);
+}
+
+VM_TARGET_AVX2
+inline float hmin(__m256 v)
+{
+    return sse::hmin(_mm_min_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1)));
+}
+
+VM_TARGET_AVX2
+inline float hmax(__m256 v)
+{
+    return sse::hmax(_mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1)));
+}
+
+VM_TARGET_AVX2
+inline void bounds_soa_n(float* lo, float* hi, float const* x, float const* y, float const* z,
+                         std::size_t n)
+{
+    __m256 lx = _mm256_set1_ps(lo[0]), ly = _mm256_set1_ps(lo[1]), lz = _mm256_set1_ps(lo[2]);
+    __m256 hx = _mm256_set1_ps(hi[0]), hy = _mm256_set1_ps(hi[1]), hz = _mm256_set1_ps(hi[2]);
+
+    std::size_t i = 0;
+    for ( ; i+8<=n; i+=8)
+    {
+        __m256 const vx = _mm256_loadu_ps(x + i);
+        __m256 const vy = _mm256_loadu_ps(y + i);
+        __m256 const vz = _mm256_loadu_ps(z + i);
+        lx = _mm256_min_ps(vx, lx);
+        hx = _mm256_max_ps(vx, hx);
+        ly = _mm256_min_ps(vy, ly);
+        hy = _mm256_max_ps(vy, hy);
+        lz = _mm256_min_ps(vz, lz);
+        hz = _mm256_max_ps(vz, hz);
+    }
+    lo[0] = hmin(lx); lo[1] = hmin(ly); lo[2] = hmin(lz);
+    hi[0] = hmax(hx); hi[1] = hmax(hy); hi[2] = hmax(hz);
+    sse::bounds_soa_n(lo, hi, x + i, y + i, z + i, n - i);
+}
+
+VM_TARGET_AVX2
+inline void cull_boxes_n(uint8_t* visible, float const* planes, float const* const* box,
+                         std::size_t n)
+{
+    __m256 const half = _mm256_set1_ps(0.5f);
+    __m256 const zero = _mm256_setzero_ps();
+
+    std::size_t i = 0;
+    for ( ; i+8<=n; i+=8)
+    {
+        __m256 const lx = _mm256_loadu_ps(box[0] + i), hx = _mm256_loadu_ps(box[3] + i);
+        __m256 const ly = _mm256_loadu_ps(box[1] + i), hy = _mm256_loadu_ps(box[4] + i);
+        __m256 const lz = _mm256_loadu_ps(box[2] + i), hz = _mm256_loadu_ps(box[5] + i);
+        __m256 const cx = _mm256_mul_ps(_mm256_add_ps(lx, hx), half);
+        __m256 const cy = _mm256_mul_ps(_mm256_add_ps(ly, hy), half);
+        __m256 const cz = _mm256_mul_ps(_mm256_add_ps(lz, hz), half);
+        __m256 const ex = _mm256_mul_ps(_mm256_sub_ps(hx, lx), half);
+        __m256 const ey = _mm256_mul_ps(_mm256_sub_ps(hy, ly), half);
+        __m256 const ez = _mm256_mul_ps(_mm256_sub_ps(hz, lz), half);
+
+        __m256 ok = _mm256_and_ps(_mm256_cmp_ps(ex, zero, _CMP_GE_OQ),
+                                  _mm256_and_ps(_mm256_cmp_ps(ey, zero, _CMP_GE_OQ),
+                                                _mm256_cmp_ps(ez, zero, _CMP_GE_OQ)));
+        for (int k=0; k<24; k+=4)
+        {
+            float const* pl = planes + k;
+            __m256 const s = _mm256_sub_ps(dot3(_mm256_set1_ps(pl[0]), _mm256_set1_ps(pl[1]),
+                                                _mm256_set1_ps(pl[2]), cx, cy, cz),
+                                           _mm256_set1_ps(pl[3]));
+            __m256 const r = dot3(_mm256_set1_ps(std::abs(pl[0])), _mm256_set1_ps(std::abs(pl[1])),
+                                  _mm256_set1_ps(std::abs(pl[2])), ex, ey, ez);
+            ok = _mm256_and_ps(ok, _mm256_cmp_ps(_mm256_add_ps(s, r), zero, _CMP_GE_OQ));
+        }
+        store_hits(visible + i, unsigned(_mm256_movemask_ps(ok)), 8);
+    }
+    arrays_from<float> const rest(box, 6, i);
+    sse::cull_boxes_n(visible + i, planes, rest.p, n - i);
+}
+
+/*
+ * Projection, eight points per register; as in the SSE kernels,
+ * but the AoS clip codes are put back in order before narrowing.
+ */
+VM_TARGET_AVX2
+inline __m256 reciprocal(__m256 w, bool fast)
+{
+    if (!fast || vecmath::detail::deterministic)
+    {
+        return _mm256_div_ps(_mm256_set1_ps(1.0f), w);
+    }
+    __m256 const e = _mm256_rcp_ps(w);
+    return _mm256_mul_ps(e, _mm256_sub_ps(_mm256_set1_ps(2.0f), _mm256_mul_ps(w, e)));
+}
+
+VM_TARGET_AVX2
+inline __m256i clip_codes(__m256 x, __m256 y, __m256 z, __m256 w)
+{
+    __m256 const nw = _mm256_xor_ps(w, _mm256_set1_ps(-0.0f));
+    __m256 const tests[6] = {_mm256_cmp_ps(x, nw, _CMP_LT_OQ), _mm256_cmp_ps(x, w, _CMP_GT_OQ),
+                             _mm256_cmp_ps(y, nw, _CMP_LT_OQ), _mm256_cmp_ps(y, w, _CMP_GT_OQ),
+                             _mm256_or_ps(_mm256_cmp_ps(z, nw, _CMP_LT_OQ),
+                                          _mm256_cmp_ps(w, _mm256_setzero_ps(), _CMP_NGT_UQ)),
+                             _mm256_cmp_ps(z, w, _CMP_GT_OQ)};
+    __m256i code = _mm256_setzero_si256();
+    for (int k=0; k<6; ++k)
+    {
+        code = _mm256_or_si256(code, _mm256_and_si256(_mm256_castps_si256(tests[k]),
+                                                      _mm256_set1_epi32(1 << k)));
+    }
+    return code;
+}
+
+VM_TARGET_AVX2
+inline void store_clip8(uint8_t* clip, __m256i code)
+{
+    __m128i const half = _mm_packs_epi32(_mm256_castsi256_si128(code),
+                                         _mm256_extracti128_si256(code, 1));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(clip), _mm_packus_epi16(half, half));
+}
+
+VM_TARGET_AVX2
+inline void project_n(float* r, uint8_t* clip, float const* m, float const* v, bool fast,
+                      std::size_t n)
+{
+    __m256 mm[16];
+    for (int k=0; k<16; ++k)
+    {
+        mm[k] = _mm256_set1_ps(m[k]);
+    }
+
+    std::size_t i = 0;
+    for ( ; i+8<=n; i+=8, v+=32, r+=32)
+    {
+        __m256 x = _mm256_loadu_ps(v + 0);
+        __m256 y = _mm256_loadu_ps(v + 8);
+        __m256 z = _mm256_loadu_ps(v + 16);
+        __m256 w = _mm256_loadu_ps(v + 24);
+        transpose4(x, y, z, w);
+
+        __m256 c[4];
+        for (int k=0; k<4; ++k)
+        {
+            __m256 acc = fmadd(y, mm[4*k+1], _mm256_mul_ps(x, mm[4*k+0]));
+            acc = fmadd(z, mm[4*k+2], acc);
+            c[k] = fmadd(w, mm[4*k+3], acc);
+        }
+        if (clip)
+        {
+            __m256i const code = clip_codes(c[0], c[1], c[2], c[3]);
+            store_clip8(clip + i, _mm256_permutevar8x32_epi32(code, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7)));
+        }
+
+        __m256 const inv = reciprocal(c[3], fast);
+        __m256 rx = _mm256_mul_ps(c[0], inv), ry = _mm256_mul_ps(c[1], inv);
+        __m256 rz = _mm256_mul_ps(c[2], inv), rw = inv;
+        transpose4(rx, ry, rz, rw);
+        _mm256_storeu_ps(r + 0, rx);
+        _mm256_storeu_ps(r + 8, ry);
+        _mm256_storeu_ps(r + 16, rz);
+        _mm256_storeu_ps(r + 24, rw);
+    }
+    sse::project_n(r, clip ? clip + i : nullptr, m, v, fast, n - i);
+}
+
+VM_TARGET_AVX2
+inline void project_soa_n(float* const* r, uint8_t* clip, float const* m, float const* const* v,
+                          bool fast, std::size_t n)
+{
+    __m256 mm[16];
+    for (int k=0; k<16; ++k)
+    {
+        mm[k] = _mm256_set1_ps(m[k]);
+    }
+
+    std::size_t i = 0;
+    for ( ; i+8<=n; i+=8)
+    {
+        __m256 const x = _mm256_loadu_ps(v[0] + i);
+        __m256 const y = _mm256_loadu_ps(v[1] + i);
+        __m256 const z = _mm256_loadu_ps(v[2] + i);
+
+        __m256 c[4];
+        for (int k=0; k<4; ++k)
+        {
+            __m256 const acc = fmadd(y, mm[4*k+1], _mm256_mul_ps(x, mm[4*k+0]));
+            c[k] = _mm256_add_ps(fmadd(z, mm[4*k+2], acc), mm[4*k+3]);
+        }
+        if (clip)
+        {
+            store_clip8(clip + i, clip_codes(c[0], c[1], c[2], c[3]));
+        }
+
+        __m256 const inv = reciprocal(c[3], fast);
+        _mm256_storeu_ps(r[0] + i, _mm256_mul_ps(c[0], inv));
+        _mm256_storeu_ps(r[1] + i, _mm256_mul_ps(c[1], inv));
+        _mm256_storeu_ps(r[2] + i, _mm256_mul_ps(c[2], inv));
+    }
+    arrays_from<float> const in(v, 3, i);
+    outputs_from<float> const out(r, 3, i);
+    sse::project_soa_n(out.p, clip ? clip + i : nullptr, m, in.p, fast, n - i);
+}
+
+} // ::avx2
+} // ::simd
+} // ::vecmath
+
+#endif // VM_VECSIMD_AVX2_H
@@ -0,0 +1,693 @@
+/*
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/*
+ * AVX-512F kernels for the SIMD backend. Included by vecsimd.h.
+ */
+#ifndef VM_VECSIMD_AVX512_H
+#define VM_VECSIMD_AVX512_H
+
+#include <immintrin.h>
+
+#include <limits>
+
+/*
+ * GCC 12 warns that _mm512_undefined_ps() is uninitialized when
+ * broadcasts and permutes are inlined; the value is never read.
+ */
+#if defined(__GNUC__) && !defined(__clang__)
+#  pragma GCC diagnostic push
+#  pragma GCC diagnostic ignored "-Wuninitialized"
+#  pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+namespace vecmath {
+namespace simd {
+namespace avx512 {
+
+// As avx2::fmadd() and avx2::fmsub().
+VM_TARGET_AVX512
+inline __m512 fmadd(__m512 a, __m512 b, __m512 c)
+{
+#if defined(VECMATH_DETERMINISTIC)
+    return _mm512_add_ps(_mm512_mul_ps(a, b), c);
+#else
+    return _mm512_fmadd_ps(a, b, c);
+#endif
+}
+
+VM_TARGET_AVX512
+inline __m512 fmsub(__m512 a, __m512 b, __m512 c)
+{
+#if defined(VECMATH_DETERMINISTIC)
+    return _mm512_sub_ps(_mm512_mul_ps(a, b), c);
+#else
+    return _mm512_fmsub_ps(a, b, c);
+#endif
+}
+
+/*
+ * A 512-bit register holds a whole 4x4 matrix, or four vectors.
+ * Single-vector products gain nothing from the wider registers
+ * and reuse the AVX2 kernels.
+ */
+
+// r = a * b; r may alias a or b.
+VM_TARGET_AVX512
+inline void mm_mult(float* r, float const* a, float const* b)
+{
+    __m512 const b0 = _mm512_broadcast_f32x4(_mm_loadu_ps(b + 0));
+    __m512 const b1 = _mm512_broadcast_f32x4(_mm_loadu_ps(b + 4));
+    __m512 const b2 = _mm512_broadcast_f32x4(_mm_loadu_ps(b + 8));
+    __m512 const b3 = _mm512_broadcast_f32x4(_mm_loadu_ps(b + 12));
+
+    __m512 const rows = _mm512_loadu_ps(a);
+    __m512 acc = _mm512_mul_ps(_mm512_permute_ps(rows, 0x00), b0);
+    acc = fmadd(_mm512_permute_ps(rows, 0x55), b1, acc);
+    acc = fmadd(_mm512_permute_ps(rows, 0xAA), b2, acc);
+    acc = fmadd(_mm512_permute_ps(rows, 0xFF), b3, acc);
+    _mm512_storeu_ps(r, acc);
+}
+
+// r[i] = m * v[i] for n packed 4-float vectors; r may alias v.
+VM_TARGET_AVX512
+inline void mv_mult_n(float* r, float const* m, float const* v, std::size_t n)
+{
+    __m128 c0 = _mm_loadu_ps(m + 0);
+    __m128 c1 = _mm_loadu_ps(m + 4);
+    __m128 c2 = _mm_loadu_ps(m + 8);
+    __m128 c3 = _mm_loadu_ps(m + 12);
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+    __m512 const d0 = _mm512_broadcast_f32x4(c0);
+    __m512 const d1 = _mm512_broadcast_f32x4(c1);
+    __m512 const d2 = _mm512_broadcast_f32x4(c2);
+    __m512 const d3 = _mm512_broadcast_f32x4(c3);
+
+    std::size_t i = 0;
+    for ( ; i<n; i+=4, v+=16, r+=16)
+    {
+        // The last 1-3 vectors are handled with a masked load/store.
+        std::size_t const left = (n - i < 4) ? (n - i) : 4;
+        __mmask16 const mask = static_cast<__mmask16>((1u << (4*left)) - 1);
+
+        __m512 const x = _mm512_maskz_loadu_ps(mask, v);
+        __m512 acc = _mm512_mul_ps(_mm512_permute_ps(x, 0x00), d0);
+        acc = fmadd(_mm512_permute_ps(x, 0x55), d1, acc);
+        acc = fmadd(_mm512_permute_ps(x, 0xAA), d2, acc);
+        acc = fmadd(_mm512_permute_ps(x, 0xFF), d3, acc);
+        _mm512_mask_storeu_ps(r, mask, acc);
+    }
+}
+
+// r = m * v (column vector)
+VM_TARGET_AVX512
+inline void mv_mult(float* r, float const* m, float const* v)
+{
+    avx2::mv_mult_n(r, m, v, 1);
+}
+
+// r = v * m (row vector)
+VM_TARGET_AVX512
+inline void vm_mult(float* r, float const* v, float const* m)
+{
+    avx2::vm_mult(r, v, m);
+}
+
+/*
+ * The batch kernels load sixteen vectors as four registers of four
+ * and transpose each 128-bit lane, as the AVX2 kernels do; X, Y
+ * and Z come out in the order [0 4 8 12 | 1 5 9 13 | ...]. Products
+ * are summed as in the AVX2 kernels, with FMA unless
+ * VECMATH_DETERMINISTIC. The last 1-15
+ * vectors use masked loads and stores, so there is no scalar tail.
+ */
+VM_TARGET_AVX512
+inline void transpose4(__m512& r0, __m512& r1, __m512& r2, __m512& r3)
+{
+    __m512 const t0 = _mm512_unpacklo_ps(r0, r1);
+    __m512 const t1 = _mm512_unpacklo_ps(r2, r3);
+    __m512 const t2 = _mm512_unpackhi_ps(r0, r1);
+    __m512 const t3 = _mm512_unpackhi_ps(r2, r3);
+    r0 = _mm512_shuffle_ps(t0, t1, 0x44);
+    r1 = _mm512_shuffle_ps(t0, t1, 0xEE);
+    r2 = _mm512_shuffle_ps(t2, t3, 0x44);
+    r3 = _mm512_shuffle_ps(t2, t3, 0xEE);
+}
+
+/*
+ * The masks for the first \c left (1-16) of sixteen vectors: one
+ * per register of four vectors, and one for sixteen scalars.
+ */
+struct tail16
+{
+    __mmask16 rows[4];
+    __mmask16 scalars;
+
+    explicit tail16(std::size_t left)
+    {
+        for (std::size_t k=0; k<4; ++k)
+        {
+            std::size_t const in = (left > 4*k) ? left - 4*k : 0;
+            rows[k] = static_cast<__mmask16>((in >= 4) ? 0xffff : (1u << (4*in)) - 1);
+        }
+        scalars = static_cast<__mmask16>((1u << left) - 1);
+    }
+};
+
+VM_TARGET_AVX512
+inline void load16(float const* v, tail16 const& t, __m512& x, __m512& y, __m512& z)
+{
+    __m512 w = _mm512_maskz_loadu_ps(t.rows[3], v + 48);
+    x = _mm512_maskz_loadu_ps(t.rows[0], v + 0);
+    y = _mm512_maskz_loadu_ps(t.rows[1], v + 16);
+    z = _mm512_maskz_loadu_ps(t.rows[2], v + 32);
+    transpose4(x, y, z, w);
+}
+
+VM_TARGET_AVX512
+inline void store16(float* v, tail16 const& t, __m512 x, __m512 y, __m512 z)
+{
+    __m512 w = _mm512_set1_ps(1.0f);
+    transpose4(x, y, z, w);
+    _mm512_mask_storeu_ps(v + 0, t.rows[0], x);
+    _mm512_mask_storeu_ps(v + 16, t.rows[1], y);
+    _mm512_mask_storeu_ps(v + 32, t.rows[2], z);
+    _mm512_mask_storeu_ps(v + 48, t.rows[3], w);
+}
+
+VM_TARGET_AVX512
+inline __m512 dot3(__m512 ax, __m512 ay, __m512 az, __m512 bx, __m512 by, __m512 bz)
+{
+    return fmadd(az, bz, fmadd(ay, by, _mm512_mul_ps(ax, bx)));
+}
+
+// Put scalar results from the transposed order back in order.
+VM_TARGET_AVX512
+inline __m512 in_order(__m512 d)
+{
+    __m512i const idx = _mm512_setr_epi32(0, 4, 8, 12, 1, 5, 9, 13,
+                                          2, 6, 10, 14, 3, 7, 11, 15);
+    return _mm512_permutexvar_ps(idx, d);
+}
+
+/*
+ * One block of up to sixteen vectors for each kernel. The kernels
+ * run whole blocks with all-ones masks, then one partial block.
+ */
+VM_TARGET_AVX512
+inline void dot16(float* r, float const* a, float const* b, tail16 const& t)
+{
+    __m512 ax, ay, az, bx, by, bz;
+    load16(a, t, ax, ay, az);
+    load16(b, t, bx, by, bz);
+    _mm512_mask_storeu_ps(r, t.scalars, in_order(dot3(ax, ay, az, bx, by, bz)));
+}
+
+VM_TARGET_AVX512
+inline void cross16(float* r, float const* a, float const* b, tail16 const& t)
+{
+    __m512 ax, ay, az, bx, by, bz;
+    load16(a, t, ax, ay, az);
+    load16(b, t, bx, by, bz);
+    store16(r, t, fmsub(ay, bz, _mm512_mul_ps(az, by)),
+                  fmsub(az, bx, _mm512_mul_ps(ax, bz)),
+                  fmsub(ax, by, _mm512_mul_ps(ay, bx)));
+}
+
+VM_TARGET_AVX512
+inline void length16(float* r, float const* v, tail16 const& t)
+{
+    __m512 x, y, z;
+    load16(v, t, x, y, z);
+    _mm512_mask_storeu_ps(r, t.scalars, in_order(_mm512_sqrt_ps(dot3(x, y, z, x, y, z))));
+}
+
+VM_TARGET_AVX512
+inline __m512 inv_length(__m512 x, __m512 y, __m512 z)
+{
+    __m512 const d = _mm512_add_ps(dot3(x, y, z, x, y, z),
+                                   _mm512_set1_ps(std::numeric_limits<float>::min()));
+    return _mm512_div_ps(_mm512_set1_ps(1.0f), _mm512_sqrt_ps(d));
+}
+
+VM_TARGET_AVX512
+inline void normalize16(float* r, float const* v, tail16 const& t)
+{
+    __m512 x, y, z;
+    load16(v, t, x, y, z);
+    __m512 const inv = inv_length(x, y, z);
+    store16(r, t, _mm512_mul_ps(x, inv), _mm512_mul_ps(y, inv), _mm512_mul_ps(z, inv));
+}
+
+VM_TARGET_AVX512
+inline void dot_n(float* r, float const* a, float const* b, std::size_t n)
+{
+    tail16 const all(16);
+    std::size_t i = 0;
+    for ( ; i+16<=n; i+=16, a+=64, b+=64)
+    {
+        dot16(r + i, a, b, all);
+    }
+    if (i < n)
+    {
+        dot16(r + i, a, b, tail16(n - i));
+    }
+}
+
+VM_TARGET_AVX512
+inline void cross_n(float* r, float const* a, float const* b, std::size_t n)
+{
+    tail16 const all(16);
+    std::size_t i = 0;
+    for ( ; i+16<=n; i+=16, a+=64, b+=64, r+=64)
+    {
+        cross16(r, a, b, all);
+    }
+    if (i < n)
+    {
+        cross16(r, a, b, tail16(n - i));
+    }
+}
+
+VM_TARGET_AVX512
+inline void length_n(float* r, float const* v, std::size_t n)
+{
+    tail16 const all(16);
+    std::size_t i = 0;
+    for ( ; i+16<=n; i+=16, v+=64)
+    {
+        length16(r + i, v, all);
+    }
+    if (i < n)
+    {
+        length16(r + i, v, tail16(n - i));
+    }
+}
+
+VM_TARGET_AVX512
+inline void normalize_n(float* r, float const* v, std::size_t n)
+{
+    tail16 const all(16);
+    std::size_t i = 0;
+    for ( ; i+16<=n; i+=16, v+=64, r+=64)
+    {
+        normalize16(r, v, all);
+    }
+    if (i < n)
+    {
+        normalize16(r, v, tail16(n - i));
+    }
+}
+
+// Separate X, Y and Z arrays need no transpose.
+VM_TARGET_AVX512
+inline void length_soa_n(float* r, float const* x, float const* y, float const* z, std::size_t n)
+{
+    for (std::size_t i=0; i<n; i+=16)
+    {
+        std::size_t const left = n - i;
+        __mmask16 const m = static_cast<__mmask16>((left >= 16) ? 0xffff : (1u << left) - 1);
+        __m512 const vx = _mm512_maskz_loadu_ps(m, x + i);
+        __m512 const vy = _mm512_maskz_loadu_ps(m, y + i);
+        __m512 const vz = _mm512_maskz_loadu_ps(m, z + i);
+        _mm512_mask_storeu_ps(r + i, m, _mm512_sqrt_ps(dot3(vx, vy, vz, vx, vy, vz)));
+    }
+}
+
+VM_TARGET_AVX512
+inline void normalize_soa_n(float* rx, float* ry, float* rz, float const* x,
+                            float const* y, float const* z, std::size_t n)
+{
+    for (std::size_t i=0; i<n; i+=16)
+    {
+        std::size_t const left = n - i;
+        __mmask16 const m = static_cast<__mmask16>((left >= 16) ? 0xffff : (1u << left) - 1);
+        __m512 const vx = _mm512_maskz_loadu_ps(m, x + i);
+        __m512 const vy = _mm512_maskz_loadu_ps(m, y + i);
+        __m512 const vz = _mm512_maskz_loadu_ps(m, z + i);
+        __m512 const inv = inv_length(vx, vy, vz);
+        _mm512_mask_storeu_ps(rx + i, m, _mm512_mul_ps(vx, inv));
+        _mm512_mask_storeu_ps(ry + i, m, _mm512_mul_ps(vy, inv));
+        _mm512_mask_storeu_ps(rz + i, m, _mm512_mul_ps(vz, inv));
+    }
+}
+
+// The element-wise kernels take four vectors per register.
+inline __mmask16 mask4(std::size_t i, std::size_t n)
+{
+    return static_cast<__mmask16>((n - i >= 4) ? 0xffff : (1u << (4*(n - i))) - 1);
+}
+
+VM_TARGET_AVX512
+inline void add_n(float* r, float const* a, float const* b, std::size_t n)
+{
+    __m512 const one = _mm512_set1_ps(1.0f);
+    for (std::size_t i=0; i<n; i+=4, a+=16, b+=16, r+=16)
+    {
+        __mmask16 const m = mask4(i, n);
+        __m512 const s = _mm512_add_ps(_mm512_maskz_loadu_ps(m, a), _mm512_maskz_loadu_ps(m, b));
+        _mm512_mask_storeu_ps(r, m, _mm512_mask_mov_ps(s, 0x8888, one));
+    }
+}
+
+VM_TARGET_AVX512
+inline void sub_n(float* r, float const* a, float const* b, std::size_t n)
+{
+    __m512 const one = _mm512_set1_ps(1.0f);
+    for (std::size_t i=0; i<n; i+=4, a+=16, b+=16, r+=16)
+    {
+        __mmask16 const m = mask4(i, n);
+        __m512 const s = _mm512_sub_ps(_mm512_maskz_loadu_ps(m, a), _mm512_maskz_loadu_ps(m, b));
+        _mm512_mask_storeu_ps(r, m, _mm512_mask_mov_ps(s, 0x8888, one));
+    }
+}
+
+VM_TARGET_AVX512
+inline void scale_n(float* r, float const* v, float s, std::size_t n)
+{
+    __m512 const one = _mm512_set1_ps(1.0f);
+    __m512 const k = _mm512_set1_ps(s);
+    for (std::size_t i=0; i<n; i+=4, v+=16, r+=16)
+    {
+        __mmask16 const m = mask4(i, n);
+        __m512 const p = _mm512_mul_ps(_mm512_maskz_loadu_ps(m, v), k);
+        _mm512_mask_storeu_ps(r, m, _mm512_mask_mov_ps(p, 0x8888, one));
+    }
+}
+
+// The broadcast mm_mult() for each node of a hierarchy.
+VM_TARGET_AVX512
+inline void compose_n(float* world, float const* local, int32_t const* parent,
+                      int32_t const* node, std::size_t n)
+{
+    for (std::size_t k=0; k<n; ++k)
+    {
+        prefetch_node(world, local, parent, node, k, n);
+        std::size_t const i = node_at(node, k);
+        if (parent[i] < 0)
+        {
+            std::memmove(world + 16*i, local + 16*i, 16*sizeof(float));
+        }
+        else
+        {
+            mm_mult(world + 16*i, world + 16*parent[i], local + 16*i);
+        }
+    }
+}
+
+// Ray intersection, sixteen triangles or rays per register, the
+// last block masked.
+VM_TARGET_AVX512
+inline void ray_triangles_n(float* t, uint8_t* hit, float const* ray, float const* const* tri,
+                            float eps, std::size_t n)
+{
+    __m512 const ox = _mm512_set1_ps(ray[0]), oy = _mm512_set1_ps(ray[1]), oz = _mm512_set1_ps(ray[2]);
+    __m512 const dx = _mm512_set1_ps(ray[3]), dy = _mm512_set1_ps(ray[4]), dz = _mm512_set1_ps(ray[5]);
+    __m512 const veps = _mm512_set1_ps(eps);
+    __m512 const zero = _mm512_setzero_ps();
+    __m512 const one = _mm512_set1_ps(1.0f);
+    __m512 const inf = _mm512_set1_ps(std::numeric_limits<float>::infinity());
+
+    for (std::size_t i=0; i<n; i+=16)
+    {
+        std::size_t const left = n - i;
+        __mmask16 const m = static_cast<__mmask16>((left >= 16) ? 0xffff : (1u << left) - 1);
+        __m512 const e1x = _mm512_maskz_loadu_ps(m, tri[3] + i);
+        __m512 const e1y = _mm512_maskz_loadu_ps(m, tri[4] + i);
+        __m512 const e1z = _mm512_maskz_loadu_ps(m, tri[5] + i);
+        __m512 const e2x = _mm512_maskz_loadu_ps(m, tri[6] + i);
+        __m512 const e2y = _mm512_maskz_loadu_ps(m, tri[7] + i);
+        __m512 const e2z = _mm512_maskz_loadu_ps(m, tri[8] + i);
+        __m512 const px = fmsub(dy, e2z, _mm512_mul_ps(dz, e2y));
+        __m512 const py = fmsub(dz, e2x, _mm512_mul_ps(dx, e2z));
+        __m512 const pz = fmsub(dx, e2y, _mm512_mul_ps(dy, e2x));
+        __m512 const det = dot3(e1x, e1y, e1z, px, py, pz);
+        __m512 const inv = _mm512_div_ps(one, det);
+        __m512 const sx = _mm512_sub_ps(ox, _mm512_maskz_loadu_ps(m, tri[0] + i));
+        __m512 const sy = _mm512_sub_ps(oy, _mm512_maskz_loadu_ps(m, tri[1] + i));
+        __m512 const sz = _mm512_sub_ps(oz, _mm512_maskz_loadu_ps(m, tri[2] + i));
+        __m512 const u = _mm512_mul_ps(dot3(sx, sy, sz, px, py, pz), inv);
+        __m512 const qx = fmsub(sy, e1z, _mm512_mul_ps(sz, e1y));
+        __m512 const qy = fmsub(sz, e1x, _mm512_mul_ps(sx, e1z));
+        __m512 const qz = fmsub(sx, e1y, _mm512_mul_ps(sy, e1x));
+        __m512 const v = _mm512_mul_ps(dot3(dx, dy, dz, qx, qy, qz), inv);
+        __m512 const d = _mm512_mul_ps(dot3(e2x, e2y, e2z, qx, qy, qz), inv);
+
+        __mmask16 ok = _mm512_mask_cmp_ps_mask(m, _mm512_abs_ps(det), veps, _CMP_GE_OQ);
+        ok = _mm512_mask_cmp_ps_mask(ok, u, zero, _CMP_GE_OQ);
+        ok = _mm512_mask_cmp_ps_mask(ok, v, zero, _CMP_GE_OQ);
+        ok = _mm512_mask_cmp_ps_mask(ok, _mm512_add_ps(u, v), one, _CMP_LE_OQ);
+        ok = _mm512_mask_cmp_ps_mask(ok, d, zero, _CMP_GE_OQ);
+        _mm512_mask_storeu_ps(t + i, m, _mm512_mask_blend_ps(ok, inf, d));
+        store_hits(hit + i, ok, (left >= 16) ? 16 : int(left));
+    }
+}
+
+VM_TARGET_AVX512
+inline void rays_plane_n(float* t, uint8_t* hit, float const* const* rays, float const* plane,
+                         float eps, std::size_t n)
+{
+    __m512 const nx = _mm512_set1_ps(plane[0]), ny = _mm512_set1_ps(plane[1]);
+    __m512 const nz = _mm512_set1_ps(plane[2]), offset = _mm512_set1_ps(plane[3]);
+    __m512 const veps = _mm512_set1_ps(eps);
+    __m512 const zero = _mm512_setzero_ps();
+    __m512 const inf = _mm512_set1_ps(std::numeric_limits<float>::infinity());
+
+    for (std::size_t i=0; i<n; i+=16)
+    {
+        std::size_t const left = n - i;
+        __mmask16 const m = static_cast<__mmask16>((left >= 16) ? 0xffff : (1u << left) - 1);
+        __m512 const denom = dot3(nx, ny, nz, _mm512_maskz_loadu_ps(m, rays[3] + i),
+                                  _mm512_maskz_loadu_ps(m, rays[4] + i),
+                                  _mm512_maskz_loadu_ps(m, rays[5] + i));
+        __m512 const dist = _mm512_sub_ps(offset, dot3(nx, ny, nz, _mm512_maskz_loadu_ps(m, rays[0] + i),
+                                                       _mm512_maskz_loadu_ps(m, rays[1] + i),
+                                                       _mm512_maskz_loadu_ps(m, rays[2] + i)));
+        __m512 const d = _mm512_div_ps(dist, denom);
+        __mmask16 ok = _mm512_mask_cmp_ps_mask(m, _mm512_abs_ps(denom), veps, _CMP_GE_OQ);
+        ok = _mm512_mask_cmp_ps_mask(ok, d, zero, _CMP_GE_OQ);
+        _mm512_mask_storeu_ps(t + i, m, _mm512_mask_blend_ps(ok, inf, d));
+        store_hits(hit + i, ok, (left >= 16) ? 16 : int(left));
+    }
+}
+
+// Bounding boxes. Masked-off lanes load the box so far, which
+// leaves it unchanged.
+VM_TARGET_AVX512
+inline void bounds_n(float* lo, float* hi, float const* v, std::size_t n)
+{
+    __m512 l = _mm512_broadcast_f32x4(_mm_setr_ps(lo[0], lo[1], lo[2], 0.0f));
+    __m512 h = _mm512_broadcast_f32x4(_mm_setr_ps(hi[0], hi[1], hi[2], 0.0f));
+    for (std::size_t i=0; i<n; i+=4, v+=16)
+    {
+        __mmask16 const m = mask4(i, n);
+        l = _mm512_min_ps(_mm512_mask_loadu_ps(l, m, v), l);
+        h = _mm512_max_ps(_mm512_mask_loadu_ps(h, m, v), h);
+    }
+    __m256 const l8 = _mm256_min_ps(_mm512_castps512_ps256(l),
+                                    _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(l), 1)));
+    __m256 const h8 = _mm256_max_ps(_mm512_castps512_ps256(h),
+                                    _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(h), 1)));
+    sse::store3(lo, _mm_min_ps(_mm256_castps256_ps128(l8), _mm256_extractf128_ps(l8, 1)));
+    sse::store3(hi, _mm_max_ps(_mm256_castps256_ps128(h8), _mm256_extractf128_ps(h8, 1)));
+}
+
+VM_TARGET_AVX512
+inline void bounds_soa_n(float* lo, float* hi, float const* x, float const* y, float const* z,
+                         std::size_t n)
+{
+    __m512 lx = _mm512_set1_ps(lo[0]), ly = _mm512_set1_ps(lo[1]), lz = _mm512_set1_ps(lo[2]);
+    __m512 hx = _mm512_set1_ps(hi[0]), hy = _mm512_set1_ps(hi[1]), hz = _mm512_set1_ps(hi[2]);
+    for (std::size_t i=0; i<n; i+=16)
+    {
+        std::size_t const left = n - i;
+        __mmask16 const m = static_cast<__mmask16>((left >= 16) ? 0xffff : (1u << left) - 1);
+        lx = _mm512_min_ps(_mm512_mask_loadu_ps(lx, m, x + i), lx);
+        hx = _mm512_max_ps(_mm512_mask_loadu_ps(hx, m, x + i), hx);
+        ly = _mm512_min_ps(_mm512_mask_loadu_ps(ly, m, y + i), ly);
+        hy = _mm512_max_ps(_mm512_mask_loadu_ps(hy, m, y + i), hy);
+        lz = _mm512_min_ps(_mm512_mask_loadu_ps(lz, m, z + i), lz);
+        hz = _mm512_max_ps(_mm512_mask_loadu_ps(hz, m, z + i), hz);
+    }
+    lo[0] = _mm512_reduce_min_ps(lx); lo[1] = _mm512_reduce_min_ps(ly); lo[2] = _mm512_reduce_min_ps(lz);
+    hi[0] = _mm512_reduce_max_ps(hx); hi[1] = _mm512_reduce_max_ps(hy); hi[2] = _mm512_reduce_max_ps(hz);
+}
+
+VM_TARGET_AVX512
+inline void cull_boxes_n(uint8_t* visible, float const* planes, float const* const* box,
+                         std::size_t n)
+{
+    __m512 const half = _mm512_set1_ps(0.5f);
+    __m512 const zero = _mm512_setzero_ps();
+
+    for (std::size_t i=0; i<n; i+=16)
+    {
+        std::size_t const left = n - i;
+        __mmask16 const m = static_cast<__mmask16>((left >= 16) ? 0xffff : (1u << left) - 1);
+        __m512 const lx = _mm512_maskz_loadu_ps(m, box[0] + i), hx = _mm512_maskz_loadu_ps(m, box[3] + i);
+        __m512 const ly = _mm512_maskz_loadu_ps(m, box[1] + i), hy = _mm512_maskz_loadu_ps(m, box[4] + i);
+        __m512 const lz = _mm512_maskz_loadu_ps(m, box[2] + i), hz = _mm512_maskz_loadu_ps(m, box[5] + i);
+        __m512 const cx = _mm512_mul_ps(_mm512_add_ps(lx, hx), half);
+        __m512 const cy = _mm512_mul_ps(_mm512_add_ps(ly, hy), half);
+        __m512 const cz = _mm512_mul_ps(_mm512_add_ps(lz, hz), half);
+        __m512 const ex = _mm512_mul_ps(_mm512_sub_ps(hx, lx), half);
+        __m512 const ey = _mm512_mul_ps(_mm512_sub_ps(hy, ly), half);
+        __m512 const ez = _mm512_mul_ps(_mm512_sub_ps(hz, lz), half);
+
+        __mmask16 ok = _mm512_mask_cmp_ps_mask(m, ex, zero, _CMP_GE_OQ);
+        ok = _mm512_mask_cmp_ps_mask(ok, ey, zero, _CMP_GE_OQ);
+        ok = _mm512_mask_cmp_ps_mask(ok, ez, zero, _CMP_GE_OQ);
+        for (int k=0; k<24; k+=4)
+        {
+            float const* pl = planes + k;
+            __m512 const s = _mm512_sub_ps(dot3(_mm512_set1_ps(pl[0]), _mm512_set1_ps(pl[1]),
+                                                _mm512_set1_ps(pl[2]), cx, cy, cz),
+                                           _mm512_set1_ps(pl[3]));
+            __m512 const r = dot3(_mm512_set1_ps(std::abs(pl[0])), _mm512_set1_ps(std::abs(pl[1])),
+                                  _mm512_set1_ps(std::abs(pl[2])), ex, ey, ez);
+            ok = _mm512_mask_cmp_ps_mask(ok, _mm512_add_ps(s, r), zero, _CMP_GE_OQ);
+        }
+        store_hits(visible + i, ok, (left >= 16) ? 16 : int(left));
+    }
+}
+
+/*
+ * Projection, sixteen points per register, the last block masked.
+ * The clip codes are built from the compare masks and narrowed to
+ * bytes by a masked store.
+ */
+VM_TARGET_AVX512
+inline __m512 reciprocal(__m512 w, bool fast)
+{
+    if (!fast || vecmath::detail::deterministic)
+    {
+        return _mm512_div_ps(_mm512_set1_ps(1.0f), w);
+    }
+    __m512 const e = _mm512_rcp14_ps(w);    // 14 bits, then about 23
+    return _mm512_mul_ps(e, _mm512_sub_ps(_mm512_set1_ps(2.0f), _mm512_mul_ps(w, e)));
+}
+
+VM_TARGET_AVX512
+inline __m512i clip_codes(__m512 x, __m512 y, __m512 z, __m512 w)
+{
+    __m512 const nw = _mm512_sub_ps(_mm512_setzero_ps(), w);
+    __mmask16 const tests[6] = {_mm512_cmp_ps_mask(x, nw, _CMP_LT_OQ), _mm512_cmp_ps_mask(x, w, _CMP_GT_OQ),
+                                _mm512_cmp_ps_mask(y, nw, _CMP_LT_OQ), _mm512_cmp_ps_mask(y, w, _CMP_GT_OQ),
+                                static_cast<__mmask16>(_mm512_cmp_ps_mask(z, nw, _CMP_LT_OQ) |
+                                    _mm512_cmp_ps_mask(w, _mm512_setzero_ps(), _CMP_NGT_UQ)),
+                                _mm512_cmp_ps_mask(z, w, _CMP_GT_OQ)};
+    __m512i code = _mm512_setzero_si512();
+    for (int k=0; k<6; ++k)
+    {
+        code = _mm512_mask_or_epi32(code, tests[k], code, _mm512_set1_epi32(1 << k));
+    }
+    return code;
+}
+
+VM_TARGET_AVX512
+inline void project16(float* r, uint8_t* clip, __m512 const* mm, float const* v, bool fast,
+                      tail16 const& t)
+{
+    __m512 x = _mm512_maskz_loadu_ps(t.rows[0], v + 0);
+    __m512 y = _mm512_maskz_loadu_ps(t.rows[1], v + 16);
+    __m512 z = _mm512_maskz_loadu_ps(t.rows[2], v + 32);
+    __m512 w = _mm512_maskz_loadu_ps(t.rows[3], v + 48);
+    transpose4(x, y, z, w);
+
+    __m512 c[4];
+    for (int k=0; k<4; ++k)
+    {
+        __m512 acc = fmadd(y, mm[4*k+1], _mm512_mul_ps(x, mm[4*k+0]));
+        acc = fmadd(z, mm[4*k+2], acc);
+        c[k] = fmadd(w, mm[4*k+3], acc);
+    }
+    if (clip)
+    {
+        __m512i const idx = _mm512_setr_epi32(0, 4, 8, 12, 1, 5, 9, 13,
+                                              2, 6, 10, 14, 3, 7, 11, 15);
+        __m512i const code = _mm512_permutexvar_epi32(idx, clip_codes(c[0], c[1], c[2], c[3]));
+        _mm512_mask_cvtepi32_storeu_epi8(clip, t.scalars, code);
+    }
+
+    __m512 const inv = reciprocal(c[3], fast);
+    __m512 rx = _mm512_mul_ps(c[0], inv), ry = _mm512_mul_ps(c[1], inv);
+    __m512 rz = _mm512_mul_ps(c[2], inv), rw = inv;
+    transpose4(rx, ry, rz, rw);
+    _mm512_mask_storeu_ps(r + 0, t.rows[0], rx);
+    _mm512_mask_storeu_ps(r + 16, t.rows[1], ry);
+    _mm512_mask_storeu_ps(r + 32, t.rows[2], rz);
+    _mm512_mask_storeu_ps(r + 48, t.rows[3], rw);
+}
+
+VM_TARGET_AVX512
+inline void project_n(float* r, uint8_t* clip, float const* m, float const* v, bool fast,
+                      std::size_t n)
+{
+    __m512 mm[16];
+    for (int k=0; k<16; ++k)
+    {
+        mm[k] = _mm512_set1_ps(m[k]);
+    }
+
+    tail16 const all(16);
+    std::size_t i = 0;
+    for ( ; i+16<=n; i+=16, v+=64, r+=64)
+    {
+        project16(r, clip ? clip + i : nullptr, mm, v, fast, all);
+    }
+    if (i < n)
+    {
+        project16(r, clip ? clip + i : nullptr, mm, v, fast, tail16(n - i));
+    }
+}
+
+VM_TARGET_AVX512
+inline void project_soa_n(float* const* r, uint8_t* clip, float const* m, float const* const* v,
+                          bool fast, std::size_t n)
+{
+    __m512 mm[16];
+    for (int k=0; k<16; ++k)
+    {
+        mm[k] = _mm512_set1_ps(m[k]);
+    }
+
+    for (std::size_t i=0; i<n; i+=16)
+    {
+        std::size_t const left = n - i;
+        __mmask16 const mask = static_cast<__mmask16>((left >= 16) ? 0xffff : (1u << left) - 1);
+        __m512 const x = _mm512_maskz_loadu_ps(mask, v[0] + i);
+        __m512 const y = _mm512_maskz_loadu_ps(mask, v[1] + i);
+        __m512 const z = _mm512_maskz_loadu_ps(mask, v[2] + i);
+
+        __m512 c[4];
+        for (int k=0; k<4; ++k)
+        {
+            __m512 const acc = fmadd(y, mm[4*k+1], _mm512_mul_ps(x, mm[4*k+0]));
+            c[k] = _mm512_add_ps(fmadd(z, mm[4*k+2], acc), mm[4*k+3]);
+        }
+        if (clip)
+        {
+            _mm512_mask_cvtepi32_storeu_epi8(clip + i, mask, clip_codes(c[0], c[1], c[2], c[3]));
+        }
+
+        __m512 const inv = reciprocal(c[3], fast);
+        _mm512_mask_storeu_ps(r[0] + i, mask, _mm512_mul_ps(c[0], inv));
+        _mm512_mask_storeu_ps(r[1] + i, mask, _mm512_mul_ps(c[1], inv));
+        _mm512_mask_storeu_ps(r[2] + i, mask, _mm512_mul_ps(c[2], inv));
+    }
+}
+
+} // ::avx512
+} // ::simd
+} // ::vecmath
+
+#if defined(__GNUC__) && !defined(__clang__)
+#  pragma GCC diagnostic pop
+#endif
+
+#endif // VM_VECSIMD_AVX512_H
@@ -0,0 +1,522 @@
+/*
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/*
+ * AArch64 NEON kernels for the SIMD backend. Included by vecsimd.h.
+ */
+#ifndef VM_VECSIMD_NEON_H
+#define VM_VECSIMD_NEON_H
+
+#include <arm_neon.h>
+
+#include <limits>
+
+namespace vecmath {
+namespace simd {
+namespace neon {
+
+/*
+ * NEON is part of the AArch64 baseline, so these kernels need
+ * no target attributes. vfmaq_laneq_f32() multiplies by one lane
+ * of a register, which is the broadcast form for free. With
+ * VECMATH_DETERMINISTIC the multiply and add are separate, as in
+ * the scalar kernels.
+ */
+template <int lane>
+inline float32x4_t fma_lane(float32x4_t acc, float32x4_t b, float32x4_t v)
+{
+#if defined(VECMATH_DETERMINISTIC)
+    return vaddq_f32(acc, vmulq_laneq_f32(b, v, lane));
+#else
+    return vfmaq_laneq_f32(acc, b, v, lane);
+#endif
+}
+
+// r = a * b; r may alias a or b.
+inline void mm_mult(float* r, float const* a, float const* b)
+{
+    float32x4_t const b0 = vld1q_f32(b + 0);
+    float32x4_t const b1 = vld1q_f32(b + 4);
+    float32x4_t const b2 = vld1q_f32(b + 8);
+    float32x4_t const b3 = vld1q_f32(b + 12);
+
+    for (int i=0; i<16; i+=4)
+    {
+        float32x4_t const row = vld1q_f32(a + i);
+        float32x4_t acc = vmulq_laneq_f32(b0, row, 0);
+        acc = fma_lane<1>(acc, b1, row);
+        acc = fma_lane<2>(acc, b2, row);
+        acc = fma_lane<3>(acc, b3, row);
+        vst1q_f32(r + i, acc);
+    }
+}
+
+// r = v * m (row vector)
+inline void vm_mult(float* r, float const* v, float const* m)
+{
+    float32x4_t const x = vld1q_f32(v);
+    float32x4_t acc = vmulq_laneq_f32(vld1q_f32(m + 0), x, 0);
+    acc = fma_lane<1>(acc, vld1q_f32(m + 4), x);
+    acc = fma_lane<2>(acc, vld1q_f32(m + 8), x);
+    acc = fma_lane<3>(acc, vld1q_f32(m + 12), x);
+    vst1q_f32(r, acc);
+}
+
+// r[i] = m * v[i] for n packed 4-float vectors; r may alias v.
+inline void mv_mult_n(float* r, float const* m, float const* v, std::size_t n)
+{
+    float32x4x4_t const c = vld4q_f32(m);   // de-interleaves into columns
+
+    for (std::size_t i=0; i<n; ++i, v+=4, r+=4)
+    {
+        float32x4_t const x = vld1q_f32(v);
+        float32x4_t acc = vmulq_laneq_f32(c.val[0], x, 0);
+        acc = fma_lane<1>(acc, c.val[1], x);
+        acc = fma_lane<2>(acc, c.val[2], x);
+        acc = fma_lane<3>(acc, c.val[3], x);
+        vst1q_f32(r, acc);
+    }
+}
+
+// r = m * v (column vector)
+inline void mv_mult(float* r, float const* m, float const* v)
+{
+    mv_mult_n(r, m, v, 1);
+}
+
+/*
+ * vld4q_f32() de-interleaves four vectors into X, Y, Z and W
+ * registers, and vst4q_f32() interleaves them back, so the batch
+ * kernels need no transposes. They multiply and add separately,
+ * not with FMA, to round as the scalar kernels do; a tail of 1-3
+ * vectors goes to the scalar kernels.
+ */
+inline float32x4_t dot3(float32x4x4_t const& a, float32x4x4_t const& b)
+{
+    return vaddq_f32(vaddq_f32(vmulq_f32(a.val[0], b.val[0]), vmulq_f32(a.val[1], b.val[1])),
+                     vmulq_f32(a.val[2], b.val[2]));
+}
+
+inline void dot_n(float* r, float const* a, float const* b, std::size_t n)
+{
+    std::size_t i = 0;
+    for ( ; i+4<=n; i+=4, a+=16, b+=16)
+    {
+        vst1q_f32(r + i, dot3(vld4q_f32(a), vld4q_f32(b)));
+    }
+    scalar::dot_n(r + i, a, b, n - i);
+}
+
+inline void cross_n(float* r, float const* a, float const* b, std::size_t n)
+{
+    std::size_t i = 0;
+    for ( ; i+4<=n; i+=4, a+=16, b+=16, r+=16)
+    {
+        float32x4x4_t const va = vld4q_f32(a);
+        float32x4x4_t const vb = vld4q_f32(b);
+        float32x4x4_t c;
+        c.val[0] = vsubq_f32(vmulq_f32(va.val[1], vb.val[2]), vmulq_f32(va.val[2], vb.val[1]));
+        c.val[1] = vsubq_f32(vmulq_f32(va.val[2], vb.val[0]), vmulq_f32(va.val[0], vb.val[2]));
+        c.val[2] = vsubq_f32(vmulq_f32(va.val[0], vb.val[1]), vmulq_f32(va.val[1], vb.val[0]));
+        c.val[3] = vdupq_n_f32(1.0f);
+        vst4q_f32(r, c);
+    }
+    scalar::cross_n(r, a, b, n - i);
+}
+
+inline void length_n(float* r, float const* v, std::size_t n)
+{
+    std::size_t i = 0;
+    for ( ; i+4<=n; i+=4, v+=16)
+    {
+        float32x4x4_t const x = vld4q_f32(v);
+        vst1q_f32(r + i, vsqrtq_f32(dot3(x, x)));
+    }
+    scalar::length_n(r + i, v, n - i);
+}
+
+inline void normalize_n(float* r, float const* v, std::size_t n)
+{
+    float32x4_t const one = vdupq_n_f32(1.0f);
+    float32x4_t const tiny = vdupq_n_f32(std::numeric_limits<float>::min());
+
+    std::size_t i = 0;
+    for ( ; i+4<=n; i+=4, v+=16, r+=16)
+    {
+        float32x4x4_t x = vld4q_f32(v);
+        float32x4_t const inv = vdivq_f32(one, vsqrtq_f32(vaddq_f32(dot3(x, x), tiny)));
+        x.val[0] = vmulq_f32(x.val[0], inv);
+        x.val[1] = vmulq_f32(x.val[1], inv);
+        x.val[2] = vmulq_f32(x.val[2], inv);
+        x.val[3] = one;
+        vst4q_f32(r, x);
+    }
+    scalar::normalize_n(r, v, n - i);
+}
+
+// Separate X, Y and Z arrays need no de-interleaving.
+inline float32x4_t dot3(float32x4_t x, float32x4_t y, float32x4_t z)
+{
+    return vaddq_f32(vaddq_f32(vmulq_f32(x, x), vmulq_f32(y, y)), vmulq_f32(z, z));
+}
+
+inline void length_soa_n(float* r, float const* x, float const* y, float const* z, std::size_t n)
+{
+    std::size_t i = 0;
+    for ( ; i+4<=n; i+=4)
+    {
+        vst1q_f32(r + i, vsqrtq_f32(dot3(vld1q_f32(x + i), vld1q_f32(y + i), vld1q_f32(z + i))));
+    }
+    scalar::length_soa_n(r + i, x + i, y + i, z + i, n - i);
+}
+
+inline void normalize_soa_n(float* rx, float* ry, float* rz, float const* x,
+                            float const* y, float const* z, std::size_t n)
+{
+    float32x4_t const one = vdupq_n_f32(1.0f);
+    float32x4_t const tiny = vdupq_n_f32(std::numeric_limits<float>::min());
+
+    std::size_t i = 0;
+    for ( ; i+4<=n; i+=4)
+    {
+        float32x4_t const vx = vld1q_f32(x + i);
+        float32x4_t const vy = vld1q_f32(y + i);
+        float32x4_t const vz = vld1q_f32(z + i);
+        float32x4_t const inv = vdivq_f32(one, vsqrtq_f32(vaddq_f32(dot3(vx, vy, vz), tiny)));
+        vst1q_f32(rx + i, vmulq_f32(vx, inv));
+        vst1q_f32(ry + i, vmulq_f32(vy, inv));
+        vst1q_f32(rz + i, vmulq_f32(vz, inv));
+    }
+    scalar::normalize_soa_n(rx + i, ry + i, rz + i, x + i, y + i, z + i, n - i);
+}
+
+// The element-wise kernels take one vector per register.
+inline void add_n(float* r, float const* a, float const* b, std::size_t n)
+{
+    for (std::size_t i=0; i<n; ++i, a+=4, b+=4, r+=4)
+    {
+        vst1q_f32(r, vsetq_lane_f32(1.0f, vaddq_f32(vld1q_f32(a), vld1q_f32(b)), 3));
+    }
+}
+
+inline void sub_n(float* r, float const* a, float const* b, std::size_t n)
+{
+    for (std::size_t i=0; i<n; ++i, a+=4, b+=4, r+=4)
+    {
+        vst1q_f32(r, vsetq_lane_f32(1.0f, vsubq_f32(vld1q_f32(a), vld1q_f32(b)), 3));
+    }
+}
+
+inline void scale_n(float* r, float const* v, float s, std::size_t n)
+{
+    for (std::size_t i=0; i<n; ++i, v+=4, r+=4)
+    {
+        vst1q_f32(r, vsetq_lane_f32(1.0f, vmulq_n_f32(vld1q_f32(v), s), 3));
+    }
+}
+
+// The broadcast mm_mult() for each node of a hierarchy.
+inline void compose_n(float* world, float const* local, int32_t const* parent,
+                      int32_t const* node, std::size_t n)
+{
+    for (std::size_t k=0; k<n; ++k)
+    {
+        prefetch_node(world, local, parent, node, k, n);
+        std::size_t const i = node_at(node, k);
+        if (parent[i] < 0)
+        {
+            std::memmove(world + 16*i, local + 16*i, 16*sizeof(float));
+        }
+        else
+        {
+            mm_mult(world + 16*i, world + 16*parent[i], local + 16*i);
+        }
+    }
+}
+
+/*
+ * Ray intersection, four triangles or rays per register, in the
+ * scalar kernels' order of operations.
+ */
+inline float32x4_t dot3(float32x4_t ax, float32x4_t ay, float32x4_t az,
+                        float32x4_t bx, float32x4_t by, float32x4_t bz)
+{
+    return vaddq_f32(vaddq_f32(vmulq_f32(ax, bx), vmulq_f32(ay, by)), vmulq_f32(az, bz));
+}
+
+inline void store_hits4(uint8_t* hit, uint32x4_t ok)
+{
+    hit[0] = uint8_t(vgetq_lane_u32(ok, 0) & 1);
+    hit[1] = uint8_t(vgetq_lane_u32(ok, 1) & 1);
+    hit[2] = uint8_t(vgetq_lane_u32(ok, 2) & 1);
+    hit[3] = uint8_t(vgetq_lane_u32(ok, 3) & 1);
+}
+
+inline void ray_triangles_n(float* t, uint8_t* hit, float const* ray, float const* const* tri,
+                            float eps, std::size_t n)
+{
+    float32x4_t const ox = vdupq_n_f32(ray[0]), oy = vdupq_n_f32(ray[1]), oz = vdupq_n_f32(ray[2]);
+    float32x4_t const dx = vdupq_n_f32(ray[3]), dy = vdupq_n_f32(ray[4]), dz = vdupq_n_f32(ray[5]);
+    float32x4_t const veps = vdupq_n_f32(eps);
+    float32x4_t const zero = vdupq_n_f32(0.0f);
+    float32x4_t const one = vdupq_n_f32(1.0f);
+    float32x4_t const inf = vdupq_n_f32(std::numeric_limits<float>::infinity());
+
+    std::size_t i = 0;
+    for ( ; i+4<=n; i+=4)
+    {
+        float32x4_t const e1x = vld1q_f32(tri[3] + i);
+        float32x4_t const e1y = vld1q_f32(tri[4] + i);
+        float32x4_t const e1z = vld1q_f32(tri[5] + i);
+        float32x4_t const e2x = vld1q_f32(tri[6] + i);
+        float32x4_t const e2y = vld1q_f32(tri[7] + i);
+        float32x4_t const e2z = vld1q_f32(tri[8] + i);
+        float32x4_t const px = vsubq_f32(vmulq_f32(dy, e2z), vmulq_f32(dz, e2y));
+        float32x4_t const py = vsubq_f32(vmulq_f32(dz, e2x), vmulq_f32(dx, e2z));
+        float32x4_t const pz = vsubq_f32(vmulq_f32(dx, e2y), vmulq_f32(dy, e2x));
+        float32x4_t const det = dot3(e1x, e1y, e1z, px, py, pz);
+        float32x4_t const inv = vdivq_f32(one, det);
+        float32x4_t const sx = vsubq_f32(ox, vld1q_f32(tri[0] + i));
+        float32x4_t const sy = vsubq_f32(oy, vld1q_f32(tri[1] + i));
+        float32x4_t const sz = vsubq_f32(oz, vld1q_f32(tri[2] + i));
+        float32x4_t const u = vmulq_f32(dot3(sx, sy, sz, px, py, pz), inv);
+        float32x4_t const qx = vsubq_f32(vmulq_f32(sy, e1z), vmulq_f32(sz, e1y));
+        float32x4_t const qy = vsubq_f32(vmulq_f32(sz, e1x), vmulq_f32(sx, e1z));
+        float32x4_t const qz = vsubq_f32(vmulq_f32(sx, e1y), vmulq_f32(sy, e1x));
+        float32x4_t const v = vmulq_f32(dot3(dx, dy, dz, qx, qy, qz), inv);
+        float32x4_t const d = vmulq_f32(dot3(e2x, e2y, e2z, qx, qy, qz), inv);
+
+        uint32x4_t ok = vcgeq_f32(vabsq_f32(det), veps);
+        ok = vandq_u32(ok, vcgeq_f32(u, zero));
+        ok = vandq_u32(ok, vcgeq_f32(v, zero));
+        ok = vandq_u32(ok, vcleq_f32(vaddq_f32(u, v), one));
+        ok = vandq_u32(ok, vcgeq_f32(d, zero));
+        vst1q_f32(t + i, vbslq_f32(ok, d, inf));
+        store_hits4(hit + i, ok);
+    }
+    arrays_from<float> const rest(tri, 9, i);
+    scalar::ray_triangles_n(t + i, hit + i, ray, rest.p, eps, n - i);
+}
+
+inline void rays_plane_n(float* t, uint8_t* hit, float const* const* rays, float const* plane,
+                         float eps, std::size_t n)
+{
+    float32x4_t const nx = vdupq_n_f32(plane[0]), ny = vdupq_n_f32(plane[1]);
+    float32x4_t const nz = vdupq_n_f32(plane[2]), offset = vdupq_n_f32(plane[3]);
+    float32x4_t const veps = vdupq_n_f32(eps);
+    float32x4_t const zero = vdupq_n_f32(0.0f);
+    float32x4_t const inf = vdupq_n_f32(std::numeric_limits<float>::infinity());
+
+    std::size_t i = 0;
+    for ( ; i+4<=n; i+=4)
+    {
+        float32x4_t const denom = dot3(nx, ny, nz, vld1q_f32(rays[3] + i),
+                                       vld1q_f32(rays[4] + i), vld1q_f32(rays[5] + i));
+        float32x4_t const dist = vsubq_f32(offset, dot3(nx, ny, nz, vld1q_f32(rays[0] + i),
+                                                        vld1q_f32(rays[1] + i),
+                                                        vld1q_f32(rays[2] + i)));
+        float32x4_t const d = vdivq_f32(dist, denom);
+        uint32x4_t const ok = vandq_u32(vcgeq_f32(vabsq_f32(denom), veps), vcgeq_f32(d, zero));
+        vst1q_f32(t + i, vbslq_f32(ok, d, inf));
+        store_hits4(hit + i, ok);
+    }
+    arrays_from<float> const rest(rays, 6, i);
+    scalar::rays_plane_n(t + i, hit + i, rest.p, plane, eps, n - i);
+}
+
+// Bounding boxes. A vector's W is boxed too, and dropped.
+inline void store3(float* r, float32x4_t v)
+{
+    r[0] = vgetq_lane_f32(v, 0);
+    r[1] = vgetq_lane_f32(v, 1);
+    r[2] = vgetq_lane_f32(v, 2);
+}
+
+inline void bounds_n(float* lo, float* hi, float const* v, std::size_t n)
+{
+    float const l[4] = {lo[0], lo[1], lo[2], 0.0f};
+    float const h[4] = {hi[0], hi[1], hi[2], 0.0f};
+    float32x4_t l0 = vld1q_f32(l), l1 = l0;
+    float32x4_t h0 = vld1q_f32(h), h1 = h0;
+
+    std::size_t i = 0;
+    for ( ; i+2<=n; i+=2, v+=8)
+    {
+        float32x4_t const a = vld1q_f32(v);
+        float32x4_t const b = vld1q_f32(v + 4);
+        l0 = vminq_f32(a, l0);
+        h0 = vmaxq_f32(a, h0);
+        l1 = vminq_f32(b, l1);
+        h1 = vmaxq_f32(b, h1);
+    }
+    if (i < n)
+    {
+        float32x4_t const a = vld1q_f32(v);
+        l0 = vminq_f32(a, l0);
+        h0 = vmaxq_f32(a, h0);
+    }
+    store3(lo, vminq_f32(l0, l1));
+    store3(hi, vmaxq_f32(h0, h1));
+}
+
+inline void bounds_soa_n(float* lo, float* hi, float const* x, float const* y, float const* z,
+                         std::size_t n)
+{
+    float32x4_t lx = vdupq_n_f32(lo[0]), ly = vdupq_n_f32(lo[1]), lz = vdupq_n_f32(lo[2]);
+    float32x4_t hx = vdupq_n_f32(hi[0]), hy = vdupq_n_f32(hi[1]), hz = vdupq_n_f32(hi[2]);
+
+    std::size_t i = 0;
+    for ( ; i+4<=n; i+=4)
+    {
+        float32x4_t const vx = vld1q_f32(x + i);
+        float32x4_t const vy = vld1q_f32(y + i);
+        float32x4_t const vz = vld1q_f32(z + i);
+        lx = vminq_f32(vx, lx);
+        hx = vmaxq_f32(vx, hx);
+        ly = vminq_f32(vy, ly);
+        hy = vmaxq_f32(vy, hy);
+        lz = vminq_f32(vz, lz);
+        hz = vmaxq_f32(vz, hz);
+    }
+    lo[0] = vminvq_f32(lx); lo[1] = vminvq_f32(ly); lo[2] = vminvq_f32(lz);
+    hi[0] = vmaxvq_f32(hx); hi[1] = vmaxvq_f32(hy); hi[2] = vmaxvq_f32(hz);
+    scalar::bounds_soa_n(lo, hi, x + i, y + i, z + i, n - i);
+}
+
+inline void cull_boxes_n(uint8_t* visible, float const* planes, float const* const* box,
+                         std::size_t n)
+{
+    float32x4_t const half = vdupq_n_f32(0.5f);
+    float32x4_t const zero = vdupq_n_f32(0.0f);
+
+    std::size_t i = 0;
+    for ( ; i+4<=n; i+=4)
+    {
+        float32x4_t const lx = vld1q_f32(box[0] + i), hx = vld1q_f32(box[3] + i);
+        float32x4_t const ly = vld1q_f32(box[1] + i), hy = vld1q_f32(box[4] + i);
+        float32x4_t const lz = vld1q_f32(box[2] + i), hz = vld1q_f32(box[5] + i);
+        float32x4_t const cx = vmulq_f32(vaddq_f32(lx, hx), half), ex = vmulq_f32(vsubq_f32(hx, lx), half);
+        float32x4_t const cy = vmulq_f32(vaddq_f32(ly, hy), half), ey = vmulq_f32(vsubq_f32(hy, ly), half);
+        float32x4_t const cz = vmulq_f32(vaddq_f32(lz, hz), half), ez = vmulq_f32(vsubq_f32(hz, lz), half);
+
+        uint32x4_t ok = vandq_u32(vcgeq_f32(ex, zero), vandq_u32(vcgeq_f32(ey, zero), vcgeq_f32(ez, zero)));
+        for (int k=0; k<24; k+=4)
+        {
+            float const* pl = planes + k;
+            float32x4_t const s = vsubq_f32(dot3(vdupq_n_f32(pl[0]), vdupq_n_f32(pl[1]), vdupq_n_f32(pl[2]),
+                                                 cx, cy, cz), vdupq_n_f32(pl[3]));
+            float32x4_t const r = dot3(vdupq_n_f32(std::abs(pl[0])), vdupq_n_f32(std::abs(pl[1])),
+                                       vdupq_n_f32(std::abs(pl[2])), ex, ey, ez);
+            ok = vandq_u32(ok, vcgeq_f32(vaddq_f32(s, r), zero));
+        }
+        store_hits4(visible + i, ok);
+    }
+    arrays_from<float> const rest(box, 6, i);
+    scalar::cull_boxes_n(visible + i, planes, rest.p, n - i);
+}
+
+/*
+ * Projection, four points per register, multiplying and adding
+ * separately as the scalar kernels do. The reciprocal estimate has
+ * only 8 bits, so the fast form takes two refinement steps.
+ */
+inline float32x4_t reciprocal(float32x4_t w, bool fast)
+{
+    if (!fast || vecmath::detail::deterministic)
+    {
+        return vdivq_f32(vdupq_n_f32(1.0f), w);
+    }
+    float32x4_t e = vrecpeq_f32(w);
+    e = vmulq_f32(e, vrecpsq_f32(w, e));
+    return vmulq_f32(e, vrecpsq_f32(w, e));
+}
+
+inline void store_clip4(uint8_t* clip, float32x4_t x, float32x4_t y, float32x4_t z, float32x4_t w)
+{
+    float32x4_t const nw = vnegq_f32(w);
+    uint32x4_t const tests[6] = {vcltq_f32(x, nw), vcgtq_f32(x, w),
+                                 vcltq_f32(y, nw), vcgtq_f32(y, w),
+                                 vorrq_u32(vcltq_f32(z, nw), vmvnq_u32(vcgtq_f32(w, vdupq_n_f32(0.0f)))),
+                                 vcgtq_f32(z, w)};
+    uint32x4_t code = vdupq_n_u32(0);
+    for (int k=0; k<6; ++k)
+    {
+        code = vorrq_u32(code, vandq_u32(tests[k], vdupq_n_u32(1u << k)));
+    }
+    uint16x4_t const half = vmovn_u32(code);
+    uint32_t const bytes = vget_lane_u32(vreinterpret_u32_u8(vmovn_u16(vcombine_u16(half, half))), 0);
+    std::memcpy(clip, &bytes, 4);
+}
+
+inline float32x4_t row4(float32x4_t x, float32x4_t y, float32x4_t z, float const* m)
+{
+    float32x4_t const acc = vaddq_f32(vmulq_f32(x, vdupq_n_f32(m[0])), vmulq_f32(y, vdupq_n_f32(m[1])));
+    return vaddq_f32(acc, vmulq_f32(z, vdupq_n_f32(m[2])));
+}
+
+inline void project_n(float* r, uint8_t* clip, float const* m, float const* v, bool fast,
+                      std::size_t n)
+{
+    std::size_t i = 0;
+    for ( ; i+4<=n; i+=4, v+=16, r+=16)
+    {
+        float32x4x4_t p = vld4q_f32(v);
+        float32x4_t c[4];
+        for (int k=0; k<4; ++k)
+        {
+            c[k] = vaddq_f32(row4(p.val[0], p.val[1], p.val[2], m + 4*k),
+                             vmulq_f32(p.val[3], vdupq_n_f32(m[4*k+3])));
+        }
+        if (clip)
+        {
+            store_clip4(clip + i, c[0], c[1], c[2], c[3]);
+        }
+
+        float32x4_t const inv = reciprocal(c[3], fast);
+        p.val[0] = vmulq_f32(c[0], inv);
+        p.val[1] = vmulq_f32(c[1], inv);
+        p.val[2] = vmulq_f32(c[2], inv);
+        p.val[3] = inv;
+        vst4q_f32(r, p);
+    }
+    scalar::project_n(r, clip ? clip + i : nullptr, m, v, fast, n - i);
+}
+
+inline void project_soa_n(float* const* r, uint8_t* clip, float const* m, float const* const* v,
+                          bool fast, std::size_t n)
+{
+    std::size_t i = 0;
+    for ( ; i+4<=n; i+=4)
+    {
+        float32x4_t const x = vld1q_f32(v[0] + i);
+        float32x4_t const y = vld1q_f32(v[1] + i);
+        float32x4_t const z = vld1q_f32(v[2] + i);
+        float32x4_t c[4];
+        for (int k=0; k<4; ++k)
+        {
+            c[k] = vaddq_f32(row4(x, y, z, m + 4*k), vdupq_n_f32(m[4*k+3]));
+        }
+        if (clip)
+        {
+            store_clip4(clip + i, c[0], c[1], c[2], c[3]);
+        }
+
+        float32x4_t const inv = reciprocal(c[3], fast);
+        vst1q_f32(r[0] + i, vmulq_f32(c[0], inv));
+        vst1q_f32(r[1] + i, vmulq_f32(c[1], inv));
+        vst1q_f32(r[2] + i, vmulq_f32(c[2], inv));
+    }
+    arrays_from<float> const in(v, 3, i);
+    outputs_from<float> const out(r, 3, i);
+    scalar::project_soa_n(out.p, clip ? clip + i : nullptr, m, in.p, fast, n - i);
+}
+
+} // ::neon
+} // ::simd
+} // ::vecmath
+
+#endif // VM_VECSIMD_NEON_H
@@ -0,0 +1,600 @@
+/*
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/*
+ * SSE2 kernels for the SIMD backend. Included by vecsimd.h.
+ */
+#ifndef VM_VECSIMD_SSE_H
+#define VM_VECSIMD_SSE_H
+
+#include <emmintrin.h>
+
+#include <limits>
+
+namespace vecmath {
+namespace simd {
+namespace sse {
+
+/*
+ * SSE2 has no FMA, so products are accumulated one at a time in
+ * the same order as the scalar operators (((p0 + p1) + p2) + p3).
+ * The results are bit-identical to matops.h when the compiler
+ * does not contract the scalar code.
+ */
+
+// r = a * b; r may alias a or b.
+VM_TARGET_SSE
+inline void mm_mult(float* r, float const* a, float const* b)
+{
+    __m128 const b0 = _mm_loadu_ps(b + 0);
+    __m128 const b1 = _mm_loadu_ps(b + 4);
+    __m128 const b2 = _mm_loadu_ps(b + 8);
+    __m128 const b3 = _mm_loadu_ps(b + 12);
+
+    for (int i=0; i<16; i+=4)
+    {
+        __m128 acc = _mm_mul_ps(_mm_set1_ps(a[i+0]), b0);
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(a[i+1]), b1));
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(a[i+2]), b2));
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(a[i+3]), b3));
+        _mm_storeu_ps(r + i, acc);
+    }
+}
+
+// r = v * m (row vector)
+VM_TARGET_SSE
+inline void vm_mult(float* r, float const* v, float const* m)
+{
+    __m128 acc = _mm_mul_ps(_mm_set1_ps(v[0]), _mm_loadu_ps(m + 0));
+    acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(v[1]), _mm_loadu_ps(m + 4)));
+    acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(v[2]), _mm_loadu_ps(m + 8)));
+    acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(v[3]), _mm_loadu_ps(m + 12)));
+    _mm_storeu_ps(r, acc);
+}
+
+/*
+ * M * v needs the columns of m for the broadcast form, so the
+ * matrix is transposed in registers first. The batch version
+ * pays for the transpose once per call rather than per vector.
+ */
+VM_TARGET_SSE
+inline void mv_mult_n(float* r, float const* m, float const* v, std::size_t n)
+{
+    __m128 c0 = _mm_loadu_ps(m + 0);
+    __m128 c1 = _mm_loadu_ps(m + 4);
+    __m128 c2 = _mm_loadu_ps(m + 8);
+    __m128 c3 = _mm_loadu_ps(m + 12);
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+    for (std::size_t i=0; i<n; ++i, v+=4, r+=4)
+    {
+        __m128 const x = _mm_loadu_ps(v);
+        __m128 acc = _mm_mul_ps(_mm_shuffle_ps(x, x, 0x00), c0);
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_shuffle_ps(x, x, 0x55), c1));
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_shuffle_ps(x, x, 0xAA), c2));
+        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_shuffle_ps(x, x, 0xFF), c3));
+        _mm_storeu_ps(r, acc);
+    }
+}
+
+// r = m * v (column vector)
+VM_TARGET_SSE
+inline void mv_mult(float* r, float const* m, float const* v)
+{
+    mv_mult_n(r, m, v, 1);
+}
+
+/*
+ * The batch kernels transpose four vectors at a time in registers,
+ * so that X, Y and Z each fill one, and work on the components as
+ * the scalar kernels do. A tail of 1-3 vectors goes to the scalar
+ * kernels, which round identically.
+ */
+VM_TARGET_SSE
+inline void load4(float const* v, __m128& x, __m128& y, __m128& z)
+{
+    __m128 r0 = _mm_loadu_ps(v + 0);
+    __m128 r1 = _mm_loadu_ps(v + 4);
+    __m128 r2 = _mm_loadu_ps(v + 8);
+    __m128 r3 = _mm_loadu_ps(v + 12);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    x = r0;
+    y = r1;
+    z = r2;
+}
+
+VM_TARGET_SSE
+inline void store4(float* v, __m128 x, __m128 y, __m128 z)
+{
+    __m128 w = _mm_set1_ps(1.0f);
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+    _mm_storeu_ps(v + 0, x);
+    _mm_storeu_ps(v + 4, y);
+    _mm_storeu_ps(v + 8, z);
+    _mm_storeu_ps(v + 12, w);
+}
+
+VM_TARGET_SSE
+inline __m128 dot3(__m128 ax, __m128 ay, __m128 az, __m128 bx, __m128 by, __m128 bz)
+{
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz));
+}
+
+VM_TARGET_SSE
+inline void dot_n(float* r, float const* a, float const* b, std::size_t n)
+{
+    std::size_t i = 0;
+    for ( ; i+4<=n; i+=4, a+=16, b+=16)
+    {
+        __m128 ax, ay, az, bx, by, bz;
+        load4(a, ax, ay, az);
+        load4(b, bx, by, bz);
+        _mm_storeu_ps(r + i, dot3(ax, ay, az, bx, by, bz));
+    }
+    scalar::dot_n(r + i, a, b, n - i);
+}
+
+VM_TARGET_SSE
+inline void cross_n(float* r, float const* a, float const* b, std::size_t n)
+{
+    std::size_t i = 0;
+    for ( ; i+4<=n; i+=4, a+=16, b+=16, r+=16)
+    {
+        __m128 ax, ay, az, bx, by, bz;
+        load4(a, ax, ay, az);
+        load4(b, bx, by, bz);
+        store4(r, _mm_sub_ps(_mm_mul_ps(ay, bz), _mm_mul_ps(az, by)),
+                  _mm_sub_ps(_mm_mul_ps(az, bx), _mm_mul_ps(ax, bz)),
+                  _mm_sub_ps(_mm_mul_ps(ax, by), _mm_mul_ps(ay, bx)));
+    }
+    scalar::cross_n(r, a, b, n - i);
+}
+
+VM_TARGET_SSE
+inline void length_n(float* r, float const* v, std::size_t n)
+{
+    std::size_t i = 0;
+    for ( ; i+4<=n; i+=4, v+=16)
+    {
+        __m128 x, y, z;
+        load4(v, x, y, z);
+        _mm_storeu_ps(r + i, _mm_sqrt_ps(dot3(x, y, z, x, y, z)));
+    }
+    scalar::length_n(r + i, v, n - i);
+}
+
+VM_TARGET_SSE
+inline void normalize_n(float* r, float const* v, std::size_t n)
+{
+    __m128 const one = _mm_set1_ps(1.0f);
+    __m128 const tiny = _mm_set1_ps(std::numeric_limits<float>::min());
+
+    std::size_t i = 0;
+    for ( ; i+4<=n; i+=4, v+=16, r+=16)
+    {
+        __m128 x, y, z;
+        load4(v, x, y, z);
+        __m128 const d = _mm_add_ps(dot3(x, y, z, x, y, z), tiny);
+        __m128 const inv = _mm_div_ps(one, _mm_sqrt_ps(d));
+        store4(r, _mm_mul_ps(x, inv), _mm_mul_ps(y, inv), _mm_mul_ps(z, inv));
+    }
+    scalar::normalize_n(r, v, n - i);
+}
+
+// Separate X, Y and Z arrays need no transpose.
+VM_TARGET_SSE
+inline void length_soa_n(float* r, float const* x, float const* y, float const* z, std::size_t n)
+{
+    std::size_t i = 0;
+    for ( ; i+4<=n; i+=4)
+    {
+        __m128 const vx = _mm_loadu_ps(x + i);
+        __m128 const vy = _mm_loadu_ps(y + i);
+        __m128 const vz = _mm_loadu_ps(z + i);
+        _mm_storeu_ps(r + i, _mm_sqrt_ps(dot3(vx, vy, vz, vx, vy, vz)));
+    }
+    scalar::length_soa_n(r + i, x + i, y + i, z + i, n - i);
+}
+
+VM_TARGET_SSE
+inline void normalize_soa_n(float* rx, float* ry, float* rz, float const* x,
+                            float const* y, float const* z, std::size_t n)
+{
+    __m128 const one = _mm_set1_ps(1.0f);
+    __m128 const tiny = _mm_set1_ps(std::numeric_limits<float>::min());
+
+    std::size_t i = 0;
+    for ( ; i+4<=n; i+=4)
+    {
+        __m128 const vx = _mm_loadu_ps(x + i);
+        __m128 const vy = _mm_loadu_ps(y + i);
+        __m128 const vz = _mm_loadu_ps(z + i);
+        __m128 const d = _mm_add_ps(dot3(vx, vy, vz, vx, vy, vz), tiny);
+        __m128 const inv = _mm_div_ps(one, _mm_sqrt_ps(d));
+        _mm_storeu_ps(rx + i, _mm_mul_ps(vx, inv));
+        _mm_storeu_ps(ry + i, _mm_mul_ps(vy, inv));
+        _mm_storeu_ps(rz + i, _mm_mul_ps(vz, inv));
+    }
+    scalar::normalize_soa_n(rx + i, ry + i, rz + i, x + i, y + i, z + i, n - i);
+}
+
+/*
+ * The element-wise kernels need no transpose: each vector is one
+ * register, with W replaced by 1.
+ */
+VM_TARGET_SSE
+inline __m128 with_w1(__m128 v)
+{
+    __m128 const xyz = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+    return _mm_or_ps(_mm_and_ps(v, xyz), _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f));
+}
+
+VM_TARGET_SSE
+inline void add_n(float* r, float const* a, float const* b, std::size_t n)
+{
+    for (std::size_t i=0; i<n; ++i, a+=4, b+=4, r+=4)
+    {
+        _mm_storeu_ps(r, with_w1(_mm_add_ps(_mm_loadu_ps(a), _mm_loadu_ps(b))));
+    }
+}
+
+VM_TARGET_SSE
+inline void sub_n(float* r, float const* a, float const* b, std::size_t n)
+{
+    for (std::size_t i=0; i<n; ++i, a+=4, b+=4, r+=4)
+    {
+        _mm_storeu_ps(r, with_w1(_mm_sub_ps(_mm_loadu_ps(a), _mm_loadu_ps(b))));
+    }
+}
+
+VM_TARGET_SSE
+inline void scale_n(float* r, float const* v, float s, std::size_t n)
+{
+    __m128 const k = _mm_set1_ps(s);
+    for (std::size_t i=0; i<n; ++i, v+=4, r+=4)
+    {
+        _mm_storeu_ps(r, with_w1(_mm_mul_ps(_mm_loadu_ps(v), k)));
+    }
+}
+
+// The broadcast mm_mult() for each node of a hierarchy.
+VM_TARGET_SSE
+inline void compose_n(float* world, float const* local, int32_t const* parent,
+                      int32_t const* node, std::size_t n)
+{
+    for (std::size_t k=0; k<n; ++k)
+    {
+        prefetch_node(world, local, parent, node, k, n);
+        std::size_t const i = node_at(node, k);
+        if (parent[i] < 0)
+        {
+            std::memmove(world + 16*i, local + 16*i, 16*sizeof(float));
+        }
+        else
+        {
+            mm_mult(world + 16*i, world + 16*parent[i], local + 16*i);
+        }
+    }
+}
+
+/*
+ * Ray intersection, four triangles or rays per register, in the
+ * scalar kernels' order of operations.
+ */
+VM_TARGET_SSE
+inline __m128 select(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+VM_TARGET_SSE
+inline void ray_triangles_n(float* t, uint8_t* hit, float const* ray, float const* const* tri,
+                            float eps, std::size_t n)
+{
+    __m128 const ox = _mm_set1_ps(ray[0]), oy = _mm_set1_ps(ray[1]), oz = _mm_set1_ps(ray[2]);
+    __m128 const dx = _mm_set1_ps(ray[3]), dy = _mm_set1_ps(ray[4]), dz = _mm_set1_ps(ray[5]);
+    __m128 const veps = _mm_set1_ps(eps);
+    __m128 const zero = _mm_setzero_ps();
+    __m128 const one = _mm_set1_ps(1.0f);
+    __m128 const inf = _mm_set1_ps(std::numeric_limits<float>::infinity());
+    __m128 const sign = _mm_set1_ps(-0.0f);
+
+    std::size_t i = 0;
+    for ( ; i+4<=n; i+=4)
+    {
+        __m128 const e1x = _mm_loadu_ps(tri[3] + i);
+        __m128 const e1y = _mm_loadu_ps(tri[4] + i);
+        __m128 const e1z = _mm_loadu_ps(tri[5] + i);
+        __m128 const e2x = _mm_loadu_ps(tri[6] + i);
+        __m128 const e2y = _mm_loadu_ps(tri[7] + i);
+        __m128 const e2z = _mm_loadu_ps(tri[8] + i);
+        __m128 const px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+        __m128 const py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+        __m128 const pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+        __m128 const det = dot3(e1x, e1y, e1z, px, py, pz);
+        __m128 const inv = _mm_div_ps(one, det);
+        __m128 const sx = _mm_sub_ps(ox, _mm_loadu_ps(tri[0] + i));
+        __m128 const sy = _mm_sub_ps(oy, _mm_loadu_ps(tri[1] + i));
+        __m128 const sz = _mm_sub_ps(oz, _mm_loadu_ps(tri[2] + i));
+        __m128 const u = _mm_mul_ps(dot3(sx, sy, sz, px, py, pz), inv);
+        __m128 const qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+        __m128 const qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+        __m128 const qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+        __m128 const v = _mm_mul_ps(dot3(dx, dy, dz, qx, qy, qz), inv);
+        __m128 const d = _mm_mul_ps(dot3(e2x, e2y, e2z, qx, qy, qz), inv);
+
+        __m128 ok = _mm_cmpge_ps(_mm_andnot_ps(sign, det), veps);
+        ok = _mm_and_ps(ok, _mm_cmpge_ps(u, zero));
+        ok = _mm_and_ps(ok, _mm_cmpge_ps(v, zero));
+        ok = _mm_and_ps(ok, _mm_cmple_ps(_mm_add_ps(u, v), one));
+        ok = _mm_and_ps(ok, _mm_cmpge_ps(d, zero));
+        _mm_storeu_ps(t + i, select(ok, d, inf));
+        store_hits(hit + i, unsigned(_mm_movemask_ps(ok)), 4);
+    }
+    arrays_from<float> const rest(tri, 9, i);
+    scalar::ray_triangles_n(t + i, hit + i, ray, rest.p, eps, n - i);
+}
+
+VM_TARGET_SSE
+inline void rays_plane_n(float* t, uint8_t* hit, float const* const* rays, float const* plane,
+                         float eps, std::size_t n)
+{
+    __m128 const nx = _mm_set1_ps(plane[0]), ny = _mm_set1_ps(plane[1]), nz = _mm_set1_ps(plane[2]);
+    __m128 const offset = _mm_set1_ps(plane[3]);
+    __m128 const veps = _mm_set1_ps(eps);
+    __m128 const zero = _mm_setzero_ps();
+    __m128 const inf = _mm_set1_ps(std::numeric_limits<float>::infinity());
+    __m128 const sign = _mm_set1_ps(-0.0f);
+
+    std::size_t i = 0;
+    for ( ; i+4<=n; i+=4)
+    {
+        __m128 const denom = dot3(nx, ny, nz, _mm_loadu_ps(rays[3] + i),
+                                  _mm_loadu_ps(rays[4] + i), _mm_loadu_ps(rays[5] + i));
+        __m128 const dist = _mm_sub_ps(offset, dot3(nx, ny, nz, _mm_loadu_ps(rays[0] + i),
+                                                    _mm_loadu_ps(rays[1] + i),
+                                                    _mm_loadu_ps(rays[2] + i)));
+        __m128 const d = _mm_div_ps(dist, denom);
+        __m128 const ok = _mm_and_ps(_mm_cmpge_ps(_mm_andnot_ps(sign, denom), veps),
+                                     _mm_cmpge_ps(d, zero));
+        _mm_storeu_ps(t + i, select(ok, d, inf));
+        store_hits(hit + i, unsigned(_mm_movemask_ps(ok)), 4);
+    }
+    arrays_from<float> const rest(rays, 6, i);
+    scalar::rays_plane_n(t + i, hit + i, rest.p, plane, eps, n - i);
+}
+
+// Bounding boxes. A vector's W is boxed too, and dropped.
+VM_TARGET_SSE
+inline void store3(float* r, __m128 v)
+{
+    float t[4];
+    _mm_storeu_ps(t, v);
+    r[0] = t[0];
+    r[1] = t[1];
+    r[2] = t[2];
+}
+
+VM_TARGET_SSE
+inline float hmin(__m128 v)
+{
+    v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtss_f32(_mm_min_ps(v, _mm_movehl_ps(v, v)));
+}
+
+VM_TARGET_SSE
+inline float hmax(__m128 v)
+{
+    v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtss_f32(_mm_max_ps(v, _mm_movehl_ps(v, v)));
+}
+
+VM_TARGET_SSE
+inline void bounds_n(float* lo, float* hi, float const* v, std::size_t n)
+{
+    __m128 l0 = _mm_setr_ps(lo[0], lo[1], lo[2], 0.0f), l1 = l0;
+    __m128 h0 = _mm_setr_ps(hi[0], hi[1], hi[2], 0.0f), h1 = h0;
+
+    std::size_t i = 0;
+    for ( ; i+2<=n; i+=2, v+=8)
+    {
+        __m128 const a = _mm_loadu_ps(v);
+        __m128 const b = _mm_loadu_ps(v + 4);
+        l0 = _mm_min_ps(a, l0);
+        h0 = _mm_max_ps(a, h0);
+        l1 = _mm_min_ps(b, l1);
+        h1 = _mm_max_ps(b, h1);
+    }
+    if (i < n)
+    {
+        __m128 const a = _mm_loadu_ps(v);
+        l0 = _mm_min_ps(a, l0);
+        h0 = _mm_max_ps(a, h0);
+    }
+    store3(lo, _mm_min_ps(l0, l1));
+    store3(hi, _mm_max_ps(h0, h1));
+}
+
+VM_TARGET_SSE
+inline void bounds_soa_n(float* lo, float* hi, float const* x, float const* y, float const* z,
+                         std::size_t n)
+{
+    __m128 lx = _mm_set1_ps(lo[0]), ly = _mm_set1_ps(lo[1]), lz = _mm_set1_ps(lo[2]);
+    __m128 hx = _mm_set1_ps(hi[0]), hy = _mm_set1_ps(hi[1]), hz = _mm_set1_ps(hi[2]);
+
+    std::size_t i = 0;
+    for ( ; i+4<=n; i+=4)
+    {
+        __m128 const vx = _mm_loadu_ps(x + i);
+        __m128 const vy = _mm_loadu_ps(y + i);
+        __m128 const vz = _mm_loadu_ps(z + i);
+        lx = _mm_min_ps(vx, lx);
+        hx = _mm_max_ps(vx, hx);
+        ly = _mm_min_ps(vy, ly);
+        hy = _mm_max_ps(vy, hy);
+        lz = _mm_min_ps(vz, lz);
+        hz = _mm_max_ps(vz, hz);
+    }
+    lo[0] = hmin(lx); lo[1] = hmin(ly); lo[2] = hmin(lz);
+    hi[0] = hmax(hx); hi[1] = hmax(hy); hi[2] = hmax(hz);
+    scalar::bounds_soa_n(lo, hi, x + i, y + i, z + i, n - i);
+}
+
+VM_TARGET_SSE
+inline void cull_boxes_n(uint8_t* visible, float const* planes, float const* const* box,
+                         std::size_t n)
+{
+    __m128 const half = _mm_set1_ps(0.5f);
+    __m128 const zero = _mm_setzero_ps();
+
+    std::size_t i = 0;
+    for ( ; i+4<=n; i+=4)
+    {
+        __m128 const lx = _mm_loadu_ps(box[0] + i), hx = _mm_loadu_ps(box[3] + i);
+        __m128 const ly = _mm_loadu_ps(box[1] + i), hy = _mm_loadu_ps(box[4] + i);
+        __m128 const lz = _mm_loadu_ps(box[2] + i), hz = _mm_loadu_ps(box[5] + i);
+        __m128 const cx = _mm_mul_ps(_mm_add_ps(lx, hx), half), ex = _mm_mul_ps(_mm_sub_ps(hx, lx), half);
+        __m128 const cy = _mm_mul_ps(_mm_add_ps(ly, hy), half), ey = _mm_mul_ps(_mm_sub_ps(hy, ly), half);
+        __m128 const cz = _mm_mul_ps(_mm_add_ps(lz, hz), half), ez = _mm_mul_ps(_mm_sub_ps(hz, lz), half);
+
+        __m128 ok = _mm_and_ps(_mm_cmpge_ps(ex, zero),
+                               _mm_and_ps(_mm_cmpge_ps(ey, zero), _mm_cmpge_ps(ez, zero)));
+        for (int k=0; k<24; k+=4)
+        {
+            float const* pl = planes + k;
+            __m128 const s = _mm_sub_ps(dot3(_mm_set1_ps(pl[0]), _mm_set1_ps(pl[1]), _mm_set1_ps(pl[2]),
+                                             cx, cy, cz), _mm_set1_ps(pl[3]));
+            __m128 const r = dot3(_mm_set1_ps(std::abs(pl[0])), _mm_set1_ps(std::abs(pl[1])),
+                                  _mm_set1_ps(std::abs(pl[2])), ex, ey, ez);
+            ok = _mm_and_ps(ok, _mm_cmpge_ps(_mm_add_ps(s, r), zero));
+        }
+        store_hits(visible + i, unsigned(_mm_movemask_ps(ok)), 4);
+    }
+    arrays_from<float> const rest(box, 6, i);
+    scalar::cull_boxes_n(visible + i, planes, rest.p, n - i);
+}
+
+/*
+ * Projection, four points per register. The clip tests are masks
+ * ANDed with their bit, ORed together and narrowed to bytes.
+ */
+VM_TARGET_SSE
+inline __m128 reciprocal(__m128 w, bool fast)
+{
+    if (!fast || vecmath::detail::deterministic)
+    {
+        return _mm_div_ps(_mm_set1_ps(1.0f), w);
+    }
+    __m128 const e = _mm_rcp_ps(w);         // 12 bits, then about 22
+    return _mm_mul_ps(e, _mm_sub_ps(_mm_set1_ps(2.0f), _mm_mul_ps(w, e)));
+}
+
+VM_TARGET_SSE
+inline void store_clip4(uint8_t* clip, __m128 x, __m128 y, __m128 z, __m128 w)
+{
+    __m128 const nw = _mm_xor_ps(w, _mm_set1_ps(-0.0f));
+    __m128 const tests[6] = {_mm_cmplt_ps(x, nw), _mm_cmpgt_ps(x, w),
+                             _mm_cmplt_ps(y, nw), _mm_cmpgt_ps(y, w),
+                             _mm_or_ps(_mm_cmplt_ps(z, nw), _mm_cmpngt_ps(w, _mm_setzero_ps())),
+                             _mm_cmpgt_ps(z, w)};
+    __m128i code = _mm_setzero_si128();
+    for (int k=0; k<6; ++k)
+    {
+        code = _mm_or_si128(code, _mm_and_si128(_mm_castps_si128(tests[k]), _mm_set1_epi32(1 << k)));
+    }
+    code = _mm_packs_epi32(code, code);
+    int const bytes = _mm_cvtsi128_si32(_mm_packus_epi16(code, code));
+    std::memcpy(clip, &bytes, 4);
+}
+
+VM_TARGET_SSE
+inline void project_n(float* r, uint8_t* clip, float const* m, float const* v, bool fast,
+                      std::size_t n)
+{
+    __m128 mm[16];
+    for (int k=0; k<16; ++k)
+    {
+        mm[k] = _mm_set1_ps(m[k]);
+    }
+
+    std::size_t i = 0;
+    for ( ; i+4<=n; i+=4, v+=16, r+=16)
+    {
+        __m128 x = _mm_loadu_ps(v + 0);
+        __m128 y = _mm_loadu_ps(v + 4);
+        __m128 z = _mm_loadu_ps(v + 8);
+        __m128 w = _mm_loadu_ps(v + 12);
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+
+        __m128 c[4];
+        for (int k=0; k<4; ++k)
+        {
+            __m128 acc = _mm_add_ps(_mm_mul_ps(x, mm[4*k+0]), _mm_mul_ps(y, mm[4*k+1]));
+            acc = _mm_add_ps(acc, _mm_mul_ps(z, mm[4*k+2]));
+            c[k] = _mm_add_ps(acc, _mm_mul_ps(w, mm[4*k+3]));
+        }
+        if (clip)
+        {
+            store_clip4(clip + i, c[0], c[1], c[2], c[3]);
+        }
+
+        __m128 const inv = reciprocal(c[3], fast);
+        __m128 rx = _mm_mul_ps(c[0], inv), ry = _mm_mul_ps(c[1], inv);
+        __m128 rz = _mm_mul_ps(c[2], inv), rw = inv;
+        _MM_TRANSPOSE4_PS(rx, ry, rz, rw);
+        _mm_storeu_ps(r + 0, rx);
+        _mm_storeu_ps(r + 4, ry);
+        _mm_storeu_ps(r + 8, rz);
+        _mm_storeu_ps(r + 12, rw);
+    }
+    scalar::project_n(r, clip ? clip + i : nullptr, m, v, fast, n - i);
+}
+
+VM_TARGET_SSE
+inline void project_soa_n(float* const* r, uint8_t* clip, float const* m, float const* const* v,
+                          bool fast, std::size_t n)
+{
+    __m128 mm[16];
+    for (int k=0; k<16; ++k)
+    {
+        mm[k] = _mm_set1_ps(m[k]);
+    }
+
+    std::size_t i = 0;
+    for ( ; i+4<=n; i+=4)
+    {
+        __m128 const x = _mm_loadu_ps(v[0] + i);
+        __m128 const y = _mm_loadu_ps(v[1] + i);
+        __m128 const z = _mm_loadu_ps(v[2] + i);
+
+        __m128 c[4];
+        for (int k=0; k<4; ++k)
+        {
+            __m128 acc = _mm_add_ps(_mm_mul_ps(x, mm[4*k+0]), _mm_mul_ps(y, mm[4*k+1]));
+            acc = _mm_add_ps(acc, _mm_mul_ps(z, mm[4*k+2]));
+            c[k] = _mm_add_ps(acc, mm[4*k+3]);
+        }
+        if (clip)
+        {
+            store_clip4(clip + i, c[0], c[1], c[2], c[3]);
+        }
+
+        __m128 const inv = reciprocal(c[3], fast);
+        _mm_storeu_ps(r[0] + i, _mm_mul_ps(c[0], inv));
+        _mm_storeu_ps(r[1] + i, _mm_mul_ps(c[1], inv));
+        _mm_storeu_ps(r[2] + i, _mm_mul_ps(c[2], inv));
+    }
+    arrays_from<float> const in(v, 3, i);
+    outputs_from<float> const out(r, 3, i);
+    scalar::project_soa_n(out.p, clip ? clip + i : nullptr, m, in.p, fast, n - i);
+}
+
+} // ::sse
+} // ::simd
+} // ::vecmath
+
+#endif // VM_VECSIMD_SSE_H
@@ -0,0 +1,139 @@
+/*
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/*
+ * Flat views of arrays of vectors and matrices
+ *
+ * Vector3<>, Matrix3<> and AffineMatrix3<> are standard layout and
+ * hold nothing but their elements, so an array of them is a plain
+ * array of fptype that can be handed to glBufferData(), memcpy() or
+ * a BLAS routine without copying:
+ *
+ *     std::vector<Matrix3f> mats = ...;
+ *     auto flat = as_scalars(mats);           // 16 floats per matrix
+ *     glBufferData(GL_UNIFORM_BUFFER, flat.size_bytes(), flat.data(), ...);
+ */
+#ifndef VM_VECSPAN_H
+#define VM_VECSPAN_H
+
+#include "vecmath.h"
+#include "affine.h"
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace vecmath {
+
+/**
+ * A non-owning view of \c n contiguous values of type \c T, in the
+ * manner of C++20's std::span.
+ */
+template <typename T>
+class span
+{
+  private:
+    T* m_data;
+    std::size_t m_size;
+
+  public:
+    typedef T element_type;
+
+    constexpr span() noexcept : m_data(nullptr), m_size(0) { }
+    constexpr span(T* data, std::size_t n) noexcept : m_data(data), m_size(n) { }
+
+    /* From a span or vector of T, or of the non-const T for a const view */
+    template <typename U, typename = typename std::enable_if<
+                  std::is_convertible<U (*)[], T (*)[]>::value>::type>
+    constexpr span(span<U> const& o) noexcept : m_data(o.data()), m_size(o.size()) { }
+
+    template <typename U, typename A, typename = typename std::enable_if<
+                  std::is_convertible<U (*)[], T (*)[]>::value>::type>
+    span(std::vector<U, A>& v) noexcept : m_data(v.data()), m_size(v.size()) { }
+
+    template <typename U, typename A, typename = typename std::enable_if<
+                  std::is_convertible<U const (*)[], T (*)[]>::value>::type>
+    span(std::vector<U, A> const& v) noexcept : m_data(v.data()), m_size(v.size()) { }
+
+    constexpr T* data() const noexcept { return m_data; }
+    constexpr std::size_t size() const noexcept { return m_size; }
+    constexpr std::size_t size_bytes() const noexcept { return m_size * sizeof(T); }
+    constexpr bool empty() const noexcept { return m_size == 0; }
+
+    constexpr T* begin() const noexcept { return m_data; }
+    constexpr T* end() const noexcept { return m_data + m_size; }
+
+    /* Element \c i, without bounds checks */
+    constexpr T& operator[](std::size_t i) const noexcept { return m_data[i]; }
+};
+
+namespace detail {
+
+/**
+ * The number of fptype values in a T, if an array of T may be
+ * viewed as an array of fptype.
+ */
+template <typename T>
+struct scalars_of;
+
+template <typename FP>
+struct scalars_of<Vector3<FP> > { typedef FP type; static constexpr std::size_t count = 4; };
+
+template <typename FP>
+struct scalars_of<Matrix3<FP> > { typedef FP type; static constexpr std::size_t count = 16; };
+
+template <typename FP>
+struct scalars_of<AffineMatrix3<FP> > { typedef FP type; static constexpr std::size_t count = 12; };
+
+// A const object's values are const.
+template <typename T>
+struct scalars_of<T const> : scalars_of<T>
+{
+    typedef typename scalars_of<T>::type const type;
+};
+
+template <typename T>
+struct flat_layout
+{
+    typedef typename scalars_of<T>::type fptype;
+
+    static_assert(std::is_standard_layout<T>::value &&
+                  std::is_trivially_copyable<T>::value,
+                  "type must be standard layout and trivially copyable");
+    static_assert(sizeof(T) == scalars_of<T>::count * sizeof(fptype),
+                  "type must hold nothing but its elements");
+};
+
+} // ::detail
+
+/**
+ * View \c n objects starting at \c p as their 4 (Vector3<>), 16
+ * (Matrix3<>) or 12 (AffineMatrix3<>) values each, in the order of
+ * their data() pointers.
+ */
+template <typename T>
+span<typename detail::flat_layout<T>::fptype> as_scalars(T* p, std::size_t n) noexcept
+{
+    typedef typename detail::flat_layout<T>::fptype fptype;
+    return {reinterpret_cast<fptype*>(p), n * detail::scalars_of<T>::count};
+}
+
+template <typename T>
+span<typename detail::flat_layout<T>::fptype> as_scalars(std::vector<T>& v) noexcept
+{
+    return as_scalars(v.data(), v.size());
+}
+
+template <typename T>
+span<typename detail::flat_layout<T const>::fptype> as_scalars(std::vector<T> const& v) noexcept
+{
+    return as_scalars(v.data(), v.size());
+}
+
+} // ::vecmath
+
+#endif // VM_VECSPAN_H
@@ -0,0 +1,381 @@
+/*
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/*
+ * Opt-in operation counters and scoped timers
+ *
+ * With VECMATH_STATS defined (in every translation unit, before
+ * including vecmath.h) the library counts, per thread:
+ *
+ *     mat_mults          Matrix3 * Matrix3 products (matops.h)
+ *     vec_mults          Matrix3 * Vector3 and Vector3 * Matrix3
+ *     lengths            Vector3::length() and fast_length() calls
+ *     normalizes         Vector3::normalize() and fast_normalize()
+ *     sqrt_skips         length() calls whose fpequal() shortcut
+ *                        skipped the square root
+ *     degenerate_errors  degenerate_error exceptions created
+ *
+ * normalize() calls length(), so it counts once in each. Named
+ * scoped timers add the calls and nanoseconds spent in a block:
+ *
+ *     {
+ *         VM_STATS_TIMER("skinning");
+ *         ...
+ *     }
+ *
+ * and the library's transform(), compose_hierarchy() and
+ * transform_file() time themselves. Counters only increase;
+ * stats::collect() sums all threads (including exited ones) and
+ * stats::this_thread() the calling one, and a metrics exporter
+ * reports the difference between two snapshots:
+ *
+ *     stats::snapshot const now = stats::collect();
+ *     stats::snapshot const delta = now - last;
+ *     for (std::size_t c=0; c<stats::counter_count; ++c)
+ *         emit(stats::counter_name(c), delta.counts[c]);
+ *
+ * Without VECMATH_STATS the hooks compile to nothing and the
+ * snapshots are all zero, so exporters build either way.
+ */
+#ifndef VM_VECSTATS_H
+#define VM_VECSTATS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(VECMATH_STATS)
+#  include "vectimer.h"
+#  include <atomic>
+#  include <mutex>
+#  include <vector>
+#endif
+
+namespace vecmath {
+namespace stats {
+
+/**
+ * The counters, in the order of snapshot::counts.
+ */
+enum class counter
+{
+    mat_mults,
+    vec_mults,
+    lengths,
+    normalizes,
+    sqrt_skips,
+    degenerate_errors
+};
+
+std::size_t const counter_count = 6;
+
+/*
+ * Distinct timer names, per thread and in a snapshot; timers
+ * beyond these are not recorded.
+ */
+std::size_t const max_timers = 16;
+
+inline char const* counter_name(std::size_t c) noexcept
+{
+    static char const* const names[counter_count] = {
+        "mat_mults", "vec_mults", "lengths", "normalizes", "sqrt_skips", "degenerate_errors"
+    };
+    return (c < counter_count) ? names[c] : "";
+}
+
+/**
+ * Calls of, and time spent under, one timer name.
+ */
+struct timer_total
+{
+    char const* name;
+    uint64_t calls;
+    uint64_t nanoseconds;
+};
+
+/**
+ * Counter and timer values at one point. Timers are matched by
+ * name, so totals from different threads are merged.
+ */
+struct snapshot
+{
+    uint64_t counts[counter_count] = {};
+    timer_total timers[max_timers] = {};
+    std::size_t timer_count = 0;
+
+    uint64_t operator[](counter c) const noexcept
+    {
+        return counts[static_cast<std::size_t>(c)];
+    }
+
+    /* The totals for \c name, or null if it has none. */
+    timer_total const* timer(char const* name) const noexcept
+    {
+        for (std::size_t t=0; t<timer_count; ++t)
+        {
+            if (std::strcmp(timers[t].name, name) == 0)
+            {
+                return &timers[t];
+            }
+        }
+        return nullptr;
+    }
+
+    /* Add \c calls and \c ns to the totals for \c name. */
+    void add_timer(char const* name, uint64_t calls, uint64_t ns) noexcept
+    {
+        timer_total* t = const_cast<timer_total*>(timer(name));
+        if (!t)
+        {
+            if (timer_count == max_timers)
+            {
+                return;
+            }
+            t = &timers[timer_count++];
+            *t = timer_total{name, 0, 0};
+        }
+        t->calls += calls;
+        t->nanoseconds += ns;
+    }
+
+    snapshot& operator+=(snapshot const& o) noexcept
+    {
+        for (std::size_t c=0; c<counter_count; ++c)
+        {
+            counts[c] += o.counts[c];
+        }
+        for (std::size_t t=0; t<o.timer_count; ++t)
+        {
+            add_timer(o.timers[t].name, o.timers[t].calls, o.timers[t].nanoseconds);
+        }
+        return *this;
+    }
+};
+
+/**
+ * What happened between snapshots \c a (the earlier) and \c b.
+ */
+inline snapshot operator-(snapshot const& b, snapshot const& a) noexcept
+{
+    snapshot r = b;
+    for (std::size_t c=0; c<counter_count; ++c)
+    {
+        r.counts[c] -= a.counts[c];
+    }
+    for (std::size_t t=0; t<r.timer_count; ++t)
+    {
+        if (timer_total const* old = a.timer(r.timers[t].name))
+        {
+            r.timers[t].calls -= old->calls;
+            r.timers[t].nanoseconds -= old->nanoseconds;
+        }
+    }
+    return r;
+}
+
+#if defined(VECMATH_STATS)
+
+constexpr bool enabled = true;
+
+namespace detail {
+
+/*
+ * One thread's counters. Only the owning thread writes them, with
+ * a relaxed load and store rather than a locked add, so they cost
+ * about as much as plain increments; collect() may read them from
+ * other threads at any time.
+ */
+struct thread_block
+{
+    struct timer_slot
+    {
+        std::atomic<char const*> name;
+        std::atomic<uint64_t> calls;
+        std::atomic<uint64_t> nanoseconds;
+    };
+
+    std::atomic<uint64_t> counts[counter_count];
+    timer_slot timers[max_timers];
+    std::atomic<std::size_t> timer_count;
+
+    thread_block();
+    ~thread_block();
+
+    static void bump(std::atomic<uint64_t>& v, uint64_t by) noexcept
+    {
+        v.store(v.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+
+    void add_timer(char const* name, uint64_t ns) noexcept
+    {
+        std::size_t const n = timer_count.load(std::memory_order_relaxed);
+        for (std::size_t t=0; t<n; ++t)
+        {
+            char const* const tn = timers[t].name.load(std::memory_order_relaxed);
+            if (tn == name || std::strcmp(tn, name) == 0)
+            {
+                bump(timers[t].calls, 1);
+                bump(timers[t].nanoseconds, ns);
+                return;
+            }
+        }
+        if (n == max_timers)
+        {
+            return;
+        }
+        timers[n].calls.store(1, std::memory_order_relaxed);
+        timers[n].nanoseconds.store(ns, std::memory_order_relaxed);
+        timers[n].name.store(name, std::memory_order_relaxed);
+        timer_count.store(n + 1, std::memory_order_release);
+    }
+
+    void read(snapshot& s) const noexcept
+    {
+        for (std::size_t c=0; c<counter_count; ++c)
+        {
+            s.counts[c] += counts[c].load(std::memory_order_relaxed);
+        }
+        std::size_t const n = timer_count.load(std::memory_order_acquire);
+        for (std::size_t t=0; t<n; ++t)
+        {
+            s.add_timer(timers[t].name.load(std::memory_order_relaxed),
+                        timers[t].calls.load(std::memory_order_relaxed),
+                        timers[t].nanoseconds.load(std::memory_order_relaxed));
+        }
+    }
+};
+
+/*
+ * The live threads' blocks, and the sum of those of threads that
+ * have exited.
+ */
+struct registry
+{
+    std::mutex mutex;
+    std::vector<thread_block const*> live;
+    snapshot retired;
+
+    static registry& get()
+    {
+        static registry r;
+        return r;
+    }
+};
+
+inline thread_block::thread_block()
+    : timer_count(0)
+{
+    for (std::size_t c=0; c<counter_count; ++c)
+    {
+        counts[c].store(0, std::memory_order_relaxed);
+    }
+    registry& r = registry::get();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.live.push_back(this);
+}
+
+inline thread_block::~thread_block()
+{
+    registry& r = registry::get();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    read(r.retired);
+    for (std::size_t i=0; i<r.live.size(); ++i)
+    {
+        if (r.live[i] == this)
+        {
+            r.live.erase(r.live.begin() + i);
+            break;
+        }
+    }
+}
+
+inline thread_block& local() noexcept
+{
+    static thread_local thread_block block;
+    return block;
+}
+
+inline void count(counter c) noexcept
+{
+    thread_block::bump(local().counts[static_cast<std::size_t>(c)], 1);
+}
+
+} // ::detail
+
+/**
+ * Adds the time from its construction to its destruction, and one
+ * call, to the calling thread's totals for \c name, which must be
+ * a string that outlives the program's use of the statistics (a
+ * literal).
+ */
+class scoped_timer
+{
+  private:
+    char const* m_name;
+    Timer m_timer;
+
+  public:
+    explicit scoped_timer(char const* name)
+        : m_name(name)
+    {
+        m_timer.start();
+    }
+
+    scoped_timer(scoped_timer const&) = delete;
+    scoped_timer& operator=(scoped_timer const&) = delete;
+
+    ~scoped_timer()
+    {
+        m_timer.end();
+        detail::local().add_timer(m_name, m_timer.elapsed_ns());
+    }
+};
+
+/**
+ * The calling thread's counters and timers.
+ */
+inline snapshot this_thread()
+{
+    snapshot s;
+    detail::local().read(s);
+    return s;
+}
+
+/**
+ * The counters and timers of every thread, live or exited.
+ */
+inline snapshot collect()
+{
+    detail::registry& r = detail::registry::get();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    snapshot s = r.retired;
+    for (detail::thread_block const* b : r.live)
+    {
+        b->read(s);
+    }
+    return s;
+}
+
+#  define VM_STATS_COUNT(c) ::vecmath::stats::detail::count(::vecmath::stats::counter::c)
+#  define VM_STATS_TIMER(name) ::vecmath::stats::scoped_timer const vm_stats_timer_(name)
+
+#else // !VECMATH_STATS
+
+constexpr bool enabled = false;
+
+inline snapshot this_thread() { return snapshot(); }
+inline snapshot collect() { return snapshot(); }
+
+#  define VM_STATS_COUNT(c) ((void) 0)
+#  define VM_STATS_TIMER(name) ((void) 0)
+
+#endif // VECMATH_STATS
+
+} // ::stats
+} // ::vecmath
+
+#endif // VM_VECSTATS_H
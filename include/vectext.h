@@ -0,0 +1,312 @@
+/*
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/*
+ * Text dumps of vector and matrix arrays
+ *
+ * write_text() formats a whole array into a caller's buffer, one
+ * record per line, and read_text() parses such text back:
+ *
+ *     vector3:  x y z                        (W is not written)
+ *     matrix3:  m00 m01 m02 m03 m10 ... m33  (16 values, row-major)
+ *
+ * The numbers go through to_chars() and from_chars() (vecchars.h),
+ * not iostreams, so there is no locale or stream state, and the
+ * default precision reads back exactly:
+ *
+ *     std::vector<char> buf(max_text_size<Vector3f>(points.size()));
+ *     text_result const w = write_text(points, buf.data(), buf.size());
+ *     text_result const r = read_text(buf.data(), w.bytes, copy);
+ *
+ * A buffer too small for everything takes the records that fit, so
+ * large arrays can also be written in chunks.
+ */
+#ifndef VM_VECTEXT_H
+#define VM_VECTEXT_H
+
+#include "vecmath.h"
+#include "vecchars.h"
+#include "vecspan.h"
+
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace vecmath {
+
+/**
+ * The text_error exception is thrown when read_text() meets text
+ * that is not a number, or an incomplete record.
+ */
+class text_error : public std::runtime_error
+{
+  public:
+    text_error(std::string const& msg)
+        : std::runtime_error(msg)
+    { }
+};
+
+/**
+ * How write_text() formats numbers: as to_chars() does with
+ * \c format and \c precision. The default, general with
+ * max_digits10 digits, reads back exactly.
+ */
+struct text_options
+{
+    chars_format format;
+    int precision;
+
+    text_options(chars_format f = chars_format::general, int p = -1)
+        : format(f), precision(p)
+    { }
+};
+
+/**
+ * Records written or read, and the bytes of text they took.
+ */
+struct text_result
+{
+    std::size_t count;
+    std::size_t bytes;
+};
+
+namespace detail {
+
+template <typename Record> struct text_record;
+
+template <typename fptype> struct text_record<Vector3<fptype> >
+{
+    typedef fptype scalar;
+    static int const values = 3;
+
+    static void get(Vector3<fptype> const& v, fptype* s)
+    {
+        s[0] = v.X();
+        s[1] = v.Y();
+        s[2] = v.Z();
+    }
+
+    static void set(Vector3<fptype>& v, fptype const* s)
+    {
+        v = Vector3<fptype>(s[0], s[1], s[2]);
+    }
+};
+
+template <typename fptype> struct text_record<Matrix3<fptype> >
+{
+    typedef fptype scalar;
+    static int const values = 16;
+
+    static void get(Matrix3<fptype> const& m, fptype* s)
+    {
+        std::memcpy(s, m.data(), 16 * sizeof(fptype));
+    }
+
+    static void set(Matrix3<fptype>& m, fptype const* s)
+    {
+        std::memcpy(m.data(), s, 16 * sizeof(fptype));
+    }
+};
+
+// The options with the precision made explicit and in range.
+template <typename fptype>
+text_options resolve(text_options o)
+{
+    int const limit = (o.format == chars_format::fixed) ? max_fixed_digits : max_general_digits;
+    if (o.precision < 0)
+    {
+        o.precision = std::numeric_limits<fptype>::max_digits10;
+    }
+    if (o.precision > limit)
+    {
+        o.precision = limit;
+    }
+    if (o.format == chars_format::general && o.precision == 0)
+    {
+        o.precision = 1;
+    }
+    return o;
+}
+
+// The most bytes one record's line takes, newline included.
+template <typename Record>
+std::size_t max_line(text_options o)
+{
+    typedef typename text_record<Record>::scalar scalar;
+    std::size_t const value = (o.format == chars_format::fixed)
+        ? max_fixed_chars<scalar>(o.precision) : max_general_chars(o.precision);
+    return text_record<Record>::values * (value + 1);
+}
+
+template <typename Record>
+char* write_line(char* p, Record const& r, text_options o)
+{
+    typedef text_record<Record> rec;
+    typename rec::scalar s[rec::values];
+    rec::get(r, s);
+    for (int i=0; i<rec::values; ++i)
+    {
+        p = (o.format == chars_format::fixed) ? format_fixed(p, s[i], o.precision)
+                                              : format_general(p, s[i], o.precision);
+        *p++ = ' ';
+    }
+    p[-1] = '\n';
+    return p;
+}
+
+template <typename Record>
+text_result write_text(span<Record const> in, char* buf, std::size_t size, text_options o)
+{
+    o = resolve<typename text_record<Record>::scalar>(o);
+    std::size_t const line = max_line<Record>(o);
+    char* p = buf;
+    char* const end = buf + size;
+    std::size_t i = 0;
+    for (; i<in.size(); ++i)
+    {
+        if (std::size_t(end - p) >= line)
+        {
+            p = write_line(p, in[i], o);
+            continue;
+        }
+        // near the end: only whole lines
+        char tmp[16 * (max_fixed_chars<double>(max_fixed_digits) + 1)];
+        std::size_t const len = std::size_t(write_line(tmp, in[i], o) - tmp);
+        if (len > std::size_t(end - p))
+        {
+            break;
+        }
+        std::memcpy(p, tmp, len);
+        p += len;
+    }
+    return text_result{i, std::size_t(p - buf)};
+}
+
+inline bool is_text_separator(char c)
+{
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == ',';
+}
+
+inline text_error text_failure(char const* what, std::size_t offset)
+{
+    return text_error(std::string("read_text(): ") + what + " at byte " + std::to_string(offset));
+}
+
+template <typename Record>
+text_result read_text(char const* buf, std::size_t size, span<Record> out)
+{
+    typedef text_record<Record> rec;
+    typename rec::scalar s[rec::values];
+    char const* p = buf;
+    char const* const end = buf + size;
+    std::size_t i = 0;
+    std::size_t bytes = 0;
+    for (; i<out.size(); ++i)
+    {
+        for (int k=0; k<rec::values; ++k)
+        {
+            while (p != end && is_text_separator(*p))
+            {
+                ++p;
+            }
+            if (p == end)
+            {
+                if (k)
+                {
+                    throw text_failure("incomplete record", std::size_t(p - buf));
+                }
+                return text_result{i, bytes};
+            }
+            char const* const next = parse_float(p, end, s[k]);
+            if (!next || (next != end && !is_text_separator(*next)))
+            {
+                throw text_failure("bad number", std::size_t(p - buf));
+            }
+            p = next;
+        }
+        rec::set(out[i], s);
+        bytes = std::size_t(p - buf);
+    }
+    return text_result{i, bytes};
+}
+
+} // ::detail
+
+/**
+ * The most bytes write_text() takes for \c count records of type
+ * Record (Vector3f, Vector3d, Matrix3f or Matrix3d).
+ */
+template <typename Record>
+std::size_t max_text_size(std::size_t count, text_options o = text_options())
+{
+    typedef typename detail::text_record<Record>::scalar scalar;
+    return count * detail::max_line<Record>(detail::resolve<scalar>(o));
+}
+
+/**
+ * Write the records of \c in to buf[0, size), one per line, and
+ * return how many were written and the bytes they took. Writing
+ * stops at the first record whose line doesn't fit; the text is not
+ * terminated.
+ */
+inline text_result write_text(span<Vector3f const> in, char* buf, std::size_t size,
+                              text_options o = text_options())
+{
+    return detail::write_text(in, buf, size, o);
+}
+
+inline text_result write_text(span<Vector3d const> in, char* buf, std::size_t size,
+                              text_options o = text_options())
+{
+    return detail::write_text(in, buf, size, o);
+}
+
+inline text_result write_text(span<Matrix3f const> in, char* buf, std::size_t size,
+                              text_options o = text_options())
+{
+    return detail::write_text(in, buf, size, o);
+}
+
+inline text_result write_text(span<Matrix3d const> in, char* buf, std::size_t size,
+                              text_options o = text_options())
+{
+    return detail::write_text(in, buf, size, o);
+}
+
+/**
+ * Parse records from buf[0, size) into \c out, until the text or
+ * \c out runs out, and return how many were read and the bytes up
+ * to the end of the last one. Numbers are separated by whitespace
+ * or commas, so lines need not match records; a vector's W is set
+ * to 1. Throws text_error, with the byte offset, if the text holds
+ * something other than a number or ends within a record.
+ */
+inline text_result read_text(char const* buf, std::size_t size, span<Vector3f> out)
+{
+    return detail::read_text(buf, size, out);
+}
+
+inline text_result read_text(char const* buf, std::size_t size, span<Vector3d> out)
+{
+    return detail::read_text(buf, size, out);
+}
+
+inline text_result read_text(char const* buf, std::size_t size, span<Matrix3f> out)
+{
+    return detail::read_text(buf, size, out);
+}
+
+inline text_result read_text(char const* buf, std::size_t size, span<Matrix3d> out)
+{
+    return detail::read_text(buf, size, out);
+}
+
+} // ::vecmath
+
+#endif // VM_VECTEXT_H
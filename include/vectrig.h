@@ -0,0 +1,167 @@
+/*
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/*
+ * Batched sine and cosine, and rotation factories built on them
+ */
+#ifndef VM_VECTRIG_H
+#define VM_VECTRIG_H
+
+#include "vecmath.h"
+#include "vecarray.h"                       // VM_RESTRICT
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace vecmath {
+
+namespace detail {
+
+/*
+ * Adding and subtracting 1.5 * 2^52 rounds a double to the nearest
+ * integer, in plain arithmetic that vectorizes without SSE4.1.
+ */
+constexpr double round_magic = 6755399441055744.0;
+constexpr double two_over_pi = 0.636619772367581343076;
+
+/*
+ * The quadrant k mod 2^32, from t = k + round_magic: for |k| < 2^51
+ * the low bits of t's mantissa hold k in two's complement. Reading
+ * them instead of converting k keeps any argument, however large,
+ * NaN included, free of undefined behaviour.
+ */
+inline uint32_t quadrant(double t)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &t, sizeof(bits));
+    return uint32_t(bits);
+}
+
+/*
+ * Pick the sine and cosine of x = r + q*pi/2 from those of r; only
+ * q mod 4 matters.
+ */
+template <typename fptype>
+inline void sincos_quadrant(uint32_t q, fptype ps, fptype pc, fptype& s, fptype& c)
+{
+    fptype const ss = (q & 1) ? pc : ps;
+    fptype const cc = (q & 1) ? ps : pc;
+    s = (q & 2) ? -ss : ss;
+    c = ((q + 1) & 2) ? -cc : cc;
+}
+
+/*
+ * Branch-free sine and cosine. The argument is reduced to
+ * [-pi/4, pi/4] and the Cephes minimax polynomials are evaluated
+ * there. Accurate to about 1 ulp for |x| up to 1e6.
+ */
+inline void sincos_poly(float x, float& s, float& c)
+{
+    // The reduction is done in double, which is exact enough for float.
+    double const t = double(x) * two_over_pi + round_magic;
+    double const k = t - round_magic;
+    float const r = float(double(x) - k * 1.57079632679489661923);
+    float const z = r * r;
+
+    float const ps = r + r*z*(-1.6666654611e-1f + z*(8.3321608736e-3f + z*-1.9515295891e-4f));
+    float const pc = 1 - 0.5f*z + z*z*(4.166664568298827e-2f +
+                                       z*(-1.388731625493765e-3f + z*2.443315711809948e-5f));
+    sincos_quadrant(quadrant(t), ps, pc, s, c);
+}
+
+inline void sincos_poly(double x, double& s, double& c)
+{
+    // pi/2 in three parts (Cody-Waite), each k*part exact for |k| < 2^20
+    double const t = x * two_over_pi + round_magic;
+    double const k = t - round_magic;
+    double const r = ((x - k * 1.57079632673412561417e+00)
+                        - k * 6.07710050630396597660e-11)
+                        - k * 2.02226624871116645580e-21;
+    double const z = r * r;
+
+    double const ps = r + r*z*(-1.66666666666666307295e-1 +
+                          z*(8.33333333332211858878e-3 +
+                          z*(-1.98412698295895385996e-4 +
+                          z*(2.75573136213857245213e-6 +
+                          z*(-2.50507477628578072866e-8 +
+                          z*1.58962301576546568060e-10)))));
+    double const pc = 1 - 0.5*z + z*z*(4.16666666666665929218e-2 +
+                                  z*(-1.38888888888730564116e-3 +
+                                  z*(2.48015872888517045348e-5 +
+                                  z*(-2.75573141792967388112e-7 +
+                                  z*(2.08757008419747316778e-9 +
+                                  z*-1.13585365213876817300e-11)))));
+    sincos_quadrant(quadrant(t), ps, pc, s, c);
+}
+
+} // ::detail
+
+/**
+ * Sine and cosine of \c x together, without branches.
+ *
+ * Accurate to about 1 ulp for |x| up to 1e6 radians; beyond that
+ * the argument reduction loses precision, and past about 3e15
+ * radians (2^51 quadrants) the results are meaningless. NaN and
+ * infinite inputs give unspecified results, though no input is
+ * undefined behaviour.
+ */
+template <typename fptype>
+inline void sincos(fptype x, fptype& s, fptype& c)
+{
+    detail::sincos_poly(x, s, c);
+}
+
+/**
+ * s[i] = sin(x[i]) and c[i] = cos(x[i]) for \c n angles.
+ *
+ * Unlike std::sin() and std::cos(), the loop vectorizes, so this
+ * is several times faster for large arrays. Accuracy is as for
+ * sincos(). The arrays must not overlap.
+ */
+template <typename fptype>
+void sincos_batch(fptype const* VM_RESTRICT x, fptype* VM_RESTRICT s,
+                  fptype* VM_RESTRICT c, std::size_t n)
+{
+    for (std::size_t i=0; i<n; ++i)
+    {
+        detail::sincos_poly(x[i], s[i], c[i]);
+    }
+}
+
+/**
+ * out[i] = Matrix3::rotateEuler(x[i], y[i], z[i]) for \c n sets
+ * of angles, with the sines and cosines from sincos_batch().
+ */
+template <typename fptype>
+void rotateEuler_batch(fptype const* x, fptype const* y, fptype const* z,
+                       Matrix3<fptype>* out, std::size_t n)
+{
+    // Work through the angles in chunks that stay in L1.
+    std::size_t const chunk = 128;
+    fptype s[3][chunk];
+    fptype c[3][chunk];
+
+    for (std::size_t first=0; first<n; first+=chunk)
+    {
+        std::size_t const count = (n - first < chunk) ? (n - first) : chunk;
+        sincos_batch(x + first, s[0], c[0], count);
+        sincos_batch(y + first, s[1], c[1], count);
+        sincos_batch(z + first, s[2], c[2], count);
+
+        for (std::size_t i=0; i<count; ++i)
+        {
+            out[first + i] = Matrix3<fptype>::rotateEulerSinCos(s[0][i], c[0][i],
+                                                                s[1][i], c[1][i],
+                                                                s[2][i], c[2][i]);
+        }
+    }
+}
+
+} // ::vecmath
+
+#endif // VM_VECTRIG_H
@@ -11,7 +11,9 @@
  *
  */
 #include "vecmath.h"
+#include "vecsse.h"
 #include "test_common.h"
+#include "Timer.h"
 
 #include <pmmintrin.h>
 
@@ -6,6 +6,7 @@
  *
  */
 #include <vecmath.h>
+#include "vecsse.h"
 
 namespace vecmath {
 
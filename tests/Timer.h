@@ -7,59 +7,15 @@
  */
 /**
  * A Timer class for measuring durations.
+ *
+ * The class now lives in vectimer.h, where the VECMATH_STATS
+ * scoped timers use it too.
  */
 #ifndef TIMER_H
 #define TIMER_H
 
-#include <chrono>
-
-/**
- * A Timer class for measuring durations.
- *
- * Usage:
- * - create it: Timer timer;
- * - start it:  timer.start();
- * - stop it:   timer.stop();
- * - get elapsed time: timer.elapsed();
- *
- * The same timer can be stopped/started multiple times:
- *
- * Calling start() is equivalent to a reset.
- *
- * Calls to stop() record the time passed since the last
- * call to start(). Thus, code can call stop() multiple
- * times to note elapsed time from a single start point
- * (to record multiple delta-points).
- */
-class Timer {
-  private:
-    using Clock = std::chrono::steady_clock;
-    using TimePoint = Clock::time_point;
-
-    TimePoint m_start;
-    TimePoint m_end;
-
-  public:
-    Timer()
-        : m_start()
-        , m_end()
-    { }
-
-    void start()
-    {
-        m_end = m_start = Clock::now();
-    }
-
-    void end()
-    {
-        m_end = Clock::now();
-    }
+#include "vectimer.h"
 
-    /* Returns milliseconds */
-    float elapsed()
-    {
-        return 1.0e3f * (m_end - m_start).count() / Clock::period::den;
-    }
-};
+using vecmath::Timer;
 
 #endif // TIMER_H
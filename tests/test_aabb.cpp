@@ -0,0 +1,211 @@
+/**
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/**
+ * Unit tests for axis-aligned bounding boxes.
+ *
+ * The bounds and culling kernels of every supported instruction set
+ * are checked against the scalar ones, at sizes that leave every
+ * tail length, and transform() against the transformed corners.
+ */
+#include "vecmath.h"
+#include "aabb.h"
+
+#include "test_common.h"
+
+#include <cmath>
+#include <vector>
+
+using vecmath::Vector3f;
+using vecmath::Vector3d;
+
+namespace {
+
+std::vector<Vector3f> makePoints(std::size_t n, int seed)
+{
+    std::vector<Vector3f> v(n);
+    for (std::size_t i=0; i<n; ++i)
+    {
+        float const t = float(i * 7 + seed);
+        v[i] = Vector3f(std::sin(t) * 3, std::cos(t * 2) * 5, 1.5f - std::sin(t * 3));
+    }
+    return v;
+}
+
+bool sameBox(vecmath::AABBf const& a, vecmath::AABBf const& b)
+{
+    return a.lo.X() == b.lo.X() && a.lo.Y() == b.lo.Y() && a.lo.Z() == b.lo.Z() &&
+           a.hi.X() == b.hi.X() && a.hi.Y() == b.hi.Y() && a.hi.Z() == b.hi.Z();
+}
+
+} // anonymous
+
+BTEST(AABB, basics)
+{
+    vecmath::AABBd b;
+    ASSERT_EQ(b.empty(), true);
+    ASSERT_EQ(b.contains(Vector3d(0, 0, 0)), false);
+
+    b.extend(Vector3d(1, 2, 3));
+    ASSERT_EQ(b.empty(), false);
+    ASSERT_EQ(b.contains(Vector3d(1, 2, 3)), true);
+    b.extend(Vector3d(-1, 4, 0));
+    ASSERT_EQ(b.lo.X(), -1.0);
+    ASSERT_EQ(b.hi.Y(), 4.0);
+    ASSERT_EQ(b.center().Z(), 1.5);
+    ASSERT_EQ(b.extent().X(), 1.0);
+    ASSERT_EQ(b.contains(Vector3d(0, 3, 1)), true);
+    ASSERT_EQ(b.contains(Vector3d(0, 5, 1)), false);
+
+    vecmath::AABBd const c(Vector3d(1, 4, 3), Vector3d(2, 5, 4));    // touches b's corner
+    ASSERT_EQ(vecmath::overlaps(b, c), true);
+    ASSERT_EQ(vecmath::overlaps(b, vecmath::AABBd(Vector3d(1.5, 0, 0), Vector3d(2, 1, 1))), false);
+    ASSERT_EQ(vecmath::overlaps(b, vecmath::AABBd()), false);
+
+    vecmath::AABBd const m = vecmath::merge(b, c);
+    ASSERT_EQ(m.lo.X(), -1.0);
+    ASSERT_EQ(m.hi.Z(), 4.0);
+    ASSERT_EQ(vecmath::merge(vecmath::AABBd(), c).lo.Y(), 4.0);
+}
+
+BTEST(AABB, kernelsMatchScalar)
+{
+    vecmath::simd::kernels const& scalar = *vecmath::simd::find(vecmath::simd::isa::scalar);
+    vecmath::Frustumf const f = vecmath::Frustumf::from_matrix(
+        perspective(1.0f, 1.5f, 0.5f, 20.0f) * vecmath::Matrix3f::translation(0, 0, -6));
+    float planes[24];
+    f.values(planes);
+
+    for (vecmath::simd::kernels const* k : supportedKernels())
+    {
+        for (std::size_t n : kernel_sizes)
+        {
+            std::vector<Vector3f> const p = makePoints(n, 1);
+            float lo[3] = {100, 100, 100}, hi[3] = {-100, -100, -100};
+            float le[3] = {100, 100, 100}, he[3] = {-100, -100, -100};
+            k->bounds_n(lo, hi, n ? p[0].data() : nullptr, n);
+            scalar.bounds_n(le, he, n ? p[0].data() : nullptr, n);
+            for (int c=0; c<3; ++c)
+            {
+                ASSERT_EQ(lo[c], le[c]);
+                ASSERT_EQ(hi[c], he[c]);
+            }
+
+            vecmath::Vector3Arrayf a;
+            for (Vector3f const& v : p)
+                a.push_back(v);
+            k->bounds_soa_n(lo, hi, a.X(), a.Y(), a.Z(), n);
+            for (int c=0; c<3; ++c)
+            {
+                ASSERT_EQ(lo[c], le[c]);
+                ASSERT_EQ(hi[c], he[c]);
+            }
+
+            // boxes around the points, some of them empty
+            vecmath::AABBArrayf boxes;
+            std::vector<Vector3f> const q = makePoints(n, 2);
+            for (std::size_t i=0; i<n; ++i)
+            {
+                vecmath::AABBf b(p[i], p[i]);
+                b.extend(q[i]);
+                boxes.push_back(i % 9 == 4 ? vecmath::AABBf() : b);
+            }
+            float const* const box[6] = {boxes.lo.X(), boxes.lo.Y(), boxes.lo.Z(),
+                                         boxes.hi.X(), boxes.hi.Y(), boxes.hi.Z()};
+            std::vector<uint8_t> vis(n + 1, 7), ve(n);
+            k->cull_boxes_n(vis.data(), planes, box, n);
+            scalar.cull_boxes_n(ve.data(), planes, box, n);
+            std::size_t count = 0;
+            for (std::size_t i=0; i<n; ++i)
+            {
+                ASSERT_EQ(int(vis[i]), int(ve[i]));
+                count += vis[i];
+            }
+            ASSERT_EQ(int(vis[n]), 7);
+            if (n == 100)
+                ASSERT_EQ(count > 10 && count < 90, true);
+        }
+    }
+}
+
+BTEST(AABB, computeBounds)
+{
+    std::vector<Vector3f> const p = makePoints(1000, 3);
+    vecmath::AABBf expect;
+    for (Vector3f const& v : p)
+        expect.extend(v);
+
+    ASSERT_EQ(sameBox(vecmath::compute_bounds(p), expect), true);
+    vecmath::Vector3Arrayf a;
+    for (Vector3f const& v : p)
+        a.push_back(v);
+    ASSERT_EQ(sameBox(vecmath::compute_bounds(a), expect), true);
+    ASSERT_EQ(vecmath::compute_bounds(std::vector<Vector3f>()).empty(), true);
+
+    std::vector<Vector3d> const d = {Vector3d(1, -2, 3), Vector3d(-4, 5, 0.5)};
+    vecmath::AABBd const bd = vecmath::compute_bounds(d);
+    ASSERT_EQ(bd.lo.X(), -4.0);
+    ASSERT_EQ(bd.lo.Y(), -2.0);
+    ASSERT_EQ(bd.hi.Z(), 3.0);
+}
+
+BTEST(AABB, transform)
+{
+    vecmath::AABBd const b(Vector3d(-1, 0, 2), Vector3d(3, 1, 5));
+    vecmath::Matrix3d const m = vecmath::Matrix3d::translation(1, 2, 3) *
+                                vecmath::Matrix3d::rotateEuler(0.3, -0.7, 1.1) *
+                                vecmath::Matrix3d::scale(2, 1, 0.5);
+    vecmath::AABBd expect;
+    for (int c=0; c<8; ++c)
+        expect.extend(m * Vector3d((c & 1) ? b.hi.X() : b.lo.X(), (c & 2) ? b.hi.Y() : b.lo.Y(),
+                                   (c & 4) ? b.hi.Z() : b.lo.Z()));
+
+    vecmath::AABBd const t = vecmath::transform(b, m);
+    ASSERT_EQ(vecmath::fpequal(t.lo.X(), expect.lo.X(), 1.0e-12), true);
+    ASSERT_EQ(vecmath::fpequal(t.lo.Y(), expect.lo.Y(), 1.0e-12), true);
+    ASSERT_EQ(vecmath::fpequal(t.lo.Z(), expect.lo.Z(), 1.0e-12), true);
+    ASSERT_EQ(vecmath::fpequal(t.hi.X(), expect.hi.X(), 1.0e-12), true);
+    ASSERT_EQ(vecmath::fpequal(t.hi.Y(), expect.hi.Y(), 1.0e-12), true);
+    ASSERT_EQ(vecmath::fpequal(t.hi.Z(), expect.hi.Z(), 1.0e-12), true);
+
+    vecmath::AABBd const a = vecmath::transform(b, vecmath::AffineMatrix3d(m));
+    ASSERT_EQ(a.lo.X(), t.lo.X());
+    ASSERT_EQ(a.hi.Z(), t.hi.Z());
+    ASSERT_EQ(vecmath::transform(vecmath::AABBd(), m).empty(), true);
+}
+
+BTEST(AABB, frustum)
+{
+    // looking down -z from the origin, near 1, far 10
+    vecmath::Frustumd const f = vecmath::Frustumd::from_matrix(
+        perspective(1.2, 1.0, 1.0, 10.0));
+
+    ASSERT_EQ(f.visible(vecmath::AABBd(Vector3d(-0.5, -0.5, -5.5), Vector3d(0.5, 0.5, -4.5))), true);
+    ASSERT_EQ(f.visible(vecmath::AABBd(Vector3d(-0.5, -0.5, 1), Vector3d(0.5, 0.5, 2))), false);
+    ASSERT_EQ(f.visible(vecmath::AABBd(Vector3d(-0.5, -0.5, -20), Vector3d(0.5, 0.5, -11))), false);
+    ASSERT_EQ(f.visible(vecmath::AABBd(Vector3d(20, -0.5, -5.5), Vector3d(21, 0.5, -4.5))), false);
+    ASSERT_EQ(f.visible(vecmath::AABBd(Vector3d(-0.5, -0.5, -12), Vector3d(0.5, 0.5, -8))), true);  // straddles far
+    ASSERT_EQ(f.visible(vecmath::AABBd(Vector3d(-100, -100, -5), Vector3d(100, 100, -4))), true);   // holds the view
+    ASSERT_EQ(f.visible(vecmath::AABBd()), false);
+
+    vecmath::AABBArrayd boxes;
+    boxes.push_back(vecmath::AABBd(Vector3d(-0.5, -0.5, -5.5), Vector3d(0.5, 0.5, -4.5)));
+    boxes.push_back(vecmath::AABBd(Vector3d(-0.5, -0.5, 1), Vector3d(0.5, 0.5, 2)));
+    boxes.push_back(vecmath::AABBd(Vector3d(-0.5, -0.5, -12), Vector3d(0.5, 0.5, -8)));
+    std::vector<uint8_t> vis(3);
+    ASSERT_EQ(vecmath::cull(f, boxes, vis), std::size_t(2));
+    ASSERT_EQ(int(vis[1]), 0);
+
+    try {
+        vis.resize(2);
+        vecmath::cull(f, boxes, vis);
+        FAIL() << "cull() should have failed for a short output\n";
+    }
+    catch (vecmath::index_error&) {
+        // PASS, intended failure
+    }
+}
@@ -0,0 +1,157 @@
+/**
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/**
+ * Unit tests for the affine matrix
+ */
+#include "vecmath.h"
+#include "affine.h"
+
+#include "test_common.h"
+
+namespace {
+
+/*
+ * Compare every element of the affine matrix with the equivalent
+ * full matrix.
+ */
+bool same(vecmath::AffineMatrix3f const& a, vecmath::Matrix3f const& m)
+{
+    for (uint32_t r=0; r<4; ++r)
+    {
+        for (uint32_t c=0; c<4; ++c)
+        {
+            if (!vecmath::fpequal(a.get(r,c), m.get(r,c), EPS))
+                return false;
+        }
+    }
+    return true;
+}
+
+bool same(vecmath::Vector3f const& a, vecmath::Vector3f const& b)
+{
+    return (vecmath::fpequal(a.X(), b.X(), EPS) &&
+            vecmath::fpequal(a.Y(), b.Y(), EPS) &&
+            vecmath::fpequal(a.Z(), b.Z(), EPS) &&
+            vecmath::fpequal(a.W(), b.W(), EPS));
+}
+
+} // namespace
+
+BTEST(Affine, ctorIdentity)
+{
+    ASSERT_EQ(same(vecmath::AffineMatrix3f(), vecmath::Matrix3f()), true);
+    ASSERT_EQ(sizeof(vecmath::AffineMatrix3f), 12 * sizeof(float));
+}
+
+BTEST(Affine, getIndexCheck)
+{
+    vecmath::AffineMatrix3f m;
+
+    try {
+        (void)m.get(4,0);
+        FAIL() << "get(4,0) didn't throw expected exception\n";
+    }
+    catch (vecmath::index_error &) {
+        // expected
+    }
+
+    try {
+        (void)m.get(0,4);
+        FAIL() << "get(0,4) didn't throw expected exception\n";
+    }
+    catch (vecmath::index_error &) {
+        // expected
+    }
+}
+
+BTEST(Affine, factories)
+{
+    using vecmath::AffineMatrix3f;
+    using vecmath::Matrix3f;
+
+    ASSERT_EQ(same(AffineMatrix3f::translation(1, 2, 3), Matrix3f::translation(1, 2, 3)), true);
+    ASSERT_EQ(same(AffineMatrix3f::scale(2, 3, 4), Matrix3f::scale(2, 3, 4)), true);
+    ASSERT_EQ(same(AffineMatrix3f::rotateX(0.3f), Matrix3f::rotateX(0.3f)), true);
+    ASSERT_EQ(same(AffineMatrix3f::rotateY(0.4f), Matrix3f::rotateY(0.4f)), true);
+    ASSERT_EQ(same(AffineMatrix3f::rotateZ(0.5f), Matrix3f::rotateZ(0.5f)), true);
+}
+
+BTEST(Affine, conversions)
+{
+    vecmath::Matrix3f const m = vecmath::Matrix3f::translation(1, 2, 3) *
+                                vecmath::Matrix3f::rotateY(0.7f);
+
+    vecmath::AffineMatrix3f const a(m);
+    ASSERT_EQ(same(a, m), true);
+
+    vecmath::Matrix3f const back(a);
+    ASSERT_EQ(same(a, back), true);
+}
+
+BTEST(Affine, compose)
+{
+    using vecmath::AffineMatrix3f;
+    using vecmath::Matrix3f;
+
+    AffineMatrix3f const a = AffineMatrix3f::translation(1, -2, 3) *
+                             AffineMatrix3f::rotateX(0.3f) *
+                             AffineMatrix3f::scale(2, 3, 4) *
+                             AffineMatrix3f::rotateZ(-1.1f);
+    Matrix3f const m = Matrix3f::translation(1, -2, 3) *
+                       Matrix3f::rotateX(0.3f) *
+                       Matrix3f::scale(2, 3, 4) *
+                       Matrix3f::rotateZ(-1.1f);
+    ASSERT_EQ(same(a, m), true);
+}
+
+BTEST(Affine, vectorProducts)
+{
+    using vecmath::AffineMatrix3f;
+
+    AffineMatrix3f const a = AffineMatrix3f::translation(1, -2, 3) *
+                             AffineMatrix3f::rotateY(0.9f);
+    vecmath::Matrix3f const m(a);
+    vecmath::Vector3f const v {0.5f, -1.5f, 2.0f};
+
+    ASSERT_EQ(same(a * v, m * v), true);
+    ASSERT_EQ(same(v * a, v * m), true);
+
+    // W passes through a column vector product unchanged
+    vecmath::Vector3f const t = AffineMatrix3f::translation(1, 2, 3) * xunit;
+    ASSERT_FPEQ(t.X(), 2.0f, EPS);
+    ASSERT_FPEQ(t.Y(), 2.0f, EPS);
+    ASSERT_FPEQ(t.Z(), 3.0f, EPS);
+    ASSERT_FPEQ(t.W(), 1.0f, EPS);
+}
+
+BTEST(Affine, transformArray)
+{
+    vecmath::AffineMatrix3f const a = vecmath::AffineMatrix3f::translation(1, -2, 3) *
+                                      vecmath::AffineMatrix3f::rotateZ(0.4f);
+
+    vecmath::Vector3Arrayf in;
+    for (int i=0; i<37; ++i)
+    {
+        in.push_back({float(i), float(2*i) - 5, float(i % 7)});
+    }
+
+    vecmath::Vector3Arrayf out;
+    vecmath::transform(a, in, out);
+    ASSERT_EQ(out.size(), in.size());
+
+    for (std::size_t i=0; i<in.size(); ++i)
+    {
+        ASSERT_EQ(same(out.get(i), a * in.get(i)), true);
+    }
+
+    vecmath::transform(a, in, in);
+    for (std::size_t i=0; i<in.size(); ++i)
+    {
+        ASSERT_EQ(same(in.get(i), out.get(i)), true);
+    }
+}
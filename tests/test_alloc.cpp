@@ -0,0 +1,144 @@
+/**
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/**
+ * Unit tests for storage alignment and the allocators
+ */
+#include "vecmath.h"
+#include "affine.h"
+#include "vecalloc.h"
+
+#include "test_common.h"
+
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <vector>
+
+namespace {
+
+bool aligned(void const* p, std::size_t align)
+{
+    return (reinterpret_cast<std::uintptr_t>(p) % align) == 0;
+}
+
+} // namespace
+
+BTEST(Alloc, storageAlignment)
+{
+    using namespace vecmath;
+
+    // VECMATH_ALIGN never changes sizes
+    static_assert(sizeof(Vector3f) == 4 * sizeof(float), "Vector3f size");
+    static_assert(sizeof(Matrix3f) == 16 * sizeof(float), "Matrix3f size");
+    static_assert(sizeof(AffineMatrix3f) == 12 * sizeof(float), "AffineMatrix3f size");
+    static_assert(sizeof(Matrix3d) == 16 * sizeof(double), "Matrix3d size");
+
+    static_assert(alignof(Vector3f) == detail::storage_align(16, 4), "Vector3f alignment");
+    static_assert(alignof(Matrix3d) == detail::storage_align(128, 8), "Matrix3d alignment");
+
+    // capped by the largest power of 2 dividing the size
+    static_assert(detail::storage_align(48, 4) <= 16, "48 bytes align to 16 at most");
+    static_assert(detail::storage_align(16, 8) >= 8, "never below natural");
+}
+
+BTEST(Alloc, alignedAllocator)
+{
+    std::vector<vecmath::Matrix3f, vecmath::aligned_allocator<vecmath::Matrix3f> > mats(5);
+    ASSERT_EQ(aligned(mats.data(), vecmath::cache_line), true);
+
+    // every 64-byte element in its own cache line
+    for (vecmath::Matrix3f const& m : mats)
+    {
+        ASSERT_EQ(aligned(&m, vecmath::cache_line), true);
+        ASSERT_EQ(m(0,0), 1.0f);
+    }
+
+    std::vector<float, vecmath::aligned_allocator<float, 32> > f;
+    for (int i=0; i<100; ++i)
+    {
+        f.push_back(float(i));                      // reallocates
+        ASSERT_EQ(aligned(f.data(), 32), true);
+    }
+    ASSERT_EQ(f[99], 99.0f);
+}
+
+BTEST(Alloc, arena)
+{
+    vecmath::arena a(1024);
+
+    vecmath::Vector3f* v = a.allocate<vecmath::Vector3f>(10);
+    ASSERT_EQ(aligned(v, alignof(vecmath::Vector3f)), true);
+    char* c = static_cast<char*>(a.allocate(3, 1));
+    vecmath::Matrix3d* m = a.allocate<vecmath::Matrix3d>(2);
+    ASSERT_EQ(aligned(m, alignof(vecmath::Matrix3d)), true);
+    ASSERT_EQ(static_cast<void*>(c) > static_cast<void*>(v), true);
+    std::size_t const cap = a.capacity();
+    ASSERT_EQ(cap, std::size_t(1024));
+
+    // larger than a block, so it gets its own
+    (void) a.allocate(5000);
+    ASSERT_EQ(a.capacity(), std::size_t(1024 + 5000));
+
+    // reset keeps the blocks and hands out the same memory again
+    a.reset();
+    ASSERT_EQ(static_cast<void*>(a.allocate<vecmath::Vector3f>(10)), static_cast<void*>(v));
+    (void) a.allocate(4000);
+    ASSERT_EQ(a.capacity(), std::size_t(1024 + 5000));
+}
+
+BTEST(Alloc, arenaAllocator)
+{
+    vecmath::arena a;
+    typedef vecmath::arena_allocator<vecmath::Vector3f> alloc;
+
+    for (int pass=0; pass<3; ++pass)
+    {
+        std::vector<vecmath::Vector3f, alloc> tmp{alloc(a)};
+        for (int i=0; i<200; ++i)
+        {
+            tmp.push_back(vecmath::Vector3f(float(i), 0.0f, 0.0f));
+        }
+        ASSERT_EQ(tmp[199].X(), 199.0f);
+        a.reset();
+    }
+    ASSERT_EQ(a.capacity(), std::size_t(1 << 16));
+}
+
+BTEST(Alloc, overflow)
+{
+    std::size_t const huge = std::numeric_limits<std::size_t>::max() / sizeof(vecmath::Matrix3f) + 1;
+
+    vecmath::aligned_allocator<vecmath::Matrix3f> a;
+    ASSERT_EQ(a.max_size(), huge - 1);
+    try {
+        a.allocate(huge);
+        FAIL() << "aligned_allocator should have failed for a size that overflows\n";
+    }
+    catch (std::bad_array_new_length&) {
+        // PASS, intended failure
+    }
+
+    vecmath::arena scratch;
+    try {
+        scratch.allocate<vecmath::Matrix3f>(huge);
+        FAIL() << "arena should have failed for a size that overflows\n";
+    }
+    catch (std::bad_array_new_length&) {
+        // PASS, intended failure
+    }
+
+    // bytes that fit a size_t, but not with the alignment padding
+    try {
+        scratch.allocate(std::numeric_limits<std::size_t>::max() - 8);
+        FAIL() << "arena should have failed for a block that overflows\n";
+    }
+    catch (std::bad_alloc&) {
+        // PASS, intended failure
+    }
+    ASSERT_EQ(scratch.capacity(), 0u);
+}
@@ -0,0 +1,99 @@
+/**
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/**
+ * Unit tests for the Vector3Array container
+ */
+#include "vecmath.h"
+#include "vecarray.h"
+
+#include "test_common.h"
+
+BTEST(Array, pushAndGet)
+{
+    vecmath::Vector3Arrayf a;
+    ASSERT_EQ(a.size(), 0u);
+
+    a.push_back(xunit);
+    a.push_back(yunit);
+    a.push_back({1.0f, 2.0f, 3.0f});
+    ASSERT_EQ(a.size(), 3u);
+
+    vecmath::Vector3f v = a.get(2);
+    ASSERT_FPEQ(v.X(), 1.0f, EPS);
+    ASSERT_FPEQ(v.Y(), 2.0f, EPS);
+    ASSERT_FPEQ(v.Z(), 3.0f, EPS);
+    ASSERT_FPEQ(v.W(), 1.0f, EPS);
+
+    ASSERT_FPEQ(a.X()[0], 1.0f, EPS);
+    ASSERT_FPEQ(a.Y()[1], 1.0f, EPS);
+    ASSERT_FPEQ(a.Z()[2], 3.0f, EPS);
+}
+
+BTEST(Array, indexCheck)
+{
+    vecmath::Vector3Arrayf a(2);
+
+    try {
+        (void)a.get(2);
+        FAIL() << "get(2) didn't throw expected exception\n";
+    }
+    catch (vecmath::index_error &) {
+        // expected
+    }
+
+    try {
+        a.set(5, xunit);
+        FAIL() << "set(5) didn't throw expected exception\n";
+    }
+    catch (vecmath::index_error &) {
+        // expected
+    }
+}
+
+BTEST(Array, transformMatchesMV)
+{
+    vecmath::Matrix3f m = (vecmath::Matrix3f::translation(1.0f, -2.0f, 3.0f) *
+                           vecmath::Matrix3f::rotateZ(0.3f) *
+                           vecmath::Matrix3f::scale(2.0f, 0.5f, 1.5f));
+
+    vecmath::Vector3Arrayf in;
+    for (int i=0; i<37; ++i)                // odd count to exercise tails
+    {
+        in.push_back({0.25f*i, 1.0f - 0.5f*i, 0.125f*i*i});
+    }
+
+    vecmath::Vector3Arrayf out;
+    vecmath::transform(m, in, out);
+    ASSERT_EQ(out.size(), in.size());
+
+    for (std::size_t i=0; i<in.size(); ++i)
+    {
+        vecmath::Vector3f expect = m * in.get(i);
+        vecmath::Vector3f actual = out.get(i);
+        ASSERT_FPEQ(actual.X(), expect.X(), 1.0e-4f);
+        ASSERT_FPEQ(actual.Y(), expect.Y(), 1.0e-4f);
+        ASSERT_FPEQ(actual.Z(), expect.Z(), 1.0e-4f);
+    }
+}
+
+BTEST(Array, transformInPlace)
+{
+    vecmath::Matrix3d m = vecmath::Matrix3d::translation(1.0, 2.0, 3.0);
+    vecmath::Vector3Arrayd a;
+    a.push_back({1.0, 1.0, 1.0});
+    a.push_back({-1.0, 0.0, 2.0});
+
+    vecmath::transform(m, a, a);
+
+    ASSERT_FPEQ(a.X()[0], 2.0, EPS);
+    ASSERT_FPEQ(a.Y()[0], 3.0, EPS);
+    ASSERT_FPEQ(a.Z()[0], 4.0, EPS);
+    ASSERT_FPEQ(a.X()[1], 0.0, EPS);
+    ASSERT_FPEQ(a.Y()[1], 2.0, EPS);
+    ASSERT_FPEQ(a.Z()[1], 5.0, EPS);
+}
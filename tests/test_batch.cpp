@@ -0,0 +1,224 @@
+/**
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/**
+ * Unit tests for the batched vector operations.
+ *
+ * The batch kernels of every supported instruction set are checked
+ * against the one-vector functions, at sizes that leave every tail
+ * length.
+ */
+#include "vecmath.h"
+#include "vecbatch.h"
+
+#include "test_common.h"
+
+#include <vector>
+
+namespace {
+
+// Deterministic vectors, including a zero one.
+template <typename fptype>
+std::vector<vecmath::Vector3<fptype> > makeVectors(std::size_t n, int seed)
+{
+    std::vector<vecmath::Vector3<fptype> > v(n);
+    for (std::size_t i=0; i<n; ++i)
+    {
+        fptype const t = fptype(i * 7 + seed);
+        v[i] = vecmath::Vector3<fptype>(std::sin(t) * 3, std::cos(t * 2), fptype(1.5) - std::sin(t * 3));
+    }
+    if (n > 2)
+        v[2] = vecmath::Vector3<fptype>(0, 0, 0);
+    return v;
+}
+
+// Equal to within rounding: the AVX2 and AVX-512 kernels use FMA.
+template <typename fptype>
+bool near(fptype a, fptype b)
+{
+    return std::abs(a - b) <= fptype(1.0e-6) * (1 + std::abs(b));
+}
+
+template <typename fptype>
+bool same(vecmath::Vector3<fptype> const& a, vecmath::Vector3<fptype> const& b)
+{
+    return near(a.X(), b.X()) && near(a.Y(), b.Y()) && near(a.Z(), b.Z()) && a.W() == b.W();
+}
+
+float const* flat(std::vector<vecmath::Vector3f> const& v) { return v.empty() ? nullptr : v[0].data(); }
+float* flat(std::vector<vecmath::Vector3f>& v) { return v.empty() ? nullptr : v[0].data(); }
+
+} // anonymous
+
+BTEST(Batch, kernelsMatchScalar)
+{
+    for (vecmath::simd::kernels const* k : supportedKernels())
+    {
+        for (std::size_t n : kernel_sizes)
+        {
+            std::vector<vecmath::Vector3f> const a = makeVectors<float>(n, 1);
+            std::vector<vecmath::Vector3f> const b = makeVectors<float>(n, 2);
+            std::vector<vecmath::Vector3f> v(n + 1);        // one past the end stays untouched
+            std::vector<float> s(n + 1, -1.0f);
+
+            k->dot_n(s.data(), flat(a), flat(b), n);
+            for (std::size_t i=0; i<n; ++i)
+                ASSERT_EQ(near(s[i], vecmath::dot(a[i], b[i])), true);
+            ASSERT_EQ(s[n], -1.0f);
+
+            k->length_n(s.data(), flat(a), n);
+            for (std::size_t i=0; i<n; ++i)
+                ASSERT_EQ(near(s[i], a[i].fast_length<vecmath::precision::exact>()), true);
+
+            k->cross_n(flat(v), flat(a), flat(b), n);
+            for (std::size_t i=0; i<n; ++i)
+                ASSERT_EQ(same(v[i], vecmath::cross(a[i], b[i])), true);
+            ASSERT_EQ(same(v[n], vecmath::Vector3f()), true);
+
+            k->normalize_n(flat(v), flat(a), n);
+            for (std::size_t i=0; i<n; ++i)
+            {
+                vecmath::Vector3f e = a[i];
+                ASSERT_EQ(same(v[i], e.fast_normalize<vecmath::precision::exact>()), true);
+            }
+
+            k->add_n(flat(v), flat(a), flat(b), n);
+            for (std::size_t i=0; i<n; ++i)
+                ASSERT_EQ(same(v[i], a[i] + b[i]), true);
+
+            k->sub_n(flat(v), flat(a), flat(b), n);
+            for (std::size_t i=0; i<n; ++i)
+                ASSERT_EQ(same(v[i], a[i] - b[i]), true);
+
+            k->scale_n(flat(v), flat(a), 2.5f, n);
+            for (std::size_t i=0; i<n; ++i)
+                ASSERT_EQ(same(v[i], vecmath::Vector3f(a[i].X() * 2.5f, a[i].Y() * 2.5f, a[i].Z() * 2.5f)), true);
+            ASSERT_EQ(same(v[n], vecmath::Vector3f()), true);
+
+            // SoA, in place
+            vecmath::Vector3Arrayf p(n + 1);
+            for (std::size_t i=0; i<n; ++i)
+                p.set(i, a[i]);
+            k->length_soa_n(s.data(), p.X(), p.Y(), p.Z(), n);
+            for (std::size_t i=0; i<n; ++i)
+                ASSERT_EQ(near(s[i], a[i].fast_length<vecmath::precision::exact>()), true);
+            k->normalize_soa_n(p.X(), p.Y(), p.Z(), p.X(), p.Y(), p.Z(), n);
+            for (std::size_t i=0; i<n; ++i)
+            {
+                vecmath::Vector3f e = a[i];
+                ASSERT_EQ(same(p.get(i), e.fast_normalize<vecmath::precision::exact>()), true);
+            }
+            ASSERT_EQ(p.X()[n], 0.0f);
+        }
+    }
+}
+
+BTEST(Batch, aliased)
+{
+    for (vecmath::simd::kernels const* k : supportedKernels())
+    {
+        std::vector<vecmath::Vector3f> const a = makeVectors<float>(37, 3);
+        std::vector<vecmath::Vector3f> const b = makeVectors<float>(37, 4);
+        std::vector<vecmath::Vector3f> v = a;
+
+        k->cross_n(flat(v), flat(v), flat(b), v.size());
+        for (std::size_t i=0; i<v.size(); ++i)
+            ASSERT_EQ(same(v[i], vecmath::cross(a[i], b[i])), true);
+
+        v = a;
+        k->normalize_n(flat(v), flat(v), v.size());
+        for (std::size_t i=0; i<v.size(); ++i)
+        {
+            vecmath::Vector3f e = a[i];
+            ASSERT_EQ(same(v[i], e.fast_normalize<vecmath::precision::exact>()), true);
+        }
+    }
+}
+
+BTEST(Batch, spans)
+{
+    std::vector<vecmath::Vector3d> const a = makeVectors<double>(21, 5);
+    std::vector<vecmath::Vector3d> const b = makeVectors<double>(21, 6);
+    std::vector<vecmath::Vector3d> v(a.size());
+    std::vector<double> s(a.size());
+
+    vecmath::dot_batch(a, b, s);
+    ASSERT_EQ(s[20], vecmath::dot(a[20], b[20]));
+    vecmath::length_batch(a, s);
+    ASSERT_EQ(s[20], a[20].fast_length<vecmath::precision::exact>());
+    vecmath::cross_batch(a, b, v);
+    ASSERT_EQ(same(v[20], vecmath::cross(a[20], b[20])), true);
+    vecmath::add_batch(a, b, v);
+    vecmath::sub_batch(v, b, v);                            // in place
+    ASSERT_FPEQ(v[20].Y(), a[20].Y(), 1.0e-12);
+    vecmath::scale_batch(a, 2.0, v);
+    ASSERT_EQ(v[20].Z(), 2 * a[20].Z());
+    vecmath::normalize_batch(v, v);
+    ASSERT_FPEQ(v[20].length(), 1.0, 1.0e-12);
+    ASSERT_EQ(v[2].X(), 0.0);                               // zero stays zero
+
+    // Vector3f goes through the active kernels
+    std::vector<vecmath::Vector3f> const af = makeVectors<float>(9, 7);
+    std::vector<float> sf(af.size());
+    vecmath::length_batch(vecmath::span<vecmath::Vector3f const>(af.data() + 1, 8),
+                          vecmath::span<float>(sf.data(), 8));
+    ASSERT_EQ(near(sf[0], af[1].fast_length<vecmath::precision::exact>()), true);
+
+    try {
+        vecmath::dot_batch(a, b, vecmath::span<double>(s.data(), 3));
+        FAIL() << "dot_batch() should have failed for a short output\n";
+    }
+    catch (vecmath::index_error&) {
+        // PASS, intended failure
+    }
+}
+
+BTEST(Batch, arrays)
+{
+    std::vector<vecmath::Vector3f> const av = makeVectors<float>(300, 8);
+    std::vector<vecmath::Vector3f> const bv = makeVectors<float>(300, 9);
+    vecmath::Vector3Arrayf a, b, r;
+    for (std::size_t i=0; i<av.size(); ++i)
+    {
+        a.push_back(av[i]);
+        b.push_back(bv[i]);
+    }
+
+    std::vector<float> s(a.size());
+    vecmath::dot_batch(a, b, s);
+    ASSERT_EQ(s[299], vecmath::dot(av[299], bv[299]));
+    vecmath::length_batch(a, s);
+    ASSERT_EQ(s[299], av[299].fast_length<vecmath::precision::exact>());
+
+    vecmath::cross_batch(a, b, r);
+    ASSERT_EQ(same(r.get(299), vecmath::cross(av[299], bv[299])), true);
+    r = a;
+    vecmath::cross_batch(r, b, r);                          // in place
+    ASSERT_EQ(same(r.get(299), vecmath::cross(av[299], bv[299])), true);
+
+    vecmath::normalize_batch(a, r);
+    for (std::size_t i=0; i<r.size(); ++i)
+    {
+        vecmath::Vector3f e = av[i];
+        ASSERT_EQ(same(r.get(i), e.fast_normalize<vecmath::precision::exact>()), true);
+    }
+
+    vecmath::add_batch(a, b, r);
+    ASSERT_EQ(same(r.get(123), av[123] + bv[123]), true);
+    vecmath::sub_batch(r, b, r);                            // in place
+    ASSERT_FPEQ(r.get(123).X(), av[123].X(), 1.0e-6f);
+    vecmath::scale_batch(a, 0.5f, r);
+    ASSERT_EQ(r.Y()[7], av[7].Y() * 0.5f);
+
+    try {
+        vecmath::add_batch(a, vecmath::Vector3Arrayf(3), r);
+        FAIL() << "add_batch() should have failed for different sizes\n";
+    }
+    catch (vecmath::index_error&) {
+        // PASS, intended failure
+    }
+}
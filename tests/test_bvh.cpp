@@ -0,0 +1,246 @@
+/**
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/**
+ * Unit tests for the point cloud BVH.
+ *
+ * The queries are checked against brute force over clouds with
+ * clusters and duplicate points, before and after the points move,
+ * and the parallel build against the serial one.
+ */
+#include "vecmath.h"
+#include "bvh.h"
+#include "vecparallel.h"
+
+#include "test_common.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+using vecmath::Vector3f;
+using vecmath::Vector3d;
+
+namespace {
+
+// A cloud of uniform points, a tight cluster and exact duplicates.
+std::vector<Vector3f> makeCloud(std::size_t n, uint32_t seed)
+{
+    uint32_t s = seed;
+    auto next = [&s]() {
+        s = s * 1664525u + 1013904223u;
+        return float(s >> 8) / float(1 << 24);
+    };
+    std::vector<Vector3f> v(n);
+    for (std::size_t i=0; i<n; ++i)
+    {
+        if (i % 10 == 7)
+            v[i] = Vector3f(3.0f + next() * 1.0e-3f, -2.0f, 1.0f + next() * 1.0e-3f);
+        else if (i % 10 == 3 && i > 3)
+            v[i] = v[i - 3];
+        else
+            v[i] = Vector3f(next() * 20 - 10, next() * 8 - 4, next() * 12);
+    }
+    return v;
+}
+
+float dist2(Vector3f const& a, Vector3f const& b)
+{
+    float const dx = a.X() - b.X(), dy = a.Y() - b.Y(), dz = a.Z() - b.Z();
+    return dx*dx + dy*dy + dz*dz;
+}
+
+// Every point in its leaf's box, and every box in its parent's.
+bool wellFormed(vecmath::PointBVHf const& bvh)
+{
+    std::vector<vecmath::PointBVHf::Node> const& nodes = bvh.nodes();
+    std::vector<int> seen(bvh.size(), 0);
+    for (std::size_t i=0; i<nodes.size(); ++i)
+    {
+        vecmath::PointBVHf::Node const& n = nodes[i];
+        if (n.count)
+        {
+            for (uint32_t k=n.index; k<n.index+n.count; ++k)
+            {
+                float const p[3] = {bvh.points().X()[k], bvh.points().Y()[k], bvh.points().Z()[k]};
+                for (int c=0; c<3; ++c)
+                    if (p[c] < n.lo[c] || p[c] > n.hi[c])
+                        return false;
+                ++seen[bvh.ids()[k]];
+            }
+            continue;
+        }
+        if (n.index <= i + 1 || n.index >= nodes.size())
+            return false;
+        vecmath::PointBVHf::Node const* kids[2] = {&nodes[i + 1], &nodes[n.index]};
+        for (vecmath::PointBVHf::Node const* k : kids)
+            for (int c=0; c<3; ++c)
+                if (k->lo[c] < n.lo[c] || k->hi[c] > n.hi[c])
+                    return false;
+    }
+    for (int s : seen)
+        if (s != 1)
+            return false;
+    return true;
+}
+
+// The queries against brute force, for points pts.
+bool queriesMatch(vecmath::PointBVHf const& bvh, std::vector<Vector3f> const& pts)
+{
+    std::vector<Vector3f> const queries = makeCloud(40, 99);
+    std::vector<uint32_t> idx(20), found;
+    std::vector<float> d2(20);
+    for (Vector3f const& q : queries)
+    {
+        std::vector<float> all(pts.size());
+        for (std::size_t i=0; i<pts.size(); ++i)
+            all[i] = dist2(q, pts[i]);
+        std::vector<float> sorted = all;
+        std::sort(sorted.begin(), sorted.end());
+
+        for (std::size_t k : {std::size_t(1), std::size_t(5), std::size_t(20)})
+        {
+            std::size_t const n = bvh.nearest(q, k, idx, d2);
+            if (n != std::min(k, pts.size()))
+                return false;
+            for (std::size_t i=0; i<n; ++i)
+                if (d2[i] != sorted[i] || all[idx[i]] != d2[i])
+                    return false;
+        }
+
+        float const radius = 1.5f;
+        found.clear();
+        std::size_t const n = bvh.within(q, radius, found);
+        std::size_t expect = 0;
+        for (float a : all)
+            expect += (a <= radius * radius);
+        if (n != expect || found.size() != expect)
+            return false;
+        for (uint32_t i : found)
+            if (all[i] > radius * radius)
+                return false;
+
+        // toward the origin, and along an axis (zero direction components)
+        vecmath::Rayf const rays[2] = {vecmath::Rayf(q, Vector3f(-q.X(), -q.Y(), -q.Z())),
+                                       vecmath::Rayf(q, Vector3f(0, 0, -1))};
+        for (vecmath::Rayf const& r : rays)
+        {
+            Vector3f const d = r.direction;
+            float const dd = vecmath::dot(d, d);
+            float best = std::numeric_limits<float>::infinity();
+            for (Vector3f const& p : pts)
+            {
+                Vector3f const s = p - q;
+                float const t = vecmath::dot(s, d) / dd;
+                Vector3f const e(s.X() - t*d.X(), s.Y() - t*d.Y(), s.Z() - t*d.Z());
+                if (t >= 0 && t < best && vecmath::dot(e, e) <= 0.25f)
+                    best = t;
+            }
+            uint32_t hit = 0;
+            float t = 0;
+            bool const h = bvh.raycast(r, 0.5f, hit, t);
+            if (h != (best != std::numeric_limits<float>::infinity()) || t != best)
+                return false;
+        }
+    }
+    return true;
+}
+
+} // anonymous
+
+BTEST(BVH, queries)
+{
+    for (std::size_t n : {std::size_t(0), std::size_t(1), std::size_t(7), std::size_t(9),
+                          std::size_t(100), std::size_t(5000)})
+    {
+        std::vector<Vector3f> const pts = makeCloud(n, 1);
+        vecmath::PointBVHf const bvh(pts);
+        ASSERT_EQ(bvh.size(), n);
+        ASSERT_EQ(wellFormed(bvh), true);
+        ASSERT_EQ(queriesMatch(bvh, pts), true);
+    }
+
+    // from a Vector3Array, the same tree
+    std::vector<Vector3f> const pts = makeCloud(3000, 2);
+    vecmath::Vector3Arrayf soa;
+    for (Vector3f const& p : pts)
+        soa.push_back(p);
+    vecmath::PointBVHf const a(pts), b(soa);
+    ASSERT_EQ(a.nodes().size(), b.nodes().size());
+    ASSERT_EQ(std::memcmp(a.nodes().data(), b.nodes().data(),
+                          a.nodes().size() * sizeof(a.nodes()[0])), 0);
+
+    // one point repeated: halves of equal codes
+    std::vector<Vector3f> const same(1000, Vector3f(1, 2, 3));
+    vecmath::PointBVHf const c(same);
+    ASSERT_EQ(wellFormed(c), true);
+    std::vector<uint32_t> found;
+    ASSERT_EQ(c.within(Vector3f(1, 2, 3), 0, found), std::size_t(1000));
+}
+
+BTEST(BVH, refit)
+{
+    std::vector<Vector3f> pts = makeCloud(4000, 3);
+    vecmath::PointBVHf bvh(pts);
+
+    vecmath::Matrix3f const m = vecmath::Matrix3f::translation(1, -2, 0.5f) *
+                                vecmath::Matrix3f::rotateEuler(0.4f, 0.1f, -0.9f);
+    bvh.transform(m);
+    for (Vector3f& p : pts)
+        p = m * p;
+    ASSERT_EQ(wellFormed(bvh), true);
+    ASSERT_EQ(queriesMatch(bvh, pts), true);
+
+    // each point moved its own way
+    for (std::size_t i=0; i<pts.size(); ++i)
+        pts[i] = Vector3f(pts[i].X() + std::sin(float(i)), pts[i].Y(), pts[i].Z() * 1.5f);
+    bvh.refit(pts);
+    ASSERT_EQ(wellFormed(bvh), true);
+    ASSERT_EQ(queriesMatch(bvh, pts), true);
+
+    try {
+        pts.pop_back();
+        bvh.refit(pts);
+        FAIL() << "refit() should have failed for a different size\n";
+    }
+    catch (vecmath::index_error&) {
+        // PASS, intended failure
+    }
+}
+
+BTEST(BVH, parallelBuild)
+{
+    // enough points for several subtree tasks
+    std::vector<Vector3f> const pts = makeCloud(200000, 4);
+    vecmath::PointBVHf serial(pts), par;
+    vecmath::parallel::thread_pool pool(4);
+    vecmath::parallel::build_bvh(pts, par, pool);
+
+    ASSERT_EQ(par.nodes().size(), serial.nodes().size());
+    ASSERT_EQ(std::memcmp(par.nodes().data(), serial.nodes().data(),
+                          par.nodes().size() * sizeof(par.nodes()[0])), 0);
+    ASSERT_EQ(par.ids() == serial.ids(), true);
+    ASSERT_EQ(wellFormed(par), true);
+
+    std::vector<uint32_t> idx(1);
+    std::vector<float> d2(1);
+    ASSERT_EQ(par.nearest(pts[12345], 1, idx, d2), std::size_t(1));
+    ASSERT_EQ(d2[0], 0.0f);
+
+    // double, from a Vector3Array
+    vecmath::Vector3Arrayd soa;
+    for (Vector3f const& p : pts)
+        soa.push_back(Vector3d(p.X(), p.Y(), p.Z()));
+    vecmath::PointBVHd const sd(soa);
+    vecmath::PointBVHd pd;
+    vecmath::parallel::build_bvh(soa, pd, pool);
+    ASSERT_EQ(pd.nodes().size(), sd.nodes().size());
+    ASSERT_EQ(std::memcmp(pd.nodes().data(), sd.nodes().data(),
+                          pd.nodes().size() * sizeof(pd.nodes()[0])), 0);
+}
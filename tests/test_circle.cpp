@@ -44,3 +44,59 @@ BTEST(Circle, basic)
         FAIL() << e.what() << std::endl;
     }
 }
+
+BTEST(Circle, batch)
+{
+    vecmath::Vector3f a[3] = {{1.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 0.0f}, {-1.0f, 0.0f, 0.0f}};
+    vecmath::Vector3f b[3] = {{2.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 0.0f}, { 0.0f, 1.0f, 0.0f}};
+    vecmath::Vector3f c[3] = {{3.0f, 1.0f, 0.0f}, {2.0f, 2.0f, 0.0f}, { 1.0f, 0.0f, 0.0f}};
+    vecmath::Vector3f centers[3];
+    uint8_t status[3];
+
+    // The middle triple is colinear.
+    std::size_t solved = vecmath::circle3pts_batch(a, b, c, centers, status, 3);
+    ASSERT_EQ(solved, 2u);
+    ASSERT_EQ(status[0], 1);
+    ASSERT_EQ(status[1], 0);
+    ASSERT_EQ(status[2], 1);
+
+    vecmath::Vector3f expect0 = vecmath::circle3pts(a[0], b[0], c[0]);
+    ASSERT_FPEQ(centers[0].X(), expect0.X(), EPS);
+    ASSERT_FPEQ(centers[0].Y(), expect0.Y(), EPS);
+
+    ASSERT_FPEQ(centers[1].X(), 0.0f, EPS);
+    ASSERT_FPEQ(centers[1].Y(), 0.0f, EPS);
+
+    ASSERT_FPEQ(centers[2].X(), 0.0f, EPS);  // unit circle at origin
+    ASSERT_FPEQ(centers[2].Y(), 0.0f, EPS);
+}
+
+BTEST(Circle, batchSoA)
+{
+    vecmath::Vector3Arrayf a, b, c, centers;
+    for (int i=0; i<19; ++i)
+    {
+        // Circle of radius 2 centered at (i, -i)
+        float const t = 0.3f * i;
+        a.push_back({i + 2.0f*std::cos(t),        -i + 2.0f*std::sin(t),        0.0f});
+        b.push_back({i + 2.0f*std::cos(t + 2.0f), -i + 2.0f*std::sin(t + 2.0f), 0.0f});
+        c.push_back({i + 2.0f*std::cos(t + 4.0f), -i + 2.0f*std::sin(t + 4.0f), 0.0f});
+    }
+    a.push_back(xunit);                     // colinear last triple
+    b.push_back(xunit);
+    c.push_back(xunit);
+
+    uint8_t status[20];
+    std::size_t solved = vecmath::circle3pts_batch(a, b, c, centers, status);
+    ASSERT_EQ(solved, 19u);
+    ASSERT_EQ(centers.size(), 20u);
+    ASSERT_EQ(status[19], 0);
+
+    for (int i=0; i<19; ++i)
+    {
+        ASSERT_EQ(status[i], 1);
+        ASSERT_FPEQ(centers.X()[i], float(i), 1.0e-4f);
+        ASSERT_FPEQ(centers.Y()[i], -float(i), 1.0e-4f);
+        ASSERT_FPEQ(centers.Z()[i], 0.0f, EPS);
+    }
+}
@@ -44,3 +44,19 @@ BTEST(Circle, basicDbl)
         FAIL() << e.what() << std::endl;
     }
 }
+
+BTEST(Circle, batchDbl)
+{
+    vecmath::Vector3d a[2] = {{1.0, 1.0, 0.0}, {5.0, 5.0, 0.0}};
+    vecmath::Vector3d b[2] = {{2.0, 0.0, 0.0}, {5.0, 5.0, 0.0}};
+    vecmath::Vector3d c[2] = {{3.0, 1.0, 0.0}, {5.0, 5.0, 0.0}};
+    vecmath::Vector3d centers[2];
+    uint8_t status[2];
+
+    std::size_t solved = vecmath::circle3pts_batch(a, b, c, centers, status, 2);
+    ASSERT_EQ(solved, 1u);
+    ASSERT_EQ(status[0], 1);
+    ASSERT_EQ(status[1], 0);
+    ASSERT_FPEQ(centers[0].X(), 2.0, EPS);
+    ASSERT_FPEQ(centers[0].Y(), 1.0, EPS);
+}
@@ -11,8 +11,15 @@
 #ifndef TEST_COMMON_H
 #define TEST_COMMON_H
 
+#include "vecmath.h"
+#include "vecsimd.h"
+
 #include <btest.h>
 
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
 /**
  * EPS is a "close enough" value for equality checking.
  */
@@ -22,4 +29,48 @@ static const vecmath::Vector3f xunit(1.0, 0.0, 0.0);
 static const vecmath::Vector3f yunit(0.0, 1.0, 0.0);
 static const vecmath::Vector3f zunit(0.0, 0.0, 1.0);
 
+/**
+ * Batch sizes for the kernel tests, leaving every tail length of
+ * the 4, 8 and 16 wide kernels.
+ */
+static const std::size_t kernel_sizes[] = {0, 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 33, 100};
+
+/**
+ * The kernel tables of every instruction set this CPU supports,
+ * scalar first, for checking each against the scalar kernels:
+ *
+ *     for (vecmath::simd::kernels const* k : supportedKernels())
+ */
+inline std::vector<vecmath::simd::kernels const*> supportedKernels()
+{
+    vecmath::simd::isa const isas[] = {
+        vecmath::simd::isa::scalar,
+        vecmath::simd::isa::sse,
+        vecmath::simd::isa::avx2,
+        vecmath::simd::isa::avx512,
+        vecmath::simd::isa::neon
+    };
+    std::vector<vecmath::simd::kernels const*> found;
+    for (vecmath::simd::isa id : isas)
+    {
+        if (vecmath::simd::kernels const* k = vecmath::simd::find(id))
+            found.push_back(k);
+    }
+    return found;
+}
+
+/**
+ * OpenGL's perspective projection, looking down -z.
+ */
+template <typename fptype>
+vecmath::Matrix3<fptype> perspective(fptype fovy, fptype aspect, fptype zn, fptype zf)
+{
+    fptype const f = 1 / std::tan(fovy / 2);
+    vecmath::Matrix3<fptype> m = vecmath::Matrix3<fptype>::scale(f / aspect, f, (zf + zn) / (zn - zf));
+    m(2,3) = 2 * zf * zn / (zn - zf);
+    m(3,2) = -1;
+    m(3,3) = 0;
+    return m;
+}
+
 #endif // TEST_COMMON_H
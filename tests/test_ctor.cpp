@@ -11,6 +11,8 @@
 #include "vecmath.h"
 #include "test_common.h"
 
+#include <type_traits>
+
 BTEST(Ctor, Vector3f_default)
 {
     vecmath::Vector3f v3;
@@ -64,3 +66,48 @@ BTEST(Ctor, Vector3f_assign)
     ASSERT_EQ(v3.Z(), 0.0);
     ASSERT_EQ(v3.W(), 1.0);
 }
+
+BTEST(Ctor, triviallyCopyable)
+{
+    static_assert(std::is_trivially_copyable<vecmath::Vector3f>::value, "Vector3f");
+    static_assert(std::is_trivially_copyable<vecmath::Vector3d>::value, "Vector3d");
+    static_assert(std::is_trivially_copyable<vecmath::Matrix3f>::value, "Matrix3f");
+    static_assert(std::is_trivially_copyable<vecmath::Matrix3d>::value, "Matrix3d");
+
+    vecmath::Vector3f a {1.0f, 2.0f, 3.0f};
+    vecmath::Vector3f b;
+    std::memcpy(&b, &a, sizeof(b));
+    ASSERT_EQ(b.X(), 1.0f);
+    ASSERT_EQ(b.Z(), 3.0f);
+    ASSERT_EQ(b.W(), 1.0f);
+}
+
+BTEST(Ctor, constexprVector3)
+{
+    constexpr vecmath::Vector3f a {1.0f, 2.0f, 3.0f};
+    constexpr vecmath::Vector3f b {-1.0f, 0.5f};
+    constexpr vecmath::Vector3f c = vecmath::cross(a, b);
+    constexpr vecmath::Vector3f m = vecmath::midpoint(a + b, a - b);
+
+    static_assert(a.X() == 1.0f && a.W() == 1.0f, "ctor");
+    static_assert(b.Z() == 0.0f, "default z");
+    static_assert(vecmath::dot(a, b) == 0.0f, "dot");
+    static_assert(a.length_squared() == 14.0f, "length_squared");
+    static_assert(c.X() == -1.5f && c.Y() == -3.0f && c.Z() == 2.5f, "cross");
+    static_assert(m.X() == 1.0f && m.Y() == 2.0f && m.Z() == 3.0f, "midpoint");
+
+    ASSERT_EQ(c.W(), 1.0f);
+}
+
+#if defined(__cpp_constexpr) && __cpp_constexpr >= 201304
+BTEST(Ctor, constexprMatrix3)
+{
+    constexpr vecmath::Matrix3f t = vecmath::Matrix3f::translation(1, 2, 3);
+    constexpr vecmath::Matrix3f s = vecmath::Matrix3f::scale(4, 5, 6);
+
+    static_assert(t.get(1,3) == 2.0f && t.get(1,1) == 1.0f, "translation");
+    static_assert(s.get(2,2) == 6.0f && s.get(3,3) == 1.0f, "scale");
+
+    ASSERT_EQ(t.get(0,3), 1.0f);
+}
+#endif
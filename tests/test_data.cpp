@@ -0,0 +1,91 @@
+/**
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/**
+ * Unit tests for unchecked element access and flat data views
+ */
+#include "vecmath.h"
+#include "affine.h"
+#include "vecspan.h"
+
+#include "test_common.h"
+
+#include <cstring>
+#include <vector>
+
+BTEST(Data, matrixElements)
+{
+    vecmath::Matrix3f m = vecmath::Matrix3f::translation(1.0f, 2.0f, 3.0f);
+    ASSERT_EQ(m(0,3), 1.0f);
+    ASSERT_EQ(m(2,3), 3.0f);
+
+    m(3,0) = 5.0f;                                  // setter
+    ASSERT_EQ(m.get(3,0), 5.0f);
+
+    // row-major layout
+    float const* d = m.data();
+    for (uint32_t r=0; r<4; ++r)
+    {
+        for (uint32_t c=0; c<4; ++c)
+        {
+            ASSERT_EQ(d[4*r + c], m.get(r,c));
+        }
+    }
+}
+
+BTEST(Data, affineElements)
+{
+    vecmath::AffineMatrix3f a = vecmath::AffineMatrix3f::scale(2.0f, 3.0f, 4.0f);
+    a(1,3) = 7.0f;
+    ASSERT_EQ(a.get(1,3), 7.0f);
+    ASSERT_EQ(a.data()[4*2 + 2], 4.0f);
+}
+
+BTEST(Data, vectorElements)
+{
+    vecmath::Vector3d v(1.0, 2.0, 3.0);
+    ASSERT_EQ(v[2], 3.0);
+    ASSERT_EQ(v[3], 1.0);
+
+    v[1] = -2.0;
+    ASSERT_EQ(v.Y(), -2.0);
+    ASSERT_EQ(v.data()[1], -2.0);
+}
+
+BTEST(Data, spans)
+{
+    std::vector<vecmath::Matrix3f> mats;
+    mats.push_back(vecmath::Matrix3f::translation(1.0f, 2.0f, 3.0f));
+    mats.push_back(vecmath::Matrix3f::scale(4.0f, 5.0f, 6.0f));
+
+    vecmath::span<float> flat = vecmath::as_scalars(mats);
+    ASSERT_EQ(flat.size(), std::size_t(32));
+    ASSERT_EQ(flat.size_bytes(), sizeof(vecmath::Matrix3f) * 2);
+    ASSERT_EQ(flat[3], 1.0f);                       // mats[0](0,3)
+    ASSERT_EQ(flat[16 + 5], 5.0f);                  // mats[1](1,1)
+
+    // writes through the view reach the matrices
+    flat[16 + 15] = 2.0f;
+    ASSERT_EQ(mats[1](3,3), 2.0f);
+
+    // a byte copy round trips
+    std::vector<float> buffer(flat.size());
+    std::memcpy(buffer.data(), flat.data(), flat.size_bytes());
+    std::vector<vecmath::Matrix3f> back(2);
+    std::memcpy(vecmath::as_scalars(back).data(), buffer.data(), flat.size_bytes());
+    ASSERT_EQ(back[1](1,1), 5.0f);
+
+    std::vector<vecmath::Vector3d> const vecs(3, vecmath::Vector3d(1.0, 2.0, 3.0));
+    vecmath::span<double const> vflat = vecmath::as_scalars(vecs);
+    ASSERT_EQ(vflat.size(), std::size_t(12));
+    ASSERT_EQ(vflat[4 + 2], 3.0);
+
+    float sum = 0;
+    for (float f : vecmath::as_scalars(&mats[0], 1))
+        sum += f;
+    ASSERT_EQ(sum, 1.0f + 1.0f + 1.0f + 1.0f + 1.0f + 2.0f + 3.0f);
+}
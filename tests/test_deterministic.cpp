@@ -0,0 +1,245 @@
+/**
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/**
+ * Unit tests for VECMATH_DETERMINISTIC, built into runtests_deterministic.
+ *
+ * Every kernel table this CPU supports must give the same bits as
+ * the scalar kernels, and those the same bits as the operators.
+ */
+#if !defined(VECMATH_DETERMINISTIC)
+#  error "build with VECMATH_DETERMINISTIC defined"
+#endif
+
+#include "vecmath.h"
+#include "vecsimd.h"
+
+#include "test_common.h"
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// Values of mixed magnitudes, so that fused and separate rounding differ.
+std::vector<float> makeValues(std::size_t n, uint32_t seed)
+{
+    uint32_t s = seed;
+    std::vector<float> v(n);
+    for (std::size_t i=0; i<n; ++i)
+    {
+        s = s * 1664525u + 1013904223u;
+        float const u = float(s >> 8) / float(1 << 24) * 2 - 1;
+        v[i] = u * ((i % 3 == 0) ? 1000.0f : (i % 3 == 1) ? 0.37f : 3.1f);
+    }
+    return v;
+}
+
+bool sameBits(void const* a, void const* b, std::size_t bytes)
+{
+    return std::memcmp(a, b, bytes) == 0;
+}
+
+vecmath::Matrix3f testMatrix()
+{
+    return (vecmath::Matrix3f::translation(1.3f, -2.7f, 3.1f) *
+            vecmath::Matrix3f::rotateEuler(0.4f, -1.3f, 1.1f) *
+            vecmath::Matrix3f::scale(2.1f, 0.57f, 1.5f));
+}
+
+} // anonymous
+
+BTEST(Deterministic, matrixKernels)
+{
+    vecmath::simd::kernels const& scalar = *vecmath::simd::find(vecmath::simd::isa::scalar);
+    vecmath::Matrix3f const a = testMatrix();
+    vecmath::Matrix3f const b = vecmath::Matrix3f::rotateAxis(vecmath::Vector3f(0.6f, 0.0f, 0.8f), 0.77f) *
+                                vecmath::Matrix3f::translation(-4.9f, 5.3f, 0.61f);
+    vecmath::Vector3f const v(1.7f, -3.3f, 0.29f);
+
+    float ab[16], av[4], va[4];
+    scalar.mm_mult(ab, a.data(), b.data());
+    scalar.mv_mult(av, a.data(), v.data());
+    scalar.vm_mult(va, v.data(), a.data());
+
+    // the operators, as the scalar kernels
+    vecmath::Matrix3f const p = a * b;
+    vecmath::Vector3f const q = a * v, r = v * a;
+    ASSERT_EQ(sameBits(ab, p.data(), sizeof(ab)), true);
+    ASSERT_EQ(sameBits(av, q.data(), sizeof(av)), true);
+    ASSERT_EQ(sameBits(va, r.data(), sizeof(va)), true);
+
+    std::vector<float> const vs = makeValues(4 * 1000, 1);
+    std::vector<float> expect(vs.size());
+    scalar.mv_mult_n(expect.data(), a.data(), vs.data(), 1000);
+
+    for (vecmath::simd::kernels const* k : supportedKernels())
+    {
+        float t[16];
+        k->mm_mult(t, a.data(), b.data());
+        ASSERT_EQ(sameBits(t, ab, sizeof(ab)), true);
+        k->mv_mult(t, a.data(), v.data());
+        ASSERT_EQ(sameBits(t, av, sizeof(av)), true);
+        k->vm_mult(t, v.data(), a.data());
+        ASSERT_EQ(sameBits(t, va, sizeof(va)), true);
+
+        for (std::size_t n : kernel_sizes)
+        {
+            std::vector<float> out(4 * n);
+            k->mv_mult_n(out.data(), a.data(), vs.data(), n);
+            ASSERT_EQ(sameBits(out.data(), expect.data(), out.size() * sizeof(float)), true);
+        }
+
+        // a chain of 64 products, each node the child of the one before
+        std::vector<float> local(16 * 64), world(16 * 64), ref(16 * 64);
+        std::vector<int32_t> parent(64);
+        for (int i=0; i<64; ++i)
+        {
+            vecmath::Matrix3f const m = vecmath::Matrix3f::rotateEuler(0.1f * i, 0.37f, -0.2f * i) *
+                                        vecmath::Matrix3f::translation(0.3f, 1.1f * i, -0.7f);
+            std::memcpy(&local[16*i], m.data(), 16 * sizeof(float));
+            parent[i] = i - 1;
+        }
+        scalar.compose_n(ref.data(), local.data(), parent.data(), nullptr, 64);
+        k->compose_n(world.data(), local.data(), parent.data(), nullptr, 64);
+        ASSERT_EQ(sameBits(world.data(), ref.data(), world.size() * sizeof(float)), true);
+    }
+}
+
+BTEST(Deterministic, batchKernels)
+{
+    vecmath::simd::kernels const& scalar = *vecmath::simd::find(vecmath::simd::isa::scalar);
+
+    for (vecmath::simd::kernels const* k : supportedKernels())
+    {
+        for (std::size_t n : kernel_sizes)
+        {
+            std::vector<float> const a = makeValues(4 * n, 2), b = makeValues(4 * n, 3);
+            std::vector<float> r(4 * n), e(4 * n);
+
+            k->dot_n(r.data(), a.data(), b.data(), n);
+            scalar.dot_n(e.data(), a.data(), b.data(), n);
+            ASSERT_EQ(sameBits(r.data(), e.data(), n * sizeof(float)), true);
+
+            k->cross_n(r.data(), a.data(), b.data(), n);
+            scalar.cross_n(e.data(), a.data(), b.data(), n);
+            ASSERT_EQ(sameBits(r.data(), e.data(), r.size() * sizeof(float)), true);
+
+            k->length_n(r.data(), a.data(), n);
+            scalar.length_n(e.data(), a.data(), n);
+            ASSERT_EQ(sameBits(r.data(), e.data(), n * sizeof(float)), true);
+
+            k->normalize_n(r.data(), a.data(), n);
+            scalar.normalize_n(e.data(), a.data(), n);
+            ASSERT_EQ(sameBits(r.data(), e.data(), r.size() * sizeof(float)), true);
+
+            k->add_n(r.data(), a.data(), b.data(), n);
+            scalar.add_n(e.data(), a.data(), b.data(), n);
+            ASSERT_EQ(sameBits(r.data(), e.data(), r.size() * sizeof(float)), true);
+
+            k->sub_n(r.data(), a.data(), b.data(), n);
+            scalar.sub_n(e.data(), a.data(), b.data(), n);
+            ASSERT_EQ(sameBits(r.data(), e.data(), r.size() * sizeof(float)), true);
+
+            k->scale_n(r.data(), a.data(), 1.37f, n);
+            scalar.scale_n(e.data(), a.data(), 1.37f, n);
+            ASSERT_EQ(sameBits(r.data(), e.data(), r.size() * sizeof(float)), true);
+
+            // separate arrays
+            float const* const x = a.data();
+            float const* const y = a.data() + n;
+            float const* const z = b.data();
+            k->length_soa_n(r.data(), x, y, z, n);
+            scalar.length_soa_n(e.data(), x, y, z, n);
+            ASSERT_EQ(sameBits(r.data(), e.data(), n * sizeof(float)), true);
+
+            std::vector<float> rs(3 * n), es(3 * n);
+            k->normalize_soa_n(rs.data(), rs.data() + n, rs.data() + 2*n, x, y, z, n);
+            scalar.normalize_soa_n(es.data(), es.data() + n, es.data() + 2*n, x, y, z, n);
+            ASSERT_EQ(sameBits(rs.data(), es.data(), rs.size() * sizeof(float)), true);
+        }
+    }
+}
+
+BTEST(Deterministic, geometryKernels)
+{
+    vecmath::simd::kernels const& scalar = *vecmath::simd::find(vecmath::simd::isa::scalar);
+    float const ray[6] = {0.3f, -0.2f, -5.0f, 0.011f, -0.007f, 1.0f};
+    float const plane[4] = {0.3f, 0.4f, 0.866f, 0.71f};
+    float planes[24];
+    std::vector<float> const pv = makeValues(24, 7);
+    for (int i=0; i<24; ++i)
+        planes[i] = pv[i] * 0.001f;
+
+    for (vecmath::simd::kernels const* k : supportedKernels())
+    {
+        for (std::size_t n : kernel_sizes)
+        {
+            std::vector<float> const v = makeValues(9 * n, 4);
+            float const* const arrays[9] = {v.data(), v.data() + n, v.data() + 2*n,
+                                            v.data() + 3*n, v.data() + 4*n, v.data() + 5*n,
+                                            v.data() + 6*n, v.data() + 7*n, v.data() + 8*n};
+            std::vector<float> t(n), te(n);
+            std::vector<uint8_t> hit(n), he(n);
+
+            k->ray_triangles_n(t.data(), hit.data(), ray, arrays, 1.0e-6f, n);
+            scalar.ray_triangles_n(te.data(), he.data(), ray, arrays, 1.0e-6f, n);
+            ASSERT_EQ(sameBits(t.data(), te.data(), n * sizeof(float)), true);
+            ASSERT_EQ(hit == he, true);
+
+            k->rays_plane_n(t.data(), hit.data(), arrays, plane, 1.0e-6f, n);
+            scalar.rays_plane_n(te.data(), he.data(), arrays, plane, 1.0e-6f, n);
+            ASSERT_EQ(sameBits(t.data(), te.data(), n * sizeof(float)), true);
+            ASSERT_EQ(hit == he, true);
+
+            // boxes from the first six arrays, some of them empty
+            k->cull_boxes_n(hit.data(), planes, arrays, n);
+            scalar.cull_boxes_n(he.data(), planes, arrays, n);
+            ASSERT_EQ(hit == he, true);
+
+            // projection, asking for the fast reciprocal, which this mode ignores
+            vecmath::Matrix3f const m = testMatrix();
+            std::vector<float> p(4 * n), pe(4 * n);
+            k->project_n(p.data(), hit.data(), m.data(), v.data(), true, n);
+            scalar.project_n(pe.data(), he.data(), m.data(), v.data(), true, n);
+            ASSERT_EQ(sameBits(p.data(), pe.data(), p.size() * sizeof(float)), true);
+            ASSERT_EQ(hit == he, true);
+
+            float* const r[3] = {p.data(), p.data() + n, p.data() + 2*n};
+            float* const re[3] = {pe.data(), pe.data() + n, pe.data() + 2*n};
+            k->project_soa_n(r, hit.data(), m.data(), arrays, true, n);
+            scalar.project_soa_n(re, he.data(), m.data(), arrays, true, n);
+            ASSERT_EQ(sameBits(p.data(), pe.data(), 3 * n * sizeof(float)), true);
+            ASSERT_EQ(hit == he, true);
+        }
+    }
+}
+
+BTEST(Deterministic, lengths)
+{
+    // Just off unit length, where length() would skip the square root.
+    vecmath::Vector3f const v(0.6f, 0.8f, 0.0007f);
+    ASSERT_EQ(vecmath::fpequal(v.length_squared(), 1.0f), true);
+    ASSERT_EQ(v.length(), std::sqrt(v.length_squared()));
+    ASSERT_EQ(v.length() == 1.0f, false);
+
+    vecmath::Vector3f n = v;
+    n.normalize();
+    float const len = std::sqrt(v.length_squared());
+    ASSERT_EQ(n.X(), 0.6f / len);
+    ASSERT_EQ(n.Z(), 0.0007f / len);
+
+    vecmath::Vector3d const d(0.6, 0.8, 1.0e-7);
+    ASSERT_EQ(d.length(), std::sqrt(d.length_squared()));
+
+    // the portable estimate: 1/sqrt(4) from the bits of 4.0f
+    uint32_t const bits = 0x5f3759dfu - (0x40800000u >> 1);
+    float expect;
+    std::memcpy(&expect, &bits, sizeof(expect));
+    ASSERT_EQ(vecmath::precision::approx::rsqrt(4.0f), expect);
+}
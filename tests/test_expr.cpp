@@ -0,0 +1,141 @@
+/**
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/**
+ * Unit tests for lazily evaluated expressions
+ */
+#include "vecmath.h"
+#include "vecexpr.h"
+
+#include "test_common.h"
+
+using vecmath::lazy;
+
+BTEST(Expr, vectorArithmetic)
+{
+    vecmath::Vector3f const a {1.0f, 2.0f, 3.0f};
+    vecmath::Vector3f const b {-4.0f, 0.5f, 2.0f};
+    vecmath::Vector3f const c {0.25f, -1.0f, 7.0f};
+
+    vecmath::Vector3f const eager = a + b - c;
+    vecmath::Vector3f const fused = lazy(a) + lazy(b) - lazy(c);
+
+    ASSERT_FPEQ(fused.X(), eager.X(), EPS);
+    ASSERT_FPEQ(fused.Y(), eager.Y(), EPS);
+    ASSERT_FPEQ(fused.Z(), eager.Z(), EPS);
+    ASSERT_FPEQ(fused.W(), 1.0f, EPS);
+}
+
+BTEST(Expr, vectorScalars)
+{
+    vecmath::Vector3f const a {1.0f, 2.0f, 3.0f};
+    vecmath::Vector3f const b {-4.0f, 0.5f, 2.0f};
+
+    vecmath::Vector3f const v = 2.0f * lazy(a) - lazy(b) * 0.5f + (-lazy(a)) / 4.0f;
+    ASSERT_FPEQ(v.X(), 2.0f + 2.0f - 0.25f, EPS);
+    ASSERT_FPEQ(v.Y(), 4.0f - 0.25f - 0.5f, EPS);
+    ASSERT_FPEQ(v.Z(), 6.0f - 1.0f - 0.75f, EPS);
+
+    vecmath::Vector3f const m = vecmath::evaluate(midpoint(lazy(a), lazy(b)));
+    vecmath::Vector3f const e = vecmath::midpoint(a, b);
+    ASSERT_FPEQ(m.X(), e.X(), EPS);
+    ASSERT_FPEQ(m.Y(), e.Y(), EPS);
+    ASSERT_FPEQ(m.Z(), e.Z(), EPS);
+}
+
+BTEST(Expr, arrays)
+{
+    vecmath::Vector3Arrayd a, b;
+    for (int i=0; i<53; ++i)
+    {
+        a.push_back({double(i), double(-i), 0.5 * i});
+        b.push_back({1.0, double(i % 5), double(i * i)});
+    }
+    vecmath::Vector3d const offset {10.0, 20.0, 30.0};
+
+    vecmath::Vector3Arrayd out;
+    vecmath::evaluate(lazy(a) * 3.0 + lazy(b) - lazy(offset), out);
+    ASSERT_EQ(out.size(), a.size());
+
+    for (std::size_t i=0; i<a.size(); ++i)
+    {
+        vecmath::Vector3d const e = (a.get(i) + a.get(i) + a.get(i)) + b.get(i) - offset;
+        ASSERT_FPEQ(out.get(i).X(), e.X(), 1.0e-9);
+        ASSERT_FPEQ(out.get(i).Y(), e.Y(), 1.0e-9);
+        ASSERT_FPEQ(out.get(i).Z(), e.Z(), 1.0e-9);
+    }
+}
+
+BTEST(Expr, arraysInPlace)
+{
+    vecmath::Vector3Arrayf a, b;
+    for (int i=0; i<19; ++i)
+    {
+        a.push_back({float(i), 1.0f, -float(i)});
+        b.push_back({2.0f, float(i), 3.0f});
+    }
+
+    // out may be one of the operands
+    vecmath::evaluate(midpoint(lazy(a), lazy(b)), a);
+    ASSERT_EQ(a.size(), 19u);
+
+    for (std::size_t i=0; i<a.size(); ++i)
+    {
+        ASSERT_FPEQ(a.get(i).X(), (float(i) + 2.0f) / 2, EPS);
+        ASSERT_FPEQ(a.get(i).Y(), (1.0f + float(i)) / 2, EPS);
+        ASSERT_FPEQ(a.get(i).Z(), (3.0f - float(i)) / 2, EPS);
+    }
+}
+
+BTEST(Expr, sizesDiffer)
+{
+    vecmath::Vector3Arrayf a, b, empty;
+    for (int i=0; i<19; ++i)
+        a.push_back({float(i), 1.0f, -float(i)});
+    for (int i=0; i<7; ++i)
+        b.push_back({2.0f, float(i), 3.0f});
+    vecmath::Vector3f const v {1.0f, 2.0f, 3.0f};
+
+    // vectors apply to every element, even of an empty array
+    vecmath::Vector3Arrayf out;
+    vecmath::evaluate(lazy(empty) + lazy(v), out);
+    ASSERT_EQ(out.size(), 0u);
+    vecmath::evaluate(lazy(v) * 2.0f + lazy(v), out);
+    ASSERT_EQ(out.size(), 0u);
+
+    try {
+        vecmath::evaluate(lazy(a) + lazy(b), out);
+        FAIL() << "evaluate() should have failed for arrays of different sizes\n";
+    }
+    catch (vecmath::index_error&) {
+        // PASS, intended failure
+    }
+    try {
+        vecmath::evaluate(lazy(v) + lazy(a) - lazy(empty), b);
+        FAIL() << "evaluate() should have failed for an empty array operand\n";
+    }
+    catch (vecmath::index_error&) {
+        // PASS, intended failure
+    }
+    ASSERT_EQ(b.size(), 7u);
+
+    // an array expression is not a vector
+    try {
+        vecmath::Vector3f const w = lazy(a) * 2.0f;
+        FAIL() << "converting an array expression should have failed, giving " << w << "\n";
+    }
+    catch (vecmath::index_error&) {
+        // PASS, intended failure
+    }
+    try {
+        vecmath::Vector3f const w = vecmath::evaluate(lazy(v) + lazy(empty));
+        FAIL() << "evaluating an empty array as a vector should have failed, giving " << w << "\n";
+    }
+    catch (vecmath::index_error&) {
+        // PASS, intended failure
+    }
+}
@@ -0,0 +1,386 @@
+/**
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/**
+ * Unit tests for the binary file format
+ */
+#include "vecmath.h"
+#include "vecfile.h"
+
+#include "test_common.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+vecmath::Vector3Array<float> makePoints(std::size_t n)
+{
+    vecmath::Vector3Array<float> pts;
+    for (std::size_t i=0; i<n; ++i)
+    {
+        float const t = float(i);
+        pts.push_back(vecmath::Vector3f(t * 0.5f, 1.0f - t, t * 0.25f + 2.0f));
+    }
+    return pts;
+}
+
+bool samePoints(vecmath::Vector3Array<float> const& a, vecmath::Vector3Array<float> const& b,
+                float eps)
+{
+    if (a.size() != b.size())
+        return false;
+    for (std::size_t i=0; i<a.size(); ++i)
+    {
+        if (std::abs(a.X()[i] - b.X()[i]) > eps ||
+            std::abs(a.Y()[i] - b.Y()[i]) > eps ||
+            std::abs(a.Z()[i] - b.Z()[i]) > eps)
+            return false;
+    }
+    return true;
+}
+
+vecmath::Vector3Array<float> readSoA(vecmath::mapped_file const& f)
+{
+    vecmath::Vector3Array<float> pts(f.size());
+    vecmath::span<float const> const x = f.component<float>(0);
+    vecmath::span<float const> const y = f.component<float>(1);
+    vecmath::span<float const> const z = f.component<float>(2);
+    for (std::size_t i=0; i<f.size(); ++i)
+        pts.set(i, vecmath::Vector3f(x[i], y[i], z[i]));
+    return pts;
+}
+
+// Read the whole of a file.
+std::vector<char> readBytes(std::string const& path)
+{
+    std::vector<char> bytes;
+    std::FILE* fp = std::fopen(path.c_str(), "rb");
+    char buf[4096];
+    std::size_t n;
+    while ((n = std::fread(buf, 1, sizeof(buf), fp)) != 0)
+        bytes.insert(bytes.end(), buf, buf + n);
+    std::fclose(fp);
+    return bytes;
+}
+
+void writeBytes(std::string const& path, std::vector<char> const& bytes)
+{
+    std::FILE* fp = std::fopen(path.c_str(), "wb");
+    std::fwrite(bytes.data(), 1, bytes.size(), fp);
+    std::fclose(fp);
+}
+
+/*
+ * Rewrite the file at \c path with header \c h, moving its data
+ * from \c old_offset to h.data_offset, or just past the header.
+ */
+void rewriteFile(std::string const& path, vecmath::file_header const& h, uint64_t old_offset)
+{
+    std::vector<char> const bytes = readBytes(path);
+    std::vector<char> out(reinterpret_cast<char const*>(&h), reinterpret_cast<char const*>(&h + 1));
+    if (h.data_offset > out.size() && h.data_offset < bytes.size())
+        out.resize(h.data_offset, 0);
+    out.insert(out.end(), bytes.begin() + old_offset, bytes.end());
+    writeBytes(path, out);
+}
+
+vecmath::file_header readHeader(std::string const& path)
+{
+    vecmath::file_header h;
+    std::memcpy(&h, readBytes(path).data(), sizeof(h));
+    return h;
+}
+
+}
+
+
+BTEST(File, records)
+{
+    std::string const path = "test_file_records.vmf";
+
+    std::vector<vecmath::Vector3f> pts;
+    for (int i=0; i<37; ++i)
+        pts.push_back(vecmath::Vector3f(float(i), float(-i), 0.5f * i));
+    vecmath::write_file(path, pts);
+    {
+        vecmath::mapped_file const f(path);
+        ASSERT_EQ(f.size(), pts.size());
+        ASSERT_EQ(f.header().data_offset % 64, 0u);
+        vecmath::span<vecmath::Vector3f const> const v = f.records<vecmath::Vector3f>();
+        ASSERT_EQ(v.size(), pts.size());
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(v.data()) % alignof(vecmath::Vector3f), 0u);
+        ASSERT_EQ(v[36].Z(), pts[36].Z());
+        ASSERT_EQ(v[36].W(), 1.0f);
+
+        try {
+            (void) f.records<vecmath::Vector3d>();
+            FAIL() << "records<Vector3d>() should have failed for a float file\n";
+        }
+        catch (vecmath::file_error&) {
+            // PASS, intended failure
+        }
+    }
+
+    std::vector<vecmath::Matrix3f> mats;
+    mats.push_back(vecmath::Matrix3f::translation(1.0f, 2.0f, 3.0f));
+    mats.push_back(vecmath::Matrix3f::rotateZ(0.5f));
+    vecmath::write_file(path, mats);
+    {
+        vecmath::mapped_file const f(path);
+        vecmath::span<vecmath::Matrix3f const> const m = f.records<vecmath::Matrix3f>();
+        ASSERT_EQ(m.size(), 2u);
+        ASSERT_EQ(m[0](1, 3), 2.0f);
+        ASSERT_EQ(m[1](0, 0), mats[1](0, 0));
+    }
+
+    std::vector<vecmath::Vector3h> halves;
+    halves.push_back(vecmath::Vector3h(vecmath::Vector3f(1.5f, -2.0f, 0.25f)));
+    vecmath::write_file(path, halves);
+    {
+        vecmath::mapped_file const f(path);
+        vecmath::span<vecmath::Vector3h const> const h = f.records<vecmath::Vector3h>();
+        ASSERT_EQ(h[0].Y(), -2.0f);
+    }
+    std::remove(path.c_str());
+}
+
+BTEST(File, components)
+{
+    std::string const path = "test_file_components.vmf";
+    vecmath::Vector3Array<float> const pts = makePoints(101);
+
+    vecmath::write_file(path, pts);
+    {
+        vecmath::mapped_file const f(path);
+        ASSERT_EQ(f.header().layout == vecmath::file_layout::soa, true);
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(f.component<float>(1).data()) % 64, 0u);
+        ASSERT_EQ(samePoints(readSoA(f), pts, 0.0f), true);
+    }
+
+    vecmath::write_file(path, pts, vecmath::file_scalar::f16);
+    {
+        vecmath::mapped_file const f(path);
+        vecmath::span<uint16_t const> const x = f.component<uint16_t>(0);
+        ASSERT_EQ(vecmath::detail::half_to_float(x[3]), 1.5f);
+    }
+    std::remove(path.c_str());
+}
+
+BTEST(File, badFiles)
+{
+    std::string const path = "test_file_bad.vmf";
+
+    std::FILE* fp = std::fopen(path.c_str(), "wb");
+    std::fputs("not a vecmath file, but long enough to hold a header...........", fp);
+    std::fclose(fp);
+    try {
+        vecmath::mapped_file const f(path);
+        FAIL() << "mapped_file should have rejected a text file\n";
+    }
+    catch (vecmath::file_error&) {
+        // PASS, intended failure
+    }
+
+    // a header promising more data than the file holds
+    std::vector<vecmath::Vector3f> pts(10);
+    vecmath::write_file(path, pts);
+    fp = std::fopen(path.c_str(), "r+b");
+    vecmath::file_header h;
+    ASSERT_EQ(std::fread(&h, sizeof(h), 1, fp), 1u);
+    h.count = 11;
+    std::fseek(fp, 0, SEEK_SET);
+    std::fwrite(&h, sizeof(h), 1, fp);
+    std::fclose(fp);
+    try {
+        vecmath::mapped_file const f(path);
+        FAIL() << "mapped_file should have rejected a truncated file\n";
+    }
+    catch (vecmath::file_error&) {
+        // PASS, intended failure
+    }
+
+    std::remove(path.c_str());
+    try {
+        vecmath::mapped_file const f(path);
+        FAIL() << "mapped_file should have failed for a missing file\n";
+    }
+    catch (vecmath::file_error&) {
+        // PASS, intended failure
+    }
+}
+
+BTEST(File, corruptHeaders)
+{
+    std::string const path = "test_file_corrupt.vmf";
+    std::string const out = "test_file_corrupt_out.vmf";
+    vecmath::Matrix3f const m = vecmath::Matrix3f::translation(1.0f, -2.0f, 3.0f);
+    std::vector<vecmath::Vector3f> pts(64);
+    for (std::size_t i=0; i<pts.size(); ++i)
+        pts[i] = vecmath::Vector3f(float(i), 1.0f, -float(i));
+
+    // counts and strides whose byte counts overflow
+    vecmath::write_file(path, pts);
+    vecmath::file_header h = readHeader(path);
+    h.count = uint64_t(1) << 60;
+    rewriteFile(path, h, h.data_offset);
+    try {
+        vecmath::mapped_file const f(path);
+        FAIL() << "mapped_file should have rejected a count of 2^60\n";
+    }
+    catch (vecmath::file_error&) {
+        // PASS, intended failure
+    }
+    try {
+        vecmath::transform_file(path, out, m);
+        FAIL() << "transform_file() should have rejected a count of 2^60\n";
+    }
+    catch (vecmath::file_error&) {
+        // PASS, intended failure
+    }
+
+    vecmath::write_file(path, makePoints(64));
+    h = readHeader(path);
+    h.component_stride = (uint64_t(1) << 62) + 64;
+    rewriteFile(path, h, h.data_offset);
+    try {
+        vecmath::mapped_file const f(path);
+        FAIL() << "mapped_file should have rejected a stride of 2^62\n";
+    }
+    catch (vecmath::file_error&) {
+        // PASS, intended failure
+    }
+
+    // a stride that would misalign the Y and Z arrays
+    vecmath::write_file(path, makePoints(64));
+    h = readHeader(path);
+    h.component_stride = 401;
+    rewriteFile(path, h, h.data_offset);
+    try {
+        vecmath::mapped_file const f(path);
+        FAIL() << "mapped_file should have rejected a stride of 401\n";
+    }
+    catch (vecmath::file_error&) {
+        // PASS, intended failure
+    }
+    try {
+        vecmath::transform_file(path, out, m);
+        FAIL() << "transform_file() should have rejected a stride of 401\n";
+    }
+    catch (vecmath::file_error&) {
+        // PASS, intended failure
+    }
+
+    // data over the header
+    vecmath::write_file(path, pts);
+    h = readHeader(path);
+    h.data_offset = 0;
+    rewriteFile(path, h, 64);
+    try {
+        vecmath::mapped_file const f(path);
+        FAIL() << "mapped_file should have rejected a data offset of 0\n";
+    }
+    catch (vecmath::file_error&) {
+        // PASS, intended failure
+    }
+    try {
+        vecmath::transform_file(path, out, m);
+        FAIL() << "transform_file() should have rejected a data offset of 0\n";
+    }
+    catch (vecmath::file_error&) {
+        // PASS, intended failure
+    }
+
+    // a valid file with its data further out, padded with zeros
+    vecmath::write_file(path, pts);
+    h = readHeader(path);
+    h.data_offset = 192;
+    rewriteFile(path, h, 64);
+    vecmath::transform_file(path, out, m, 10);
+    {
+        vecmath::mapped_file const f(out);
+        vecmath::span<vecmath::Vector3f const> const v = f.records<vecmath::Vector3f>();
+        ASSERT_EQ(v.size(), pts.size());
+        for (std::size_t i=0; i<v.size(); ++i)
+        {
+            ASSERT_EQ(v[i].X(), pts[i].X() + 1.0f);
+            ASSERT_EQ(v[i].Z(), pts[i].Z() + 3.0f);
+        }
+    }
+    std::vector<char> const bytes = readBytes(out);
+    ASSERT_EQ(bytes.size(), 192 + pts.size() * sizeof(vecmath::Vector3f));
+    for (std::size_t i=sizeof(h); i<192; ++i)
+        ASSERT_EQ(bytes[i], 0);
+
+    std::remove(path.c_str());
+    std::remove(out.c_str());
+}
+
+BTEST(File, transformFile)
+{
+    std::string const in = "test_file_in.vmf";
+    std::string const out = "test_file_out.vmf";
+    vecmath::Matrix3f const m = vecmath::Matrix3f::translation(1.0f, -2.0f, 3.0f) *
+                                vecmath::Matrix3f::rotateY(0.3f);
+
+    vecmath::Vector3Array<float> const pts = makePoints(1000);
+    vecmath::Vector3Array<float> expect;
+    vecmath::transform(m, pts, expect);
+
+    // SoA, with a chunk that doesn't divide the count
+    vecmath::write_file(in, pts);
+    vecmath::transform_file(in, out, m, 64);
+    {
+        vecmath::mapped_file const f(out);
+        ASSERT_EQ(f.size(), pts.size());
+        ASSERT_EQ(samePoints(readSoA(f), expect, 0.0f), true);
+    }
+
+    // half precision is computed in float and rounded back
+    vecmath::write_file(in, pts, vecmath::file_scalar::f16);
+    vecmath::transform_file(in, out, m, 64);
+    {
+        vecmath::mapped_file const f(out);
+        vecmath::span<uint16_t const> const y = f.component<uint16_t>(1);
+        for (std::size_t i=0; i<y.size(); ++i)
+            ASSERT_FPEQ(vecmath::detail::half_to_float(y[i]), expect.Y()[i], 1.0f);
+    }
+
+    // AoS
+    std::vector<vecmath::Vector3f> aos;
+    for (std::size_t i=0; i<pts.size(); ++i)
+        aos.push_back(pts.get(i));
+    vecmath::write_file(in, aos);
+    vecmath::transform_file(in, out, m, 100);
+    {
+        vecmath::mapped_file const f(out);
+        vecmath::span<vecmath::Vector3f const> const v = f.records<vecmath::Vector3f>();
+        ASSERT_EQ(v.size(), pts.size());
+        for (std::size_t i=0; i<v.size(); ++i)
+        {
+            ASSERT_FPEQ(v[i].X(), expect.X()[i], 1.0e-4f);
+            ASSERT_FPEQ(v[i].Z(), expect.Z()[i], 1.0e-4f);
+            ASSERT_EQ(v[i].W(), 1.0f);
+        }
+    }
+
+    // matrices are not points
+    std::vector<vecmath::Matrix3f> mats(3);
+    vecmath::write_file(in, mats);
+    try {
+        vecmath::transform_file(in, out, m);
+        FAIL() << "transform_file() should have rejected a matrices file\n";
+    }
+    catch (vecmath::file_error&) {
+        // PASS, intended failure
+    }
+
+    std::remove(in.c_str());
+    std::remove(out.c_str());
+}
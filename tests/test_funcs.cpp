@@ -74,3 +74,59 @@ BTEST(Add, vector_vector)
     v = v + yunit;
     ASSERT_FPEQ(v.Y(), 1.0f, EPS);
 }
+
+BTEST(Length, squared)
+{
+    vecmath::Vector3f v {1.0f, 2.0f, 2.0f};
+    ASSERT_FPEQ(v.length_squared(), 9.0f, EPS);
+    ASSERT_FPEQ(xunit.length_squared(), 1.0f, EPS);
+}
+
+BTEST(Length, fast)
+{
+    vecmath::Vector3f v {3.0f, 4.0f, 0.0f};
+
+    ASSERT_FPEQ(v.fast_length<vecmath::precision::exact>(), 5.0f, EPS);
+    ASSERT_FPEQ(v.fast_length<vecmath::precision::refined>(), 5.0f, 5.0e-5f);
+    ASSERT_FPEQ(v.fast_length<vecmath::precision::approx>(), 5.0f, 5.0e-3f);
+    ASSERT_FPEQ(v.fast_length(), 5.0f, 5.0e-5f);
+
+    vecmath::Vector3f zero;
+    ASSERT_EQ(zero.fast_length<vecmath::precision::exact>(), 0.0f);
+    ASSERT_EQ(zero.fast_length<vecmath::precision::refined>(), 0.0f);
+    ASSERT_EQ(zero.fast_length<vecmath::precision::approx>(), 0.0f);
+}
+
+BTEST(Length, fast_norm)
+{
+    vecmath::Vector3f e {3.0f, 3.0f, 0.0f};
+    vecmath::Vector3f r = e;
+    vecmath::Vector3f a = e;
+
+    ASSERT_FPEQ(e.fast_normalize<vecmath::precision::exact>().length(), 1.0f, EPS);
+    ASSERT_FPEQ(r.fast_normalize().length(), 1.0f, 1.0e-5f);
+    ASSERT_FPEQ(a.fast_normalize<vecmath::precision::approx>().length(), 1.0f, 1.0e-3f);
+
+    ASSERT_FPEQ(r.X(), std::sqrt(0.5f), 1.0e-5f);
+    ASSERT_FPEQ(r.Y(), std::sqrt(0.5f), 1.0e-5f);
+    ASSERT_FPEQ(r.W(), 1.0f, EPS);
+}
+
+BTEST(Length, fast_norm_zero)
+{
+    // The zero vector must stay zero, not become NaN.
+    vecmath::Vector3f f;
+    f.fast_normalize<vecmath::precision::exact>();
+    ASSERT_EQ(f.X(), 0.0f);
+    f.fast_normalize<vecmath::precision::approx>();
+    ASSERT_EQ(f.Y(), 0.0f);
+
+    vecmath::Vector3d d;
+    d.fast_normalize();
+    ASSERT_EQ(d.X(), 0.0);
+    ASSERT_EQ(d.W(), 1.0);
+    ASSERT_EQ(d.fast_length<vecmath::precision::approx>(), 0.0);
+
+    vecmath::Vector3d big {3.0e15, 4.0e15, 0.0};
+    ASSERT_FPEQ(big.fast_normalize().length(), 1.0, 1.0e-5);
+}
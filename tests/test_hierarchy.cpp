@@ -0,0 +1,169 @@
+/**
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/**
+ * Unit tests for transform hierarchies.
+ *
+ * The flat passes are checked against composing each node's parent
+ * chain recursively with operator*.
+ */
+#include "vecmath.h"
+#include "vechierarchy.h"
+#include "vecparallel.h"
+
+#include "test_common.h"
+
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// A deterministic hierarchy of n nodes: a few roots, some long
+// chains and some wide fans, with parents before children.
+std::vector<int32_t> makeParents(std::size_t n)
+{
+    std::vector<int32_t> parents(n);
+    for (std::size_t i=0; i<n; ++i)
+    {
+        if (i % 97 == 0)
+            parents[i] = -1;
+        else if (i % 3 == 0)
+            parents[i] = int32_t(i - 1);
+        else
+            parents[i] = int32_t((i * 7919 % 10007) % i);
+    }
+    return parents;
+}
+
+template <typename fptype>
+std::vector<vecmath::Matrix3<fptype> > makeLocals(std::size_t n)
+{
+    typedef vecmath::Matrix3<fptype> M;
+    std::vector<M> locals(n);
+    for (std::size_t i=0; i<n; ++i)
+    {
+        fptype const t = fptype(i % 13) * fptype(0.1);
+        locals[i] = M::translation(t, fptype(1) - t, fptype(0.5)) * M::rotateZ(t) * M::rotateX(-t);
+    }
+    return locals;
+}
+
+template <typename fptype>
+vecmath::Matrix3<fptype> worldOf(std::vector<int32_t> const& parents,
+                                 std::vector<vecmath::Matrix3<fptype> > const& locals,
+                                 std::size_t i)
+{
+    if (parents[i] < 0)
+        return locals[i];
+    return worldOf(parents, locals, parents[i]) * locals[i];
+}
+
+// Equal to within rounding: the AVX2 and AVX-512 kernels use FMA.
+template <typename fptype>
+bool near(vecmath::Matrix3<fptype> const& a, vecmath::Matrix3<fptype> const& b, fptype eps)
+{
+    for (int r=0; r<4; ++r)
+        for (int c=0; c<4; ++c)
+            if (std::abs(a(r, c) - b(r, c)) > eps * (1 + std::abs(b(r, c))))
+                return false;
+    return true;
+}
+
+} // anonymous
+
+BTEST(Hierarchy, kernelsMatchRecursive)
+{
+    std::vector<int32_t> const parents = makeParents(300);
+    std::vector<vecmath::Matrix3f> const locals = makeLocals<float>(parents.size());
+
+    for (vecmath::simd::kernels const* k : supportedKernels())
+    {
+        std::vector<vecmath::Matrix3f> world(parents.size() + 1);
+        k->compose_n(world[0].data(), locals[0].data(), parents.data(), nullptr, parents.size());
+        for (std::size_t i=0; i<parents.size(); ++i)
+            ASSERT_EQ(near(world[i], worldOf(parents, locals, i), 1.0e-5f), true);
+        ASSERT_EQ(world.back()(0, 1), 0.0f);             // one past the end stays untouched
+
+        // a node list, in place
+        std::vector<int32_t> const node = {0, 1, 7, 10, 2, 11};
+        std::vector<vecmath::Matrix3f> inplace = locals;
+        k->compose_n(inplace[0].data(), inplace[0].data(), parents.data(), node.data(), node.size());
+        ASSERT_EQ(near(inplace[10], worldOf(parents, locals, 10), 1.0e-5f), true);
+        ASSERT_EQ(near(inplace[11], worldOf(parents, locals, 11), 1.0e-5f), true);
+        ASSERT_EQ(std::memcmp(&inplace[3], &locals[3], sizeof(locals[3])), 0);
+    }
+}
+
+BTEST(Hierarchy, composeHierarchy)
+{
+    std::vector<int32_t> const parents = makeParents(200);
+    std::vector<vecmath::Matrix3d> const locals = makeLocals<double>(parents.size());
+    std::vector<vecmath::Matrix3d> world(parents.size());
+
+    vecmath::compose_hierarchy(parents, locals, world);
+    for (std::size_t i=0; i<world.size(); ++i)
+        ASSERT_EQ(near(world[i], worldOf(parents, locals, i), 1.0e-12), true);
+
+    std::vector<vecmath::Matrix3d> inplace = locals;
+    vecmath::compose_hierarchy(parents, inplace, inplace);
+    ASSERT_EQ(std::memcmp(inplace.data(), world.data(), world.size() * sizeof(world[0])), 0);
+
+    std::vector<int32_t> bad = parents;
+    bad[50] = 50;
+    try {
+        vecmath::compose_hierarchy(bad, locals, world);
+        FAIL() << "compose_hierarchy() should have rejected a parent after its child\n";
+    }
+    catch (vecmath::index_error&) {
+        // PASS, intended failure
+    }
+
+    try {
+        vecmath::compose_hierarchy(parents, locals, vecmath::span<vecmath::Matrix3d>(world.data(), 3));
+        FAIL() << "compose_hierarchy() should have failed for a short output\n";
+    }
+    catch (vecmath::index_error&) {
+        // PASS, intended failure
+    }
+}
+
+BTEST(Hierarchy, parallel)
+{
+    std::vector<int32_t> const parents = makeParents(20000);
+    std::vector<vecmath::Matrix3f> const locals = makeLocals<float>(parents.size());
+    std::vector<vecmath::Matrix3f> serial(parents.size()), world(parents.size());
+    vecmath::compose_hierarchy(parents, locals, serial);
+
+    vecmath::parallel::thread_pool pool(3);
+    vecmath::parallel::compose_hierarchy(parents, locals, world, pool);
+    ASSERT_EQ(std::memcmp(world.data(), serial.data(), serial.size() * sizeof(serial[0])), 0);
+
+    // one long chain can't be split
+    std::vector<int32_t> chain(1000);
+    for (std::size_t i=0; i<chain.size(); ++i)
+        chain[i] = int32_t(i) - 1;
+    std::vector<vecmath::Matrix3f> const chainLocals = makeLocals<float>(chain.size());
+    world.resize(chain.size());
+    serial.resize(chain.size());
+    vecmath::compose_hierarchy(chain, chainLocals, serial);
+    vecmath::parallel::compose_hierarchy(chain, chainLocals, world, pool);
+    ASSERT_EQ(std::memcmp(world.data(), serial.data(), serial.size() * sizeof(serial[0])), 0);
+
+    // the split itself: every node below the top once, parents
+    // before children within a group
+    vecmath::parallel::detail::hierarchy_plan const plan =
+        vecmath::parallel::detail::plan_hierarchy(parents.data(), parents.size(), 3);
+    ASSERT_EQ(plan.group.size() > 2, true);
+    ASSERT_EQ(plan.top.size() + plan.nodes.size(), parents.size());
+    std::vector<int> group(parents.size(), -1);
+    for (std::size_t g=0; g+1<plan.group.size(); ++g)
+        for (std::size_t k=plan.group[g]; k<plan.group[g+1]; ++k)
+            group[plan.nodes[k]] = int(g);
+    for (std::size_t i=0; i<parents.size(); ++i)
+        if (group[i] >= 0 && parents[i] >= 0 && group[parents[i]] >= 0)
+            ASSERT_EQ(group[parents[i]], group[i]);
+}
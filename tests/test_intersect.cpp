@@ -0,0 +1,238 @@
+/**
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/**
+ * Unit tests for ray intersection.
+ *
+ * Known hits and misses for the one-ray forms, and the intersection
+ * kernels of every supported instruction set against the scalar
+ * ones, at sizes that leave every tail length.
+ */
+#include "vecmath.h"
+#include "vecintersect.h"
+
+#include "test_common.h"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using vecmath::Vector3f;
+using vecmath::Vector3d;
+
+namespace {
+
+float const inf = std::numeric_limits<float>::infinity();
+
+// Deterministic triangles around the z axis, about half of them hit
+// by a ray down it, and some degenerate or edge-on.
+vecmath::TriangleArrayf makeTriangles(std::size_t n)
+{
+    vecmath::TriangleArrayf tris;
+    for (std::size_t i=0; i<n; ++i)
+    {
+        float const s = float(i) * 0.7f;
+        Vector3f const a(std::sin(s) - 0.5f, std::cos(s * 2) - 0.5f, float(i % 5) - 2.0f);
+        Vector3f const b(a.X() + 1.5f, a.Y() + std::sin(s * 3), a.Z() + 0.25f);
+        Vector3f c(a.X() + std::cos(s), a.Y() + 1.25f, a.Z() - 0.5f);
+        if (i % 11 == 3)
+            c = b;                                  // degenerate
+        if (i % 13 == 5)
+            c = Vector3f(a.X() + 1, a.Y(), a.Z());  // in the ray's plane
+        tris.push_back(a, b, c);
+    }
+    return tris;
+}
+
+vecmath::RayArrayf makeRays(std::size_t n)
+{
+    vecmath::RayArrayf rays;
+    for (std::size_t i=0; i<n; ++i)
+    {
+        float const s = float(i) * 1.3f;
+        Vector3f const o(std::sin(s) * 4, std::cos(s) * 4, std::sin(s * 2) * 3);
+        Vector3f d(std::cos(s * 3), std::sin(s * 5), std::cos(s * 7));
+        if (i % 7 == 2)
+            d = Vector3f(d.X(), d.Y(), 0);          // parallel to the plane
+        rays.push_back(vecmath::Rayf(o, d));
+    }
+    return rays;
+}
+
+// Equal to within rounding: the AVX2 and AVX-512 kernels use FMA.
+bool near(float a, float b)
+{
+    if (a == b)
+        return true;
+    return std::abs(a - b) <= 1.0e-4f * (1 + std::abs(b));
+}
+
+} // anonymous
+
+BTEST(Intersect, triangle)
+{
+    vecmath::Rayd const ray(Vector3d(0.25, 0.25, -5), Vector3d(0, 0, 2));
+    Vector3d const a(-1, -1, 0), b(1, -1, 0), c(0, 1, 0);
+    double t = 0;
+
+    ASSERT_EQ(vecmath::intersect(ray, a, b, c, t), true);
+    ASSERT_EQ(vecmath::fpequal(t, 2.5), true);
+    ASSERT_EQ(vecmath::fpequal(ray.at(t).Z(), 0.0), true);
+
+    // either winding
+    ASSERT_EQ(vecmath::intersect(ray, a, c, b, t), true);
+    ASSERT_EQ(vecmath::fpequal(t, 2.5), true);
+
+    // a vertex and an edge count
+    ASSERT_EQ(vecmath::intersect(vecmath::Rayd(Vector3d(1, -1, 3), Vector3d(0, 0, -1)), a, b, c, t), true);
+    ASSERT_EQ(vecmath::fpequal(t, 3.0), true);
+    ASSERT_EQ(vecmath::intersect(vecmath::Rayd(Vector3d(0, -1, 3), Vector3d(0, 0, -1)), a, b, c, t), true);
+
+    // outside, behind, parallel and degenerate
+    ASSERT_EQ(vecmath::intersect(vecmath::Rayd(Vector3d(2, 2, -5), Vector3d(0, 0, 1)), a, b, c, t), false);
+    ASSERT_EQ(t, std::numeric_limits<double>::infinity());
+    ASSERT_EQ(vecmath::intersect(vecmath::Rayd(Vector3d(0, 0, 5), Vector3d(0, 0, 1)), a, b, c, t), false);
+    ASSERT_EQ(vecmath::intersect(vecmath::Rayd(Vector3d(0, 0, 0), Vector3d(1, 0, 0)), a, b, c, t), false);
+    ASSERT_EQ(vecmath::intersect(ray, a, b, b, t), false);
+
+    // float
+    float tf = 0;
+    ASSERT_EQ(vecmath::intersect(vecmath::Rayf(Vector3f(0.25f, 0.25f, -5), Vector3f(0, 0, 2)),
+                                 Vector3f(-1, -1, 0), Vector3f(1, -1, 0), Vector3f(0, 1, 0), tf), true);
+    ASSERT_EQ(vecmath::fpequal(tf, 2.5f), true);
+}
+
+BTEST(Intersect, plane)
+{
+    vecmath::Planed const p = vecmath::Planed::through(Vector3d(0, 0, 2), Vector3d(0, 0, 1));
+    double t = 0;
+
+    ASSERT_EQ(p.offset, 2.0);
+    ASSERT_EQ(vecmath::intersect(vecmath::Rayd(Vector3d(1, 2, -2), Vector3d(0, 0, 1)), p, t), true);
+    ASSERT_EQ(vecmath::fpequal(t, 4.0), true);
+
+    // from the back side
+    ASSERT_EQ(vecmath::intersect(vecmath::Rayd(Vector3d(1, 2, 6), Vector3d(0, 0, -2)), p, t), true);
+    ASSERT_EQ(vecmath::fpequal(t, 2.0), true);
+
+    // on the plane counts, away from it and parallel don't
+    ASSERT_EQ(vecmath::intersect(vecmath::Rayd(Vector3d(0, 0, 2), Vector3d(0, 1, 1)), p, t), true);
+    ASSERT_EQ(t, 0.0);
+    ASSERT_EQ(vecmath::intersect(vecmath::Rayd(Vector3d(1, 2, -2), Vector3d(0, 0, -1)), p, t), false);
+    ASSERT_EQ(t, std::numeric_limits<double>::infinity());
+    ASSERT_EQ(vecmath::intersect(vecmath::Rayd(Vector3d(1, 2, -2), Vector3d(1, 0, 0)), p, t), false);
+
+    // the tolerance
+    vecmath::Rayd const grazing(Vector3d(0, 0, 1), Vector3d(1, 0, 1.0e-3));
+    ASSERT_EQ(vecmath::intersect(grazing, p, t), true);
+    ASSERT_EQ(vecmath::intersect(grazing, p, t, 1.0e-2), false);
+}
+
+BTEST(Intersect, kernelsMatchScalar)
+{
+    vecmath::simd::kernels const& scalar = *vecmath::simd::find(vecmath::simd::isa::scalar);
+    float const ray[6] = {0.1f, 0.2f, -6, 0.05f, -0.02f, 1};
+    float const plane[4] = {0.3f, -0.4f, 0.866f, 0.5f};
+
+    for (vecmath::simd::kernels const* k : supportedKernels())
+    {
+        for (std::size_t n : kernel_sizes)
+        {
+            vecmath::TriangleArrayf const tris = makeTriangles(n);
+            float const* const tri[9] = {tris.v0.X(), tris.v0.Y(), tris.v0.Z(),
+                                         tris.e1.X(), tris.e1.Y(), tris.e1.Z(),
+                                         tris.e2.X(), tris.e2.Y(), tris.e2.Z()};
+            std::vector<float> t(n + 1, -1.0f), te(n);   // one past the end stays untouched
+            std::vector<uint8_t> hit(n + 1, 7), he(n);
+
+            k->ray_triangles_n(t.data(), hit.data(), ray, tri, 1.0e-6f, n);
+            scalar.ray_triangles_n(te.data(), he.data(), ray, tri, 1.0e-6f, n);
+            for (std::size_t i=0; i<n; ++i)
+            {
+                ASSERT_EQ(int(hit[i]), int(he[i]));
+                ASSERT_EQ(near(t[i], te[i]), true);
+                ASSERT_EQ(hit[i] ? t[i] >= 0 : t[i] == inf, true);
+            }
+            ASSERT_EQ(t[n], -1.0f);
+            ASSERT_EQ(int(hit[n]), 7);
+
+            vecmath::RayArrayf const rays = makeRays(n);
+            float const* const r[6] = {rays.origins.X(), rays.origins.Y(), rays.origins.Z(),
+                                       rays.directions.X(), rays.directions.Y(), rays.directions.Z()};
+            k->rays_plane_n(t.data(), hit.data(), r, plane, 1.0e-6f, n);
+            scalar.rays_plane_n(te.data(), he.data(), r, plane, 1.0e-6f, n);
+            for (std::size_t i=0; i<n; ++i)
+            {
+                ASSERT_EQ(int(hit[i]), int(he[i]));
+                ASSERT_EQ(near(t[i], te[i]), true);
+            }
+            ASSERT_EQ(t[n], -1.0f);
+            ASSERT_EQ(int(hit[n]), 7);
+        }
+    }
+}
+
+BTEST(Intersect, batchMatchesSingle)
+{
+    std::size_t const n = 100;
+    vecmath::TriangleArrayf const tris = makeTriangles(n);
+    vecmath::Rayd const ray(Vector3d(0.1, 0.2, -6), Vector3d(0.05, -0.02, 1));
+    vecmath::TriangleArrayd trisd;
+    for (std::size_t i=0; i<n; ++i)
+    {
+        Vector3d const a(tris.v0.X()[i], tris.v0.Y()[i], tris.v0.Z()[i]);
+        trisd.push_back(a, a + Vector3d(tris.e1.X()[i], tris.e1.Y()[i], tris.e1.Z()[i]),
+                        a + Vector3d(tris.e2.X()[i], tris.e2.Y()[i], tris.e2.Z()[i]));
+    }
+
+    std::vector<double> t(n);
+    std::vector<uint8_t> hit(n);
+    std::size_t const hits = vecmath::intersect(ray, trisd, t, hit);
+    std::size_t count = 0;
+    for (std::size_t i=0; i<n; ++i)
+    {
+        Vector3d const a = trisd.v0.get(i);
+        double ti;
+        bool const h = vecmath::intersect(ray, a, a + trisd.e1.get(i), a + trisd.e2.get(i), ti);
+        ASSERT_EQ(h, hit[i] != 0);
+        if (h)
+            ASSERT_EQ(vecmath::fpequal(t[i], ti, 1.0e-12), true);
+        count += h;
+    }
+    ASSERT_EQ(hits, count);
+    ASSERT_EQ(hits > 0 && hits < n, true);
+
+    // float batches through the selected kernels
+    vecmath::RayArrayf const rays = makeRays(n);
+    vecmath::Planef const p = vecmath::Planef::through(Vector3f(0, 0, 1), Vector3f(0, 0, 1));
+    std::vector<float> tf(n);
+    std::size_t const phits = vecmath::intersect(rays, p, tf, hit);
+    count = 0;
+    for (std::size_t i=0; i<n; ++i)
+    {
+        float ti;
+        bool const h = vecmath::intersect(vecmath::Rayf(rays.origins.get(i), rays.directions.get(i)), p, ti);
+        ASSERT_EQ(h, hit[i] != 0);
+        ASSERT_EQ(near(tf[i], ti), true);
+        count += h;
+    }
+    ASSERT_EQ(phits, count);
+}
+
+BTEST(Intersect, sizesDiffer)
+{
+    vecmath::TriangleArrayf const tris = makeTriangles(5);
+    std::vector<float> t(4);
+    std::vector<uint8_t> hit(5);
+    try {
+        vecmath::intersect(vecmath::Rayf(Vector3f(), zunit), tris, t, hit);
+        FAIL() << "intersect() should have failed for a short output\n";
+    }
+    catch (vecmath::index_error&) {
+        // PASS, intended failure
+    }
+}
@@ -0,0 +1,118 @@
+/**
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/**
+ * Unit tests for Matrix3 inverses and the normal matrix
+ */
+#include "vecmath.h"
+
+#include "test_common.h"
+
+namespace {
+
+bool same(vecmath::Matrix3f const& a, vecmath::Matrix3f const& b, float eps = 1.0e-5f)
+{
+    for (uint32_t r=0; r<4; ++r)
+    {
+        for (uint32_t c=0; c<4; ++c)
+        {
+            if (!vecmath::fpequal(a.get(r,c), b.get(r,c), eps))
+                return false;
+        }
+    }
+    return true;
+}
+
+vecmath::Matrix3f rigid()
+{
+    using vecmath::Matrix3f;
+    return Matrix3f::translation(1.0f, -2.0f, 3.0f) * Matrix3f::rotateEuler(0.4f, -0.9f, 1.7f);
+}
+
+vecmath::Matrix3f affine()
+{
+    using vecmath::Matrix3f;
+    return rigid() * Matrix3f::scale(2.0f, 0.5f, -3.0f) * Matrix3f::rotateX(0.3f);
+}
+
+} // namespace
+
+BTEST(Inverse, general)
+{
+    vecmath::Matrix3f const id;
+    ASSERT_EQ(same(id.inverse(), id), true);
+
+    vecmath::Matrix3f const m = affine();
+    ASSERT_EQ(same(m * m.inverse(), id), true);
+    ASSERT_EQ(same(m.inverse() * m, id), true);
+}
+
+BTEST(Inverse, affine)
+{
+    vecmath::Matrix3f const m = affine();
+    vecmath::Matrix3f const inv = m.inverseAffine();
+    ASSERT_EQ(same(m * inv, vecmath::Matrix3f()), true);
+    ASSERT_EQ(same(inv, m.inverse()), true);
+
+    vecmath::Vector3f const v(0.3f, -4.0f, 2.5f);
+    vecmath::Vector3f const r = inv * (m * v);
+    ASSERT_FPEQ(r.X(), v.X(), 1.0e-5f);
+    ASSERT_FPEQ(r.Y(), v.Y(), 1.0e-5f);
+    ASSERT_FPEQ(r.Z(), v.Z(), 1.0e-5f);
+}
+
+BTEST(Inverse, rigid)
+{
+    vecmath::Matrix3f const m = rigid();
+    ASSERT_EQ(same(m.inverseRigid(), m.inverseAffine()), true);
+    ASSERT_EQ(same(m * m.inverseRigid(), vecmath::Matrix3f()), true);
+}
+
+BTEST(Inverse, normalMatrix)
+{
+    vecmath::Matrix3f const m = affine();
+    vecmath::Matrix3f const n = m.normalMatrix();
+
+    // normals stay perpendicular to transformed tangents
+    vecmath::Vector3f const tangent(1.0f, 1.0f, 0.0f);
+    vecmath::Vector3f const normal(1.0f, -1.0f, 2.0f);
+    vecmath::Vector3f const t = m * tangent - m * vecmath::Vector3f();
+    vecmath::Vector3f const nn = n * normal;
+    ASSERT_FPEQ(vecmath::dot(t, nn), 0.0f, 1.0e-5f);
+
+    // no translation; a rotation is its own normal matrix
+    ASSERT_FPEQ(n.get(0,3), 0.0f, EPS);
+    vecmath::Matrix3f const rot = vecmath::Matrix3f::rotateEuler(0.4f, -0.9f, 1.7f);
+    ASSERT_EQ(same(rot.normalMatrix(), rot), true);
+}
+
+BTEST(Inverse, singular)
+{
+    vecmath::Matrix3f const flat = vecmath::Matrix3f::scale(1.0f, 0.0f, 1.0f);
+    vecmath::Matrix3f out = vecmath::Matrix3f::translation(1.0f, 2.0f, 3.0f);
+    vecmath::Matrix3f const before = out;
+
+    ASSERT_EQ(flat.inverse(out), false);
+    ASSERT_EQ(flat.inverseAffine(out), false);
+    ASSERT_EQ(flat.normalMatrix(out), false);
+    ASSERT_EQ(same(out, before), true);            // left unchanged
+
+    try {
+        (void) flat.inverse();
+        FAIL() << "inverse() should have failed for a singular matrix\n";
+    }
+    catch (vecmath::degenerate_error&) {
+        // PASS, intended failure
+    }
+    try {
+        (void) flat.normalMatrix();
+        FAIL() << "normalMatrix() should have failed for a singular matrix\n";
+    }
+    catch (vecmath::degenerate_error&) {
+        // PASS, intended failure
+    }
+}
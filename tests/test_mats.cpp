@@ -272,3 +272,48 @@ BTEST(Matrix3Double, print)
     std::cout << "Matrix3d:\n" << m;
     // visual confirmation currently
 }
+
+BTEST(Matrix3Float, rotateEuler)
+{
+    using vecmath::Matrix3f;
+    float const x = 0.3f, y = -1.1f, z = 2.5f;
+
+    Matrix3f const fused = Matrix3f::rotateEuler(x, y, z);
+    Matrix3f const product = Matrix3f::rotateX(x) * Matrix3f::rotateY(y) * Matrix3f::rotateZ(z);
+    for (uint32_t r=0; r<4; ++r)
+    {
+        for (uint32_t c=0; c<4; ++c)
+        {
+            ASSERT_FPEQ(fused.get(r,c), product.get(r,c), 1.0e-5f);
+        }
+    }
+}
+
+BTEST(Matrix3Float, rotateAxis)
+{
+    using vecmath::Matrix3f;
+
+    // about each unit axis, the same as the single-axis factories
+    Matrix3f const mats[3][2] = {
+        {Matrix3f::rotateAxis(xunit, 0.7f), Matrix3f::rotateX(0.7f)},
+        {Matrix3f::rotateAxis(yunit, 0.7f), Matrix3f::rotateY(0.7f)},
+        {Matrix3f::rotateAxis(zunit, 0.7f), Matrix3f::rotateZ(0.7f)}};
+    for (auto const& m : mats)
+    {
+        for (uint32_t r=0; r<4; ++r)
+        {
+            for (uint32_t c=0; c<4; ++c)
+            {
+                ASSERT_FPEQ(m[0].get(r,c), m[1].get(r,c), 1.0e-6f);
+            }
+        }
+    }
+
+    // the axis itself is fixed
+    vecmath::Vector3f axis(1.0f, 2.0f, -2.0f);
+    axis.normalize();
+    vecmath::Vector3f const r = Matrix3f::rotateAxis(axis, 1.3f) * axis;
+    ASSERT_FPEQ(r.X(), axis.X(), 1.0e-6f);
+    ASSERT_FPEQ(r.Y(), axis.Y(), 1.0e-6f);
+    ASSERT_FPEQ(r.Z(), axis.Z(), 1.0e-6f);
+}
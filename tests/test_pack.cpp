@@ -0,0 +1,113 @@
+/**
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/**
+ * Unit tests for the packed storage types
+ */
+#include "vecmath.h"
+#include "vecpack.h"
+
+#include "test_common.h"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+BTEST(Pack, halfScalar)
+{
+    using vecmath::detail::float_to_half;
+    using vecmath::detail::half_to_float;
+
+    ASSERT_EQ(float_to_half(1.0f), uint16_t(0x3c00));
+    ASSERT_EQ(float_to_half(-2.0f), uint16_t(0xc000));
+    ASSERT_EQ(float_to_half(65504.0f), uint16_t(0x7bff));        // largest half
+    ASSERT_EQ(float_to_half(1.0e6f), uint16_t(0x7c00));          // overflows to Inf
+    ASSERT_EQ(float_to_half(5.9604645e-8f), uint16_t(0x0001));   // smallest subnormal
+    ASSERT_EQ(float_to_half(1.0f + 1.0f/2048), uint16_t(0x3c00)); // tie rounds to even
+    ASSERT_EQ(float_to_half(std::numeric_limits<float>::quiet_NaN()) & 0x7c00, 0x7c00);
+
+    // every finite half round trips
+    for (uint32_t h=0; h<0x10000; ++h)
+    {
+        if ((h & 0x7c00) == 0x7c00)
+            continue;
+        ASSERT_EQ(float_to_half(half_to_float(uint16_t(h))), uint16_t(h));
+    }
+    ASSERT_EQ(std::isinf(half_to_float(0xfc00)), true);
+}
+
+BTEST(Pack, types)
+{
+    vecmath::Vector3f const v(1.5f, -2.25f, 1000.0f);
+
+    vecmath::PackedVector3f const p(v);
+    vecmath::Vector3f const pv = p;
+    ASSERT_EQ(pv.X(), v.X());
+    ASSERT_EQ(pv.Z(), v.Z());
+    ASSERT_EQ(pv.W(), 1.0f);
+
+    vecmath::Vector3h const h(v);
+    ASSERT_EQ(h.X(), 1.5f);                                 // exact in half
+    ASSERT_EQ(h.Z(), 1000.0f);
+
+    vecmath::Vector3f n(1.0f, 2.0f, -2.0f);
+    n.normalize();
+    vecmath::PackedNormal3 const pn(n);
+    vecmath::Vector3f const un = pn;
+    ASSERT_FPEQ(un.X(), n.X(), 2.0e-5f);
+    ASSERT_FPEQ(un.Y(), n.Y(), 2.0e-5f);
+    ASSERT_FPEQ(un.Z(), n.Z(), 2.0e-5f);
+    ASSERT_EQ(vecmath::PackedNormal3(vecmath::Vector3f(-3.0f, 1.0f, 0.0f)).X(), -1.0f);
+}
+
+BTEST(Pack, batch)
+{
+    std::size_t const n = 1000;                     // several chunks and a tail
+    std::vector<vecmath::Vector3f> in(n);
+    for (std::size_t i=0; i<n; ++i)
+    {
+        float const t = 0.01f * i;
+        in[i] = vecmath::Vector3f(std::cos(t), std::sin(t), 0.5f - 0.001f * i);
+    }
+
+    std::vector<vecmath::Vector3h> h(n);
+    vecmath::pack(in.data(), h.data(), n);
+    std::vector<vecmath::Vector3f> out(n);
+    vecmath::unpack(h.data(), out.data(), n);
+    vecmath::Vector3Array<float> soa;
+    vecmath::unpack(h.data(), n, soa);
+    for (std::size_t i=0; i<n; ++i)
+    {
+        vecmath::Vector3h const e(in[i]);                   // scalar reference
+        ASSERT_EQ(out[i].X(), e.X());
+        ASSERT_EQ(out[i].Y(), e.Y());
+        ASSERT_EQ(out[i].Z(), e.Z());
+        ASSERT_EQ(out[i].W(), 1.0f);
+        ASSERT_EQ(soa.X()[i], e.X());
+        ASSERT_EQ(soa.Z()[i], e.Z());
+    }
+
+    std::vector<vecmath::PackedNormal3> pn(n);
+    vecmath::pack(in.data(), pn.data(), n);
+    vecmath::unpack(pn.data(), out.data(), n);
+    vecmath::unpack(pn.data(), n, soa);
+    for (std::size_t i=0; i<n; ++i)
+    {
+        ASSERT_FPEQ(out[i].Y(), in[i].Y(), 2.0e-5f);
+        ASSERT_EQ(soa.Y()[i], out[i].Y());
+    }
+
+    std::vector<vecmath::PackedVector3f> pv(n);
+    vecmath::pack(in.data(), pv.data(), n);
+    vecmath::unpack(pv.data(), out.data(), n);
+    vecmath::unpack(pv.data(), n, soa);
+    for (std::size_t i=0; i<n; ++i)
+    {
+        ASSERT_EQ(out[i].Z(), in[i].Z());
+        ASSERT_EQ(soa.X()[i], in[i].X());
+    }
+}
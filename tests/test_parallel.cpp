@@ -0,0 +1,208 @@
+/**
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/**
+ * Unit tests for the multithreaded batch kernels
+ */
+#include "vecmath.h"
+#include "affine.h"
+#include "vecparallel.h"
+
+#include "test_common.h"
+
+#include <atomic>
+#include <vector>
+
+namespace {
+
+// More than a few blocks, with a partial last block
+std::size_t const kPoints = 5 * vecmath::parallel::point_block + 123;
+
+vecmath::Vector3Arrayf makePoints(std::size_t n)
+{
+    vecmath::Vector3Arrayf a;
+    for (std::size_t i=0; i<n; ++i)
+    {
+        float const t = float(i);
+        a.push_back({std::sin(t), std::cos(0.5f * t), 0.001f * t - 2.0f});
+    }
+    return a;
+}
+
+vecmath::Matrix3f const kXform = vecmath::Matrix3f::translation(1, -2, 3) *
+                                 vecmath::Matrix3f::rotateY(0.7f) *
+                                 vecmath::Matrix3f::scale(2, 0.5f, 3);
+
+} // namespace
+
+BTEST(Parallel, runAllBlocks)
+{
+    vecmath::parallel::thread_pool pool(4);
+    ASSERT_EQ(pool.size(), 4u);
+
+    std::vector<int> hits(1000, 0);
+    pool.run(hits.size(), [&](std::size_t b) { hits[b] += 1; });
+
+    for (int h : hits)
+    {
+        ASSERT_EQ(h, 1);
+    }
+
+    // Nested runs fall back to the calling thread
+    std::atomic<int> nested(0);
+    pool.run(8, [&](std::size_t) {
+        pool.run(10, [&](std::size_t) { ++nested; });
+    });
+    ASSERT_EQ(nested.load(), 80);
+}
+
+BTEST(Parallel, runRethrows)
+{
+    vecmath::parallel::thread_pool pool(3);
+    std::atomic<int> ran(0);
+
+    try {
+        pool.run(100, [&](std::size_t b) {
+            ++ran;
+            if (b == 42)
+                throw vecmath::degenerate_error("block 42");
+        });
+        FAIL() << "run() didn't rethrow the block's exception\n";
+    }
+    catch (vecmath::degenerate_error &) {
+        // expected
+    }
+    ASSERT_EQ(ran.load(), 100);
+}
+
+BTEST(Parallel, transformPoints)
+{
+    vecmath::Vector3Arrayf const in = makePoints(kPoints);
+    vecmath::Vector3Arrayf serial;
+    vecmath::transform(kXform, in, serial);
+
+    vecmath::parallel::thread_pool pool(4);
+    vecmath::Vector3Arrayf out;
+    vecmath::parallel::transform_points(kXform, in, out, pool);
+    ASSERT_EQ(out.size(), in.size());
+
+    for (std::size_t i=0; i<in.size(); ++i)
+    {
+        ASSERT_EQ(out.X()[i], serial.X()[i]);
+        ASSERT_EQ(out.Y()[i], serial.Y()[i]);
+        ASSERT_EQ(out.Z()[i], serial.Z()[i]);
+    }
+
+    vecmath::Vector3Arrayf inplace = in;
+    vecmath::parallel::transform_points(kXform, inplace, inplace, pool);
+    for (std::size_t i=0; i<in.size(); ++i)
+    {
+        ASSERT_EQ(inplace.X()[i], serial.X()[i]);
+        ASSERT_EQ(inplace.Z()[i], serial.Z()[i]);
+    }
+}
+
+BTEST(Parallel, transformPointsAoS)
+{
+    vecmath::Vector3Arrayf const soa = makePoints(kPoints);
+    std::vector<vecmath::Vector3f> in;
+    for (std::size_t i=0; i<soa.size(); ++i)
+    {
+        in.push_back(soa.get(i));
+    }
+
+    std::vector<vecmath::Vector3f> out(in.size());
+    vecmath::parallel::thread_pool pool(3);
+    vecmath::parallel::transform_points(kXform, in.data(), out.data(), in.size(), pool);
+
+    for (std::size_t i=0; i<in.size(); ++i)
+    {
+        vecmath::Vector3f const e = kXform * in[i];
+        ASSERT_EQ(out[i].X(), e.X());
+        ASSERT_EQ(out[i].Y(), e.Y());
+        ASSERT_EQ(out[i].Z(), e.Z());
+    }
+}
+
+BTEST(Parallel, transformNormals)
+{
+    // A non-uniform scale: normals must not simply be scaled too
+    vecmath::Matrix3f const m = vecmath::Matrix3f::rotateZ(0.3f) *
+                                vecmath::Matrix3f::scale(2, 1, 1);
+
+    vecmath::Vector3Arrayf in;
+    in.push_back({1.0f, 1.0f, 0.0f});
+    in.push_back({0.0f, 0.0f, 5.0f});
+    in.push_back({0.0f, 0.0f, 0.0f});
+
+    vecmath::Vector3Arrayf out;
+    vecmath::parallel::transform_normals(m, in, out);
+
+    // The surface x + y = 0 contains (1,-1,0); its normal must stay
+    // perpendicular to the transformed tangent.
+    vecmath::Vector3f const tangent = m * vecmath::Vector3f(1.0f, -1.0f, 0.0f);
+    vecmath::Vector3f const n0 = out.get(0);
+    ASSERT_FPEQ(vecmath::dot(n0, tangent), 0.0f, EPS);
+    ASSERT_FPEQ(n0.length(), 1.0f, EPS);
+
+    ASSERT_FPEQ(out.get(1).Z(), 1.0f, EPS);
+    ASSERT_EQ(out.get(2).X(), 0.0f);
+
+    vecmath::Vector3Arrayd ind, outd;
+    ind.push_back({3.0, 4.0, 12.0});
+    vecmath::parallel::transform_normals(vecmath::Matrix3d(), ind, outd);
+    ASSERT_FPEQ(outd.get(0).X(), 3.0 / 13.0, 1.0e-15);
+    ASSERT_FPEQ(outd.get(0).Z(), 12.0 / 13.0, 1.0e-15);
+
+    try {
+        vecmath::parallel::transform_normals(vecmath::Matrix3f::scale(1, 0, 1), in, out);
+        FAIL() << "singular matrix didn't throw expected exception\n";
+    }
+    catch (vecmath::degenerate_error &) {
+        // expected
+    }
+}
+
+BTEST(Parallel, composeChainDeterministic)
+{
+    std::size_t const n = 3 * vecmath::parallel::matrix_block + 17;
+    std::vector<vecmath::AffineMatrix3d> in;
+    for (std::size_t i=0; i<n; ++i)
+    {
+        in.push_back(vecmath::AffineMatrix3d::rotateX(1.0e-3 * double(i)) *
+                     vecmath::AffineMatrix3d::translation(0.01, 0.0, -0.02));
+    }
+
+    std::vector<vecmath::AffineMatrix3d> serial(n);
+    serial[0] = in[0];
+    for (std::size_t i=1; i<n; ++i)
+    {
+        serial[i] = serial[i-1] * in[i];
+    }
+
+    vecmath::parallel::thread_pool one(1);
+    vecmath::parallel::thread_pool many(5);
+    std::vector<vecmath::AffineMatrix3d> a(n), b(n);
+    vecmath::parallel::compose_chain(in.data(), a.data(), n, one);
+    vecmath::parallel::compose_chain(in.data(), b.data(), n, many);
+
+    for (std::size_t i=0; i<n; ++i)
+    {
+        for (uint32_t r=0; r<3; ++r)
+        {
+            for (uint32_t c=0; c<4; ++c)
+            {
+                ASSERT_EQ(a[i].get(r,c), b[i].get(r,c));
+                ASSERT_FPEQ(a[i].get(r,c), serial[i].get(r,c), 1.0e-9);
+            }
+        }
+    }
+
+    // In place
+    vecmath::parallel::compose_chain(in.data(), in.data(), n, many);
+    ASSERT_EQ(in[n-1].get(1,2), a[n-1].get(1,2));
+}
@@ -0,0 +1,264 @@
+/**
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/**
+ * Unit tests for run_pipeline() and the pipelined transform_file()
+ */
+#include "vecmath.h"
+#include "vecpipeline.h"
+
+#include "test_common.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+vecmath::Vector3Arrayf makePoints(std::size_t n)
+{
+    vecmath::Vector3Arrayf a;
+    for (std::size_t i=0; i<n; ++i)
+    {
+        float const t = float(i);
+        a.push_back({std::sin(t), std::cos(0.5f * t), 0.001f * t - 2.0f});
+    }
+    return a;
+}
+
+std::string readBytes(std::string const& path)
+{
+    std::ifstream f(path.c_str(), std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+}
+
+/*
+ * Rewrite the file at \c path with header \c h, moving its data
+ * from just past the header to h.data_offset, or leaving it there.
+ */
+void rewriteFile(std::string const& path, vecmath::file_header const& h)
+{
+    std::string const bytes = readBytes(path);
+    std::string out(reinterpret_cast<char const*>(&h), sizeof(h));
+    if (h.data_offset > out.size() && h.data_offset < bytes.size())
+        out.resize(h.data_offset, '\0');
+    out.append(bytes, sizeof(h), std::string::npos);
+    std::ofstream f(path.c_str(), std::ios::binary);
+    f.write(out.data(), out.size());
+}
+
+vecmath::file_header readHeader(std::string const& path)
+{
+    vecmath::file_header h;
+    std::memcpy(&h, readBytes(path).data(), sizeof(h));
+    return h;
+}
+
+vecmath::Matrix3f const kXform = vecmath::Matrix3f::translation(1, -2, 3) *
+                                 vecmath::Matrix3f::rotateY(0.7f) *
+                                 vecmath::Matrix3f::scale(2, 0.5f, 3);
+
+} // namespace
+
+BTEST(Pipeline, stages)
+{
+    // Every stage sees the chunks in order, in the slot it was given,
+    // and never more than depth chunks are loaded but not stored.
+    std::size_t const kChunks = 200, kDepth = 3;
+    std::vector<int> slots(kDepth, -1);
+    std::atomic<int> inflight(0), most(0);
+    std::atomic<bool> ordered(true);
+    std::size_t loaded = 0, computed = 0, stored = 0;
+
+    vecmath::parallel::run_pipeline(kChunks, kDepth,
+        [&](std::size_t k, std::size_t s) {
+            if (k != loaded++ || s != k % kDepth || slots[s] != -1)
+                ordered = false;
+            slots[s] = int(k);
+            int const now = ++inflight;
+            if (now > most)
+                most = now;
+        },
+        [&](std::size_t k, std::size_t s) {
+            if (k != computed++ || slots[s] != int(k))
+                ordered = false;
+        },
+        [&](std::size_t k, std::size_t s) {
+            if (k != stored++ || slots[s] != int(k))
+                ordered = false;
+            slots[s] = -1;
+            --inflight;
+        });
+
+    ASSERT_EQ(ordered.load(), true);
+    ASSERT_EQ(stored, kChunks);
+    ASSERT_EQ(most.load() <= int(kDepth), true);
+
+    // nothing to do
+    vecmath::parallel::run_pipeline(0, kDepth,
+        [&](std::size_t, std::size_t) { FAIL() << "no chunks to load\n"; },
+        [&](std::size_t, std::size_t) { },
+        [&](std::size_t, std::size_t) { });
+}
+
+BTEST(Pipeline, errors)
+{
+    // A throwing stage stops the others, and its exception comes back.
+    std::size_t stored = 0;
+    try {
+        vecmath::parallel::run_pipeline(100, 4,
+            [&](std::size_t, std::size_t) { },
+            [&](std::size_t k, std::size_t) {
+                if (k == 10)
+                    throw std::runtime_error("chunk 10");
+            },
+            [&](std::size_t, std::size_t) { ++stored; });
+        FAIL() << "run_pipeline() should have rethrown\n";
+    }
+    catch (std::runtime_error& e) {
+        ASSERT_EQ(std::string(e.what()), std::string("chunk 10"));
+    }
+    ASSERT_EQ(stored <= 10u, true);
+
+    try {
+        vecmath::parallel::run_pipeline(100, 2,
+            [&](std::size_t, std::size_t) { },
+            [&](std::size_t, std::size_t) { },
+            [&](std::size_t k, std::size_t) {
+                if (k == 50)
+                    throw vecmath::file_error("store");
+            });
+        FAIL() << "run_pipeline() should have rethrown\n";
+    }
+    catch (vecmath::file_error&) {
+        // PASS, intended failure
+    }
+}
+
+BTEST(Pipeline, transformFile)
+{
+    std::string const in = "test_pipeline_in.vmf";
+    std::string const out = "test_pipeline_out.vmf";
+    std::string const ref = "test_pipeline_ref.vmf";
+    vecmath::parallel::thread_pool pool(4);
+
+    // The same bytes as the serial transform, for every format, and
+    // chunks that do and don't divide the count.
+    vecmath::Vector3Arrayf const pts = makePoints(3 * vecmath::parallel::point_block + 77);
+    std::vector<vecmath::Vector3f> aos;
+    for (std::size_t i=0; i<pts.size(); ++i)
+        aos.push_back(pts.get(i));
+
+    for (int format=0; format<3; ++format)
+    {
+        if (format == 0)
+            vecmath::write_file(in, pts);
+        else if (format == 1)
+            vecmath::write_file(in, pts, vecmath::file_scalar::f16);
+        else
+            vecmath::write_file(in, aos);
+
+        vecmath::transform_file(in, ref, kXform, 1000);
+        std::string const expect = readBytes(ref);
+        ASSERT_EQ(expect.empty(), false);
+
+        std::size_t const chunks[] = {1000, 4096, 1 << 16};
+        std::size_t const depths[] = {1, 2, 3, 8};
+        for (std::size_t chunk : chunks)
+        {
+            for (std::size_t depth : depths)
+            {
+                vecmath::parallel::transform_file(in, out, kXform, pool, chunk, depth);
+                ASSERT_EQ(readBytes(out) == expect, true);
+            }
+        }
+    }
+
+    // double precision, on the default pool
+    vecmath::Vector3Arrayd ptsd;
+    for (std::size_t i=0; i<1234; ++i)
+        ptsd.push_back(vecmath::Vector3d(0.5 * i, 1.0 - i, 0.25 * i));
+    vecmath::Matrix3d const md = vecmath::Matrix3d::rotateX(0.3) * vecmath::Matrix3d::translation(1, 2, 3);
+    vecmath::write_file(in, ptsd);
+    vecmath::transform_file(in, ref, md, 100);
+    vecmath::parallel::transform_file(in, out, md);
+    ASSERT_EQ(readBytes(out) == readBytes(ref), true);
+
+    // an empty file
+    vecmath::write_file(in, vecmath::Vector3Arrayf());
+    vecmath::parallel::transform_file(in, out, kXform, pool);
+    {
+        vecmath::mapped_file const f(out);
+        ASSERT_EQ(f.size(), 0u);
+    }
+
+    // matrices are not points
+    std::vector<vecmath::Matrix3f> mats(3);
+    vecmath::write_file(in, mats);
+    try {
+        vecmath::parallel::transform_file(in, out, kXform, pool);
+        FAIL() << "transform_file() should have rejected a matrices file\n";
+    }
+    catch (vecmath::file_error&) {
+        // PASS, intended failure
+    }
+
+    std::remove(in.c_str());
+    std::remove(out.c_str());
+    std::remove(ref.c_str());
+}
+
+BTEST(Pipeline, corruptHeaders)
+{
+    std::string const in = "test_pipeline_corrupt.vmf";
+    std::string const out = "test_pipeline_corrupt_out.vmf";
+    std::string const ref = "test_pipeline_corrupt_ref.vmf";
+    vecmath::parallel::thread_pool pool(2);
+    std::vector<vecmath::Vector3f> aos;
+    for (std::size_t i=0; i<100; ++i)
+        aos.push_back(vecmath::Vector3f(float(i), 1.0f, -float(i)));
+
+    // a count whose byte count overflows, and data over the header
+    uint64_t const counts[] = {uint64_t(1) << 60, aos.size()};
+    uint64_t const offsets[] = {64, 0};
+    for (int k=0; k<2; ++k)
+    {
+        vecmath::write_file(in, aos);
+        vecmath::file_header h = readHeader(in);
+        h.count = counts[k];
+        h.data_offset = offsets[k];
+        rewriteFile(in, h);
+        try {
+            vecmath::parallel::transform_file(in, out, kXform, pool);
+            FAIL() << "transform_file() should have rejected a corrupt header\n";
+        }
+        catch (vecmath::file_error&) {
+            // PASS, intended failure
+        }
+    }
+
+    // a valid file with its data further out, as the serial transform
+    vecmath::write_file(in, aos);
+    vecmath::file_header h = readHeader(in);
+    h.data_offset = 192;
+    rewriteFile(in, h);
+    vecmath::transform_file(in, ref, kXform, 30);
+    vecmath::parallel::transform_file(in, out, kXform, pool, 30);
+    std::string const bytes = readBytes(out);
+    ASSERT_EQ(bytes.size(), 192 + aos.size() * sizeof(vecmath::Vector3f));
+    ASSERT_EQ(bytes == readBytes(ref), true);
+    ASSERT_EQ(bytes.find_first_not_of('\0', sizeof(h)) >= 192u, true);
+
+    std::remove(in.c_str());
+    std::remove(out.c_str());
+    std::remove(ref.c_str());
+}
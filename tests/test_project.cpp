@@ -0,0 +1,284 @@
+/**
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/**
+ * Unit tests for projection with the homogeneous divide.
+ *
+ * project_points() against the product and divide done apart, the
+ * clip codes of known points, and the projection kernels of every
+ * supported instruction set against the scalar ones, at sizes that
+ * leave every tail length.
+ */
+#include "vecmath.h"
+#include "vecproject.h"
+
+#include "test_common.h"
+
+#include <cmath>
+#include <vector>
+
+using vecmath::Vector3f;
+using vecmath::Vector3d;
+
+namespace {
+
+template <typename fptype>
+vecmath::Matrix3<fptype> camera()
+{
+    return perspective<fptype>(1.0, 1.5, 0.5, 20.0) *
+           vecmath::Matrix3<fptype>::translation(0, 0, -6);
+}
+
+// Points around the view volume, some inside it and some outside.
+template <typename fptype>
+std::vector<vecmath::Vector3<fptype>> makePoints(std::size_t n, int seed)
+{
+    std::vector<vecmath::Vector3<fptype>> v(n);
+    for (std::size_t i=0; i<n; ++i)
+    {
+        fptype const t = fptype(i * 7 + seed);
+        v[i] = vecmath::Vector3<fptype>(std::sin(t) * 4, std::cos(t * 2) * 3,
+                                        std::sin(t * 3) * 12);
+    }
+    return v;
+}
+
+// The product m * v divided by its W, and the clip code of m * v.
+template <typename fptype>
+vecmath::Vector3<fptype> projected(vecmath::Matrix3<fptype> const& m,
+                                   vecmath::Vector3<fptype> const& v, uint8_t& clip)
+{
+    vecmath::Vector3<fptype> const c = m * v;
+    fptype const w = c.W();
+    clip = uint8_t((c.X() < -w ? vecmath::clip_left : 0) |
+                   (c.X() > w ? vecmath::clip_right : 0) |
+                   (c.Y() < -w ? vecmath::clip_bottom : 0) |
+                   (c.Y() > w ? vecmath::clip_top : 0) |
+                   (c.Z() < -w || w <= 0 ? vecmath::clip_near : 0) |
+                   (c.Z() > w ? vecmath::clip_far : 0));
+    vecmath::Vector3<fptype> r(c.X() / w, c.Y() / w, c.Z() / w);
+    r[3] = 1 / w;
+    return r;
+}
+
+template <typename fptype>
+bool nearly(fptype a, fptype b, fptype rel)
+{
+    return std::abs(a - b) <= rel * std::max(fptype(1), std::abs(b));
+}
+
+} // anonymous
+
+BTEST(Project, knownPoints)
+{
+    vecmath::Matrix3f const m = camera<float>();
+    std::vector<Vector3f> const p = {
+        Vector3f(0, 0, 0),                  // inside, 6 in front of the eye
+        Vector3f(0, 0, 6),                  // at the eye
+        Vector3f(0, 0, 7),                  // behind it
+        Vector3f(0, 0, -30),                // beyond the far plane
+        Vector3f(-20, 0, 0),                // left
+        Vector3f(0, 20, 0),                 // above
+        Vector3f(20, -20, -2)               // right and below
+    };
+    std::vector<Vector3f> r(p.size());
+    std::vector<uint8_t> clip(p.size());
+
+    ASSERT_EQ(vecmath::project_points(m, p, r, clip), 1u);
+    ASSERT_EQ(clip[0], 0);
+    ASSERT_EQ(clip[1], vecmath::clip_near);
+    ASSERT_EQ(clip[2] & vecmath::clip_near, vecmath::clip_near);
+    ASSERT_EQ(clip[3], vecmath::clip_far);
+    ASSERT_EQ(clip[4], vecmath::clip_left);
+    ASSERT_EQ(clip[5], vecmath::clip_top);
+    ASSERT_EQ(clip[6], vecmath::clip_right | vecmath::clip_bottom);
+
+    // the center of the view, at depth 6
+    ASSERT_FPEQ(r[0].X(), 0.0f, EPS);
+    ASSERT_FPEQ(r[0].Y(), 0.0f, EPS);
+    ASSERT_FPEQ(r[0].W(), 1.0f / 6, EPS);
+    ASSERT_EQ(r[0].Z() > -1 && r[0].Z() < 1, true);
+}
+
+BTEST(Project, aos)
+{
+    vecmath::Matrix3f const mf = camera<float>();
+    vecmath::Matrix3d const md = camera<double>();
+
+    for (std::size_t n : kernel_sizes)
+    {
+        std::vector<Vector3f> const pf = makePoints<float>(n, 1);
+        std::vector<Vector3d> const pd = makePoints<double>(n, 1);
+        std::vector<Vector3f> rf(n), af(n);
+        std::vector<Vector3d> rd(n);
+        std::vector<uint8_t> cf(n), cd(n);
+
+        std::size_t const inf = vecmath::project_points(mf, pf, rf, cf);
+        std::size_t const ind = vecmath::project_points(md, pd, rd, cd);
+        vecmath::project_points<vecmath::precision::refined>(mf, pf, af);
+
+        std::size_t count = 0;
+        for (std::size_t i=0; i<n; ++i)
+        {
+            uint8_t ef, ed;
+            Vector3f const xf = projected(mf, pf[i], ef);
+            Vector3d const xd = projected(md, pd[i], ed);
+            ASSERT_EQ(cf[i], ef);
+            ASSERT_EQ(cd[i], ed);
+            count += (ed == 0);
+            for (int c=0; c<4; ++c)
+            {
+                ASSERT_EQ(nearly(rf[i][c], xf[c], 1.0e-5f), true);
+                ASSERT_EQ(nearly(af[i][c], xf[c], 1.0e-5f), true);
+                ASSERT_EQ(nearly(rd[i][c], xd[c], 1.0e-12), true);
+            }
+        }
+        ASSERT_EQ(inf, count);
+        ASSERT_EQ(ind, count);
+
+        // in place
+        std::vector<Vector3f> q = pf;
+        vecmath::project_points(mf, q, q);
+        for (std::size_t i=0; i<n; ++i)
+        {
+            for (int c=0; c<4; ++c)
+                ASSERT_EQ(q[i][c], rf[i][c]);
+        }
+    }
+}
+
+BTEST(Project, soa)
+{
+    vecmath::Matrix3f const mf = camera<float>();
+    vecmath::Matrix3d const md = camera<double>();
+
+    for (std::size_t n : kernel_sizes)
+    {
+        std::vector<Vector3f> const pf = makePoints<float>(n, 2);
+        std::vector<Vector3d> const pd = makePoints<double>(n, 2);
+        vecmath::Vector3Arrayf af, rf, ff;
+        vecmath::Vector3Arrayd ad, rd;
+        for (std::size_t i=0; i<n; ++i)
+        {
+            af.push_back(pf[i]);
+            ad.push_back(pd[i]);
+        }
+        std::vector<uint8_t> cf(n), cd(n);
+
+        std::size_t const inf = vecmath::project_points(mf, af, rf, cf);
+        std::size_t const ind = vecmath::project_points(md, ad, rd, cd);
+        vecmath::project_points<vecmath::precision::approx>(mf, af, ff);
+        ASSERT_EQ(rf.size(), n);
+        ASSERT_EQ(ff.size(), n);
+        ASSERT_EQ(rd.size(), n);
+
+        std::size_t count = 0;
+        for (std::size_t i=0; i<n; ++i)
+        {
+            uint8_t ef, ed;
+            Vector3f const xf = projected(mf, pf[i], ef);
+            Vector3d const xd = projected(md, pd[i], ed);
+            ASSERT_EQ(cf[i], ef);
+            ASSERT_EQ(cd[i], ed);
+            count += (ed == 0);
+            for (int c=0; c<3; ++c)
+            {
+                ASSERT_EQ(nearly(rf.get(i)[c], xf[c], 1.0e-5f), true);
+                ASSERT_EQ(nearly(ff.get(i)[c], xf[c], 1.0e-5f), true);
+                ASSERT_EQ(nearly(rd.get(i)[c], xd[c], 1.0e-12), true);
+            }
+        }
+        ASSERT_EQ(inf, count);
+        ASSERT_EQ(ind, count);
+
+        // in place
+        vecmath::project_points(mf, af, af);
+        for (std::size_t i=0; i<n; ++i)
+        {
+            for (int c=0; c<3; ++c)
+                ASSERT_EQ(af.get(i)[c], rf.get(i)[c]);
+        }
+    }
+}
+
+BTEST(Project, kernelsMatchScalar)
+{
+    vecmath::simd::kernels const& scalar = *vecmath::simd::find(vecmath::simd::isa::scalar);
+    vecmath::Matrix3f const m = camera<float>();
+
+    for (vecmath::simd::kernels const* k : supportedKernels())
+    {
+        for (std::size_t n : kernel_sizes)
+        {
+            std::vector<Vector3f> const p = makePoints<float>(n, 3);
+            float const* const v = vecmath::as_scalars(p).data();
+            std::vector<float> r(4 * n + 1), e(4 * n + 1);
+            std::vector<uint8_t> clip(n + 1, 0xff), ce(n + 1, 0xff);
+
+            for (int fast=0; fast<2; ++fast)
+            {
+                k->project_n(r.data(), clip.data(), m.data(), v, fast != 0, n);
+                scalar.project_n(e.data(), ce.data(), m.data(), v, false, n);
+                ASSERT_EQ(clip == ce, true);
+                for (std::size_t i=0; i<4*n; ++i)
+                    ASSERT_EQ(nearly(r[i], e[i], 1.0e-5f), true);
+
+                // no codes asked for
+                k->project_n(r.data(), nullptr, m.data(), v, fast != 0, n);
+                for (std::size_t i=0; i<4*n; ++i)
+                    ASSERT_EQ(nearly(r[i], e[i], 1.0e-5f), true);
+
+                vecmath::Vector3Arrayf a;
+                for (Vector3f const& q : p)
+                    a.push_back(q);
+                float const* const va[3] = {a.X(), a.Y(), a.Z()};
+                std::vector<float> rs(3 * n + 1), es(3 * n + 1);
+                float* const ra[3] = {rs.data(), rs.data() + n, rs.data() + 2*n};
+                float* const ea[3] = {es.data(), es.data() + n, es.data() + 2*n};
+                k->project_soa_n(ra, clip.data(), m.data(), va, fast != 0, n);
+                scalar.project_soa_n(ea, ce.data(), m.data(), va, false, n);
+                ASSERT_EQ(clip == ce, true);
+                for (std::size_t i=0; i<3*n; ++i)
+                    ASSERT_EQ(nearly(rs[i], es[i], 1.0e-5f), true);
+                ASSERT_EQ(rs[3*n], 0.0f);
+                ASSERT_EQ(clip[n], 0xff);
+            }
+        }
+    }
+}
+
+BTEST(Project, sizesDiffer)
+{
+    vecmath::Matrix3f const m = camera<float>();
+    std::vector<Vector3f> const p(5);
+    std::vector<Vector3f> r(4), q(5);
+    std::vector<uint8_t> clip(4);
+    try {
+        vecmath::project_points(m, p, r);
+        FAIL() << "project_points() should have failed for a short output\n";
+    }
+    catch (vecmath::index_error&) {
+        // PASS, intended failure
+    }
+    try {
+        vecmath::project_points(m, p, q, clip);
+        FAIL() << "project_points() should have failed for short clip codes\n";
+    }
+    catch (vecmath::index_error&) {
+        // PASS, intended failure
+    }
+
+    vecmath::Vector3Arrayf a, b;
+    a.resize(5);
+    try {
+        vecmath::project_points(m, a, b, clip);
+        FAIL() << "project_points() should have failed for short clip codes\n";
+    }
+    catch (vecmath::index_error&) {
+        // PASS, intended failure
+    }
+}
@@ -0,0 +1,139 @@
+/**
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/**
+ * Unit tests for quaternions
+ */
+#include "vecmath.h"
+#include "quaternion.h"
+
+#include "test_common.h"
+
+namespace {
+
+bool same(vecmath::Vector3f const& a, vecmath::Vector3f const& b, float eps = 1.0e-5f)
+{
+    return (vecmath::fpequal(a.X(), b.X(), eps) &&
+            vecmath::fpequal(a.Y(), b.Y(), eps) &&
+            vecmath::fpequal(a.Z(), b.Z(), eps));
+}
+
+bool same(vecmath::Matrix3f const& a, vecmath::Matrix3f const& b, float eps = 1.0e-5f)
+{
+    for (uint32_t r=0; r<4; ++r)
+    {
+        for (uint32_t c=0; c<4; ++c)
+        {
+            if (!vecmath::fpequal(a.get(r,c), b.get(r,c), eps))
+                return false;
+        }
+    }
+    return true;
+}
+
+// q and -q are the same rotation
+bool sameRotation(vecmath::Quaternionf const& a, vecmath::Quaternionf const& b)
+{
+    return vecmath::fpequal(std::abs(vecmath::dot(a, b)), 1.0f, 1.0e-5f);
+}
+
+} // namespace
+
+BTEST(Quat, identity)
+{
+    constexpr vecmath::Quaternionf q;
+    static_assert(q.W() == 1.0f && q.X() == 0.0f, "identity");
+
+    vecmath::Vector3f const v {1.0f, 2.0f, 3.0f};
+    ASSERT_EQ(same(q * v, v), true);
+    ASSERT_EQ(same(vecmath::Matrix3f(q), vecmath::Matrix3f()), true);
+}
+
+BTEST(Quat, factoriesMatchMatrix3)
+{
+    using vecmath::Quaternionf;
+    using vecmath::Matrix3f;
+
+    ASSERT_EQ(same(Matrix3f(Quaternionf::rotateX(0.3f)), Matrix3f::rotateX(0.3f)), true);
+    ASSERT_EQ(same(Matrix3f(Quaternionf::rotateY(-1.2f)), Matrix3f::rotateY(-1.2f)), true);
+    ASSERT_EQ(same(Matrix3f(Quaternionf::rotateZ(2.5f)), Matrix3f::rotateZ(2.5f)), true);
+
+    Quaternionf const q = Quaternionf::axisAngle(yunit, 0.8f);
+    ASSERT_EQ(same(Matrix3f(q), Matrix3f::rotateY(0.8f)), true);
+}
+
+BTEST(Quat, compose)
+{
+    using vecmath::Quaternionf;
+    using vecmath::Matrix3f;
+
+    Quaternionf const q = Quaternionf::rotateX(0.3f) *
+                          Quaternionf::rotateY(-0.7f) *
+                          Quaternionf::rotateZ(1.9f);
+    Matrix3f const m = Matrix3f::rotateX(0.3f) *
+                       Matrix3f::rotateY(-0.7f) *
+                       Matrix3f::rotateZ(1.9f);
+    ASSERT_EQ(same(Matrix3f(q), m), true);
+
+    vecmath::Vector3f const v {0.5f, -2.0f, 4.0f};
+    ASSERT_EQ(same(q * v, m * v), true);
+    ASSERT_EQ(same(q.conjugate() * (q * v), v), true);
+}
+
+BTEST(Quat, fromMatrix)
+{
+    using vecmath::Quaternionf;
+    using vecmath::Matrix3f;
+
+    // Angles that exercise each branch of the conversion
+    float const angles[] = {0.2f, 2.9f, -3.0f, 1.5f};
+    for (float t : angles)
+    {
+        Quaternionf const qx = Quaternionf::rotateX(t);
+        Quaternionf const qy = Quaternionf::rotateY(t);
+        Quaternionf const qz = Quaternionf::rotateZ(t);
+        ASSERT_EQ(sameRotation(Quaternionf(Matrix3f::rotateX(t)), qx), true);
+        ASSERT_EQ(sameRotation(Quaternionf(Matrix3f::rotateY(t)), qy), true);
+        ASSERT_EQ(sameRotation(Quaternionf(Matrix3f::rotateZ(t)), qz), true);
+
+        Quaternionf const q = qx * qy * qz;
+        ASSERT_EQ(sameRotation(Quaternionf(Matrix3f(q)), q), true);
+    }
+}
+
+BTEST(Quat, interpolate)
+{
+    using vecmath::Quaternionf;
+
+    Quaternionf const a = Quaternionf::rotateZ(0.2f);
+    Quaternionf const b = Quaternionf::rotateZ(1.4f);
+
+    ASSERT_EQ(sameRotation(vecmath::slerp(a, b, 0.0f), a), true);
+    ASSERT_EQ(sameRotation(vecmath::slerp(a, b, 1.0f), b), true);
+    ASSERT_EQ(sameRotation(vecmath::slerp(a, b, 0.25f), Quaternionf::rotateZ(0.5f)), true);
+    ASSERT_EQ(sameRotation(vecmath::nlerp(a, b, 0.5f), Quaternionf::rotateZ(0.8f)), true);
+
+    // -b is the same rotation, and still takes the short way
+    Quaternionf const nb(-b.W(), -b.X(), -b.Y(), -b.Z());
+    ASSERT_EQ(sameRotation(vecmath::slerp(a, nb, 0.25f), Quaternionf::rotateZ(0.5f)), true);
+
+    // Nearly equal rotations fall back to nlerp
+    Quaternionf const c = Quaternionf::rotateZ(0.2001f);
+    ASSERT_FPEQ(vecmath::slerp(a, c, 0.5f).length_squared(), 1.0f, 1.0e-5f);
+}
+
+BTEST(Quat, normalize)
+{
+    vecmath::Quaternionf q(2.0f, 0.0f, 0.0f, 2.0f);
+    q.normalize();
+    ASSERT_FPEQ(q.length_squared(), 1.0f, EPS);
+    ASSERT_EQ(sameRotation(q, vecmath::Quaternionf::rotateZ(1.5707963f)), true);
+
+    vecmath::Quaternionf z(0.0f, 0.0f, 0.0f, 0.0f);
+    z.normalize();
+    ASSERT_EQ(z.W(), 1.0f);
+}
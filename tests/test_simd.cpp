@@ -0,0 +1,152 @@
+/**
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/**
+ * Unit tests for the SIMD kernels.
+ *
+ * Every kernel table this CPU supports is checked against the
+ * scalar operators in matops.h.
+ */
+#include "vecmath.h"
+#include "vecsimd.h"
+
+#include "test_common.h"
+
+namespace {
+
+// A matrix with no zero or repeated elements.
+vecmath::Matrix3f testMatrix()
+{
+    return (vecmath::Matrix3f::translation(1.0f, -2.0f, 3.0f) *
+            vecmath::Matrix3f::rotateX(0.4f) *
+            vecmath::Matrix3f::rotateZ(1.1f) *
+            vecmath::Matrix3f::scale(2.0f, 0.5f, 1.5f));
+}
+
+float const* rawData(vecmath::Matrix3f const& m) { return reinterpret_cast<float const*>(&m); }
+float const* rawData(vecmath::Vector3f const& v) { return reinterpret_cast<float const*>(&v); }
+
+} // anonymous
+
+BTEST(Simd, activeIsSupported)
+{
+    vecmath::simd::kernels const& k = vecmath::simd::active();
+    std::cout << "  active SIMD kernels: " << k.name << std::endl;
+
+    ASSERT_EQ(vecmath::simd::supported(k.id), true);
+    ASSERT_EQ(vecmath::simd::supported(vecmath::simd::isa::scalar), true);
+}
+
+BTEST(Simd, mmMult)
+{
+    vecmath::Matrix3f a = testMatrix();
+    vecmath::Matrix3f b = vecmath::Matrix3f::rotateY(-0.7f) * vecmath::Matrix3f::translation(4.0f, 5.0f, 6.0f);
+    vecmath::Matrix3f expect = a * b;
+
+    for (vecmath::simd::kernels const* k : supportedKernels())
+    {
+        float r[16];
+        k->mm_mult(r, rawData(a), rawData(b));
+        for (int i=0; i<16; ++i)
+        {
+            ASSERT_FPEQ(r[i], expect.get(i/4, i%4), 1.0e-5f);
+        }
+    }
+}
+
+BTEST(Simd, mmMultAliased)
+{
+    vecmath::Matrix3f a = testMatrix();
+    vecmath::Matrix3f expect = a * a;
+
+    for (vecmath::simd::kernels const* k : supportedKernels())
+    {
+        vecmath::Matrix3f r = a;
+        float* rp = reinterpret_cast<float*>(&r);
+        k->mm_mult(rp, rp, rp);
+        for (int i=0; i<16; ++i)
+        {
+            ASSERT_FPEQ(rp[i], expect.get(i/4, i%4), 1.0e-5f);
+        }
+    }
+}
+
+BTEST(Simd, vmAndMvMult)
+{
+    vecmath::Matrix3f m = testMatrix();
+    vecmath::Vector3f v {0.5f, -1.5f, 2.5f};
+    vecmath::Vector3f vm = v * m;
+    vecmath::Vector3f mv = m * v;
+
+    for (vecmath::simd::kernels const* k : supportedKernels())
+    {
+        float r[4];
+        k->vm_mult(r, rawData(v), rawData(m));
+        ASSERT_FPEQ(r[0], vm.X(), 1.0e-5f);
+        ASSERT_FPEQ(r[1], vm.Y(), 1.0e-5f);
+        ASSERT_FPEQ(r[2], vm.Z(), 1.0e-5f);
+        ASSERT_FPEQ(r[3], vm.W(), 1.0e-5f);
+
+        k->mv_mult(r, rawData(m), rawData(v));
+        ASSERT_FPEQ(r[0], mv.X(), 1.0e-5f);
+        ASSERT_FPEQ(r[1], mv.Y(), 1.0e-5f);
+        ASSERT_FPEQ(r[2], mv.Z(), 1.0e-5f);
+        ASSERT_FPEQ(r[3], mv.W(), 1.0e-5f);
+    }
+}
+
+BTEST(Simd, mvMultBatch)
+{
+    vecmath::Matrix3f m = testMatrix();
+
+    // Every count 0..9 covers the 1, 2 and 4-wide tails.
+    for (std::size_t n=0; n<10; ++n)
+    {
+        vecmath::Vector3f in[10];
+        for (std::size_t i=0; i<n; ++i)
+        {
+            in[i] = vecmath::Vector3f(0.5f*i, 1.0f - i, 0.25f*i*i);
+        }
+
+        for (vecmath::simd::kernels const* k : supportedKernels())
+        {
+            float r[4*11];
+            r[4*n] = 42.0f;                 // guard past the end
+            k->mv_mult_n(r, rawData(m), rawData(in[0]), n);
+            ASSERT_FPEQ(r[4*n], 42.0f, EPS);
+
+            for (std::size_t i=0; i<n; ++i)
+            {
+                vecmath::Vector3f expect = m * in[i];
+                ASSERT_FPEQ(r[4*i+0], expect.X(), 1.0e-5f);
+                ASSERT_FPEQ(r[4*i+1], expect.Y(), 1.0e-5f);
+                ASSERT_FPEQ(r[4*i+2], expect.Z(), 1.0e-5f);
+                ASSERT_FPEQ(r[4*i+3], expect.W(), 1.0e-5f);
+            }
+        }
+    }
+}
+
+BTEST(Simd, transformInPlace)
+{
+    vecmath::Matrix3f m = vecmath::Matrix3f::translation(1.0f, 2.0f, 3.0f);
+    vecmath::Vector3f pts[5];
+    for (int i=0; i<5; ++i)
+    {
+        pts[i] = vecmath::Vector3f(float(i), 0.0f, -float(i));
+    }
+
+    vecmath::simd::transform(m, pts, pts, 5);
+
+    for (int i=0; i<5; ++i)
+    {
+        ASSERT_FPEQ(pts[i].X(), i + 1.0f, EPS);
+        ASSERT_FPEQ(pts[i].Y(), 2.0f, EPS);
+        ASSERT_FPEQ(pts[i].Z(), 3.0f - i, EPS);
+        ASSERT_FPEQ(pts[i].W(), 1.0f, EPS);
+    }
+}
@@ -0,0 +1,113 @@
+/**
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/**
+ * Unit tests for the VECMATH_STATS counters and timers.
+ *
+ * runtests builds this without VECMATH_STATS, where every snapshot
+ * must be zero; runtests_stats builds it, and the rest of the
+ * library, with the counters on.
+ */
+#include "vecmath.h"
+#include "vecarray.h"
+#include "circle3pts.h"
+
+#include "test_common.h"
+
+#include <thread>
+
+namespace {
+
+using vecmath::stats::counter;
+
+// What the counters would read: the change, or 0 if disabled.
+uint64_t expect(uint64_t n)
+{
+    return vecmath::stats::enabled ? n : 0;
+}
+
+} // anonymous
+
+BTEST(Stats, counters)
+{
+    vecmath::stats::snapshot const before = vecmath::stats::this_thread();
+
+    vecmath::Matrix3d const m = vecmath::Matrix3d::rotateX(0.5) * vecmath::Matrix3d::translation(1, 2, 3);
+    vecmath::Vector3d v = m * vecmath::Vector3d(1, 0, 0);
+    v = v * m;
+    ASSERT_FPEQ(vecmath::Vector3d(3, 4, 0).length(), 5.0, 1.0e-12);
+    ASSERT_EQ(vecmath::Vector3d(0, 1, 0).length(), 1.0);     // no sqrt
+    v.normalize();
+    vecmath::Vector3f(1, 2, 3).fast_normalize();
+    try {
+        vecmath::circle3pts(vecmath::Vector3d(0, 0, 0), vecmath::Vector3d(1, 1, 1),
+                            vecmath::Vector3d(2, 2, 2));
+        FAIL() << "circle3pts() should have failed for colinear points\n";
+    }
+    catch (vecmath::degenerate_error&) {
+        // PASS, intended failure
+    }
+
+    vecmath::stats::snapshot const d = vecmath::stats::this_thread() - before;
+    ASSERT_EQ(d[counter::mat_mults], expect(1));
+    ASSERT_EQ(d[counter::vec_mults], expect(2));
+    ASSERT_EQ(d[counter::lengths] >= expect(3), true);       // normalize() calls length()
+    ASSERT_EQ(d[counter::normalizes], expect(2));
+    ASSERT_EQ(d[counter::sqrt_skips] >= expect(1), true);
+    ASSERT_EQ(d[counter::degenerate_errors], expect(1));
+
+    ASSERT_EQ(std::string(vecmath::stats::counter_name(0)), "mat_mults");
+    ASSERT_EQ(std::string(vecmath::stats::counter_name(vecmath::stats::counter_count)), "");
+}
+
+BTEST(Stats, timers)
+{
+    vecmath::stats::snapshot const before = vecmath::stats::this_thread();
+
+    vecmath::Vector3Arrayf pts(1000);
+    for (int i=0; i<3; ++i)
+    {
+        VM_STATS_TIMER("test_block");
+        vecmath::transform(vecmath::Matrix3f::rotateZ(0.25f), pts, pts);
+    }
+
+    vecmath::stats::snapshot const d = vecmath::stats::this_thread() - before;
+    vecmath::stats::timer_total const* block = d.timer("test_block");
+    vecmath::stats::timer_total const* transform = d.timer("transform");
+    if (!vecmath::stats::enabled)
+    {
+        ASSERT_EQ(block == nullptr && transform == nullptr, true);
+        return;
+    }
+    ASSERT_EQ(block != nullptr && transform != nullptr, true);
+    ASSERT_EQ(block->calls, 3u);
+    ASSERT_EQ(transform->calls, 3u);
+    ASSERT_EQ(block->nanoseconds >= transform->nanoseconds, true);
+}
+
+BTEST(Stats, threads)
+{
+    vecmath::stats::snapshot const before = vecmath::stats::collect();
+    vecmath::stats::snapshot const mine = vecmath::stats::this_thread();
+
+    float m00 = 0;
+    std::thread t([&m00] {
+        vecmath::Matrix3f m;
+        for (int i=0; i<10; ++i)
+            m = m * vecmath::Matrix3f::rotateY(0.1f);
+        VM_STATS_TIMER("worker");
+        m00 = m(0, 0);
+    });
+    t.join();
+    ASSERT_FPEQ(m00, std::cos(1.0f), 1.0e-5f);
+
+    // the exited thread's counts are kept, and are not this thread's
+    vecmath::stats::snapshot const d = vecmath::stats::collect() - before;
+    ASSERT_EQ(d[counter::mat_mults] >= expect(10), true);
+    ASSERT_EQ((vecmath::stats::this_thread() - mine)[counter::mat_mults], 0u);
+    ASSERT_EQ(d.timer("worker") != nullptr, vecmath::stats::enabled);
+}
@@ -0,0 +1,302 @@
+/**
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/**
+ * Unit tests for text conversion.
+ *
+ * to_chars() is checked against snprintf() and from_chars() against
+ * strtod() and strtof(), which glibc rounds correctly, on random bit
+ * patterns and random decimal strings.
+ */
+#include "vecmath.h"
+#include "vectext.h"
+
+#include "test_common.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+template <typename fptype>
+std::string formatted(fptype x, vecmath::chars_format f, int precision)
+{
+    char buf[512];
+    char* end = vecmath::to_chars(buf, buf + sizeof(buf), x, f, precision);
+    return std::string(buf, end ? end : buf);
+}
+
+template <typename fptype>
+std::string printed(fptype x, char const* format, int precision)
+{
+    char buf[512];
+    std::snprintf(buf, sizeof(buf), format, precision, double(x));
+    return buf;
+}
+
+template <typename fptype>
+bool sameBits(fptype a, fptype b)
+{
+    return std::memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+// A random finite double: raw bits, or a moderate magnitude.
+double randomDouble(std::mt19937_64& rng, int i)
+{
+    double d;
+    do {
+        uint64_t const bits = rng();
+        std::memcpy(&d, &bits, sizeof(d));
+        if (i % 3 == 1)
+            d = std::ldexp(double(bits >> 11), int(rng() % 120) - 80);
+    } while (d != d);
+    return d;
+}
+
+float randomFloat(std::mt19937_64& rng)
+{
+    float f;
+    do {
+        uint32_t const bits = uint32_t(rng());
+        std::memcpy(&f, &bits, sizeof(f));
+    } while (f != f);
+    return f;
+}
+
+// The text operator<< wrote before it used to_chars().
+template <typename fptype>
+std::string streamed(vecmath::Vector3<fptype> const& v)
+{
+    std::ostringstream os;
+    int const prec = (sizeof(fptype) == 4) ? 5 : 8;
+    os << std::fixed << std::setprecision(prec)
+       << '[' << v.X() << ", " << v.Y() << ", " << v.Z() << ", " << v.W() << "]";
+    return os.str();
+}
+
+} // anonymous
+
+BTEST(Text, formatMatchesPrintf)
+{
+    std::mt19937_64 rng(21);
+    for (int i=0; i<20000; ++i)
+    {
+        double const d = randomDouble(rng, i);
+        int const p = 1 + int(rng() % 19);
+        ASSERT_EQ(formatted(d, vecmath::chars_format::general, 17), printed(d, "%.*g", 17));
+        ASSERT_EQ(formatted(d, vecmath::chars_format::general, p), printed(d, "%.*g", p));
+        if (std::abs(d) < 1.0e30)
+        {
+            int const q = int(rng() % 31);
+            ASSERT_EQ(formatted(d, vecmath::chars_format::fixed, q), printed(d, "%.*f", q));
+        }
+
+        float const f = randomFloat(rng);
+        ASSERT_EQ(formatted(f, vecmath::chars_format::general, 9), printed(f, "%.*g", 9));
+        ASSERT_EQ(formatted(f, vecmath::chars_format::fixed, 5), printed(f, "%.*f", 5));
+    }
+
+    // the edges: zeros, subnormals, the largest values, ties, specials
+    double const edges[] = {
+        0.0, -0.0, 5e-324, -2.2250738585072009e-308, 2.2250738585072014e-308,
+        1.7976931348623157e308, 0.5, 1.5, 2.5, 0.125, 1e22, 1e23, 9.5, 99999.5, 0.000012345
+    };
+    for (double d : edges)
+    {
+        for (int p=0; p<=19; ++p)
+        {
+            ASSERT_EQ(formatted(d, vecmath::chars_format::fixed, p), printed(d, "%.*f", p));
+            ASSERT_EQ(formatted(d, vecmath::chars_format::general, p), printed(d, "%.*g", p));
+        }
+    }
+    ASSERT_EQ(formatted(std::numeric_limits<float>::infinity(), vecmath::chars_format::fixed, 5),
+              std::string("inf"));
+    ASSERT_EQ(formatted(-std::numeric_limits<double>::infinity(), vecmath::chars_format::general, -1),
+              std::string("-inf"));
+    ASSERT_EQ(formatted(std::numeric_limits<double>::quiet_NaN(), vecmath::chars_format::general, -1),
+              std::string("nan"));
+
+    // the defaults, and a buffer too small
+    ASSERT_EQ(formatted(0.1f, vecmath::chars_format::general, -1), std::string("0.100000001"));
+    char small[4];
+    ASSERT_EQ(vecmath::to_chars(small, small + 4, 12.25) == nullptr, true);
+    ASSERT_EQ(vecmath::to_chars(small, small + 4, 12.5, vecmath::chars_format::fixed, 1) - small, 4);
+}
+
+BTEST(Text, parseMatchesStrtod)
+{
+    std::mt19937_64 rng(22);
+    for (int i=0; i<20000; ++i)
+    {
+        // what to_chars() writes reads back exactly
+        double const d = randomDouble(rng, i);
+        std::string s = formatted(d, vecmath::chars_format::general, -1);
+        double dd = 0;
+        ASSERT_EQ(vecmath::from_chars(s.data(), s.data() + s.size(), dd) - s.data(), long(s.size()));
+        ASSERT_EQ(sameBits(dd, d), true);
+
+        float const f = randomFloat(rng);
+        s = formatted(f, vecmath::chars_format::general, -1);
+        float ff = 0;
+        vecmath::from_chars(s.data(), s.data() + s.size(), ff);
+        ASSERT_EQ(sameBits(ff, f), true);
+
+        // random decimals: up to 40 digits, exponents far out of range
+        s.clear();
+        int const digits = 1 + int(rng() % ((i % 10 == 0) ? 40 : 20));
+        int const point = int(rng() % (digits + 1));
+        for (int k=0; k<digits; ++k)
+        {
+            if (k == point)
+                s += '.';
+            s += char('0' + rng() % 10);
+        }
+        int const exponent = (i % 4 == 0) ? int(rng() % 80) - 40 : int(rng() % 700) - 350;
+        s += "e" + std::to_string(exponent);
+        vecmath::from_chars(s.data(), s.data() + s.size(), dd);
+        vecmath::from_chars(s.data(), s.data() + s.size(), ff);
+        ASSERT_EQ(sameBits(dd, std::strtod(s.c_str(), nullptr)), true);
+        ASSERT_EQ(sameBits(ff, std::strtof(s.c_str(), nullptr)), true);
+    }
+
+    // halfway cases and the ends of the range
+    char const* const cases[] = {
+        "9007199254740993", "9007199254740993.00000000000000000000000000001",
+        "2.4703282292062327e-324", "2.4703282292062328e-324", "1.7976931348623158e308",
+        "1.7976931348623159e308", "1e-400", "1e400", "-0", ".5", "5.", "0.000e99999",
+        "123456789012345678901234567890e-30"
+    };
+    for (char const* c : cases)
+    {
+        double v = -1;
+        char* end;
+        double const want = std::strtod(c, &end);
+        ASSERT_EQ(vecmath::from_chars(c, c + std::strlen(c), v), end);
+        ASSERT_EQ(sameBits(v, want), true);
+    }
+
+    // float halfway cases, which double rounds the wrong way
+    char const* const floatCases[] = {
+        "16777217", "16777219", "1.000000059604644775390625", "1.0000000596046448",
+        "3.4028235677973366e38", "3.4028235e38", "1.4012984643e-45", "7.0064923216e-46",
+        "0.0000000000000000000000000000000000000117549435"
+    };
+    for (char const* c : floatCases)
+    {
+        float f = -1;
+        vecmath::from_chars(c, c + std::strlen(c), f);
+        ASSERT_EQ(sameBits(f, std::strtof(c, nullptr)), true);
+    }
+
+    double v = 7;
+    char const* const text = "1e+x -Inf nan";
+    ASSERT_EQ(vecmath::from_chars(text, text + 13, v) - text, 1);      // "e+" with no digits isn't taken
+    ASSERT_EQ(v, 1.0);
+    ASSERT_EQ(vecmath::from_chars(text + 5, text + 13, v) - text, 9);
+    ASSERT_EQ(v, -std::numeric_limits<double>::infinity());
+    ASSERT_EQ(vecmath::from_chars(text + 10, text + 13, v) - text, 13);
+    ASSERT_EQ(v != v, true);
+    ASSERT_EQ(vecmath::from_chars(text + 4, text + 13, v) == nullptr, true);  // whitespace
+    ASSERT_EQ(vecmath::from_chars(text, text, v) == nullptr, true);
+}
+
+BTEST(Text, arrays)
+{
+    std::vector<vecmath::Vector3f> points(1000);
+    std::vector<vecmath::Matrix3d> mats(100);
+    for (std::size_t i=0; i<points.size(); ++i)
+        points[i] = vecmath::Vector3f(std::sin(float(i)), float(i) * 1.0e-3f, -1.0e20f / float(i + 1));
+    for (std::size_t i=0; i<mats.size(); ++i)
+        mats[i] = vecmath::Matrix3d::rotateEuler(double(i), 0.5, -0.25) *
+                  vecmath::Matrix3d::translation(double(i), 1.0e-9, 3.0);
+
+    // round trip exactly
+    std::vector<char> buf(vecmath::max_text_size<vecmath::Vector3f>(points.size()));
+    vecmath::text_result const w = vecmath::write_text(points, buf.data(), buf.size());
+    ASSERT_EQ(w.count, points.size());
+    ASSERT_EQ(std::count(buf.begin(), buf.begin() + w.bytes, '\n'), long(points.size()));
+    std::vector<vecmath::Vector3f> back(points.size() + 5);
+    vecmath::text_result const r = vecmath::read_text(buf.data(), w.bytes, back);
+    ASSERT_EQ(r.count, points.size());
+    ASSERT_EQ(r.bytes, w.bytes - 1);                                    // the last newline
+    ASSERT_EQ(std::memcmp(back.data(), points.data(), points.size() * sizeof(points[0])), 0);
+
+    buf.resize(vecmath::max_text_size<vecmath::Matrix3d>(mats.size()));
+    vecmath::text_result const wm = vecmath::write_text(mats, buf.data(), buf.size());
+    std::vector<vecmath::Matrix3d> mback(mats.size());
+    ASSERT_EQ(vecmath::read_text(buf.data(), wm.bytes, mback).count, mats.size());
+    ASSERT_EQ(std::memcmp(mback.data(), mats.data(), mats.size() * sizeof(mats[0])), 0);
+
+    // fixed, as printf would; a short buffer takes whole lines
+    std::vector<vecmath::Vector3d> const one(1, vecmath::Vector3d(1.5, -0.25, 1.0e6));
+    char line[64];
+    vecmath::text_options const fixed(vecmath::chars_format::fixed, 3);
+    vecmath::text_result const wl = vecmath::write_text(one, line, sizeof(line), fixed);
+    ASSERT_EQ(std::string(line, wl.bytes), std::string("1.500 -0.250 1000000.000\n"));
+    ASSERT_EQ(vecmath::write_text(one, line, wl.bytes - 1, fixed).count, 0u);
+    ASSERT_EQ(vecmath::write_text(one, line, wl.bytes, fixed).count, 1u);
+
+    // a partial out: the rest can be read from r.bytes on
+    std::string const text = "1, 2, 3\n4 5 6   7\t8\r\n9 ";
+    std::vector<vecmath::Vector3d> two(2);
+    vecmath::text_result const rp = vecmath::read_text(text.data(), text.size(), two);
+    ASSERT_EQ(rp.count, 2u);
+    ASSERT_EQ(two[1].Z(), 6.0);
+    ASSERT_EQ(two[1].W(), 1.0);
+    ASSERT_EQ(vecmath::read_text(text.data() + rp.bytes, text.size() - rp.bytes, two).count, 1u);
+    ASSERT_EQ(two[0].Y(), 8.0);
+
+    try {
+        vecmath::read_text(text.data(), text.size() - 3, back);
+        FAIL() << "read_text() should have failed for an incomplete record\n";
+    }
+    catch (vecmath::text_error&) {
+        // PASS, intended failure
+    }
+    std::string const bad = "1 2 3 4 5x 6";
+    try {
+        vecmath::read_text(bad.data(), bad.size(), two);
+        FAIL() << "read_text() should have failed for a bad number\n";
+    }
+    catch (vecmath::text_error& e) {
+        ASSERT_EQ(std::string(e.what()), std::string("read_text(): bad number at byte 8"));
+    }
+}
+
+BTEST(Text, printUnchanged)
+{
+    std::mt19937_64 rng(23);
+    for (int i=0; i<500; ++i)
+    {
+        vecmath::Vector3f const f(randomFloat(rng), float(i) * 0.37f, -1.0f / float(i + 1));
+        vecmath::Vector3d const d(randomDouble(rng, i), double(i) * 0.37, -0.0);
+        std::ostringstream os;
+        os << f;
+        ASSERT_EQ(os.str(), streamed(f));
+        os.str("");
+        os << d;
+        ASSERT_EQ(os.str(), streamed(d));
+    }
+
+    std::ostringstream os;
+    os << std::scientific << vecmath::Matrix3f::rotateZ(0.5f) << 0.25;
+    ASSERT_EQ(os.str(), std::string("[[0.87758, -0.47943, 0.00000, 0.00000],\n"
+                                    " [0.47943, 0.87758, 0.00000, 0.00000],\n"
+                                    " [0.00000, 0.00000, 1.00000, 0.00000],\n"
+                                    " [0.00000, 0.00000, 0.00000, 1.00000]]\n0.25"));
+
+    // a field width pads the opening bracket, and is used up by it
+    os.str("");
+    os << std::defaultfloat << std::setw(10) << vecmath::Vector3f(1, -2, 0.5f) << 7;
+    ASSERT_EQ(os.str(), std::string("         [1.00000, -2.00000, 0.50000, 1.00000]7"));
+}
@@ -0,0 +1,163 @@
+/**
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/**
+ * Unit tests for the incremental transform cache
+ */
+#include "vecmath.h"
+#include "vechierarchy.h"
+
+#include "test_common.h"
+
+#include <cstring>
+#include <vector>
+
+namespace {
+
+using vecmath::Matrix3d;
+
+bool same(Matrix3d const& a, Matrix3d const& b)
+{
+    return std::memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+// root 0 -> 1 -> 2, 0 -> 3, and a second root 4 -> 5
+vecmath::TransformCached makeCache(std::vector<Matrix3d>& locals)
+{
+    int32_t const parents[] = {-1, 0, 1, 0, -1, 4};
+    vecmath::TransformCached cache;
+    for (int i=0; i<6; ++i)
+    {
+        locals.push_back(Matrix3d::translation(i, 2.0 * i, -1.0) * Matrix3d::rotateY(0.1 * i));
+        cache.add(parents[i], locals.back());
+    }
+    return cache;
+}
+
+} // anonymous
+
+BTEST(TransformCache, lazyWorld)
+{
+    std::vector<Matrix3d> locals;
+    vecmath::TransformCached cache = makeCache(locals);
+    ASSERT_EQ(cache.size(), 6u);
+    ASSERT_EQ(cache.parent(2), 1);
+    ASSERT_EQ(cache.generation(2), 0u);
+
+    // the first query computes the path from the root
+    ASSERT_EQ(same(cache.world(2), locals[0] * locals[1] * locals[2]), true);
+    ASSERT_EQ(cache.stats().worlds_computed, 3u);
+    ASSERT_EQ(cache.stats().worlds_skipped, 0u);
+
+    // then only node 3 is new
+    ASSERT_EQ(same(cache.world(3), locals[0] * locals[3]), true);
+    ASSERT_EQ(cache.stats().worlds_computed, 4u);
+    ASSERT_EQ(cache.stats().worlds_skipped, 1u);
+
+    cache.resetCounters();
+    uint64_t const gen2 = cache.generation(2);
+    cache.world(2);
+    ASSERT_EQ(cache.stats().worlds_computed, 0u);
+    ASSERT_EQ(cache.stats().worlds_skipped, 3u);
+    ASSERT_EQ(cache.generation(2), gen2);
+
+    // moving the root reaches its descendants, not the other tree
+    locals[0] = Matrix3d::rotateZ(1.0);
+    cache.setLocal(0, locals[0]);
+    cache.world(5);
+    cache.resetCounters();
+    ASSERT_EQ(same(cache.world(2), locals[0] * locals[1] * locals[2]), true);
+    ASSERT_EQ(cache.stats().worlds_computed, 3u);
+    ASSERT_EQ(cache.generation(2) > gen2, true);
+    ASSERT_EQ(same(cache.world(3), locals[0] * locals[3]), true);
+    ASSERT_EQ(cache.stats().worlds_computed, 4u);
+    cache.world(5);
+    ASSERT_EQ(cache.stats().worlds_computed, 4u);
+
+    // moving a leaf recomputes only the leaf
+    locals[2] = Matrix3d::translation(0.0, 0.0, 5.0);
+    cache.setLocal(2, locals[2]);
+    cache.resetCounters();
+    ASSERT_EQ(same(cache.world(2), locals[0] * locals[1] * locals[2]), true);
+    ASSERT_EQ(cache.stats().worlds_computed, 1u);
+    ASSERT_EQ(cache.stats().worlds_skipped, 2u);
+}
+
+BTEST(TransformCache, inverses)
+{
+    std::vector<Matrix3d> locals;
+    vecmath::TransformCached cache = makeCache(locals);
+
+    Matrix3d const inv = cache.inverse(2);
+    ASSERT_EQ(same(inv, cache.world(2).inverse()), true);
+    cache.inverse(2);
+    ASSERT_EQ(cache.stats().inverses_computed, 1u);
+    ASSERT_EQ(cache.stats().inverses_skipped, 1u);
+
+    // a change above recomputes the inverse, a change elsewhere doesn't
+    cache.setLocal(3, Matrix3d::scale(2.0, 2.0, 2.0));
+    cache.inverse(2);
+    ASSERT_EQ(cache.stats().inverses_computed, 1u);
+    cache.setLocal(1, Matrix3d::rotateX(0.5));
+    cache.inverse(2);
+    ASSERT_EQ(cache.stats().inverses_computed, 2u);
+
+    cache.setLocal(5, Matrix3d::scale(0.0, 1.0, 1.0));
+    try {
+        cache.inverse(5);
+        FAIL() << "inverse() should have failed for a singular transform\n";
+    }
+    catch (vecmath::degenerate_error&) {
+        // PASS, intended failure
+    }
+}
+
+BTEST(TransformCache, update)
+{
+    std::vector<int32_t> parents;
+    std::vector<vecmath::Matrix3f> locals;
+    vecmath::TransformCachef cache;
+    for (int32_t i=0; i<500; ++i)
+    {
+        parents.push_back(i % 50 == 0 ? -1 : i / 2);
+        locals.push_back(vecmath::Matrix3f::translation(0.01f * i, 1.0f, 0.0f) *
+                         vecmath::Matrix3f::rotateZ(0.002f * i));
+        cache.add(parents.back(), locals.back());
+    }
+
+    std::vector<vecmath::Matrix3f> expect(locals.size());
+    vecmath::compose_hierarchy(parents, locals, expect);
+    cache.update();
+    ASSERT_EQ(cache.stats().worlds_computed, 500u);
+    for (std::size_t i=0; i<expect.size(); ++i)
+        ASSERT_EQ(std::memcmp(&cache.world(i), &expect[i], sizeof(expect[i])), 0);
+
+    // node 101's subtree is 101, 202-203 and 404-407
+    locals[101] = vecmath::Matrix3f::rotateX(0.25f);
+    cache.setLocal(101, locals[101]);
+    cache.resetCounters();
+    cache.update();
+    ASSERT_EQ(cache.stats().worlds_computed, 7u);
+    ASSERT_EQ(cache.stats().worlds_skipped, 493u);
+    vecmath::compose_hierarchy(parents, locals, expect);
+    ASSERT_EQ(std::memcmp(&cache.world(407), &expect[407], sizeof(expect[407])), 0);
+
+    try {
+        cache.add(500, vecmath::Matrix3f());
+        FAIL() << "add() should have rejected a missing parent\n";
+    }
+    catch (vecmath::index_error&) {
+        // PASS, intended failure
+    }
+    try {
+        cache.world(500);
+        FAIL() << "world() should have failed for a missing node\n";
+    }
+    catch (vecmath::index_error&) {
+        // PASS, intended failure
+    }
+}
@@ -0,0 +1,107 @@
+/**
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/**
+ * Unit tests for batched sine and cosine
+ */
+#include "vecmath.h"
+#include "vectrig.h"
+
+#include "test_common.h"
+
+#include <cmath>
+#include <vector>
+
+BTEST(Trig, sincosFloat)
+{
+    // every quadrant, both signs, and large arguments
+    for (int i=-2000; i<=2000; ++i)
+    {
+        float const x = i * 0.0123f + ((i % 7 == 0) ? i * 250.0f : 0.0f);
+        float s, c;
+        vecmath::sincos(x, s, c);
+        ASSERT_FPEQ(s, float(std::sin(double(x))), 2.0e-7f);
+        ASSERT_FPEQ(c, float(std::cos(double(x))), 2.0e-7f);
+    }
+}
+
+BTEST(Trig, sincosDouble)
+{
+    for (int i=-2000; i<=2000; ++i)
+    {
+        double const x = i * 0.0123 + ((i % 7 == 0) ? i * 250.0 : 0.0);
+        double s, c;
+        vecmath::sincos(x, s, c);
+        ASSERT_FPEQ(s, std::sin(x), 1.0e-15);
+        ASSERT_FPEQ(c, std::cos(x), 1.0e-15);
+    }
+}
+
+BTEST(Trig, sincosOutOfRange)
+{
+    // the quadrant, read from the bits of k + round_magic
+    ASSERT_EQ(vecmath::detail::quadrant(12.0 + vecmath::detail::round_magic), 12u);
+    ASSERT_EQ(vecmath::detail::quadrant(-3.0 + vecmath::detail::round_magic) & 3, 1u);
+
+    // in range at the documented limit, and some answer far out of it
+    float s, c;
+    vecmath::sincos(1.0e6f, s, c);
+    ASSERT_FPEQ(s, float(std::sin(1.0e6)), 2.0e-7f);
+    vecmath::sincos(3.0e38f, s, c);
+    vecmath::sincos(std::nanf(""), s, c);
+    double ds, dc;
+    vecmath::sincos(-1.0e300, ds, dc);
+    vecmath::sincos(std::nan(""), ds, dc);
+}
+
+BTEST(Trig, sincosBatch)
+{
+    std::size_t const n = 1001;
+    std::vector<float> x(n), s(n), c(n);
+    for (std::size_t i=0; i<n; ++i)
+    {
+        x[i] = float(i) * 0.05f - 25.0f;
+    }
+
+    vecmath::sincos_batch(x.data(), s.data(), c.data(), n);
+    for (std::size_t i=0; i<n; ++i)
+    {
+        float es, ec;
+        vecmath::sincos(x[i], es, ec);
+        ASSERT_EQ(s[i], es);
+        ASSERT_EQ(c[i], ec);
+    }
+}
+
+BTEST(Trig, rotateEulerBatch)
+{
+    using vecmath::Matrix3f;
+
+    // more than one chunk, and a partial one
+    std::size_t const n = 300;
+    std::vector<float> x(n), y(n), z(n);
+    for (std::size_t i=0; i<n; ++i)
+    {
+        x[i] = 0.01f * i;
+        y[i] = -0.02f * i;
+        z[i] = 0.03f * i + 1.0f;
+    }
+
+    std::vector<Matrix3f> out(n);
+    vecmath::rotateEuler_batch(x.data(), y.data(), z.data(), out.data(), n);
+    for (std::size_t i=0; i<n; ++i)
+    {
+        Matrix3f const e = Matrix3f::rotateEuler(x[i], y[i], z[i]);
+        for (uint32_t r=0; r<4; ++r)
+        {
+            for (uint32_t c=0; c<4; ++c)
+            {
+                ASSERT_FPEQ(out[i].get(r,c), e.get(r,c), 1.0e-6f);
+            }
+        }
+    }
+}
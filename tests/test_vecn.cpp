@@ -0,0 +1,164 @@
+/**
+ * The "vecmath" 3D vector library
+ *
+ * Copyright 1996-2022 Brent Burton
+ * Licensed under the MIT License. See LICENSE for details.
+ *
+ */
+/**
+ * Unit tests for VectorN<> and MatrixN<>.
+ *
+ * The 4-component forms are checked against Vector3<> and Matrix3<>,
+ * and the 2D forms against the 3D ones with Z = 0.
+ */
+#include "vecmath.h"
+#include "vecn.h"
+#include "circle3pts.h"
+
+#include "test_common.h"
+
+#include <type_traits>
+
+using vecmath::Vector2f;
+using vecmath::Vector2d;
+using vecmath::Vector3f;
+using vecmath::Vector3d;
+
+static_assert(sizeof(Vector2f) == 2 * sizeof(float), "Vector2f holds 2 floats");
+static_assert(sizeof(vecmath::VectorN<double, 3>) == 3 * sizeof(double), "no padding for N = 3");
+static_assert(sizeof(vecmath::Matrix2x2f) == 4 * sizeof(float), "Matrix2x2f holds 4 floats");
+static_assert(sizeof(vecmath::Matrix4x4f) == sizeof(vecmath::Matrix3f), "as large as Matrix3f");
+static_assert(std::is_trivially_copyable<Vector2d>::value, "Vector2d is trivially copyable");
+static_assert(std::is_trivially_copyable<vecmath::Matrix3x3d>::value, "Matrix3x3d is trivially copyable");
+
+BTEST(VecN, basics)
+{
+    Vector2f const a;
+    ASSERT_EQ(a.X(), 0.0f);
+    ASSERT_EQ(a.Y(), 0.0f);
+
+    vecmath::VectorN<double, 3> v(1, 2, 2);
+    ASSERT_EQ(v.size(), std::size_t(3));
+    ASSERT_EQ(v.Z(), 2.0);
+    ASSERT_EQ(v.length_squared(), 9.0);
+    ASSERT_EQ(v.length(), 3.0);
+    v.normalize();
+    ASSERT_FPEQ(v.Y(), 2.0 / 3, 1.0e-15);
+
+    Vector2d const b(3, -4), c(1, 0.5);
+    ASSERT_EQ((b + c) == Vector2d(4, -3.5), true);
+    ASSERT_EQ((b - c) == Vector2d(2, -4.5), true);
+    ASSERT_EQ((-b) == Vector2d(-3, 4), true);
+    ASSERT_EQ((b * 2.0) == (2.0 * b), true);
+    ASSERT_EQ((b * 2.0) != b, true);
+    ASSERT_EQ(vecmath::dot(b, c), 1.0);
+
+    Vector2d z;
+    z.normalize();
+    ASSERT_EQ(z == Vector2d(), true);
+
+    vecmath::Vector4f const w(1, 2, 3, 4);
+    ASSERT_EQ(w.W(), 4.0f);
+    ASSERT_EQ(w.data()[2], 3.0f);
+}
+
+BTEST(VecN, matchesVector3)
+{
+    Vector3d const a(1.5, -2, 0.25), b(-3, 0.5, 4);
+    vecmath::VectorN<double, 3> const an = vecmath::to_vectorn<3>(a), bn = vecmath::to_vectorn<3>(b);
+    ASSERT_EQ(vecmath::dot(an, bn), vecmath::dot(a, b));
+
+    Vector3d const c = vecmath::cross(a, b);
+    vecmath::VectorN<double, 3> const cn = vecmath::cross(an, bn);
+    ASSERT_EQ(cn.X(), c.X());
+    ASSERT_EQ(cn.Y(), c.Y());
+    ASSERT_EQ(cn.Z(), c.Z());
+
+    // Vector3<> * Matrix3<> is the 4x4 product with W
+    vecmath::Matrix3d const m = vecmath::Matrix3d::translation(1, 2, 3) *
+                                vecmath::Matrix3d::rotateEuler(0.3, -0.7, 1.1);
+    vecmath::Matrix4x4d const mn = vecmath::to_matrixn(m);
+    Vector3d const p = m * a;
+    vecmath::Vector4d const pn = mn * vecmath::to_vectorn<4>(a);
+    ASSERT_EQ(pn.X(), p.X());
+    ASSERT_EQ(pn.Y(), p.Y());
+    ASSERT_EQ(pn.Z(), p.Z());
+    ASSERT_EQ(pn.W(), p.W());
+
+    Vector3d const q = a * m;
+    vecmath::Vector4d const qn = vecmath::to_vectorn<4>(a) * mn;
+    ASSERT_EQ(qn.X(), q.X());
+    ASSERT_EQ(qn.W(), q.W());
+
+    vecmath::VectorN<double, 3> const pt = vecmath::transform_point(mn, an);
+    ASSERT_EQ(pt.Z(), p.Z());
+
+    vecmath::Matrix3d const mm = m * m.inverse();
+    vecmath::Matrix4x4d const mmn = mn * vecmath::to_matrixn(m.inverse());
+    ASSERT_EQ(vecmath::to_matrix3(mmn)(1,2), mm(1,2));
+    ASSERT_EQ(vecmath::to_matrix3(mn.transpose())(0,3), m(3,0));
+
+    Vector3d const back = vecmath::to_vector3(vecmath::to_vectorn<2>(a));
+    ASSERT_EQ(back.X(), a.X());
+    ASSERT_EQ(back.Z(), 0.0);
+    ASSERT_EQ(back.W(), 1.0);
+}
+
+BTEST(VecN, transforms2D)
+{
+    // A 2D affine transform is the 3D one in the X,Y plane.
+    vecmath::Matrix3x3d const m = vecmath::Matrix3x3d::translation(Vector2d(1, -2)) *
+                                  vecmath::Matrix3x3d::rotation(0.7) *
+                                  vecmath::Matrix3x3d::scale(Vector2d(2, 0.5));
+    vecmath::Matrix3d const m3 = vecmath::Matrix3d::translation(1, -2, 0) *
+                                 vecmath::Matrix3d::rotateZ(0.7) *
+                                 vecmath::Matrix3d::scale(2, 0.5, 1);
+    Vector2d const p(3, 4);
+    Vector2d const t = vecmath::transform_point(m, p);
+    Vector3d const t3 = m3 * Vector3d(3, 4, 0);
+    ASSERT_FPEQ(t.X(), t3.X(), 1.0e-12);
+    ASSERT_FPEQ(t.Y(), t3.Y(), 1.0e-12);
+
+    Vector2d const d = vecmath::transform_direction(m, p);
+    ASSERT_FPEQ(d.X(), t3.X() - 1, 1.0e-12);
+
+    // non-square products
+    vecmath::MatrixN<double, 2, 3> a;
+    a(0,2) = 5;
+    vecmath::MatrixN<double, 3, 2> const at = a.transpose();
+    ASSERT_EQ(at(2,0), 5.0);
+    vecmath::Matrix2x2d const aat = a * at;
+    ASSERT_EQ(aat(0,0), 26.0);
+    ASSERT_EQ(aat(1,1), 1.0);
+    Vector2d const av = a * vecmath::VectorN<double, 3>(1, 1, 1);
+    ASSERT_EQ(av.X(), 6.0);
+    ASSERT_EQ(vecmath::Matrix2x2d::zero()(0,0), 0.0);
+
+    try {
+        (void) a.get(2, 0);
+        FAIL() << "get() should have failed for row 2\n";
+    }
+    catch (vecmath::index_error&) {
+        // PASS, intended failure
+    }
+}
+
+BTEST(VecN, circle)
+{
+    Vector2f const center = vecmath::circle3pts(Vector2f(1, 1), Vector2f(2, 0), Vector2f(3, 1));
+    ASSERT_FPEQ(center.X(), 2.0f, EPS);
+    ASSERT_FPEQ(center.Y(), 1.0f, EPS);
+
+    Vector3d const c3 = vecmath::circle3pts(Vector3d(-1.5, 0.25, 0), Vector3d(2, 3, 0), Vector3d(0.5, -4, 0));
+    Vector2d const c2 = vecmath::circle3pts(Vector2d(-1.5, 0.25), Vector2d(2, 3), Vector2d(0.5, -4));
+    ASSERT_FPEQ(c2.X(), c3.X(), 1.0e-12);
+    ASSERT_FPEQ(c2.Y(), c3.Y(), 1.0e-12);
+
+    try {
+        (void) vecmath::circle3pts(Vector2d(0, 0), Vector2d(1, 1), Vector2d(2, 2));
+        FAIL() << "circle3pts() should have failed for colinear points\n";
+    }
+    catch (vecmath::degenerate_error&) {
+        // PASS, intended failure
+    }
+}